@@ -209,6 +209,77 @@ impl Frame {
     }
 }
 
+/// NV12 Direct3D 11 texture shared by NT handle, drawn without a CPU copy.
+///
+/// The texture must live on the adapter gpui renders with and be guarded by a keyed mutex that the
+/// producer releases with key 0; the renderer holds it with key 0 while sampling.
+#[cfg(target_os = "windows")]
+#[derive(Clone)]
+pub struct SharedTexture {
+    handle: usize,
+    id: u64,
+    width: u32,
+    height: u32,
+    _owner: Arc<dyn Send + Sync>,
+}
+
+#[cfg(target_os = "windows")]
+impl SharedTexture {
+    /// Wrap a shared texture handle.
+    ///
+    /// `id` must differ between textures for as long as any of them may be drawn, and `owner`
+    /// keeps the handle open.
+    ///
+    /// # Safety
+    ///
+    /// `handle` must be an NT handle to an NV12 `ID3D11Texture2D` with a keyed mutex that stays
+    /// valid while `owner` is alive.
+    pub unsafe fn new(
+        handle: *mut std::ffi::c_void,
+        id: u64,
+        width: u32,
+        height: u32,
+        owner: Arc<dyn Send + Sync>,
+    ) -> Self {
+        Self {
+            handle: handle as usize,
+            id,
+            width,
+            height,
+            _owner: owner,
+        }
+    }
+
+    /// Texture width in pixels.
+    pub fn width(&self) -> u32 {
+        self.width
+    }
+
+    /// Texture height in pixels.
+    pub fn height(&self) -> u32 {
+        self.height
+    }
+
+    pub(crate) fn id(&self) -> u64 {
+        self.id
+    }
+
+    pub(crate) fn handle(&self) -> *mut std::ffi::c_void {
+        self.handle as *mut std::ffi::c_void
+    }
+}
+
+#[cfg(target_os = "windows")]
+impl std::fmt::Debug for SharedTexture {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("SharedTexture")
+            .field("id", &self.id)
+            .field("width", &self.width)
+            .field("height", &self.height)
+            .finish_non_exhaustive()
+    }
+}
+
 /// Supported frame sources for the video element.
 #[derive(Clone, Debug)]
 pub enum VideoFrame {
@@ -217,6 +288,9 @@ pub enum VideoFrame {
     #[cfg(target_os = "macos")]
     /// macOS CoreVideo pixel buffer.
     CvPixelBuffer(CVPixelBuffer),
+    #[cfg(target_os = "windows")]
+    /// Shared Direct3D 11 NV12 texture.
+    D3D11Texture(SharedTexture),
 }
 
 impl VideoFrame {
@@ -226,6 +300,8 @@ impl VideoFrame {
             VideoFrame::Nv12(frame) => frame.width(),
             #[cfg(target_os = "macos")]
             VideoFrame::CvPixelBuffer(buffer) => buffer.get_width() as u32,
+            #[cfg(target_os = "windows")]
+            VideoFrame::D3D11Texture(texture) => texture.width(),
         }
     }
 
@@ -235,6 +311,8 @@ impl VideoFrame {
             VideoFrame::Nv12(frame) => frame.height(),
             #[cfg(target_os = "macos")]
             VideoFrame::CvPixelBuffer(buffer) => buffer.get_height() as u32,
+            #[cfg(target_os = "windows")]
+            VideoFrame::D3D11Texture(texture) => texture.height(),
         }
     }
 }
@@ -252,6 +330,13 @@ impl From<CVPixelBuffer> for VideoFrame {
     }
 }
 
+#[cfg(target_os = "windows")]
+impl From<SharedTexture> for VideoFrame {
+    fn from(value: SharedTexture) -> Self {
+        VideoFrame::D3D11Texture(value)
+    }
+}
+
 /// Handle used to submit frames to a [`Video`] element.
 #[derive(Clone)]
 pub struct VideoHandle {
@@ -449,6 +534,15 @@ impl Element for Video {
                     generation,
                 );
             }
+            #[cfg(target_os = "windows")]
+            VideoFrame::D3D11Texture(texture) => {
+                window.paint_surface(
+                    new_bounds,
+                    SurfaceSource::D3D11Texture(texture),
+                    Some(surface_id),
+                    generation,
+                );
+            }
         }
     }
 }
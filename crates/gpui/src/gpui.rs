@@ -311,4 +311,7 @@ pub struct GpuSpecs {
     pub driver_name: String,
     /// Further information about the driver, as reported by Vulkan.
     pub driver_info: String,
+    /// LUID of the DXGI adapter the window renders on, as `HighPart << 32 | LowPart`. Only set by
+    /// the DirectX renderer; shared textures have to be created on this adapter.
+    pub adapter_luid: Option<u64>,
 }
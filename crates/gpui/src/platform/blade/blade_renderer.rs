@@ -580,6 +580,7 @@ impl BladeRenderer {
             device_name: info.device_name.clone(),
             driver_name: info.driver_name.clone(),
             driver_info: info.driver_info.clone(),
+            adapter_luid: None,
         }
     }
 
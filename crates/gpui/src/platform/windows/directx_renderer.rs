@@ -32,6 +32,10 @@ pub(crate) const DISABLE_DIRECT_COMPOSITION: &str = "GPUI_DISABLE_DIRECT_COMPOSI
 const RENDER_TARGET_FORMAT: DXGI_FORMAT = DXGI_FORMAT_B8G8R8A8_UNORM;
 // This configuration is used for MSAA rendering on paths only, and it's guaranteed to be supported by DirectX 11.
 const PATH_MULTISAMPLE_COUNT: u32 = 4;
+// Opened shared video textures kept around; producers recycle a handful, so this covers a full cycle.
+const SHARED_TEXTURE_CACHE_SIZE: usize = 16;
+// A frame whose producer still holds its keyed mutex after this long is skipped rather than waited for.
+const SHARED_TEXTURE_SYNC_TIMEOUT_MS: u32 = 4;
 
 pub(crate) struct FontInfo {
     pub gamma_ratios: [f32; 4],
@@ -48,6 +52,16 @@ pub(crate) struct DirectXRenderer {
     direct_composition: Option<DirectComposition>,
     font_info: &'static FontInfo,
     surface_cache: FxHashMap<SurfaceId, DirectXSurfaceCache>,
+    shared_textures: FxHashMap<u64, DirectXSharedTexture>,
+    surface_draws: u64,
+}
+
+#[derive(Clone)]
+struct DirectXSharedTexture {
+    last_used: u64,
+    mutex: IDXGIKeyedMutex,
+    y_view: ID3D11ShaderResourceView,
+    uv_view: ID3D11ShaderResourceView,
 }
 
 struct DirectXSurfaceCache {
@@ -179,6 +193,8 @@ impl DirectXRenderer {
             direct_composition,
             font_info: Self::get_font_info(),
             surface_cache: FxHashMap::default(),
+            shared_textures: FxHashMap::default(),
+            surface_draws: 0,
         })
     }
 
@@ -290,6 +306,7 @@ impl DirectXRenderer {
         self.pipelines = pipelines;
         self.direct_composition = direct_composition;
         self.surface_cache.clear();
+        self.shared_textures.clear();
 
         unsafe {
             self.devices
@@ -303,6 +320,7 @@ impl DirectXRenderer {
         self.pre_draw()?;
         if scene.surfaces.is_empty() {
             self.surface_cache.clear();
+            self.shared_textures.clear();
         }
         for batch in scene.batches() {
             match batch {
@@ -593,60 +611,45 @@ impl DirectXRenderer {
             return Ok(());
         }
         let mut seen_surfaces = FxHashSet::default();
+        self.surface_draws += 1;
 
         for surface in surfaces {
-            let SurfaceSource::Nv12(frame) = &surface.source;
             let Some(surface_id) = surface.surface_id else {
                 continue;
             };
             seen_surfaces.insert(surface_id);
 
-            let size = Size {
-                width: DevicePixels::from(frame.width as i32),
-                height: DevicePixels::from(frame.height as i32),
-            };
-            let uv_size = Size {
-                width: DevicePixels::from(frame.uv_width() as i32),
-                height: DevicePixels::from(frame.uv_height() as i32),
-            };
-
-            let mut entry = if let Some(entry) = self.surface_cache.remove(&surface_id) {
-                entry
-            } else {
-                self.create_nv12_surface_cache(frame)?
+            let (y_view, uv_view, mutex) = match &surface.source {
+                SurfaceSource::Nv12(frame) => {
+                    let (y_view, uv_view) =
+                        self.prepare_nv12_surface(surface_id, surface, frame)?;
+                    (y_view, uv_view, None)
+                }
+                SurfaceSource::D3D11Texture(texture) => {
+                    self.surface_cache.remove(&surface_id);
+                    let Some(entry) = self.open_shared_texture(texture).log_err() else {
+                        continue;
+                    };
+                    // The raw call keeps WAIT_TIMEOUT, which the wrapper reports as success.
+                    let acquired = unsafe {
+                        (Interface::vtable(&entry.mutex).AcquireSync)(
+                            Interface::as_raw(&entry.mutex),
+                            0,
+                            SHARED_TEXTURE_SYNC_TIMEOUT_MS,
+                        )
+                    };
+                    if acquired != windows::Win32::Foundation::S_OK {
+                        continue;
+                    }
+                    (entry.y_view, entry.uv_view, Some(entry.mutex))
+                }
             };
 
-            if entry.size != size || entry.uv_size != uv_size {
-                entry = self.create_nv12_surface_cache(frame)?;
+            let drawn = self.draw_surface_instance(surface, &y_view, &uv_view);
+            if let Some(mutex) = mutex {
+                unsafe { mutex.ReleaseSync(0) }.log_err();
             }
-
-            if entry.generation != surface.frame_generation {
-                self.upload_nv12_frame(frame, &entry);
-                entry.generation = surface.frame_generation;
-            }
-
-            let y_view = entry.y_view.clone();
-            let uv_view = entry.uv_view.clone();
-            self.surface_cache.insert(surface_id, entry);
-
-            let instance = SurfaceInstance {
-                bounds: surface.bounds,
-                content_mask: surface.content_mask.clone(),
-            };
-            self.pipelines.surfaces.update_buffer(
-                &self.devices.device,
-                &self.devices.device_context,
-                std::slice::from_ref(&instance),
-            )?;
-            self.pipelines.surfaces.draw_with_textures(
-                &self.devices.device_context,
-                &y_view,
-                &uv_view,
-                &self.resources.viewport,
-                &self.globals.global_params_buffer,
-                &self.globals.sampler,
-                1,
-            )?;
+            drawn?;
         }
 
         let mut to_remove = Vec::new();
@@ -658,10 +661,112 @@ impl DirectXRenderer {
         for surface_id in to_remove {
             self.surface_cache.remove(&surface_id);
         }
+        while self.shared_textures.len() > SHARED_TEXTURE_CACHE_SIZE {
+            let Some(oldest) = self
+                .shared_textures
+                .iter()
+                .min_by_key(|(_, entry)| entry.last_used)
+                .map(|(id, _)| *id)
+            else {
+                break;
+            };
+            self.shared_textures.remove(&oldest);
+        }
 
         Ok(())
     }
 
+    fn prepare_nv12_surface(
+        &mut self,
+        surface_id: SurfaceId,
+        surface: &PaintSurface,
+        frame: &Nv12Frame,
+    ) -> Result<(ID3D11ShaderResourceView, ID3D11ShaderResourceView)> {
+        let size = Size {
+            width: DevicePixels::from(frame.width as i32),
+            height: DevicePixels::from(frame.height as i32),
+        };
+        let uv_size = Size {
+            width: DevicePixels::from(frame.uv_width() as i32),
+            height: DevicePixels::from(frame.uv_height() as i32),
+        };
+
+        let mut entry = if let Some(entry) = self.surface_cache.remove(&surface_id) {
+            entry
+        } else {
+            self.create_nv12_surface_cache(frame)?
+        };
+
+        if entry.size != size || entry.uv_size != uv_size {
+            entry = self.create_nv12_surface_cache(frame)?;
+        }
+
+        if entry.generation != surface.frame_generation {
+            self.upload_nv12_frame(frame, &entry);
+            entry.generation = surface.frame_generation;
+        }
+
+        let y_view = entry.y_view.clone();
+        let uv_view = entry.uv_view.clone();
+        self.surface_cache.insert(surface_id, entry);
+        Ok((y_view, uv_view))
+    }
+
+    /// Opens a producer's shared texture once and returns views on its two planes.
+    fn open_shared_texture(
+        &mut self,
+        texture: &crate::SharedTexture,
+    ) -> Result<DirectXSharedTexture> {
+        let draws = self.surface_draws;
+        if let Some(entry) = self.shared_textures.get_mut(&texture.id()) {
+            entry.last_used = draws;
+            return Ok(entry.clone());
+        }
+
+        let device: ID3D11Device1 = self.devices.device.cast()?;
+        let resource: ID3D11Texture2D = unsafe {
+            device.OpenSharedResource1(windows::Win32::Foundation::HANDLE(texture.handle()))
+        }
+        .context("Opening shared video texture")?;
+        let mutex: IDXGIKeyedMutex = resource.cast()?;
+        let y_view = create_plane_view(&self.devices.device, &resource, DXGI_FORMAT_R8_UNORM)?;
+        let uv_view = create_plane_view(&self.devices.device, &resource, DXGI_FORMAT_R8G8_UNORM)?;
+        let entry = DirectXSharedTexture {
+            last_used: draws,
+            mutex,
+            y_view,
+            uv_view,
+        };
+        self.shared_textures.insert(texture.id(), entry.clone());
+        Ok(entry)
+    }
+
+    fn draw_surface_instance(
+        &mut self,
+        surface: &PaintSurface,
+        y_view: &ID3D11ShaderResourceView,
+        uv_view: &ID3D11ShaderResourceView,
+    ) -> Result<()> {
+        let instance = SurfaceInstance {
+            bounds: surface.bounds,
+            content_mask: surface.content_mask.clone(),
+        };
+        self.pipelines.surfaces.update_buffer(
+            &self.devices.device,
+            &self.devices.device_context,
+            std::slice::from_ref(&instance),
+        )?;
+        self.pipelines.surfaces.draw_with_textures(
+            &self.devices.device_context,
+            y_view,
+            uv_view,
+            &self.resources.viewport,
+            &self.globals.global_params_buffer,
+            &self.globals.sampler,
+            1,
+        )
+    }
+
     fn create_nv12_surface_cache(&self, frame: &Nv12Frame) -> Result<DirectXSurfaceCache> {
         let size = Size {
             width: DevicePixels::from(frame.width as i32),
@@ -760,6 +865,10 @@ impl DirectXRenderer {
             device_name,
             driver_name,
             driver_info: driver_version,
+            adapter_luid: Some(
+                (u64::from(desc.AdapterLuid.HighPart as u32) << 32)
+                    | u64::from(desc.AdapterLuid.LowPart),
+            ),
         })
     }
 
@@ -1396,6 +1505,27 @@ fn create_surface_texture(
     Ok((texture, view.unwrap()))
 }
 
+/// View on one plane of an NV12 texture: `R8_UNORM` selects luma, `R8G8_UNORM` the interleaved chroma.
+fn create_plane_view(
+    device: &ID3D11Device,
+    texture: &ID3D11Texture2D,
+    format: DXGI_FORMAT,
+) -> Result<ID3D11ShaderResourceView> {
+    let desc = D3D11_SHADER_RESOURCE_VIEW_DESC {
+        Format: format,
+        ViewDimension: D3D11_SRV_DIMENSION_TEXTURE2D,
+        Anonymous: D3D11_SHADER_RESOURCE_VIEW_DESC_0 {
+            Texture2D: D3D11_TEX2D_SRV {
+                MostDetailedMip: 0,
+                MipLevels: 1,
+            },
+        },
+    };
+    let mut view = None;
+    unsafe { device.CreateShaderResourceView(texture, Some(&desc), Some(&mut view))? };
+    Ok(view.unwrap())
+}
+
 #[inline]
 fn create_path_intermediate_msaa_texture_and_view(
     device: &ID3D11Device,
@@ -687,6 +687,8 @@ pub(crate) enum SurfaceSource {
     #[cfg(target_os = "macos")]
     CvPixelBuffer(CVPixelBuffer),
     Nv12(Nv12Frame),
+    #[cfg(target_os = "windows")]
+    D3D11Texture(crate::SharedTexture),
 }
 
 #[derive(Clone, Debug)]
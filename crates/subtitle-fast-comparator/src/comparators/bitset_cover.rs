@@ -131,6 +131,9 @@ impl SubtitleComparator for BitsetCoverComparator {
     }
 
     fn extract(&self, frame: &VideoFrame, roi: &RoiConfig) -> Option<FeatureBlob> {
+        if !frame.has_pixels() {
+            return None;
+        }
         let features = self.build_features(frame, roi)?;
         Some(FeatureBlob::new(TAG, features))
     }
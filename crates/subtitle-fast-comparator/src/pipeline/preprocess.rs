@@ -40,6 +40,9 @@ pub fn extract_masked_patch(
     roi: &RoiConfig,
     settings: PreprocessSettings,
 ) -> Option<MaskedPatch> {
+    if !frame.has_pixels() {
+        return None;
+    }
     let bounds = roi_bounds(frame, roi)?;
     let (x0, y0, x1, y1) = bounds;
     if x1 <= x0 || y1 <= y0 {
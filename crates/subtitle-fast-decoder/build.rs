@@ -35,6 +35,9 @@ fn build_mft_bridge() {
     }
 
     println!("cargo:rerun-if-changed=src/backends/mft/mft_bridge.cpp");
+    println!("cargo:rerun-if-changed=src/backends/dxgi_adapters.h");
+    println!("cargo:rerun-if-changed=src/backends/prefetch_stream.h");
+    println!("cargo:rerun-if-changed=src/backends/stream_copy.h");
 
     let mut build = cc::Build::new();
     build.file("src/backends/mft/mft_bridge.cpp");
@@ -53,6 +56,9 @@ fn build_dxva_bridge() {
     }
 
     println!("cargo:rerun-if-changed=src/backends/dxva/dxva_bridge.cpp");
+    println!("cargo:rerun-if-changed=src/backends/dxgi_adapters.h");
+    println!("cargo:rerun-if-changed=src/backends/prefetch_stream.h");
+    println!("cargo:rerun-if-changed=src/backends/stream_copy.h");
 
     let mut build = cc::Build::new();
     build.file("src/backends/dxva/dxva_bridge.cpp");
@@ -1,24 +1,138 @@
+//! Decoder benchmark matrix with JSON output.
+//!
+//! `decoder-bench [--json PATH] [--backend NAME]... [[LABEL=]PATH]...`
+//!
+//! Every input (default `./demo/video1_30s.mp4`) is decoded by every compiled backend except mock,
+//! or by the `--backend`s given. Each input is decoded as NV12 and as luma, over the full frame and
+//! over a bottom-quarter ROI. Label inputs by codec and bit depth (`hevc10=./demo/hevc10_2160p.mp4`);
+//! resolution and frame rate come from the decoder. Backends without GPU crop decode the full frame
+//! in the ROI cells too.
+//!
+//! Each cell runs in a child process of this binary, so its peak RSS is its own and no backend
+//! state carries over. The JSON document goes to `--json` (or stdout), the summary to stderr.
+//! `SUBFAST_PREFETCH_MIB`/`SUBFAST_PREFETCH_MAP` decode every DXVA/MFT cell through the read-ahead
+//! byte stream, whose hit rate the cells then report. `SUBFAST_BACKPRESSURE` applies its policy to
+//! them, and the cells count the frames it dropped.
+
+use std::env;
 use std::error::Error;
+use std::fs;
 use std::path::{Path, PathBuf};
-use std::time::Instant;
+use std::process::Command;
+use std::time::{Duration, Instant};
 
-use indicatif::{ProgressBar, ProgressStyle};
-use subtitle_fast_decoder::{Backend, Configuration, OutputFormat};
+use serde_json::{Map, Value, json};
+use subtitle_fast_decoder::{
+    Backend, Configuration, DecodePhase, DecoderStatsSnapshot, OutputFormat, RoiConfig, ScanMode,
+};
 use tokio_stream::StreamExt;
 
-const INPUT_VIDEO: &str = "./demo/video1_30s.mp4";
+const DEFAULT_INPUT: &str = "./demo/video1_30s.mp4";
+const CELL_FLAG: &str = "--cell";
+const OUTPUTS: [OutputFormat; 2] = [OutputFormat::Nv12, OutputFormat::Luma];
+const REGIONS: [Region; 2] = [Region::Full, Region::Roi];
+/// Band subtitles usually sit in.
+const ROI: RoiConfig = RoiConfig {
+    x: 0.0,
+    y: 0.75,
+    width: 1.0,
+    height: 0.25,
+};
+
+#[derive(Debug, Clone, Copy)]
+enum Region {
+    Full,
+    Roi,
+}
+
+impl Region {
+    fn as_str(self) -> &'static str {
+        match self {
+            Region::Full => "full",
+            Region::Roi => "roi",
+        }
+    }
 
-#[tokio::main(flavor = "multi_thread")]
-async fn main() -> Result<(), Box<dyn Error>> {
-    let input_path = PathBuf::from(INPUT_VIDEO);
-    if !input_path.exists() {
-        return Err(format!("input file {:?} does not exist", input_path).into());
+    fn parse(value: &str) -> Result<Self, String> {
+        match value {
+            "full" => Ok(Region::Full),
+            "roi" => Ok(Region::Roi),
+            other => Err(format!("unknown region '{other}'")),
+        }
     }
 
-    let mut backends = Configuration::available_backends();
-    // Skip mock backend; we only care about real decoders here.
-    backends.retain(|b| !matches!(b, Backend::Mock));
+    fn crop(self) -> Option<RoiConfig> {
+        match self {
+            Region::Full => None,
+            Region::Roi => Some(ROI),
+        }
+    }
+}
 
+struct Input {
+    label: String,
+    path: PathBuf,
+}
+
+struct Args {
+    json: Option<PathBuf>,
+    backends: Vec<Backend>,
+    inputs: Vec<Input>,
+}
+
+fn main() -> Result<(), Box<dyn Error>> {
+    let args: Vec<String> = env::args().skip(1).collect();
+    if args.first().map(String::as_str) == Some(CELL_FLAG) {
+        return run_cell(&args[1..]);
+    }
+    run_suite(parse_args(args)?)
+}
+
+fn parse_args(args: Vec<String>) -> Result<Args, Box<dyn Error>> {
+    let mut json = None;
+    let mut backends = Vec::new();
+    let mut inputs = Vec::new();
+    let mut args = args.into_iter();
+    while let Some(arg) = args.next() {
+        match arg.as_str() {
+            "--json" => {
+                json = Some(PathBuf::from(args.next().ok_or("--json needs a path")?));
+            }
+            "--backend" => {
+                let name = args.next().ok_or("--backend needs a name")?;
+                backends.push(name.parse::<Backend>()?);
+            }
+            _ => {
+                let (label, path) = match arg.split_once('=') {
+                    Some((label, path)) => (label.to_string(), PathBuf::from(path)),
+                    None => {
+                        let path = PathBuf::from(&arg);
+                        let label = path.file_stem().map_or_else(
+                            || arg.clone(),
+                            |stem| stem.to_string_lossy().into_owned(),
+                        );
+                        (label, path)
+                    }
+                };
+                inputs.push(Input { label, path });
+            }
+        }
+    }
+
+    if inputs.is_empty() {
+        let path = PathBuf::from(DEFAULT_INPUT);
+        let label = path.file_stem().unwrap().to_string_lossy().into_owned();
+        inputs.push(Input { label, path });
+    }
+    if let Some(missing) = inputs.iter().find(|input| !input.path.exists()) {
+        return Err(format!("input file {:?} does not exist", missing.path).into());
+    }
+
+    if backends.is_empty() {
+        backends = Configuration::available_backends();
+        // Skip mock backend; we only care about real decoders here.
+        backends.retain(|b| !matches!(b, Backend::Mock));
+    }
     if backends.is_empty() {
         return Err(
             "no decoder backend is compiled; enable a backend feature such as backend-ffmpeg"
@@ -26,107 +140,325 @@ async fn main() -> Result<(), Box<dyn Error>> {
         );
     }
 
-    let mut results = Vec::new();
+    Ok(Args {
+        json,
+        backends,
+        inputs,
+    })
+}
 
-    println!(
-        "Running decoder benchmark over input {:?} for backends: {:?}",
-        input_path,
-        backends.iter().map(|b| b.as_str()).collect::<Vec<&str>>()
-    );
+fn run_suite(args: Args) -> Result<(), Box<dyn Error>> {
+    let exe = env::current_exe()?;
+    let mut results = Vec::new();
+    let mut failures = 0usize;
 
-    for backend in backends {
-        println!(
-            "\nRunning decoder benchmark for backend='{}'...",
-            backend.as_str()
-        );
-        match run_backend_bench(&input_path, backend).await {
-            Ok((frames, avg_ms)) => {
-                results.push((backend, frames, avg_ms));
-            }
-            Err(err) => {
-                eprintln!("backend '{}' failed: {err}", backend.as_str());
+    for input in &args.inputs {
+        for &backend in &args.backends {
+            for output in OUTPUTS {
+                for region in REGIONS {
+                    eprint!(
+                        "{:>16} {:>12} {:>5} {:>4}  ",
+                        input.label,
+                        backend.as_str(),
+                        output.as_str(),
+                        region.as_str()
+                    );
+                    let mut entry = Map::new();
+                    entry.insert("input".into(), json!(input.label));
+                    entry.insert("path".into(), json!(input.path.display().to_string()));
+                    entry.insert("backend".into(), json!(backend.as_str()));
+                    entry.insert("output".into(), json!(output.as_str()));
+                    entry.insert("region".into(), json!(region.as_str()));
+                    match spawn_cell(&exe, backend, output, region, &input.path) {
+                        Ok(metrics) => {
+                            eprintln!("{}", summary(&metrics));
+                            entry.extend(metrics);
+                        }
+                        Err(err) => {
+                            failures += 1;
+                            eprintln!("failed: {err}");
+                            entry.insert("error".into(), json!(err));
+                        }
+                    }
+                    results.push(Value::Object(entry));
+                }
             }
         }
     }
 
-    if results.is_empty() {
-        return Err("no backends produced benchmark results".into());
+    let document = json!({ "suite": "decoder-bench", "results": results });
+    let text = serde_json::to_string_pretty(&document)?;
+    match &args.json {
+        Some(path) => fs::write(path, text + "\n")?,
+        None => println!("{text}"),
     }
 
-    println!("\nDecoder benchmark summary over input {:?}:", input_path);
-    for (backend, frames, avg_ms) in results {
-        println!(
-            "  {:>12}: frames={} avg={avg_ms:.3}ms/frame",
-            backend.as_str(),
-            frames,
-        );
+    if failures == results.len() {
+        return Err("no benchmark cell produced results".into());
+    }
+    Ok(())
+}
+
+/// Runs one cell in a child process and returns the metrics object it printed.
+fn spawn_cell(
+    exe: &Path,
+    backend: Backend,
+    output: OutputFormat,
+    region: Region,
+    path: &Path,
+) -> Result<Map<String, Value>, String> {
+    let child = Command::new(exe)
+        .arg(CELL_FLAG)
+        .arg(backend.as_str())
+        .arg(output.as_str())
+        .arg(region.as_str())
+        .arg(path)
+        .output()
+        .map_err(|err| format!("failed to start cell: {err}"))?;
+    if !child.status.success() {
+        let stderr = String::from_utf8_lossy(&child.stderr);
+        let message = stderr.lines().rev().find(|line| !line.trim().is_empty());
+        return Err(message
+            .unwrap_or("cell exited without output")
+            .trim()
+            .to_string());
     }
+    let stdout = String::from_utf8_lossy(&child.stdout);
+    match serde_json::from_str(stdout.trim()) {
+        Ok(Value::Object(metrics)) => Ok(metrics),
+        Ok(_) | Err(_) => Err(format!("cell printed no metrics: {}", stdout.trim())),
+    }
+}
 
+fn summary(metrics: &Map<String, Value>) -> String {
+    let number = |key: &str| metrics.get(key).and_then(Value::as_f64).unwrap_or(0.0);
+    let rss = metrics
+        .get("peak_rss_bytes")
+        .and_then(Value::as_u64)
+        .map_or_else(|| "n/a".to_string(), |bytes| format!("{}MiB", bytes >> 20));
+    format!(
+        "{:>7.1} fps  interval p50={:.3}ms p99={:.3}ms first={:.1}ms rss={rss}",
+        number("fps"),
+        number("interval_p50_ms"),
+        number("interval_p99_ms"),
+        number("first_frame_ms"),
+    )
+}
+
+/// Child side of `spawn_cell`: decodes the whole input once and prints its metrics as one JSON object.
+fn run_cell(args: &[String]) -> Result<(), Box<dyn Error>> {
+    let [backend, output, region, path] = args else {
+        return Err(format!("usage: {CELL_FLAG} BACKEND OUTPUT REGION PATH").into());
+    };
+    let backend = backend.parse::<Backend>()?;
+    let output = match output.as_str() {
+        "nv12" => OutputFormat::Nv12,
+        "luma" => OutputFormat::Luma,
+        other => return Err(format!("unsupported output format '{other}'").into()),
+    };
+    let region = Region::parse(region)?;
+    let runtime = tokio::runtime::Builder::new_multi_thread()
+        .enable_all()
+        .build()?;
+    let metrics = runtime.block_on(measure(backend, output, region, Path::new(path)))?;
+    println!("{metrics}");
     Ok(())
 }
 
-async fn run_backend_bench(
-    input_path: &Path,
+async fn measure(
     backend: Backend,
-) -> Result<(u64, f64), Box<dyn Error>> {
+    output_format: OutputFormat,
+    region: Region,
+    input_path: &Path,
+) -> Result<Value, Box<dyn Error>> {
+    let env_config = Configuration::from_env()?;
+    let started = Instant::now();
     let config = Configuration {
         backend,
         input: Some(input_path.to_path_buf()),
         channel_capacity: None,
-        output_format: OutputFormat::Nv12,
+        output_format,
         start_frame: None,
+        readback_depth: None,
+        samples_per_second: None,
+        crop: region.crop(),
+        retained_frames: None,
+        scan: ScanMode::Full,
+        decode_workers: None,
+        read_ahead: None,
+        luma_gate: None,
+        scale_height: None,
+        delivery_batch: None,
+        index_cache: None,
+        change_detection: None,
+        prefetch: env_config.prefetch,
+        luma_cache: None,
+        backpressure: env_config.backpressure,
     };
 
     let provider = config.create_provider()?;
     let metadata = provider.metadata();
-    let total_frames = metadata.total_frames;
-
-    let progress = total_frames.map(|total| {
-        let style = ProgressStyle::with_template(
-            "{spinner:.green} [{elapsed_precise}] {prefix:>10.cyan.bold} \
-{bar:40.cyan/blue} {pos:>4}/{len:4} frames avg={msg}ms",
-        )
-        .unwrap()
-        .progress_chars("█▉▊▋▌▍▎▏  ");
-        let bar = ProgressBar::new(total);
-        bar.set_style(style);
-        bar.set_prefix(backend.as_str().to_string());
-        bar.set_message("0.000");
-        bar
-    });
-
-    let (_controller, mut stream) = provider.open()?;
-    let mut processed = 0u64;
-    let bench_start = Instant::now();
+    let (controller, mut stream) = provider.open()?;
 
+    let mut first_frame = None;
+    let mut frame_size = None;
+    let mut intervals = Vec::new();
+    let mut last = None;
     while let Some(item) = stream.next().await {
-        match item {
-            Ok(_frame) => {
-                processed += 1;
-
-                if let Some(ref bar) = progress {
-                    bar.inc(1);
-                    let elapsed = bench_start.elapsed();
-                    let avg_ms = elapsed.as_secs_f64() * 1000.0 / processed as f64;
-                    bar.set_message(format!("{avg_ms:.3}"));
-                }
-            }
-            Err(err) => {
-                return Err(err.into());
+        let frame = item?;
+        let now = Instant::now();
+        match last {
+            Some(previous) => intervals.push(ms(now - previous)),
+            None => {
+                first_frame = Some(now - started);
+                frame_size = Some((frame.width(), frame.height()));
             }
         }
+        last = Some(now);
     }
+    let (Some(first_frame), Some(end)) = (first_frame, last) else {
+        return Err("no frames decoded".into());
+    };
+
+    let stats = controller.stats();
+    let frames = intervals.len() as u64 + 1;
+    let decoding = end - (started + first_frame);
+    intervals.sort_by(f64::total_cmp);
+    let fps = if decoding.is_zero() {
+        None
+    } else {
+        Some((frames - 1) as f64 / decoding.as_secs_f64())
+    };
+
+    Ok(json!({
+        "width": metadata.width,
+        "height": metadata.height,
+        "source_fps": metadata.fps,
+        "frame_width": frame_size.map(|(width, _)| width),
+        "frame_height": frame_size.map(|(_, height)| height),
+        "frames": frames,
+        "seconds": (end - started).as_secs_f64(),
+        "fps": fps,
+        "first_frame_ms": ms(first_frame),
+        "interval_p50_ms": quantile(&intervals, 0.5),
+        "interval_p99_ms": quantile(&intervals, 0.99),
+        "peak_rss_bytes": peak_rss(),
+        "phases": phases(&stats),
+        "adapters": stats
+            .adapters
+            .iter()
+            .map(|adapter| json!({ "name": adapter.name, "frames": adapter.frames }))
+            .collect::<Vec<_>>(),
+        "prefetch": stats.prefetch.hit_rate().map(|hit_rate| json!({
+            "hit_rate": hit_rate,
+            "hits": stats.prefetch.hits,
+            "misses": stats.prefetch.misses,
+            "bytes_read": stats.prefetch.bytes_read,
+        })),
+        "dropped_frames": stats.dropped_frames,
+    }))
+}
 
-    if let Some(bar) = progress {
-        bar.finish_with_message("done");
+fn ms(duration: Duration) -> f64 {
+    duration.as_secs_f64() * 1000.0
+}
+
+/// Nearest-rank quantile of sorted `values`.
+fn quantile(values: &[f64], q: f64) -> Option<f64> {
+    let last = values.len().checked_sub(1)?;
+    Some(values[(last as f64 * q).round() as usize])
+}
+
+/// Per-stage breakdown for backends that instrument their decode loop.
+fn phases(stats: &DecoderStatsSnapshot) -> Value {
+    let millis = |value: Option<Duration>| value.map(ms);
+    let mut phases = Map::new();
+    for phase in DecodePhase::ALL {
+        let phase_stats = stats.phase(phase);
+        if phase_stats.count == 0 {
+            continue;
+        }
+        phases.insert(
+            phase.as_str().into(),
+            json!({
+                "count": phase_stats.count,
+                "avg_ms": millis(phase_stats.average()),
+                "p50_ms": millis(phase_stats.quantile(0.5)),
+                "p99_ms": millis(phase_stats.quantile(0.99)),
+                "max_ms": ms(phase_stats.max),
+                "total_ms": ms(phase_stats.total),
+            }),
+        );
     }
+    Value::Object(phases)
+}
 
-    if processed == 0 {
-        return Err("no frames decoded".into());
+#[cfg(target_os = "linux")]
+fn peak_rss() -> Option<u64> {
+    let status = fs::read_to_string("/proc/self/status").ok()?;
+    let line = status.lines().find(|line| line.starts_with("VmHWM:"))?;
+    let kib: u64 = line.split_whitespace().nth(1)?.parse().ok()?;
+    Some(kib * 1024)
+}
+
+#[cfg(target_os = "macos")]
+fn peak_rss() -> Option<u64> {
+    #[repr(C)]
+    struct RUsage {
+        utime: [i64; 2],
+        stime: [i64; 2],
+        maxrss: i64,
+        rest: [i64; 13],
+    }
+    unsafe extern "C" {
+        fn getrusage(who: i32, usage: *mut RUsage) -> i32;
     }
+    let mut usage = RUsage {
+        utime: [0; 2],
+        stime: [0; 2],
+        maxrss: 0,
+        rest: [0; 13],
+    };
+    // SAFETY: RUSAGE_SELF (0) with a buffer laid out like `struct rusage`; macOS reports bytes.
+    (unsafe { getrusage(0, &mut usage) } == 0).then_some(usage.maxrss as u64)
+}
+
+#[cfg(target_os = "windows")]
+fn peak_rss() -> Option<u64> {
+    use std::ffi::c_void;
 
-    let total = bench_start.elapsed();
-    let avg_ms = total.as_secs_f64() * 1000.0 / processed as f64;
+    #[repr(C)]
+    #[derive(Default)]
+    struct ProcessMemoryCounters {
+        cb: u32,
+        page_fault_count: u32,
+        peak_working_set_size: usize,
+        working_set_size: usize,
+        quota_peak_paged_pool_usage: usize,
+        quota_paged_pool_usage: usize,
+        quota_peak_non_paged_pool_usage: usize,
+        quota_non_paged_pool_usage: usize,
+        pagefile_usage: usize,
+        peak_pagefile_usage: usize,
+    }
+    unsafe extern "system" {
+        fn GetCurrentProcess() -> *mut c_void;
+        fn K32GetProcessMemoryInfo(
+            process: *mut c_void,
+            counters: *mut ProcessMemoryCounters,
+            cb: u32,
+        ) -> i32;
+    }
+    let mut counters = ProcessMemoryCounters {
+        cb: std::mem::size_of::<ProcessMemoryCounters>() as u32,
+        ..Default::default()
+    };
+    // SAFETY: the pseudo handle of this process and a PROCESS_MEMORY_COUNTERS of the size passed in.
+    let ok = unsafe { K32GetProcessMemoryInfo(GetCurrentProcess(), &mut counters, counters.cb) };
+    (ok != 0).then_some(counters.peak_working_set_size as u64)
+}
 
-    Ok((processed, avg_ms))
+#[cfg(not(any(target_os = "linux", target_os = "macos", target_os = "windows")))]
+fn peak_rss() -> Option<u64> {
+    None
 }
@@ -5,7 +5,9 @@ use std::time::{Duration, SystemTime, UNIX_EPOCH};
 
 use indicatif::{ProgressBar, ProgressStyle};
 use png::{BitDepth, ColorType, Encoder};
-use subtitle_fast_decoder::{Backend, Configuration, OutputFormat, VideoFrame};
+use subtitle_fast_decoder::{
+    Backend, Backpressure, Configuration, OutputFormat, ScanMode, VideoFrame,
+};
 use tokio_stream::StreamExt;
 
 const SAMPLE_FREQUENCY: usize = 7; // frames per second
@@ -51,6 +53,21 @@ async fn main() -> io::Result<()> {
         channel_capacity: None,
         output_format: OutputFormat::Nv12,
         start_frame: None,
+        readback_depth: None,
+        samples_per_second: None,
+        crop: None,
+        retained_frames: None,
+        scan: ScanMode::Full,
+        decode_workers: None,
+        read_ahead: None,
+        luma_gate: None,
+        scale_height: None,
+        delivery_batch: None,
+        index_cache: None,
+        change_detection: None,
+        prefetch: None,
+        luma_cache: None,
+        backpressure: Backpressure::Block,
     };
     let provider = config.create_provider().map_err(io::Error::other)?;
     let metadata = provider.metadata();
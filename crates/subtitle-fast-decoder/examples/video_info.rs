@@ -1,5 +1,5 @@
 use std::path::PathBuf;
-use subtitle_fast_decoder::{Backend, Configuration, OutputFormat};
+use subtitle_fast_decoder::{Backend, Backpressure, Configuration, OutputFormat, ScanMode};
 
 const VIDEO_FILE: &str = "demo/video1_30s.mp4";
 const BACKEND: Backend = Backend::FFmpeg;
@@ -14,6 +14,21 @@ async fn main() {
         channel_capacity: None,
         output_format: OutputFormat::Nv12,
         start_frame: None,
+        readback_depth: None,
+        samples_per_second: None,
+        crop: None,
+        retained_frames: None,
+        scan: ScanMode::Full,
+        decode_workers: None,
+        read_ahead: None,
+        luma_gate: None,
+        scale_height: None,
+        delivery_batch: None,
+        index_cache: None,
+        change_detection: None,
+        prefetch: None,
+        luma_cache: None,
+        backpressure: Backpressure::Block,
     };
 
     match config.create_provider() {
@@ -0,0 +1,509 @@
+//! Decode scheduling across several GPUs.
+//!
+//! Hosts with an iGPU plus one or two dGPUs have decode engines on each of them. A backend enumerates
+//! its adapters into an [`AdapterScheduler`] and leases one per reader (a whole decode, or one segment
+//! worker), so concurrent readers spread over the GPUs in proportion to the throughput each adapter has
+//! delivered so far. A session limit caps the readers per adapter for processes that run many decodes
+//! at once; bounded leases wait for a slot instead of over-subscribing the decode engines.
+
+use std::num::NonZeroUsize;
+use std::sync::atomic::{AtomicBool, AtomicU64, AtomicUsize, Ordering};
+use std::sync::{Arc, Condvar, Mutex};
+use std::time::{Duration, Instant};
+
+use crate::core::DecoderStats;
+
+/// Leases shorter than this say more about open and seek cost than about the adapter.
+const MIN_MEASURED: Duration = Duration::from_millis(500);
+/// Weight of the newest lease in an adapter's smoothed throughput.
+const THROUGHPUT_SMOOTHING: f64 = 0.5;
+
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct AdapterInfo {
+    /// Position in the backend's own enumeration (DXGI `EnumAdapters1` for DXVA).
+    pub ordinal: u32,
+    pub name: String,
+    pub vendor_id: u32,
+    pub dedicated_memory: u64,
+    /// DXGI `AdapterLuid` as `HighPart << 32 | LowPart`, which a renderer can name its adapter by.
+    pub luid: u64,
+}
+
+/// Point-in-time load of one adapter.
+#[derive(Debug, Clone, PartialEq)]
+pub struct AdapterLoad {
+    pub ordinal: u32,
+    pub name: String,
+    /// Readers currently decoding on the adapter.
+    pub active: usize,
+    /// Frames decoded on it by every lease so far.
+    pub frames: u64,
+    /// Smoothed frames per second of a single reader; `None` until a long enough lease has ended.
+    pub throughput: Option<f64>,
+}
+
+struct Slot {
+    info: AdapterInfo,
+    active: AtomicUsize,
+    frames: AtomicU64,
+    throughput: Mutex<Option<f64>>,
+    failed: AtomicBool,
+}
+
+pub struct AdapterScheduler {
+    slots: Vec<Slot>,
+    /// Readers allowed per adapter for bounded leases; 0 for no limit.
+    session_limit: AtomicUsize,
+    /// Signalled whenever a lease ends or the limit or an adapter's state changes.
+    released: (Mutex<()>, Condvar),
+}
+
+impl AdapterScheduler {
+    /// Until throughput has been measured, ties go to the adapter with the most dedicated memory,
+    /// which is what single-adapter selection picks.
+    pub fn new(mut adapters: Vec<AdapterInfo>) -> Arc<Self> {
+        adapters.sort_by(|a, b| b.dedicated_memory.cmp(&a.dedicated_memory));
+        Arc::new(Self {
+            slots: adapters
+                .into_iter()
+                .map(|info| Slot {
+                    info,
+                    active: AtomicUsize::new(0),
+                    frames: AtomicU64::new(0),
+                    throughput: Mutex::new(None),
+                    failed: AtomicBool::new(false),
+                })
+                .collect(),
+            session_limit: AtomicUsize::new(0),
+            released: (Mutex::new(()), Condvar::new()),
+        })
+    }
+
+    pub fn session_limit(&self) -> Option<NonZeroUsize> {
+        NonZeroUsize::new(self.session_limit.load(Ordering::Relaxed))
+    }
+
+    /// Caps the readers `lease_bounded` places on one adapter. Unbounded leases ignore it.
+    pub fn set_session_limit(&self, limit: Option<NonZeroUsize>) {
+        self.session_limit
+            .store(limit.map_or(0, NonZeroUsize::get), Ordering::Relaxed);
+        self.notify();
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.slots.is_empty()
+    }
+
+    pub fn adapters(&self) -> impl Iterator<Item = &AdapterInfo> {
+        self.slots.iter().map(|slot| &slot.info)
+    }
+
+    pub fn loads(&self) -> Vec<AdapterLoad> {
+        self.slots
+            .iter()
+            .map(|slot| AdapterLoad {
+                ordinal: slot.info.ordinal,
+                name: slot.info.name.clone(),
+                active: slot.active.load(Ordering::Relaxed),
+                frames: slot.frames.load(Ordering::Relaxed),
+                throughput: slot.throughput(),
+            })
+            .collect()
+    }
+
+    /// Adapter the next lease would get, without reserving it.
+    pub fn preferred(&self) -> Option<&AdapterInfo> {
+        self.pick(false).map(|slot| &self.slots[slot].info)
+    }
+
+    /// Cheapest adapter, regardless of the session limit.
+    pub fn lease(self: &Arc<Self>) -> Option<AdapterLease> {
+        let slot = self.pick(false)?;
+        Some(self.claim(slot))
+    }
+
+    /// Cheapest adapter below the session limit, blocking until one has a free slot. `None` once no
+    /// adapter is left in rotation.
+    pub fn lease_bounded(self: &Arc<Self>) -> Option<AdapterLease> {
+        let (lock, released) = &self.released;
+        let mut guard = lock.lock().unwrap_or_else(|poisoned| poisoned.into_inner());
+        loop {
+            if let Some(slot) = self.pick(true) {
+                return Some(self.claim(slot));
+            }
+            self.pick(false)?;
+            guard = released
+                .wait(guard)
+                .unwrap_or_else(|poisoned| poisoned.into_inner());
+        }
+    }
+
+    /// `count` leases below the session limit, taken together once that many slots are free. Readers
+    /// that wait on each other's output (the workers of one segmented decode) would deadlock if some
+    /// held slots while the rest queued, so none is handed out alone. `count` is clamped to
+    /// [`Self::session_capacity`]; empty once no adapter is left in rotation.
+    pub fn lease_bounded_group(self: &Arc<Self>, count: usize) -> Vec<AdapterLease> {
+        let (lock, released) = &self.released;
+        let mut guard = lock.lock().unwrap_or_else(|poisoned| poisoned.into_inner());
+        loop {
+            let count = self
+                .session_capacity()
+                .map_or(count, |capacity| count.min(capacity));
+            let mut claimed = Vec::with_capacity(count);
+            while claimed.len() < count {
+                let Some(slot) = self.pick(true) else {
+                    break;
+                };
+                self.slots[slot].active.fetch_add(1, Ordering::Relaxed);
+                claimed.push(slot);
+            }
+            if claimed.len() == count {
+                return claimed.into_iter().map(|slot| self.held(slot)).collect();
+            }
+            // Handing back a partial claim; the waiters it could wake hold this lock.
+            for slot in claimed {
+                self.slots[slot].active.fetch_sub(1, Ordering::Relaxed);
+            }
+            if self.pick(false).is_none() {
+                return Vec::new();
+            }
+            guard = released
+                .wait(guard)
+                .unwrap_or_else(|poisoned| poisoned.into_inner());
+        }
+    }
+
+    /// Bounded leases that can be held at once: the session limit times the adapters in rotation.
+    /// `None` without a limit, or once no adapter is left.
+    pub fn session_capacity(&self) -> Option<usize> {
+        let limit = self.session_limit.load(Ordering::Relaxed);
+        let live = self
+            .slots
+            .iter()
+            .filter(|slot| !slot.failed.load(Ordering::Relaxed))
+            .count();
+        Some(limit * live).filter(|&capacity| capacity > 0)
+    }
+
+    /// Takes an adapter out of rotation, e.g. after its device could not be created.
+    pub fn mark_failed(&self, ordinal: u32) {
+        if let Some(slot) = self.slots.iter().find(|slot| slot.info.ordinal == ordinal) {
+            slot.failed.store(true, Ordering::Relaxed);
+        }
+        self.notify();
+    }
+
+    fn claim(self: &Arc<Self>, slot: usize) -> AdapterLease {
+        self.slots[slot].active.fetch_add(1, Ordering::Relaxed);
+        self.held(slot)
+    }
+
+    /// Lease for a slot whose `active` count already includes it.
+    fn held(self: &Arc<Self>, slot: usize) -> AdapterLease {
+        AdapterLease {
+            scheduler: self.clone(),
+            slot,
+            started: Instant::now(),
+            frames: 0,
+            usage: None,
+        }
+    }
+
+    fn notify(&self) {
+        // Taking the lock orders this against a waiter between its check and its wait.
+        let _guard = self
+            .released
+            .0
+            .lock()
+            .unwrap_or_else(|poisoned| poisoned.into_inner());
+        self.released.1.notify_all();
+    }
+
+    /// Lowest expected time per frame for one more reader: readers already on the adapter plus the
+    /// new one, over its throughput. Unmeasured adapters are assumed to be as fast as the average
+    /// measured one so they get probed. `bounded` leaves out adapters at the session limit.
+    fn pick(&self, bounded: bool) -> Option<usize> {
+        let limit = if bounded {
+            self.session_limit.load(Ordering::Relaxed)
+        } else {
+            0
+        };
+        let measured: Vec<f64> = self.slots.iter().filter_map(Slot::throughput).collect();
+        let fallback = if measured.is_empty() {
+            1.0
+        } else {
+            measured.iter().sum::<f64>() / measured.len() as f64
+        };
+        let mut best: Option<(usize, f64)> = None;
+        for (index, slot) in self.slots.iter().enumerate() {
+            if slot.failed.load(Ordering::Relaxed) {
+                continue;
+            }
+            let active = slot.active.load(Ordering::Relaxed);
+            if limit > 0 && active >= limit {
+                continue;
+            }
+            let rate = slot.throughput().unwrap_or(fallback);
+            let readers = active + 1;
+            let cost = readers as f64 / rate;
+            if best.is_none_or(|(_, best_cost)| cost < best_cost) {
+                best = Some((index, cost));
+            }
+        }
+        best.map(|(index, _)| index)
+    }
+}
+
+impl Slot {
+    fn throughput(&self) -> Option<f64> {
+        *self
+            .throughput
+            .lock()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+    }
+}
+
+/// One reader's claim on an adapter. Dropping it releases the slot and folds the frames it decoded
+/// into the adapter's throughput.
+pub struct AdapterLease {
+    scheduler: Arc<AdapterScheduler>,
+    slot: usize,
+    started: Instant,
+    frames: u64,
+    usage: Option<Arc<AtomicU64>>,
+}
+
+impl AdapterLease {
+    pub fn info(&self) -> &AdapterInfo {
+        &self.scheduler.slots[self.slot].info
+    }
+
+    /// Also counts this lease's frames into `stats` under the adapter's name. Throughput is measured
+    /// from here, so a lease held idle before its reader starts does not count as slow.
+    pub fn attach(mut self, stats: &DecoderStats) -> Self {
+        self.started = Instant::now();
+        self.usage = Some(stats.adapter_counter(&self.info().name));
+        self
+    }
+
+    pub fn record_frame(&mut self) {
+        self.frames += 1;
+        self.scheduler.slots[self.slot]
+            .frames
+            .fetch_add(1, Ordering::Relaxed);
+        if let Some(usage) = self.usage.as_ref() {
+            usage.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+}
+
+impl Drop for AdapterLease {
+    fn drop(&mut self) {
+        let slot = &self.scheduler.slots[self.slot];
+        slot.active.fetch_sub(1, Ordering::Relaxed);
+        self.scheduler.notify();
+        let elapsed = self.started.elapsed();
+        if self.frames == 0 || elapsed < MIN_MEASURED {
+            return;
+        }
+        let rate = self.frames as f64 / elapsed.as_secs_f64();
+        let mut throughput = slot
+            .throughput
+            .lock()
+            .unwrap_or_else(|poisoned| poisoned.into_inner());
+        *throughput = Some(match *throughput {
+            Some(previous) => previous + THROUGHPUT_SMOOTHING * (rate - previous),
+            None => rate,
+        });
+    }
+}
+
+/// Bounded leases for the readers of one decode: taken together by the first reader to start, then
+/// handed out one per reader. A whole decode is a group of one.
+pub struct LeaseGroup {
+    count: usize,
+    leases: Mutex<Option<Vec<AdapterLease>>>,
+}
+
+impl LeaseGroup {
+    pub fn new(count: usize) -> Self {
+        Self {
+            count,
+            leases: Mutex::new(None),
+        }
+    }
+
+    /// The calling reader's lease, blocking the group's first reader until every slot is free.
+    /// `None` once the group is spent or `scheduler` had no adapter left.
+    pub fn take(&self, scheduler: &Arc<AdapterScheduler>) -> Option<AdapterLease> {
+        self.leases
+            .lock()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+            .get_or_insert_with(|| scheduler.lease_bounded_group(self.count))
+            .pop()
+    }
+}
+
+/// Scheduler over this machine's DXGI adapters, shared by every Windows backend so the session
+/// limit counts DXVA and MFT readers together. Whichever backend asks first enumerates the
+/// adapters; both enumerate the same list in the same order. `SUBFAST_DXVA_SESSIONS_PER_ADAPTER`
+/// sets the initial limit.
+#[cfg(any(
+    all(target_os = "windows", feature = "backend-dxva"),
+    all(target_os = "windows", feature = "backend-mft")
+))]
+pub(crate) fn dxgi_scheduler(
+    enumerate: impl FnOnce() -> Vec<AdapterInfo>,
+) -> &'static Arc<AdapterScheduler> {
+    use std::sync::OnceLock;
+
+    static SCHEDULER: OnceLock<Arc<AdapterScheduler>> = OnceLock::new();
+    SCHEDULER.get_or_init(|| {
+        let scheduler = AdapterScheduler::new(enumerate());
+        let limit = std::env::var("SUBFAST_DXVA_SESSIONS_PER_ADAPTER")
+            .ok()
+            .and_then(|value| value.trim().parse::<NonZeroUsize>().ok());
+        scheduler.set_session_limit(limit);
+        scheduler
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn adapter(ordinal: u32, name: &str, dedicated_memory: u64) -> AdapterInfo {
+        AdapterInfo {
+            ordinal,
+            name: name.to_string(),
+            vendor_id: 0,
+            dedicated_memory,
+            luid: u64::from(ordinal),
+        }
+    }
+
+    fn set_throughput(scheduler: &AdapterScheduler, ordinal: u32, rate: f64) {
+        let slot = scheduler
+            .slots
+            .iter()
+            .find(|slot| slot.info.ordinal == ordinal)
+            .unwrap();
+        *slot.throughput.lock().unwrap() = Some(rate);
+    }
+
+    #[test]
+    fn unmeasured_adapters_fill_largest_first_then_spread() {
+        let scheduler =
+            AdapterScheduler::new(vec![adapter(0, "igpu", 128), adapter(1, "dgpu", 8 << 30)]);
+        assert_eq!(scheduler.preferred().unwrap().name, "dgpu");
+        let first = scheduler.lease().unwrap();
+        let second = scheduler.lease().unwrap();
+        assert_eq!(first.info().name, "dgpu");
+        assert_eq!(second.info().name, "igpu");
+        drop(first);
+        assert_eq!(scheduler.preferred().unwrap().name, "dgpu");
+    }
+
+    #[test]
+    fn measured_throughput_weights_assignment() {
+        let scheduler =
+            AdapterScheduler::new(vec![adapter(0, "igpu", 128), adapter(1, "dgpu", 8 << 30)]);
+        set_throughput(&scheduler, 0, 100.0);
+        set_throughput(&scheduler, 1, 300.0);
+        let leases: Vec<_> = (0..4).map(|_| scheduler.lease().unwrap()).collect();
+        let on_dgpu = leases
+            .iter()
+            .filter(|lease| lease.info().name == "dgpu")
+            .count();
+        assert_eq!(on_dgpu, 3);
+        let loads = scheduler.loads();
+        assert_eq!(loads.iter().map(|load| load.active).sum::<usize>(), 4);
+    }
+
+    #[test]
+    fn failed_adapters_leave_rotation_and_leases_count_frames() {
+        let scheduler = AdapterScheduler::new(vec![adapter(0, "a", 2), adapter(1, "b", 1)]);
+        scheduler.mark_failed(0);
+        let stats = DecoderStats::default();
+        let mut lease = scheduler.lease().unwrap().attach(&stats);
+        assert_eq!(lease.info().name, "b");
+        lease.record_frame();
+        lease.record_frame();
+        drop(lease);
+        let usage = stats.snapshot().adapters;
+        assert_eq!(usage.len(), 1);
+        assert_eq!((usage[0].name.as_str(), usage[0].frames), ("b", 2));
+        let load = &scheduler.loads()[1];
+        assert_eq!((load.active, load.frames), (0, 2));
+        scheduler.mark_failed(1);
+        assert!(scheduler.lease().is_none());
+    }
+
+    #[test]
+    fn bounded_leases_wait_for_a_free_session() {
+        let scheduler = AdapterScheduler::new(vec![adapter(0, "a", 2), adapter(1, "b", 1)]);
+        scheduler.set_session_limit(NonZeroUsize::new(1));
+        let first = scheduler.lease_bounded().unwrap();
+        let second = scheduler.lease_bounded().unwrap();
+        assert_eq!(
+            (first.info().name.as_str(), second.info().name.as_str()),
+            ("a", "b")
+        );
+        // Unbounded leases still get an adapter past the limit.
+        let extra = scheduler.lease().unwrap();
+
+        let waiter = {
+            let scheduler = scheduler.clone();
+            std::thread::spawn(move || scheduler.lease_bounded().map(|lease| lease.info().ordinal))
+        };
+        drop(extra);
+        std::thread::sleep(Duration::from_millis(20));
+        assert!(!waiter.is_finished());
+        drop(first);
+        assert_eq!(waiter.join().unwrap(), Some(0));
+
+        scheduler.mark_failed(0);
+        scheduler.mark_failed(1);
+        assert!(scheduler.lease_bounded().is_none());
+    }
+
+    #[test]
+    fn group_leases_wait_for_every_slot_at_once() {
+        let scheduler = AdapterScheduler::new(vec![adapter(0, "a", 2), adapter(1, "b", 1)]);
+        scheduler.set_session_limit(NonZeroUsize::new(2));
+        assert_eq!(scheduler.session_capacity(), Some(4));
+        // More than the limit allows is clamped rather than waited for forever.
+        assert_eq!(scheduler.lease_bounded_group(9).len(), 4);
+
+        let held = scheduler.lease_bounded().unwrap();
+        let waiter = {
+            let scheduler = scheduler.clone();
+            std::thread::spawn(move || scheduler.lease_bounded_group(4).len())
+        };
+        std::thread::sleep(Duration::from_millis(20));
+        assert!(!waiter.is_finished());
+        // A partial claim is handed back while waiting, so single leases still get the free slots.
+        let single = scheduler.lease_bounded().unwrap();
+        drop((held, single));
+        assert_eq!(waiter.join().unwrap(), 4);
+
+        let group = LeaseGroup::new(2);
+        let readers = [group.take(&scheduler), group.take(&scheduler)];
+        assert!(readers.iter().all(Option::is_some));
+        assert!(group.take(&scheduler).is_none());
+        assert_eq!(
+            scheduler
+                .loads()
+                .iter()
+                .map(|load| load.active)
+                .sum::<usize>(),
+            2
+        );
+        drop(readers);
+
+        scheduler.mark_failed(0);
+        scheduler.mark_failed(1);
+        assert_eq!(scheduler.session_capacity(), None);
+        assert!(scheduler.lease_bounded_group(2).is_empty());
+    }
+}
@@ -0,0 +1,102 @@
+// DXGI adapter enumeration shared by the DXVA and MFT bridges.
+//
+// Both bridges create their devices on adapters the Rust side picks by ordinal from one process-wide scheduler,
+// so they must enumerate the same adapters in the same order. Software adapters are left out, and
+// SUBFAST_DXVA_ADAPTER_VENDOR narrows the list to one vendor when that vendor is present.
+
+#ifndef SUBTITLE_FAST_DXGI_ADAPTERS_H
+#define SUBTITLE_FAST_DXGI_ADAPTERS_H
+
+#include <windows.h>
+#include <dxgi1_2.h>
+#include <wrl/client.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace dxgi_adapters
+{
+    inline bool parse_vendor_from_env(UINT &vendor_out)
+    {
+        char buffer[16] = {0};
+        DWORD read = GetEnvironmentVariableA("SUBFAST_DXVA_ADAPTER_VENDOR", buffer, static_cast<DWORD>(sizeof(buffer)));
+        if (read == 0 || read >= sizeof(buffer)) { return false; }
+        char *end = nullptr;
+        unsigned long value = std::strtoul(buffer, &end, 0);
+        if (end == buffer || value > 0xFFFFFFFFul) { return false; }
+        vendor_out = static_cast<UINT>(value);
+        return true;
+    }
+
+    struct AdapterCandidate
+    {
+        Microsoft::WRL::ComPtr<IDXGIAdapter1> adapter;
+        DXGI_ADAPTER_DESC1 desc{};
+        UINT ordinal = 0;
+    };
+
+    // Hardware adapters in DXGI order. When SUBFAST_DXVA_ADAPTER_VENDOR names a vendor that is present,
+    // only its adapters are returned and `vendor_matched` is set.
+    inline bool enumerate_adapters(std::vector<AdapterCandidate> &out, bool &vendor_matched, std::string &error)
+    {
+        out.clear();
+        vendor_matched = false;
+        Microsoft::WRL::ComPtr<IDXGIFactory1> factory;
+        HRESULT hr = CreateDXGIFactory1(IID_PPV_ARGS(&factory));
+        if (FAILED(hr))
+        {
+            char buffer[80];
+            std::snprintf(buffer, sizeof(buffer), "CreateDXGIFactory1 failed: 0x%08lx", static_cast<unsigned long>(hr));
+            error = buffer;
+            return false;
+        }
+
+        for (UINT index = 0;; ++index)
+        {
+            AdapterCandidate candidate;
+            hr = factory->EnumAdapters1(index, &candidate.adapter);
+            if (hr == DXGI_ERROR_NOT_FOUND) { break; }
+            if (FAILED(hr)) { continue; }
+            if (FAILED(candidate.adapter->GetDesc1(&candidate.desc))) { continue; }
+            if (candidate.desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) { continue; }
+            candidate.ordinal = index;
+            out.push_back(std::move(candidate));
+        }
+
+        UINT desired_vendor = 0;
+        if (parse_vendor_from_env(desired_vendor))
+        {
+            std::vector<AdapterCandidate> matching;
+            for (const AdapterCandidate &candidate : out)
+            {
+                if (candidate.desc.VendorId == desired_vendor) { matching.push_back(candidate); }
+            }
+            if (!matching.empty())
+            {
+                out = std::move(matching);
+                vendor_matched = true;
+            }
+        }
+        return true;
+    }
+
+    inline std::string description(const DXGI_ADAPTER_DESC1 &desc)
+    {
+        int required = WideCharToMultiByte(CP_UTF8, 0, desc.Description, -1, nullptr, 0, nullptr, nullptr);
+        if (required <= 1) { return {}; }
+        std::string utf8(static_cast<size_t>(required - 1), '\0');
+        WideCharToMultiByte(CP_UTF8, 0, desc.Description, -1, utf8.data(), required, nullptr, nullptr);
+        return utf8;
+    }
+
+    // DXGI `AdapterLuid` as one integer, `HighPart << 32 | LowPart`.
+    inline uint64_t luid(const DXGI_ADAPTER_DESC1 &desc)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(desc.AdapterLuid.HighPart)) << 32) | desc.AdapterLuid.LowPart;
+    }
+} // namespace dxgi_adapters
+
+#endif // SUBTITLE_FAST_DXGI_ADAPTERS_H
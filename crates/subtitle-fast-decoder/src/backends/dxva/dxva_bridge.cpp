@@ -8,6 +8,7 @@
 #include <windows.h>
 #include <d3d11.h>
 #include <d3d11_4.h>
+#include <d3dcompiler.h>
 #include <dxgi1_2.h>
 #include <mfapi.h>
 #include <mfidl.h>
@@ -18,12 +19,22 @@
 #include <combaseapi.h>
 #include <wrl/client.h>
 
+#include "../dxgi_adapters.h"
+#include "../prefetch_stream.h"
+#include "../stream_copy.h"
+
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <cstdlib>
+#include <deque>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -115,7 +126,7 @@ namespace
         return utf8;
     }
 
-    bool select_adapter(Microsoft::WRL::ComPtr<IDXGIAdapter1> &out, std::string &description, std::string &error);
+    bool select_adapter(int ordinal, Microsoft::WRL::ComPtr<IDXGIAdapter1> &out, std::string &description, std::string &error);
 
     struct ScopedCoInitialize
     {
@@ -163,11 +174,13 @@ namespace
         ComPtr<IMFDXGIDeviceManager> device_manager;
         UINT reset_token = 0;
         std::string adapter_description;
+        // DXGI ordinal the device was requested on; -1 lets select_adapter choose.
+        int adapter_ordinal = -1;
 
         bool initialize(std::string &error)
         {
             ComPtr<IDXGIAdapter1> adapter;
-            if (!select_adapter(adapter, adapter_description, error))
+            if (!select_adapter(adapter_ordinal, adapter, adapter_description, error))
             {
                 return false;
             }
@@ -232,70 +245,293 @@ namespace
             #endif
             return true;
         }
+
+        bool lost() const
+        {
+            return !device || FAILED(device->GetDeviceRemovedReason());
+        }
     };
 
-    bool parse_vendor_from_env(UINT &vendor_out)
+    // MF runtime plus device shared by every probe and decode that is handed the same context.
+    struct BridgeRuntime
     {
-        char buffer[16] = {0};
-        DWORD read = GetEnvironmentVariableA("SUBFAST_DXVA_ADAPTER_VENDOR", buffer, static_cast<DWORD>(sizeof(buffer)));
-        if (read == 0 || read >= sizeof(buffer)) { return false; }
-        char *end = nullptr;
-        unsigned long value = std::strtoul(buffer, &end, 0);
-        if (end == buffer || value > 0xFFFFFFFFul) { return false; }
-        vendor_out = static_cast<UINT>(value);
-        return true;
+        ScopedMediaFoundation media_foundation;
+        D3D11Context d3d;
+
+        bool initialize(int adapter_ordinal, std::string &error)
+        {
+            d3d.adapter_ordinal = adapter_ordinal;
+            if (!media_foundation.ok())
+            {
+                error = media_foundation.error();
+                return false;
+            }
+            return d3d.initialize(error);
+        }
+    };
+
+    // Returns the shared runtime, or builds a call-local one when none is given or its device was lost.
+    // A rebuilt runtime stays on the adapter the shared one was created for.
+    BridgeRuntime *acquire_runtime(BridgeRuntime *shared, std::unique_ptr<BridgeRuntime> &local, std::string &error)
+    {
+        if (shared && !shared->d3d.lost())
+        {
+            return shared;
+        }
+        local = std::make_unique<BridgeRuntime>();
+        if (!local->initialize(shared ? shared->d3d.adapter_ordinal : -1, error))
+        {
+            return nullptr;
+        }
+        return local.get();
     }
 
-    bool select_adapter(ComPtr<IDXGIAdapter1> &out, std::string &description, std::string &error)
+    // Keeps the process MTA alive while a reader outlives the thread that opened it. The entry points
+    // are resolved at runtime because they only exist on Windows 8 and later.
+    struct MtaUsage
     {
-        ComPtr<IDXGIFactory1> factory;
-        HRESULT hr = CreateDXGIFactory1(IID_PPV_ARGS(&factory));
-        if (FAILED(hr))
+        void *cookie = nullptr;
+
+        MtaUsage()
         {
-            error = hresult("CreateDXGIFactory1", hr);
-            return false;
+            using Increment = HRESULT(WINAPI *)(void **);
+            HMODULE ole = GetModuleHandleW(L"ole32.dll");
+            auto increment = ole ? reinterpret_cast<Increment>(GetProcAddress(ole, "CoIncrementMTAUsage")) : nullptr;
+            if (!increment || FAILED(increment(&cookie))) { cookie = nullptr; }
+        }
+
+        ~MtaUsage()
+        {
+            if (!cookie) { return; }
+            using Decrement = HRESULT(WINAPI *)(void *);
+            HMODULE ole = GetModuleHandleW(L"ole32.dll");
+            auto decrement = ole ? reinterpret_cast<Decrement>(GetProcAddress(ole, "CoDecrementMTAUsage")) : nullptr;
+            if (decrement) { decrement(cookie); }
+        }
+
+        MtaUsage(const MtaUsage &) = delete;
+        MtaUsage &operator=(const MtaUsage &) = delete;
+
+        bool held() const { return cookie != nullptr; }
+    };
+
+    // IMFSourceReaderCallback that turns the async reader back into a blocking `read`. Up to `depth`
+    // ReadSample requests stay outstanding, so demux and decode of later frames overlap the copy and
+    // delivery of the current one.
+    class AsyncReadQueue final : public IMFSourceReaderCallback
+    {
+    public:
+        explicit AsyncReadQueue(uint32_t depth) : depth_(depth > 0 ? depth : 1) {}
+
+        STDMETHODIMP QueryInterface(REFIID iid, void **out) override
+        {
+            if (!out) { return E_POINTER; }
+            if (iid == __uuidof(IUnknown) || iid == __uuidof(IMFSourceReaderCallback))
+            {
+                *out = static_cast<IMFSourceReaderCallback *>(this);
+                AddRef();
+                return S_OK;
+            }
+            *out = nullptr;
+            return E_NOINTERFACE;
         }
 
-        UINT desired_vendor = 0;
-        bool vendor_requested = parse_vendor_from_env(desired_vendor);
+        STDMETHODIMP_(ULONG) AddRef() override { return InterlockedIncrement(&refs_); }
 
-        UINT index = 0;
-        SIZE_T best_memory = 0;
-        ComPtr<IDXGIAdapter1> best;
-        DXGI_ADAPTER_DESC1 best_desc{};
+        STDMETHODIMP_(ULONG) Release() override
+        {
+            ULONG count = InterlockedDecrement(&refs_);
+            if (count == 0) { delete this; }
+            return count;
+        }
 
-        while (true)
+        STDMETHODIMP OnReadSample(HRESULT status, DWORD, DWORD flags, LONGLONG timestamp, IMFSample *sample) override
         {
-            ComPtr<IDXGIAdapter1> adapter;
-            hr = factory->EnumAdapters1(index++, &adapter);
-            if (hr == DXGI_ERROR_NOT_FOUND) { break; }
-            if (FAILED(hr)) { continue; }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (outstanding_ > 0) { --outstanding_; }
+            if (!flushing_)
+            {
+                results_.push_back(Result{status, flags, timestamp, sample});
+            }
+            ready_.notify_all();
+            return S_OK;
+        }
+
+        STDMETHODIMP OnFlush(DWORD) override
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            flushing_ = false;
+            ready_.notify_all();
+            return S_OK;
+        }
+
+        STDMETHODIMP OnEvent(DWORD, IMFMediaEvent *) override { return S_OK; }
 
-            DXGI_ADAPTER_DESC1 desc{};
-            if (FAILED(adapter->GetDesc1(&desc))) { continue; }
-            if (desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) { continue; }
+        // Returns the next sample in stream order and tops the outstanding requests back up before the
+        // caller starts working on it.
+        HRESULT read(IMFSourceReader *reader, DWORD &flags, LONGLONG &timestamp, ComPtr<IMFSample> &sample)
+        {
+            HRESULT hr = request(reader);
+            if (FAILED(hr)) { return hr; }
 
-            if (vendor_requested && desc.VendorId == desired_vendor)
+            Result result{};
             {
-                out = adapter;
-                description = wide_to_utf8(desc.Description);
-                return true;
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [&] { return !results_.empty() || outstanding_ == 0; });
+                if (results_.empty())
+                {
+                    // Nothing in flight and nothing queued: the stream already ended.
+                    flags = MF_SOURCE_READERF_ENDOFSTREAM;
+                    timestamp = 0;
+                    sample.Reset();
+                    return S_OK;
+                }
+                result = std::move(results_.front());
+                results_.pop_front();
+                if (FAILED(result.status) || (result.flags & MF_SOURCE_READERF_ENDOFSTREAM)) { ended_ = true; }
+            }
+
+            flags = result.flags;
+            timestamp = result.timestamp;
+            sample = std::move(result.sample);
+            if (FAILED(result.status)) { return result.status; }
+            return request(reader);
+        }
+
+        // Drops queued samples and cancels outstanding requests, returning once the reader confirms the flush.
+        HRESULT flush(IMFSourceReader *reader)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                flushing_ = true;
+                results_.clear();
+            }
+            HRESULT hr = reader->Flush(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM));
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (SUCCEEDED(hr)) { ready_.wait(lock, [&] { return !flushing_; }); }
+            flushing_ = false;
+            results_.clear();
+            outstanding_ = 0;
+            ended_ = false;
+            return hr;
+        }
+
+    private:
+        struct Result
+        {
+            HRESULT status = S_OK;
+            DWORD flags = 0;
+            LONGLONG timestamp = 0;
+            ComPtr<IMFSample> sample;
+        };
+
+        HRESULT request(IMFSourceReader *reader)
+        {
+            uint32_t needed = 0;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (ended_) { return S_OK; }
+                const size_t queued = results_.size() + outstanding_;
+                needed = queued < depth_ ? static_cast<uint32_t>(depth_ - queued) : 0;
+                outstanding_ += needed;
+            }
+            // Issued without the lock: the reader may complete a request on this thread.
+            for (uint32_t i = 0; i < needed; ++i)
+            {
+                HRESULT hr = reader->ReadSample(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), 0, nullptr, nullptr, nullptr, nullptr);
+                if (FAILED(hr))
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    const uint32_t unissued = needed - i;
+                    outstanding_ = outstanding_ > unissued ? outstanding_ - unissued : 0;
+                    return hr;
+                }
             }
+            return S_OK;
+        }
+
+        ~AsyncReadQueue() = default;
+
+        volatile ULONG refs_ = 1;
+        const uint32_t depth_;
+        std::mutex mutex_;
+        std::condition_variable ready_;
+        std::deque<Result> results_;
+        uint32_t outstanding_ = 0;
+        bool flushing_ = false;
+        bool ended_ = false;
+    };
+
+    bool is_clean_point(IMFSample *sample)
+    {
+        UINT32 clean_point = 0;
+        return SUCCEEDED(sample->GetUINT32(MFSampleExtension_CleanPoint, &clean_point)) && clean_point != 0;
+    }
+
+    // Synchronous ReadSample unless the reader was opened with an AsyncReadQueue.
+    HRESULT read_sample(IMFSourceReader *reader, AsyncReadQueue *queue, DWORD &flags, LONGLONG &timestamp, ComPtr<IMFSample> &sample)
+    {
+        if (queue) { return queue->read(reader, flags, timestamp, sample); }
+        DWORD stream_index = 0;
+        return reader->ReadSample(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), 0, &stream_index, &flags, &timestamp, &sample);
+    }
 
-            if (desc.DedicatedVideoMemory > best_memory)
+    HRESULT flush_reader(IMFSourceReader *reader, AsyncReadQueue *queue)
+    {
+        if (queue) { return queue->flush(reader); }
+        return reader->Flush(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM));
+    }
+
+    // Reader opened by a probe and kept, already negotiated, for the decode that follows.
+    struct ReaderSession
+    {
+        MtaUsage mta;
+        std::unique_ptr<BridgeRuntime> local_runtime;
+        BridgeRuntime *runtime = nullptr;
+        ComPtr<IMFSourceReader> reader;
+        ComPtr<AsyncReadQueue> queue;
+        ComPtr<prefetch_stream::PrefetchStream> stream;
+        UINT32 width = 0;
+        UINT32 height = 0;
+    };
+
+    using dxgi_adapters::AdapterCandidate;
+    using dxgi_adapters::enumerate_adapters;
+
+    // `ordinal` >= 0 asks for that DXGI adapter. Otherwise the first adapter of the requested vendor wins,
+    // then the one with the most dedicated video memory.
+    bool select_adapter(int ordinal, ComPtr<IDXGIAdapter1> &out, std::string &description, std::string &error)
+    {
+        std::vector<AdapterCandidate> candidates;
+        bool vendor_matched = false;
+        if (!enumerate_adapters(candidates, vendor_matched, error))
+        {
+            return false;
+        }
+
+        const AdapterCandidate *best = nullptr;
+        for (const AdapterCandidate &candidate : candidates)
+        {
+            if (ordinal >= 0)
             {
-                best = adapter;
-                best_desc = desc;
-                best_memory = desc.DedicatedVideoMemory;
+                if (candidate.ordinal == static_cast<UINT>(ordinal)) { best = &candidate; break; }
+                continue;
             }
+            if (vendor_matched) { best = &candidate; break; }
+            if (!best || candidate.desc.DedicatedVideoMemory > best->desc.DedicatedVideoMemory) { best = &candidate; }
         }
 
         if (best)
         {
-            out = best;
-            description = wide_to_utf8(best_desc.Description);
+            out = best->adapter;
+            description = wide_to_utf8(best->desc.Description);
             return true;
         }
+        if (ordinal >= 0)
+        {
+            error = "DXGI adapter " + std::to_string(ordinal) + " is not available";
+            return false;
+        }
 
         // No suitable adapter found; let D3D pick default hardware.
         description.clear();
@@ -364,7 +600,35 @@ namespace
         return S_OK;
     }
 
-    ComPtr<IMFSourceReader> open_reader(const std::wstring &wide_path, D3D11Context &d3d, bool enable_video_processing, UINT32 *out_width, UINT32 *out_height, std::string &error)
+    // Attributes that keep async mode when the full set is rejected; null for a synchronous reader.
+    ComPtr<IMFAttributes> async_only_attributes(IMFSourceReaderCallback *async_callback)
+    {
+        ComPtr<IMFAttributes> attributes;
+        if (async_callback && SUCCEEDED(MFCreateAttributes(&attributes, 1)))
+        {
+            attributes->SetUnknown(MF_SOURCE_READER_ASYNC_CALLBACK, async_callback);
+        }
+        return attributes;
+    }
+
+    // Leaves `stream` null, so readers open the path themselves, unless `window` is set.
+    bool open_prefetch(const std::wstring &wide_path, uint32_t window, bool memory_map, ComPtr<prefetch_stream::PrefetchStream> &stream, std::string &error)
+    {
+        if (window == 0) { return true; }
+        HRESULT hr = prefetch_stream::PrefetchStream::open(wide_path, window, memory_map, stream);
+        if (FAILED(hr)) { error = hresult("PrefetchStream::open", hr); return false; }
+        return true;
+    }
+
+    // Each of open_best's attempts demuxes `stream` from the start.
+    HRESULT create_source_reader(const std::wstring &wide_path, IMFByteStream *stream, IMFAttributes *attributes, IMFSourceReader **reader)
+    {
+        if (!stream) { return MFCreateSourceReaderFromURL(wide_path.c_str(), attributes, reader); }
+        stream->SetCurrentPosition(0);
+        return MFCreateSourceReaderFromByteStream(stream, attributes, reader);
+    }
+
+    ComPtr<IMFSourceReader> open_reader(const std::wstring &wide_path, IMFByteStream *stream, D3D11Context &d3d, bool enable_video_processing, const GUID &subtype, IMFSourceReaderCallback *async_callback, UINT32 *out_width, UINT32 *out_height, std::string &error)
     {
         ComPtr<IMFAttributes> attributes;
         if (SUCCEEDED(MFCreateAttributes(&attributes, 4)))
@@ -372,17 +636,18 @@ namespace
             attributes->SetUINT32(MF_SOURCE_READER_ENABLE_VIDEO_PROCESSING, enable_video_processing ? TRUE : FALSE);
             attributes->SetUINT32(MF_READWRITE_ENABLE_HARDWARE_TRANSFORMS, TRUE);
             attributes->SetUnknown(MF_SOURCE_READER_D3D_MANAGER, d3d.device_manager.Get());
+            if (async_callback) { attributes->SetUnknown(MF_SOURCE_READER_ASYNC_CALLBACK, async_callback); }
         }
 
         ComPtr<IMFSourceReader> reader;
-        HRESULT hr = MFCreateSourceReaderFromURL(wide_path.c_str(), attributes.Get(), &reader);
+        HRESULT hr = create_source_reader(wide_path, stream, attributes.Get(), &reader);
         if (FAILED(hr) && hr == E_INVALIDARG)
         {
-            hr = MFCreateSourceReaderFromURL(wide_path.c_str(), nullptr, &reader);
+            hr = create_source_reader(wide_path, stream, async_only_attributes(async_callback).Get(), &reader);
         }
         if (FAILED(hr))
         {
-            error = hresult("MFCreateSourceReaderFromURL", hr);
+            error = hresult(stream ? "MFCreateSourceReaderFromByteStream" : "MFCreateSourceReaderFromURL", hr);
             return {};
         }
 
@@ -391,9 +656,9 @@ namespace
         hr = reader->SetStreamSelection(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), TRUE);
         if (FAILED(hr)) { error = hresult("SetStreamSelection(video)", hr); return {}; }
 
-        // Require NV12; reject other formats to avoid silent CPU paths.
+        // Require NV12 or P010; reject other formats to avoid silent CPU paths.
         std::string format_error;
-        if (FAILED(set_format(reader.Get(), MFVideoFormat_NV12, out_width, out_height, format_error)))
+        if (FAILED(set_format(reader.Get(), subtype, out_width, out_height, format_error)))
         {
             error = std::move(format_error);
             reader.Reset();
@@ -401,53 +666,1107 @@ namespace
         return reader;
     }
 
-    ComPtr<IMFSourceReader> open_best(const std::wstring &path, D3D11Context &d3d, UINT32 *w, UINT32 *h, std::string &error)
+    bool converts_p010(D3D11Context &d3d, UINT width, UINT height);
+
+    // Subtype the reader currently delivers; GUID_NULL when it cannot be queried.
+    GUID output_subtype(IMFSourceReader *reader)
+    {
+        GUID subtype = GUID_NULL;
+        ComPtr<IMFMediaType> current;
+        if (SUCCEEDED(reader->GetCurrentMediaType(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), &current)))
+        {
+            current->GetGUID(MF_MT_SUBTYPE, &subtype);
+        }
+        return subtype;
+    }
+
+    // YCbCr matrix and range the stream is coded in, from the decoder's output type or else the stream's native
+    // one. The processor's color space only has BT.601 and BT.709, so BT.2020 and SMPTE 240M go through as BT.709;
+    // an unsignalled matrix follows the SD/HD convention and an unsignalled range is studio.
+    D3D11_VIDEO_PROCESSOR_COLOR_SPACE source_color_space(IMFSourceReader *reader, UINT height)
+    {
+        const DWORD stream = static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM);
+        ComPtr<IMFMediaType> types[2];
+        reader->GetCurrentMediaType(stream, &types[0]);
+        reader->GetNativeMediaType(stream, 0, &types[1]);
+        UINT32 matrix = MFVideoTransferMatrix_Unknown;
+        UINT32 range = MFNominalRange_Unknown;
+        for (const ComPtr<IMFMediaType> &type : types)
+        {
+            if (!type) { continue; }
+            UINT32 value = 0;
+            if (matrix == MFVideoTransferMatrix_Unknown && SUCCEEDED(type->GetUINT32(MF_MT_YUV_MATRIX, &value)))
+            {
+                matrix = value;
+            }
+            if (range == MFNominalRange_Unknown && SUCCEEDED(type->GetUINT32(MF_MT_VIDEO_NOMINAL_RANGE, &value)))
+            {
+                range = value;
+            }
+        }
+        const bool bt601 = matrix == MFVideoTransferMatrix_BT601 || (matrix == MFVideoTransferMatrix_Unknown && height < 720);
+
+        D3D11_VIDEO_PROCESSOR_COLOR_SPACE space{};
+        space.YCbCr_Matrix = bt601 ? 0 : 1;
+        space.Nominal_Range = range == MFNominalRange_0_255 ? D3D11_VIDEO_PROCESSOR_NOMINAL_RANGE_0_255
+                                                            : D3D11_VIDEO_PROCESSOR_NOMINAL_RANGE_16_235;
+        return space;
+    }
+
+    ComPtr<IMFSourceReader> open_best(const std::wstring &path, IMFByteStream *stream, D3D11Context &d3d, IMFSourceReaderCallback *async_callback, UINT32 *w, UINT32 *h, std::string &error)
     {
         // Try without video processing first to keep surfaces on GPU; fall back to enabling processing only if needed.
-        ComPtr<IMFSourceReader> reader = open_reader(path, d3d, false, w, h, error);
-        return reader ? reader : open_reader(path, d3d, true, w, h, error);
+        ComPtr<IMFSourceReader> reader = open_reader(path, stream, d3d, false, MFVideoFormat_NV12, async_callback, w, h, error);
+        if (reader) { return reader; }
+        // 10-bit streams decode to P010 only. Taking it natively and narrowing on the video engine (see VideoScaler)
+        // avoids the reader's own processor, which converts through system memory.
+        std::string p010_error;
+        reader = open_reader(path, stream, d3d, false, MFVideoFormat_P010, async_callback, w, h, p010_error);
+        if (reader && converts_p010(d3d, *w, *h)) { return reader; }
+        reader.Reset();
+        return open_reader(path, stream, d3d, true, MFVideoFormat_NV12, async_callback, w, h, error);
+    }
+
+    double qpc_seconds()
+    {
+        static const double frequency = []
+        {
+            LARGE_INTEGER value{};
+            QueryPerformanceFrequency(&value);
+            return static_cast<double>(value.QuadPart);
+        }();
+        LARGE_INTEGER now{};
+        QueryPerformanceCounter(&now);
+        return static_cast<double>(now.QuadPart) / frequency;
+    }
+
+    struct PendingReadback
+    {
+        size_t slot = 0;
+        LONGLONG timestamp = 0;
+        double dts_seconds = NAN;
+        uint64_t index = 0;
+        // Gate pass queued for this slot; its counts and block sums are judged before the frame is staged.
+        bool gated = false;
+        // Gate verdict, read one slot before delivery so a passing frame's staging copy is already in flight.
+        bool resolved = false;
+        bool passed = true;
+        bool repeat = false;
+        float gate_score = 0.0f;
+        double gate_wait_seconds = 0.0;
+        double read_seconds = 0.0;
+        double copy_seconds = 0.0;
+        bool keyframe = false;
+    };
+
+    // Staging textures cycled round-robin so the GPU copy of frame K can run while frame K-N is mapped.
+    struct StagingRing
+    {
+        std::vector<StagingCopy> slots;
+        std::deque<PendingReadback> pending;
+        size_t next_slot = 0;
+
+        explicit StagingRing(size_t depth) : slots(depth == 0 ? 1 : depth) {}
+
+        bool full() const { return pending.size() >= slots.size(); }
+
+        size_t acquire()
+        {
+            size_t slot = next_slot;
+            next_slot = (next_slot + 1) % slots.size();
+            return slot;
+        }
+
+        void discard()
+        {
+            pending.clear();
+        }
+    };
+
+    // Run-up after an accurate seek: samples stamped before `until` are released without touching their pixels.
+    // The first sample at or past it (or without a timestamp) disarms the drop.
+    struct DropUntil
+    {
+        LONGLONG until = -1;
+
+        void arm(double seconds)
+        {
+            until = std::isfinite(seconds) && seconds > 0.0 ? static_cast<LONGLONG>(std::floor(seconds * 10000000.0)) : -1;
+        }
+
+        bool drop(LONGLONG timestamp)
+        {
+            if (until < 0) { return false; }
+            if (timestamp >= 0 && timestamp < until) { return true; }
+            until = -1;
+            return false;
+        }
+    };
+
+    // Keyframe scan: after each emitted frame the reader jumps `interval` ahead. Media Foundation lands on the
+    // keyframe at or before the target, which is emitted if it is newer than the last one; when the GOP is longer
+    // than the interval the landing repeats, so the target moves further out until the next keyframe is reached.
+    struct KeyframeScan
+    {
+        LONGLONG interval = 0;
+        LONGLONG target = 0;
+        LONGLONG last_emitted = -1;
+        bool seek_pending = false;
+        bool landed = true;
+
+        explicit KeyframeScan(double interval_seconds)
+            : interval(std::isfinite(interval_seconds) && interval_seconds > 0.0
+                           ? static_cast<LONGLONG>(std::llround(interval_seconds * 10000000.0))
+                           : 0)
+        {
+        }
+
+        bool enabled() const { return interval > 0; }
+
+        void restart(LONGLONG position)
+        {
+            target = position;
+            last_emitted = -1;
+            seek_pending = false;
+            landed = true;
+        }
+
+        bool accept(LONGLONG timestamp)
+        {
+            const bool first_after_seek = landed;
+            landed = false;
+            if (timestamp < 0) { return true; }
+            if (timestamp <= last_emitted)
+            {
+                if (first_after_seek)
+                {
+                    target += interval;
+                    seek_pending = true;
+                }
+                return false;
+            }
+            if (!first_after_seek && timestamp < target) { return false; }
+            last_emitted = timestamp;
+            target = timestamp + interval;
+            seek_pending = true;
+            return true;
+        }
+
+        bool take_seek()
+        {
+            if (!seek_pending) { return false; }
+            seek_pending = false;
+            landed = true;
+            return true;
+        }
+    };
+
+    HRESULT seek_reader(IMFSourceReader *reader, AsyncReadQueue *queue, LONGLONG position_value)
+    {
+        HRESULT hr = flush_reader(reader, queue);
+        if (FAILED(hr)) { return hr; }
+        PROPVARIANT position;
+        PropVariantInit(&position);
+        position.vt = VT_I8;
+        position.hVal.QuadPart = position_value;
+        hr = reader->SetCurrentPosition(GUID_NULL, position);
+        PropVariantClear(&position);
+        return hr;
+    }
+
+    uint64_t frame_index_at(LONGLONG timestamp, UINT32 frame_rate_num, UINT32 frame_rate_den, uint64_t fallback)
+    {
+        if (timestamp < 0 || frame_rate_num == 0 || frame_rate_den == 0) { return fallback; }
+        long double seconds = static_cast<long double>(timestamp) / 10000000.0L;
+        long double frames = seconds * frame_rate_num / frame_rate_den;
+        if (!std::isfinite(frames) || frames < 0.0L) { return fallback; }
+        return static_cast<uint64_t>(std::llround(frames));
+    }
+
+    // Source rectangle read back from each decoded surface; even-aligned so NV12 chroma stays intact.
+    struct CropRect
+    {
+        UINT left = 0;
+        UINT top = 0;
+        UINT width = 0;
+        UINT height = 0;
+        bool active = false;
+    };
+
+    UINT align_down_even(double value)
+    {
+        return static_cast<UINT>(value) & ~1u;
+    }
+
+    UINT align_up_even(double value, UINT limit)
+    {
+        UINT aligned = (static_cast<UINT>(std::ceil(value)) + 1u) & ~1u;
+        return aligned > limit ? limit : aligned;
+    }
+
+    CropRect resolve_crop(bool has_crop, double x, double y, double w, double h, UINT frame_width, UINT frame_height)
+    {
+        CropRect crop{};
+        crop.width = frame_width;
+        crop.height = frame_height;
+        if (!has_crop || !(w > 0.0) || !(h > 0.0) || frame_width < 2 || frame_height < 2)
+        {
+            return crop;
+        }
+        const double x0 = (std::clamp)(x, 0.0, 1.0) * frame_width;
+        const double y0 = (std::clamp)(y, 0.0, 1.0) * frame_height;
+        const double x1 = (std::clamp)(x + w, 0.0, 1.0) * frame_width;
+        const double y1 = (std::clamp)(y + h, 0.0, 1.0) * frame_height;
+        const UINT left = align_down_even(x0);
+        const UINT top = align_down_even(y0);
+        const UINT right = align_up_even(x1, frame_width & ~1u);
+        const UINT bottom = align_up_even(y1, frame_height & ~1u);
+        if (right <= left || bottom <= top)
+        {
+            return crop;
+        }
+        if (left == 0 && top == 0 && right >= frame_width && bottom >= frame_height)
+        {
+            return crop;
+        }
+        crop.left = left;
+        crop.top = top;
+        crop.width = right - left;
+        crop.height = bottom - top;
+        crop.active = true;
+        return crop;
+    }
+
+    // Decoded surface behind a sample buffer, checked against the crop rectangle.
+    bool decoded_surface(
+        IMFDXGIBuffer *dxgi_buffer,
+        const CropRect &crop,
+        ComPtr<ID3D11Texture2D> &texture,
+        UINT &subresource,
+        D3D11_TEXTURE2D_DESC &desc,
+        std::string &error)
+    {
+        if (!dxgi_buffer) { error = "DXGI buffer is null"; return false; }
+
+        HRESULT hr = dxgi_buffer->GetResource(IID_PPV_ARGS(&texture));
+        if (FAILED(hr) || !texture)
+        {
+            error = hresult("IMFDXGIBuffer::GetResource", hr);
+            return false;
+        }
+        hr = dxgi_buffer->GetSubresourceIndex(&subresource);
+        if (FAILED(hr))
+        {
+            error = hresult("IMFDXGIBuffer::GetSubresourceIndex", hr);
+            return false;
+        }
+
+        texture->GetDesc(&desc);
+        if (crop.active && (crop.left + crop.width > desc.Width || crop.top + crop.height > desc.Height))
+        {
+            error = "crop rectangle exceeds decoded surface";
+            return false;
+        }
+        return true;
+    }
+
+    D3D11_BOX crop_box(const CropRect &crop)
+    {
+        D3D11_BOX box{};
+        box.left = crop.left;
+        box.top = crop.top;
+        box.front = 0;
+        box.right = crop.left + crop.width;
+        box.bottom = crop.top + crop.height;
+        box.back = 1;
+        return box;
+    }
+
+    bool submit_frame_copy(
+        ID3D11Texture2D *texture,
+        UINT subresource,
+        const D3D11_TEXTURE2D_DESC &desc,
+        D3D11Context &d3d,
+        StagingCopy &staging,
+        const CropRect &crop,
+        std::string &error)
+    {
+        const UINT target_width = crop.active ? crop.width : desc.Width;
+        const UINT target_height = crop.active ? crop.height : desc.Height;
+        HRESULT hr = staging.ensure(d3d.device.Get(), target_width, target_height, desc.Format);
+        if (FAILED(hr))
+        {
+            error = hresult("ID3D11Device::CreateTexture2D", hr);
+            return false;
+        }
+
+        const D3D11_BOX box = crop_box(crop);
+
+        // The copy is queued on the immediate context ahead of any later decode into the same surface,
+        // so the sample can be released before the staging texture is mapped.
+        d3d.context->CopySubresourceRegion(
+            staging.texture.Get(), 0, 0, 0, 0, texture, subresource, crop.active ? &box : nullptr);
+        return true;
+    }
+
+    // Serializes a multi-call sequence on the immediate context, which decode workers share.
+    struct DeviceLock
+    {
+#if defined(__ID3D11Multithread_INTERFACE_DEFINED__)
+        ComPtr<ID3D11Multithread> multithread;
+
+        explicit DeviceLock(D3D11Context &d3d)
+        {
+            if (SUCCEEDED(d3d.device.As(&multithread)) && multithread) { multithread->Enter(); }
+        }
+
+        ~DeviceLock()
+        {
+            if (multithread) { multithread->Leave(); }
+        }
+#else
+        explicit DeviceLock(D3D11Context &) {}
+#endif
+
+        DeviceLock(const DeviceLock &) = delete;
+        DeviceLock &operator=(const DeviceLock &) = delete;
+    };
+
+    // Even-aligned size of `crop` once the source picture is scaled to `target_height` rows; false when that
+    // would not shrink it.
+    bool scaled_size(const CropRect &crop, UINT source_height, uint32_t target_height, UINT &out_width, UINT &out_height)
+    {
+        if (target_height == 0 || source_height == 0 || target_height >= source_height) { return false; }
+        const double factor = static_cast<double>(target_height) / static_cast<double>(source_height);
+        out_width = (std::max)(2u, static_cast<UINT>(std::lround(crop.width * factor)) & ~1u);
+        out_height = (std::max)(2u, static_cast<UINT>(std::lround(crop.height * factor)) & ~1u);
+        return out_width < crop.width || out_height < crop.height;
+    }
+
+    // Fixed-function resampler on the decoder's video engine. The crop rectangle of each decoded surface is
+    // scaled into `output`, which then stands in for the surface, so the gate and the staging copy only touch
+    // the reduced picture. Built once per decode; without a usable processor frames stay at native size.
+    // P010 surfaces always go through it, at native size if need be: the output is NV12 either way.
+    struct VideoScaler
+    {
+        ComPtr<ID3D11VideoDevice> video_device;
+        ComPtr<ID3D11VideoContext> video_context;
+        ComPtr<ID3D11VideoProcessorEnumerator> enumerator;
+        ComPtr<ID3D11VideoProcessor> processor;
+        ComPtr<ID3D11Texture2D> output;
+        ComPtr<ID3D11VideoProcessorOutputView> output_view;
+        D3D11_TEXTURE2D_DESC output_desc{};
+
+        bool active() const { return processor != nullptr; }
+
+        // The whole output surface, read in place of the crop rectangle once the scaler is active.
+        CropRect output_rect() const
+        {
+            CropRect rect{};
+            rect.width = output_desc.Width;
+            rect.height = output_desc.Height;
+            return rect;
+        }
+
+        // `space` is the source's color space (source_color_space), which the output keeps.
+        void initialize(D3D11Context &d3d, DXGI_FORMAT source_format, UINT source_width, UINT source_height, UINT target_width, UINT target_height, const D3D11_VIDEO_PROCESSOR_COLOR_SPACE &space)
+        {
+            if (!build(d3d, source_format, source_width, source_height, target_width, target_height, space))
+            {
+                processor.Reset();
+                output_view.Reset();
+                output.Reset();
+            }
+        }
+
+        bool blit(
+            D3D11Context &d3d,
+            ID3D11Texture2D *texture,
+            UINT subresource,
+            const D3D11_TEXTURE2D_DESC &desc,
+            const CropRect &crop,
+            std::string &error)
+        {
+            // Views are cheap next to the blit; creating one per sample keeps no references into the decoder's pool.
+            D3D11_VIDEO_PROCESSOR_INPUT_VIEW_DESC input_desc{};
+            input_desc.FourCC = 0;
+            input_desc.ViewDimension = D3D11_VPIV_DIMENSION_TEXTURE2D;
+            input_desc.Texture2D.MipSlice = 0;
+            input_desc.Texture2D.ArraySlice = subresource / (std::max)(desc.MipLevels, 1u);
+            ComPtr<ID3D11VideoProcessorInputView> input;
+            HRESULT hr = video_device->CreateVideoProcessorInputView(texture, enumerator.Get(), &input_desc, &input);
+            if (FAILED(hr))
+            {
+                error = hresult("ID3D11VideoDevice::CreateVideoProcessorInputView", hr);
+                return false;
+            }
+
+            RECT source_rect{};
+            source_rect.left = static_cast<LONG>(crop.left);
+            source_rect.top = static_cast<LONG>(crop.top);
+            source_rect.right = static_cast<LONG>(crop.left + crop.width);
+            source_rect.bottom = static_cast<LONG>(crop.top + crop.height);
+            D3D11_VIDEO_PROCESSOR_STREAM stream{};
+            stream.Enable = TRUE;
+            stream.pInputSurface = input.Get();
+
+            DeviceLock lock(d3d);
+            video_context->VideoProcessorSetStreamSourceRect(processor.Get(), 0, TRUE, &source_rect);
+            hr = video_context->VideoProcessorBlt(processor.Get(), output_view.Get(), 0, 1, &stream);
+            if (FAILED(hr))
+            {
+                error = hresult("ID3D11VideoContext::VideoProcessorBlt", hr);
+                return false;
+            }
+            return true;
+        }
+
+        // Whether a processor on `d3d` takes `source_format` in and writes NV12 out at these sizes.
+        bool supports(D3D11Context &d3d, DXGI_FORMAT source_format, UINT source_width, UINT source_height, UINT target_width, UINT target_height)
+        {
+            if (FAILED(d3d.device.As(&video_device)) || FAILED(d3d.context.As(&video_context))) { return false; }
+
+            D3D11_VIDEO_PROCESSOR_CONTENT_DESC content{};
+            content.InputFrameFormat = D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE;
+            content.InputFrameRate = {1, 1};
+            content.InputWidth = source_width;
+            content.InputHeight = source_height;
+            content.OutputFrameRate = {1, 1};
+            content.OutputWidth = target_width;
+            content.OutputHeight = target_height;
+            content.Usage = D3D11_VIDEO_USAGE_OPTIMAL_SPEED;
+            if (FAILED(video_device->CreateVideoProcessorEnumerator(&content, &enumerator))) { return false; }
+
+            UINT input_support = 0;
+            UINT output_support = 0;
+            return SUCCEEDED(enumerator->CheckVideoProcessorFormat(source_format, &input_support))
+                   && (input_support & D3D11_VIDEO_PROCESSOR_FORMAT_SUPPORT_INPUT)
+                   && SUCCEEDED(enumerator->CheckVideoProcessorFormat(DXGI_FORMAT_NV12, &output_support))
+                   && (output_support & D3D11_VIDEO_PROCESSOR_FORMAT_SUPPORT_OUTPUT);
+        }
+
+    private:
+        bool build(D3D11Context &d3d, DXGI_FORMAT source_format, UINT source_width, UINT source_height, UINT target_width, UINT target_height, const D3D11_VIDEO_PROCESSOR_COLOR_SPACE &space)
+        {
+            if (!supports(d3d, source_format, source_width, source_height, target_width, target_height)) { return false; }
+            if (FAILED(video_device->CreateVideoProcessor(enumerator.Get(), 0, &processor))) { return false; }
+
+            output_desc.Width = target_width;
+            output_desc.Height = target_height;
+            output_desc.MipLevels = 1;
+            output_desc.ArraySize = 1;
+            output_desc.Format = DXGI_FORMAT_NV12;
+            output_desc.SampleDesc.Count = 1;
+            output_desc.Usage = D3D11_USAGE_DEFAULT;
+            output_desc.BindFlags = D3D11_BIND_RENDER_TARGET;
+            if (FAILED(d3d.device->CreateTexture2D(&output_desc, nullptr, &output))) { return false; }
+
+            D3D11_VIDEO_PROCESSOR_OUTPUT_VIEW_DESC view_desc{};
+            view_desc.ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2D;
+            view_desc.Texture2D.MipSlice = 0;
+            if (FAILED(video_device->CreateVideoProcessorOutputView(output.Get(), enumerator.Get(), &view_desc, &output_view)))
+            {
+                return false;
+            }
+
+            // The source's color space on both sides, so the processor only resamples (and narrows P010 to 8 bits) and
+            // luma keeps its range, studio or full. HDR transfer curves are not tone-mapped; luma stays in the source's
+            // coding.
+            RECT target_rect{0, 0, static_cast<LONG>(target_width), static_cast<LONG>(target_height)};
+
+            DeviceLock lock(d3d);
+            video_context->VideoProcessorSetStreamFrameFormat(processor.Get(), 0, D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE);
+            video_context->VideoProcessorSetStreamAutoProcessingMode(processor.Get(), 0, FALSE);
+            video_context->VideoProcessorSetStreamColorSpace(processor.Get(), 0, &space);
+            video_context->VideoProcessorSetOutputColorSpace(processor.Get(), &space);
+            video_context->VideoProcessorSetStreamDestRect(processor.Get(), 0, TRUE, &target_rect);
+            video_context->VideoProcessorSetOutputTargetRect(processor.Get(), TRUE, &target_rect);
+            return true;
+        }
+    };
+
+    bool converts_p010(D3D11Context &d3d, UINT width, UINT height)
+    {
+        VideoScaler probe;
+        return probe.supports(d3d, DXGI_FORMAT_P010, width, height, width, height);
+    }
+
+    // Longest the bridge waits for a renderer to finish sampling a recycled texture before skipping the frame.
+    constexpr DWORD kTextureSyncTimeoutMs = 500;
+
+    struct SharedTexturePool;
+
+    // NV12 texture handed to the caller in place of a readback. It is shared by NT handle and guarded by a keyed
+    // mutex that both sides take with key 0, so a renderer on its own device (of the same adapter) can open it
+    // once and sample it while the bridge never overwrites a frame that is being drawn.
+    struct SharedTexture
+    {
+        ComPtr<ID3D11Texture2D> texture;
+        ComPtr<IDXGIKeyedMutex> mutex;
+        HANDLE shared_handle = nullptr;
+        // Unique per process; handle values and addresses are reused once a texture is freed.
+        uint64_t id = 0;
+        std::atomic<uint32_t> references{1};
+        std::shared_ptr<SharedTexturePool> pool;
+
+        ~SharedTexture()
+        {
+            if (shared_handle) { CloseHandle(shared_handle); }
+        }
+    };
+
+    // Shared textures of one decode. Released textures go back to the pool while the decode runs, so a renderer
+    // caching opened handles keeps seeing the same few; the pool itself lives until the caller drops the last one.
+    struct SharedTexturePool
+    {
+        // Frames the caller still holds beyond this are created and freed on demand.
+        static constexpr size_t kMaxIdle = 8;
+
+        std::mutex lock;
+        std::vector<SharedTexture *> idle;
+        bool open = true;
+        UINT width = 0;
+        UINT height = 0;
+
+        SharedTexturePool(UINT target_width, UINT target_height) : width(target_width), height(target_height) {}
+
+        // Frees the idle textures; ones still held by the caller are freed as they come back.
+        void close()
+        {
+            std::vector<SharedTexture *> released;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                open = false;
+                released.swap(idle);
+            }
+            for (SharedTexture *texture : released) { delete texture; }
+        }
+    };
+
+    SharedTexture *acquire_shared_texture(const std::shared_ptr<SharedTexturePool> &pool, ID3D11Device *device, std::string &error)
+    {
+        {
+            std::lock_guard<std::mutex> guard(pool->lock);
+            if (!pool->idle.empty())
+            {
+                SharedTexture *texture = pool->idle.back();
+                pool->idle.pop_back();
+                texture->references.store(1, std::memory_order_relaxed);
+                return texture;
+            }
+        }
+
+        D3D11_TEXTURE2D_DESC desc{};
+        desc.Width = pool->width;
+        desc.Height = pool->height;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_NV12;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        desc.MiscFlags = D3D11_RESOURCE_MISC_SHARED_NTHANDLE | D3D11_RESOURCE_MISC_SHARED_KEYEDMUTEX;
+
+        std::unique_ptr<SharedTexture> texture(new SharedTexture());
+        HRESULT hr = device->CreateTexture2D(&desc, nullptr, &texture->texture);
+        if (FAILED(hr)) { error = hresult("ID3D11Device::CreateTexture2D(shared)", hr); return nullptr; }
+        hr = texture->texture.As(&texture->mutex);
+        if (FAILED(hr)) { error = hresult("ID3D11Texture2D::QueryInterface(IDXGIKeyedMutex)", hr); return nullptr; }
+        ComPtr<IDXGIResource1> resource;
+        hr = texture->texture.As(&resource);
+        if (FAILED(hr)) { error = hresult("ID3D11Texture2D::QueryInterface(IDXGIResource1)", hr); return nullptr; }
+        hr = resource->CreateSharedHandle(nullptr, DXGI_SHARED_RESOURCE_READ, nullptr, &texture->shared_handle);
+        if (FAILED(hr)) { error = hresult("IDXGIResource1::CreateSharedHandle", hr); return nullptr; }
+        static std::atomic<uint64_t> next_id{1};
+        texture->id = next_id.fetch_add(1, std::memory_order_relaxed);
+        texture->pool = pool;
+        return texture.release();
+    }
+
+    // A `busy` texture, one the renderer still held, goes to the far end of the idle list so the next frames try
+    // the others first.
+    void release_shared_texture(SharedTexture *texture, bool busy = false)
+    {
+        if (texture->references.fetch_sub(1, std::memory_order_acq_rel) != 1) { return; }
+        {
+            std::shared_ptr<SharedTexturePool> pool = texture->pool;
+            std::lock_guard<std::mutex> guard(pool->lock);
+            if (pool->open && pool->idle.size() < SharedTexturePool::kMaxIdle)
+            {
+                pool->idle.insert(busy ? pool->idle.begin() : pool->idle.end(), texture);
+                return;
+            }
+        }
+        delete texture;
+    }
+
+    // Closes the pool when the decode returns, however it returns.
+    struct SharedTextureScope
+    {
+        std::shared_ptr<SharedTexturePool> pool;
+
+        ~SharedTextureScope()
+        {
+            if (pool) { pool->close(); }
+        }
+    };
+
+    // NV12 regions start and end on even coordinates, so an odd last column or row is left out.
+    CropRect even_rect(const CropRect &rect)
+    {
+        CropRect even = rect;
+        even.left = rect.left & ~1u;
+        even.top = rect.top & ~1u;
+        even.width = (rect.left + rect.width - even.left) & ~1u;
+        even.height = (rect.top + rect.height - even.top) & ~1u;
+        return even;
+    }
+
+    // Copies `rect` (even-aligned) of the decoded (or scaled) surface into `target` under its keyed mutex. Sets
+    // `busy` instead when the renderer holds the mutex past the timeout; the caller then skips the frame.
+    bool submit_texture_copy(
+        ID3D11Texture2D *surface,
+        UINT subresource,
+        D3D11Context &d3d,
+        SharedTexture &target,
+        const CropRect &rect,
+        bool &busy,
+        std::string &error)
+    {
+        busy = false;
+        HRESULT hr = target.mutex->AcquireSync(0, kTextureSyncTimeoutMs);
+        if (hr == static_cast<HRESULT>(WAIT_TIMEOUT))
+        {
+            busy = true;
+            return true;
+        }
+        if (hr != S_OK)
+        {
+            error = hresult("IDXGIKeyedMutex::AcquireSync", hr);
+            return false;
+        }
+        const D3D11_BOX box = crop_box(rect);
+        d3d.context->CopySubresourceRegion(target.texture.Get(), 0, 0, 0, 0, surface, subresource, &box);
+        hr = target.mutex->ReleaseSync(0);
+        if (FAILED(hr))
+        {
+            error = hresult("IDXGIKeyedMutex::ReleaseSync", hr);
+            return false;
+        }
+        return true;
+    }
+
+    // One thread group per row counts the pixels whose 8-bit luma lies in [low, high].
+    const char kLumaGateShader[] = R"(
+Texture2D<float> luma : register(t0);
+RWStructuredBuffer<uint> rows : register(u0);
+cbuffer GateParams : register(b0)
+{
+    uint width;
+    uint low;
+    uint high;
+    uint padding;
+};
+groupshared uint row_total;
+
+[numthreads(64, 1, 1)]
+void main(uint3 group : SV_GroupID, uint thread : SV_GroupIndex)
+{
+    if (thread == 0) { row_total = 0; }
+    GroupMemoryBarrierWithGroupSync();
+    uint count = 0;
+    for (uint x = thread; x < width; x += 64)
+    {
+        uint value = (uint)(luma.Load(int3(x, group.y, 0)) * 255.0 + 0.5);
+        count += (value >= low && value <= high) ? 1 : 0;
+    }
+    InterlockedAdd(row_total, count);
+    GroupMemoryBarrierWithGroupSync();
+    if (thread == 0) { rows[group.y] = row_total; }
+}
+)";
+
+    // Side of the square blocks the change signature sums luma over; matches `change::BLOCK` on the Rust side.
+    constexpr UINT kChangeBlock = 16;
+
+    // One thread group per block sums its 8-bit luma; blocks on the right and bottom edges are partial.
+    const char kBlockSumShader[] = R"(
+Texture2D<float> luma : register(t0);
+RWStructuredBuffer<uint> blocks : register(u0);
+cbuffer BlockParams : register(b0)
+{
+    uint width;
+    uint height;
+    uint columns;
+    uint padding;
+};
+groupshared uint block_total;
+
+[numthreads(16, 16, 1)]
+void main(uint3 group : SV_GroupID, uint3 local : SV_GroupThreadID, uint thread : SV_GroupIndex)
+{
+    if (thread == 0) { block_total = 0; }
+    GroupMemoryBarrierWithGroupSync();
+    uint2 pixel = group.xy * 16 + local.xy;
+    if (pixel.x < width && pixel.y < height)
+    {
+        InterlockedAdd(block_total, (uint)(luma.Load(int3(pixel, 0)) * 255.0 + 0.5));
+    }
+    GroupMemoryBarrierWithGroupSync();
+    if (thread == 0) { blocks[group.y * columns + group.x] = block_total; }
+}
+)";
+
+    // The compiler is resolved at runtime so the bridge does not link against d3dcompiler_47.
+    HRESULT compile_compute(ID3D11Device *device, const char *source, size_t source_len, const char *name,
+                            ComPtr<ID3D11ComputeShader> &out)
+    {
+        static const pD3DCompile compile = []() -> pD3DCompile
+        {
+            HMODULE module = LoadLibraryW(L"d3dcompiler_47.dll");
+            return module ? reinterpret_cast<pD3DCompile>(GetProcAddress(module, "D3DCompile")) : nullptr;
+        }();
+        if (!compile) { return HRESULT_FROM_WIN32(ERROR_MOD_NOT_FOUND); }
+
+        ComPtr<ID3DBlob> code;
+        ComPtr<ID3DBlob> messages;
+        HRESULT hr = compile(source, source_len, name, nullptr, nullptr, "main",
+                             "cs_5_0", D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &code, &messages);
+        if (FAILED(hr)) { return hr; }
+        return device->CreateComputeShader(code->GetBufferPointer(), code->GetBufferSize(), nullptr, &out);
+    }
+
+    bool create_constants(ID3D11Device *device, const uint32_t (&values)[4], ComPtr<ID3D11Buffer> &out)
+    {
+        D3D11_BUFFER_DESC desc{};
+        desc.ByteWidth = sizeof(values);
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        D3D11_SUBRESOURCE_DATA data{};
+        data.pSysMem = values;
+        return SUCCEEDED(device->CreateBuffer(&desc, &data, &out));
+    }
+
+    // A structured uint buffer the pass writes, and the staging buffers its results are copied into per slot.
+    bool create_results(ID3D11Device *device, UINT elements, ComPtr<ID3D11Buffer> &buffer,
+                        ComPtr<ID3D11UnorderedAccessView> &view, D3D11_BUFFER_DESC &staging_desc)
+    {
+        D3D11_BUFFER_DESC desc{};
+        desc.ByteWidth = elements * sizeof(uint32_t);
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+        desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        desc.StructureByteStride = sizeof(uint32_t);
+        if (FAILED(device->CreateBuffer(&desc, nullptr, &buffer))) { return false; }
+
+        D3D11_UNORDERED_ACCESS_VIEW_DESC view_desc{};
+        view_desc.Format = DXGI_FORMAT_UNKNOWN;
+        view_desc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        view_desc.Buffer.NumElements = elements;
+        if (FAILED(device->CreateUnorderedAccessView(buffer.Get(), &view_desc, &view))) { return false; }
+
+        staging_desc = desc;
+        staging_desc.Usage = D3D11_USAGE_STAGING;
+        staging_desc.BindFlags = 0;
+        staging_desc.MiscFlags = 0;
+        staging_desc.StructureByteStride = 0;
+        staging_desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        return true;
+    }
+
+    struct GateSlot
+    {
+        ComPtr<ID3D11Texture2D> surface;
+        ComPtr<ID3D11ShaderResourceView> luma;
+        ComPtr<ID3D11Buffer> counts;
+        ComPtr<ID3D11Buffer> block_sums;
+    };
+
+    // GPU pre-filter. Each frame's delivered rectangle is copied into a shader-readable surface where compute
+    // passes count in-band luma per row (the luma gate) and/or sum luma per block (the change signature); only
+    // those results are read back before the caller decides whether the pixels are worth staging, so rejected
+    // and unchanged frames never cross the bus. Slots pair with the staging ring.
+    struct LumaGate
+    {
+        ComPtr<ID3D11ComputeShader> shader;
+        ComPtr<ID3D11Buffer> params;
+        ComPtr<ID3D11Buffer> rows;
+        ComPtr<ID3D11UnorderedAccessView> rows_view;
+        ComPtr<ID3D11ComputeShader> block_shader;
+        ComPtr<ID3D11Buffer> block_params;
+        ComPtr<ID3D11Buffer> blocks;
+        ComPtr<ID3D11UnorderedAccessView> blocks_view;
+        std::vector<GateSlot> slots;
+        UINT width = 0;
+        UINT height = 0;
+        UINT count_width = 0;
+        UINT count_rows = 0;
+        UINT block_columns = 0;
+        UINT block_rows = 0;
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+        bool counting;
+        bool signing;
+        uint32_t low;
+        uint32_t high;
+        bool built = false;
+        bool unavailable = false;
+
+        LumaGate(size_t depth, bool count_rows_enabled, bool sign_blocks_enabled, uint32_t low_value, uint32_t high_value)
+            : slots(depth == 0 ? 1 : depth), counting(count_rows_enabled), signing(sign_blocks_enabled),
+              low(low_value), high(high_value) {}
+
+        bool enabled() const { return counting || signing; }
+
+        // Builds the passes on first use. Any failure (no compiler, no NV12 shader views, ...) turns the gate
+        // off for the rest of the decode and frames are copied as usual.
+        bool ensure(ID3D11Device *device, UINT surface_width, UINT surface_height, DXGI_FORMAT surface_format,
+                    UINT counted_width, UINT counted_rows)
+        {
+            if (unavailable || !enabled()) { return false; }
+            if (built && width == surface_width && height == surface_height && format == surface_format)
+            {
+                return true;
+            }
+            if (surface_format != DXGI_FORMAT_NV12
+                || !build(device, surface_width, surface_height, counted_width, counted_rows))
+            {
+                unavailable = true;
+                return false;
+            }
+            width = surface_width;
+            height = surface_height;
+            format = surface_format;
+            count_width = counted_width;
+            count_rows = counted_rows;
+            block_columns = (counted_width + kChangeBlock - 1) / kChangeBlock;
+            block_rows = (counted_rows + kChangeBlock - 1) / kChangeBlock;
+            built = true;
+            return true;
+        }
+
+    private:
+        bool build(ID3D11Device *device, UINT surface_width, UINT surface_height, UINT counted_width, UINT counted_rows)
+        {
+            ComPtr<ID3D11Buffer> new_params;
+            ComPtr<ID3D11Buffer> new_rows;
+            ComPtr<ID3D11UnorderedAccessView> new_rows_view;
+            D3D11_BUFFER_DESC counts_desc{};
+            if (counting)
+            {
+                if (!shader
+                    && FAILED(compile_compute(device, kLumaGateShader, sizeof(kLumaGateShader) - 1, "luma_gate", shader)))
+                {
+                    return false;
+                }
+                const uint32_t values[4] = {counted_width, low, high, 0};
+                if (!create_constants(device, values, new_params)
+                    || !create_results(device, counted_rows, new_rows, new_rows_view, counts_desc))
+                {
+                    return false;
+                }
+            }
+
+            ComPtr<ID3D11Buffer> new_block_params;
+            ComPtr<ID3D11Buffer> new_blocks;
+            ComPtr<ID3D11UnorderedAccessView> new_blocks_view;
+            D3D11_BUFFER_DESC sums_desc{};
+            if (signing)
+            {
+                if (!block_shader
+                    && FAILED(compile_compute(device, kBlockSumShader, sizeof(kBlockSumShader) - 1, "block_sum",
+                                              block_shader)))
+                {
+                    return false;
+                }
+                const UINT columns = (counted_width + kChangeBlock - 1) / kChangeBlock;
+                const UINT block_count = columns * ((counted_rows + kChangeBlock - 1) / kChangeBlock);
+                const uint32_t values[4] = {counted_width, counted_rows, columns, 0};
+                if (!create_constants(device, values, new_block_params)
+                    || !create_results(device, block_count, new_blocks, new_blocks_view, sums_desc))
+                {
+                    return false;
+                }
+            }
+
+            D3D11_TEXTURE2D_DESC surface_desc{};
+            surface_desc.Width = surface_width;
+            surface_desc.Height = surface_height;
+            surface_desc.MipLevels = 1;
+            surface_desc.ArraySize = 1;
+            surface_desc.Format = DXGI_FORMAT_NV12;
+            surface_desc.SampleDesc.Count = 1;
+            surface_desc.Usage = D3D11_USAGE_DEFAULT;
+            surface_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+            D3D11_SHADER_RESOURCE_VIEW_DESC luma_desc{};
+            luma_desc.Format = DXGI_FORMAT_R8_UNORM;
+            luma_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+            luma_desc.Texture2D.MipLevels = 1;
+
+            std::vector<GateSlot> new_slots(slots.size());
+            for (GateSlot &slot : new_slots)
+            {
+                if (FAILED(device->CreateTexture2D(&surface_desc, nullptr, &slot.surface))
+                    || FAILED(device->CreateShaderResourceView(slot.surface.Get(), &luma_desc, &slot.luma))
+                    || (counting && FAILED(device->CreateBuffer(&counts_desc, nullptr, &slot.counts)))
+                    || (signing && FAILED(device->CreateBuffer(&sums_desc, nullptr, &slot.block_sums))))
+                {
+                    return false;
+                }
+            }
+
+            params = new_params;
+            rows = new_rows;
+            rows_view = new_rows_view;
+            block_params = new_block_params;
+            blocks = new_blocks;
+            blocks_view = new_blocks_view;
+            slots = std::move(new_slots);
+            return true;
+        }
+    };
+
+    // Runs `shader` over the slot's luma with `results` bound as its output, then queues the copy of the
+    // results into `readback`.
+    void dispatch_pass(ID3D11DeviceContext *context, ID3D11ComputeShader *shader, ID3D11ShaderResourceView *luma,
+                       ID3D11Buffer *constants, ID3D11UnorderedAccessView *results_view, ID3D11Buffer *results,
+                       ID3D11Buffer *readback, UINT groups_x, UINT groups_y)
+    {
+        ID3D11ShaderResourceView *views[] = {luma};
+        ID3D11UnorderedAccessView *targets[] = {results_view};
+        ID3D11Buffer *buffers[] = {constants};
+        ID3D11ShaderResourceView *no_views[] = {nullptr};
+        ID3D11UnorderedAccessView *no_targets[] = {nullptr};
+        context->CSSetShader(shader, nullptr, 0);
+        context->CSSetShaderResources(0, 1, views);
+        context->CSSetUnorderedAccessViews(0, 1, targets, nullptr);
+        context->CSSetConstantBuffers(0, 1, buffers);
+        context->Dispatch(groups_x, groups_y, 1);
+        context->CSSetShaderResources(0, 1, no_views);
+        context->CSSetUnorderedAccessViews(0, 1, no_targets, nullptr);
+        context->CSSetShader(nullptr, nullptr, 0);
+        context->CopyResource(readback, results);
+    }
+
+    // Queues the copy into the slot's shader surface, the enabled passes and the copies of their results.
+    // Returns false when the gate is unavailable for this surface; the caller then copies the frame as usual.
+    bool submit_gate_pass(
+        ID3D11Texture2D *texture,
+        UINT subresource,
+        const D3D11_TEXTURE2D_DESC &desc,
+        D3D11Context &d3d,
+        LumaGate &gate,
+        size_t slot_index,
+        const CropRect &crop)
+    {
+        const UINT surface_width = crop.active ? crop.width : desc.Width;
+        const UINT surface_height = crop.active ? crop.height : desc.Height;
+        if (!gate.ensure(d3d.device.Get(), surface_width, surface_height, desc.Format, crop.width, crop.height))
+        {
+            return false;
+        }
+
+        GateSlot &slot = gate.slots[slot_index];
+        const D3D11_BOX box = crop_box(crop);
+
+        DeviceLock lock(d3d);
+        ID3D11DeviceContext *context = d3d.context.Get();
+        context->CopySubresourceRegion(slot.surface.Get(), 0, 0, 0, 0, texture, subresource, crop.active ? &box : nullptr);
+        if (gate.counting)
+        {
+            dispatch_pass(context, gate.shader.Get(), slot.luma.Get(), gate.params.Get(), gate.rows_view.Get(),
+                          gate.rows.Get(), slot.counts.Get(), 1, gate.count_rows);
+        }
+        if (gate.signing)
+        {
+            dispatch_pass(context, gate.block_shader.Get(), slot.luma.Get(), gate.block_params.Get(),
+                          gate.blocks_view.Get(), gate.blocks.Get(), slot.block_sums.Get(), gate.block_columns,
+                          gate.block_rows);
+        }
+        return true;
     }
 
-    bool copy_frame_gpu(
-        IMFDXGIBuffer *dxgi_buffer,
+    // Maps a slot's row counts for `judge(rows, row_count, row_width)`, which returns whether the frame may hold
+    // a subtitle, then its block sums for `changed(sums, width, height)`, which returns whether it differs from
+    // the last frame read back. `pass` reports the first verdict and `repeat` a frame found unchanged; only a
+    // frame that passes both is queued into `staging` for the usual copy.
+    template <typename Judge, typename Changed>
+    bool resolve_gate(
         D3D11Context &d3d,
+        LumaGate &gate,
+        size_t slot_index,
         StagingCopy &staging,
-        UINT height,
-        UINT uv_rows,
-        std::vector<uint8_t> &out,
-        size_t &stride,
+        Judge &&judge,
+        Changed &&changed,
+        bool &pass,
+        bool &repeat,
+        double &wait_seconds,
         std::string &error)
     {
-        if (!dxgi_buffer) { error = "DXGI buffer is null"; return false; }
-
-        ComPtr<ID3D11Texture2D> texture;
-        UINT subresource = 0;
-        HRESULT hr = dxgi_buffer->GetResource(IID_PPV_ARGS(&texture));
-        if (FAILED(hr) || !texture)
+        GateSlot &slot = gate.slots[slot_index];
+        pass = true;
+        repeat = false;
+        wait_seconds = 0.0;
+        D3D11_MAPPED_SUBRESOURCE mapped{};
+        if (gate.counting)
         {
-            error = hresult("IMFDXGIBuffer::GetResource", hr);
-            return false;
+            const double map_started = qpc_seconds();
+            HRESULT hr = d3d.context->Map(slot.counts.Get(), 0, D3D11_MAP_READ, 0, &mapped);
+            wait_seconds += qpc_seconds() - map_started;
+            if (FAILED(hr))
+            {
+                error = hresult("ID3D11DeviceContext::Map(gate)", hr);
+                return false;
+            }
+            pass = judge(static_cast<const uint32_t *>(mapped.pData), gate.count_rows, gate.count_width);
+            d3d.context->Unmap(slot.counts.Get(), 0);
+            if (!pass) { return true; }
         }
-        hr = dxgi_buffer->GetSubresourceIndex(&subresource);
-        if (FAILED(hr))
+        if (gate.signing)
         {
-            error = hresult("IMFDXGIBuffer::GetSubresourceIndex", hr);
-            return false;
+            const double map_started = qpc_seconds();
+            HRESULT hr = d3d.context->Map(slot.block_sums.Get(), 0, D3D11_MAP_READ, 0, &mapped);
+            wait_seconds += qpc_seconds() - map_started;
+            if (FAILED(hr))
+            {
+                error = hresult("ID3D11DeviceContext::Map(blocks)", hr);
+                return false;
+            }
+            repeat = !changed(static_cast<const uint32_t *>(mapped.pData), gate.count_width, gate.count_rows);
+            d3d.context->Unmap(slot.block_sums.Get(), 0);
+            if (repeat) { return true; }
         }
 
-        D3D11_TEXTURE2D_DESC desc{};
-        texture->GetDesc(&desc);
-        hr = staging.ensure(d3d.device.Get(), desc.Width, desc.Height, desc.Format);
+        HRESULT hr = staging.ensure(d3d.device.Get(), gate.width, gate.height, gate.format);
         if (FAILED(hr))
         {
             error = hresult("ID3D11Device::CreateTexture2D", hr);
             return false;
         }
+        d3d.context->CopyResource(staging.texture.Get(), slot.surface.Get());
+        return true;
+    }
 
-        d3d.context->CopySubresourceRegion(staging.texture.Get(), 0, 0, 0, 0, texture.Get(), subresource, nullptr);
+    // `reserve(y_len, uv_len, y_out, uv_out)` supplies the destination planes once the row pitch is known,
+    // so the mapped texture is copied exactly once into memory the caller owns.
+    template <typename Reserve>
+    bool copy_frame_gpu(
+        D3D11Context &d3d,
+        StagingCopy &staging,
+        UINT height,
+        UINT uv_rows,
+        Reserve &&reserve,
+        size_t &stride,
+        double &wait_seconds,
+        double &memcpy_seconds,
+        std::string &error)
+    {
+        if (!staging.texture) { error = "staging texture is missing"; return false; }
 
         D3D11_MAPPED_SUBRESOURCE mapped{};
-        hr = d3d.context->Map(staging.texture.Get(), 0, D3D11_MAP_READ, 0, &mapped);
+        const double map_started = qpc_seconds();
+        HRESULT hr = d3d.context->Map(staging.texture.Get(), 0, D3D11_MAP_READ, 0, &mapped);
+        wait_seconds = qpc_seconds() - map_started;
         if (FAILED(hr))
         {
             error = hresult("ID3D11DeviceContext::Map", hr);
@@ -457,7 +1776,7 @@ namespace
         stride = static_cast<size_t>(mapped.RowPitch);
         const size_t y_rows = static_cast<size_t>(height);
         const size_t uv_plane_rows = static_cast<size_t>(uv_rows);
-        const size_t buffer_height = static_cast<size_t>(desc.Height);
+        const size_t buffer_height = static_cast<size_t>(staging.height);
         if (stride == 0 || y_rows == 0)
         {
             d3d.context->Unmap(staging.texture.Get(), 0);
@@ -478,7 +1797,7 @@ namespace
             return false;
         }
         if (stride > (std::numeric_limits<size_t>::max)() / y_rows
-            || stride > (std::numeric_limits<size_t>::max)() / uv_plane_rows)
+            || (uv_plane_rows > 0 && stride > (std::numeric_limits<size_t>::max)() / uv_plane_rows))
         {
             d3d.context->Unmap(staging.texture.Get(), 0);
             error = "invalid stride when copying DXVA frame";
@@ -501,18 +1820,24 @@ namespace
         }
         const size_t uv_src_offset = stride * buffer_height;
 
-        out.resize(y_len + uv_len);
-
-        const uint8_t *src = static_cast<const uint8_t *>(mapped.pData);
-        for (size_t row = 0; row < y_rows; ++row)
+        uint8_t *y_dst = nullptr;
+        uint8_t *uv_dst = nullptr;
+        if (!reserve(y_len, uv_len, y_dst, uv_dst) || !y_dst || (uv_len > 0 && !uv_dst))
         {
-            std::memcpy(out.data() + row * stride, src + row * mapped.RowPitch, stride);
+            d3d.context->Unmap(staging.texture.Get(), 0);
+            error = "failed to allocate NV12 planes for DXVA frame";
+            return false;
         }
-        const uint8_t *uv_src = src + uv_src_offset;
-        for (size_t row = 0; row < uv_plane_rows; ++row)
+
+        const double copy_started = qpc_seconds();
+        // The destination planes use RowPitch as their stride, so each plane is a single streaming copy.
+        const uint8_t *src = static_cast<const uint8_t *>(mapped.pData);
+        stream_copy::copy_plane(y_dst, stride, src, mapped.RowPitch, stride, y_rows);
+        if (uv_plane_rows > 0)
         {
-            std::memcpy(out.data() + y_len + row * stride, uv_src + row * mapped.RowPitch, stride);
+            stream_copy::copy_plane(uv_dst, stride, src + uv_src_offset, mapped.RowPitch, stride, uv_plane_rows);
         }
+        memcpy_seconds = qpc_seconds() - copy_started;
 
         d3d.context->Unmap(staging.texture.Get(), 0);
         return true;
@@ -547,19 +1872,196 @@ extern "C"
         double pts_seconds;
         double dts_seconds;
         uint64_t index;
+        double readback_wait_seconds;
+        uint32_t crop_x;
+        uint32_t crop_y;
+        // Source pixels the frame covers; larger than width/height when the video processor scaled it.
+        uint32_t crop_width;
+        uint32_t crop_height;
+        uint32_t source_width;
+        uint32_t source_height;
+        // Rejected by the luma gate: no planes were read back and gate_score carries its verdict.
+        bool gated;
+        float gate_score;
+        // Per-stage timings; readback_wait_seconds above is the Map stall. Reads of samples skipped
+        // before this one are included in read_seconds.
+        double read_seconds;
+        double copy_seconds;
+        double memcpy_seconds;
+        // The sample carried MFSampleExtension_CleanPoint.
+        bool keyframe;
+        // Texture output: an opaque reference to a shared NV12 texture (no planes were read back), the NT handle
+        // to open it with and an id that stays unique for the process, for caching opened textures. The callback
+        // takes its own reference with dxva_texture_retain if it keeps the texture.
+        void *texture;
+        void *texture_handle;
+        uint64_t texture_id;
+        // Found unchanged by the change signature: no planes were read back and the frame repeats the last one
+        // delivered with planes.
+        bool repeat;
+        // Prefetch stream activity since the previous frame: bytes read from the file, and demuxer reads served
+        // from the read-ahead (hits) or left waiting on the file (misses). Zero without a prefetch stream.
+        uint64_t stream_bytes;
+        uint64_t prefetch_hits;
+        uint64_t prefetch_misses;
     };
 
     typedef bool(__cdecl *CDxvaFrameCallback)(const CDxvaFrame *, void *);
+    typedef bool(__cdecl *CDxvaSelectCallback)(void *, double, uint64_t);
+    typedef bool(__cdecl *CDxvaPlaneAllocator)(void *, size_t, size_t, uint8_t **, uint8_t **);
+    typedef bool(__cdecl *CDxvaGateCallback)(void *, const uint32_t *, uint32_t, uint32_t, float *);
+    typedef bool(__cdecl *CDxvaChangeCallback)(void *, const uint32_t *, uint32_t, uint32_t);
+
+    struct CDxvaDecodeOptions
+    {
+        uint32_t readback_depth;
+        // Optional; asked before each readback by the sampler and the backpressure policy.
+        // Returning false releases the decoded surface without reading it back.
+        CDxvaSelectCallback select_callback;
+        // Seconds between emitted frames in keyframe scan mode; 0 decodes every frame.
+        double scan_interval_seconds;
+        // Normalized source rectangle copied off the GPU; ignored unless has_crop is set.
+        bool has_crop;
+        double crop_x;
+        double crop_y;
+        double crop_width;
+        double crop_height;
+        // Optional; hands out caller-owned Y/UV buffers that frames are copied into directly.
+        CDxvaPlaneAllocator allocate_planes;
+        // Copy only the Y plane off the staging texture; frames arrive with a zero-length UV plane.
+        bool luma_only;
+        // ReadSample requests kept in flight by an async reader; 0 reads synchronously.
+        uint32_t read_ahead;
+        // Optional GPU pre-filter: per-row counts of luma in [gate_low, gate_high] over the delivered rectangle
+        // decide whether a frame is read back; rejected frames are delivered with `gated` set and no planes.
+        CDxvaGateCallback gate_callback;
+        uint8_t gate_low;
+        uint8_t gate_high;
+        // Source height the crop rectangle is resampled for on the video processor before the gate and readback;
+        // 0, or a height at or above the source, keeps native resolution.
+        uint32_t scale_height;
+        // Like CDxvaSeekRequest::drop_before_seconds, for the run-up to `start_frame`.
+        double drop_before_seconds;
+        // Samples read between calls to the seek callback; batched delivery polls once per batch. 0 polls every sample.
+        uint32_t seek_poll_interval;
+        // Exact position of `start_frame` when the caller has a frame index; negative derives it from MF_MT_FRAME_RATE.
+        double start_seconds;
+        // Deliver every frame as a shared texture instead of reading it back; the gate and luma_only do not apply.
+        bool texture_output;
+        // Optional change detection: luma sums of each kChangeBlock-square block of the delivered rectangle,
+        // row-major, decide after the gate whether a frame differs from the last one read back; unchanged
+        // frames are delivered with `repeat` set and no planes.
+        CDxvaChangeCallback change_callback;
+        // Demux through a PrefetchStream reading this many bytes ahead instead of the system file stream; 0 keeps
+        // the latter. prefetch_map reads local files from a mapped view instead.
+        uint32_t prefetch_window;
+        bool prefetch_map;
+    };
+
     struct CDxvaSeekRequest
     {
         double position_seconds;
         uint64_t start_frame;
+        // Samples stamped before this are dropped in the bridge; 0 keeps everything after the seek.
+        double drop_before_seconds;
     };
 
     typedef int(__cdecl *CDxvaSeekCallback)(void *, CDxvaSeekRequest *);
 
-    bool dxva_probe_total_frames(const char *path, CDxvaProbeResult *result)
+    typedef struct CDxvaContext CDxvaContext;
+
+    void dxva_texture_retain(void *texture)
+    {
+        if (texture) { reinterpret_cast<SharedTexture *>(texture)->references.fetch_add(1, std::memory_order_relaxed); }
+    }
+
+    // Thread-safe; the texture may outlive the decode that produced it.
+    void dxva_texture_release(void *texture)
+    {
+        if (texture) { release_shared_texture(reinterpret_cast<SharedTexture *>(texture)); }
+    }
+
+    struct CDxvaAdapterInfo
+    {
+        uint32_t ordinal;
+        uint32_t vendor_id;
+        uint32_t device_id;
+        uint64_t dedicated_video_memory;
+        // Release with dxva_string_free.
+        char *description;
+        // AdapterLuid as HighPart << 32 | LowPart.
+        uint64_t luid;
+    };
+
+    // Lists the hardware adapters a context can be created on (honouring SUBFAST_DXVA_ADAPTER_VENDOR). Fills
+    // at most `capacity` entries and stores the total in `out_count`.
+    bool dxva_enumerate_adapters(CDxvaAdapterInfo *out, uint32_t capacity, uint32_t *out_count, char **out_error)
+    {
+        if (out_error) { *out_error = nullptr; }
+        if (out_count) { *out_count = 0; }
+        std::vector<AdapterCandidate> candidates;
+        bool vendor_matched = false;
+        std::string error;
+        if (!enumerate_adapters(candidates, vendor_matched, error))
+        {
+            set_error(out_error, error);
+            return false;
+        }
+        for (size_t index = 0; out && index < candidates.size() && index < capacity; ++index)
+        {
+            const DXGI_ADAPTER_DESC1 &desc = candidates[index].desc;
+            out[index].ordinal = candidates[index].ordinal;
+            out[index].vendor_id = desc.VendorId;
+            out[index].device_id = desc.DeviceId;
+            out[index].dedicated_video_memory = static_cast<uint64_t>(desc.DedicatedVideoMemory);
+            out[index].description = duplicate_string(wide_to_utf8(desc.Description));
+            out[index].luid = dxgi_adapters::luid(desc);
+        }
+        if (out_count) { *out_count = static_cast<uint32_t>(candidates.size()); }
+        return true;
+    }
+
+    // Creates the runtime's device on DXGI adapter `adapter_ordinal`, or on select_adapter's choice when negative.
+    CDxvaContext *dxva_context_create_for_adapter(int32_t adapter_ordinal, char **out_error)
+    {
+        if (out_error) { *out_error = nullptr; }
+        ScopedCoInitialize coinitialize;
+        if (!coinitialize.ok())
+        {
+            set_error(out_error, coinitialize.error());
+            return nullptr;
+        }
+
+        auto runtime = std::make_unique<BridgeRuntime>();
+        std::string error;
+        if (!runtime->initialize(adapter_ordinal, error))
+        {
+            set_error(out_error, error);
+            return nullptr;
+        }
+        return reinterpret_cast<CDxvaContext *>(runtime.release());
+    }
+
+    CDxvaContext *dxva_context_create(char **out_error)
+    {
+        return dxva_context_create_for_adapter(-1, out_error);
+    }
+
+    void dxva_context_destroy(CDxvaContext *context)
+    {
+        if (!context) { return; }
+        ScopedCoInitialize coinitialize;
+        delete reinterpret_cast<BridgeRuntime *>(context);
+    }
+
+    typedef struct CDxvaSession CDxvaSession;
+
+    // Probes `path`. When `out_session` is given, the opened reader is kept there for `dxva_decode`; a non-zero
+    // `read_ahead` opens it in async mode with that many outstanding reads. `prefetch_window` and `prefetch_map`
+    // are CDxvaDecodeOptions' fields, for the probe's reader.
+    bool dxva_open(CDxvaContext *shared, const char *path, uint32_t read_ahead, uint32_t prefetch_window, bool prefetch_map, CDxvaProbeResult *result, CDxvaSession **out_session)
     {
+        if (out_session) { *out_session = nullptr; }
         if (!result) { return false; }
         result->has_value = false;
         result->value = 0;
@@ -584,25 +2086,28 @@ extern "C"
             return false;
         }
 
-        ScopedMediaFoundation media_foundation;
-        if (!media_foundation.ok())
-        {
-            set_error(&result->error, media_foundation.error());
-            return false;
-        }
-
-        D3D11Context d3d;
+        std::unique_ptr<BridgeRuntime> local_runtime;
         std::string device_error;
-        if (!d3d.initialize(device_error))
+        BridgeRuntime *runtime = acquire_runtime(reinterpret_cast<BridgeRuntime *>(shared), local_runtime, device_error);
+        if (!runtime)
         {
             set_error(&result->error, device_error);
             return false;
         }
+        D3D11Context &d3d = runtime->d3d;
 
         std::string reader_error;
         UINT32 width = 0;
         UINT32 height = 0;
-        ComPtr<IMFSourceReader> reader = open_best(wide_path, d3d, &width, &height, reader_error);
+        ComPtr<AsyncReadQueue> queue;
+        if (out_session && read_ahead > 0) { queue.Attach(new AsyncReadQueue(read_ahead)); }
+        ComPtr<prefetch_stream::PrefetchStream> stream;
+        if (!open_prefetch(wide_path, prefetch_window, prefetch_map, stream, reader_error))
+        {
+            set_error(&result->error, reader_error);
+            return false;
+        }
+        ComPtr<IMFSourceReader> reader = open_best(wide_path, stream.Get(), d3d, queue.Get(), &width, &height, reader_error);
         if (!reader)
         {
             set_error(&result->error, reader_error);
@@ -679,18 +2184,46 @@ extern "C"
                 result->value = estimated;
             }
         }
+
+        if (out_session)
+        {
+            auto session = std::make_unique<ReaderSession>();
+            if (session->mta.held())
+            {
+                session->local_runtime = std::move(local_runtime);
+                session->runtime = runtime;
+                session->reader = reader;
+                session->queue = queue;
+                session->stream = stream;
+                session->width = width;
+                session->height = height;
+                *out_session = reinterpret_cast<CDxvaSession *>(session.release());
+            }
+        }
         return true;
     }
 
+    void dxva_session_close(CDxvaSession *session)
+    {
+        if (!session) { return; }
+        ScopedCoInitialize coinitialize;
+        delete reinterpret_cast<ReaderSession *>(session);
+    }
+
+    // Takes ownership of `session` (may be null), decoding from its reader instead of reopening `path`.
     bool dxva_decode(
+        CDxvaContext *shared,
+        CDxvaSession *session,
         const char *path,
         bool has_start_frame,
         uint64_t start_frame,
+        const CDxvaDecodeOptions *options,
         CDxvaFrameCallback callback,
         void *context,
         CDxvaSeekCallback seek_callback,
         char **out_error)
     {
+        std::unique_ptr<ReaderSession> opened(reinterpret_cast<ReaderSession *>(session));
         if (out_error) { *out_error = nullptr; }
         if (!callback)
         {
@@ -718,24 +2251,39 @@ extern "C"
             return false;
         }
 
-        ScopedMediaFoundation media_foundation;
-        if (!media_foundation.ok())
-        {
-            set_error(out_error, media_foundation.error());
-            return false;
-        }
-
-        D3D11Context d3d;
+        std::unique_ptr<BridgeRuntime> local_runtime;
         std::string device_error;
-        if (!d3d.initialize(device_error))
+        BridgeRuntime *runtime = opened
+                                     ? opened->runtime
+                                     : acquire_runtime(reinterpret_cast<BridgeRuntime *>(shared), local_runtime, device_error);
+        if (!runtime)
         {
             set_error(out_error, device_error);
             return false;
         }
+        D3D11Context &d3d = runtime->d3d;
 
         std::string reader_error;
         UINT32 width = 0, height = 0;
-        ComPtr<IMFSourceReader> reader = open_best(wide_path, d3d, &width, &height, reader_error);
+        ComPtr<IMFSourceReader> reader;
+        ComPtr<AsyncReadQueue> queue;
+        ComPtr<prefetch_stream::PrefetchStream> stream;
+        if (opened)
+        {
+            queue = opened->queue;
+            stream = opened->stream;
+            reader = opened->reader;
+            width = opened->width;
+            height = opened->height;
+        }
+        else
+        {
+            if (options && options->read_ahead > 0) { queue.Attach(new AsyncReadQueue(options->read_ahead)); }
+            if (open_prefetch(wide_path, options ? options->prefetch_window : 0, options && options->prefetch_map, stream, reader_error))
+            {
+                reader = open_best(wide_path, stream.Get(), d3d, queue.Get(), &width, &height, reader_error);
+            }
+        }
         if (!reader)
         {
             set_error(out_error, reader_error);
@@ -744,29 +2292,40 @@ extern "C"
 
         if (has_start_frame)
         {
-            ComPtr<IMFMediaType> media_type;
-            HRESULT mt_hr = reader->GetCurrentMediaType(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), &media_type);
-            if (FAILED(mt_hr))
+            LONGLONG position_value = 0;
+            std::string position_error;
+            if (options && options->start_seconds >= 0.0)
             {
-                set_error(out_error, hresult("GetCurrentMediaType", mt_hr));
-                return false;
+                if (!compute_seek_seconds(options->start_seconds, position_value, position_error))
+                {
+                    set_error(out_error, position_error);
+                    return false;
+                }
             }
-
-            UINT32 frame_rate_num = 0;
-            UINT32 frame_rate_den = 0;
-            HRESULT fr_hr = MFGetAttributeRatio(media_type.Get(), MF_MT_FRAME_RATE, &frame_rate_num, &frame_rate_den);
-            if (FAILED(fr_hr))
+            else
             {
-                set_error(out_error, hresult("MFGetAttributeRatio", fr_hr));
-                return false;
-            }
+                ComPtr<IMFMediaType> media_type;
+                HRESULT mt_hr = reader->GetCurrentMediaType(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), &media_type);
+                if (FAILED(mt_hr))
+                {
+                    set_error(out_error, hresult("GetCurrentMediaType", mt_hr));
+                    return false;
+                }
 
-            LONGLONG position_value = 0;
-            std::string position_error;
-            if (!compute_seek_timestamp(start_frame, frame_rate_num, frame_rate_den, position_value, position_error))
-            {
-                set_error(out_error, position_error);
-                return false;
+                UINT32 frame_rate_num = 0;
+                UINT32 frame_rate_den = 0;
+                HRESULT fr_hr = MFGetAttributeRatio(media_type.Get(), MF_MT_FRAME_RATE, &frame_rate_num, &frame_rate_den);
+                if (FAILED(fr_hr))
+                {
+                    set_error(out_error, hresult("MFGetAttributeRatio", fr_hr));
+                    return false;
+                }
+
+                if (!compute_seek_timestamp(start_frame, frame_rate_num, frame_rate_den, position_value, position_error))
+                {
+                    set_error(out_error, position_error);
+                    return false;
+                }
             }
 
             PROPVARIANT position;
@@ -782,23 +2341,213 @@ extern "C"
             }
         }
 
-        StagingCopy staging;
+        const size_t readback_depth = options && options->readback_depth > 0 ? options->readback_depth : 1;
+        const CDxvaSelectCallback select_callback = options ? options->select_callback : nullptr;
+        const CDxvaPlaneAllocator allocate_planes = options ? options->allocate_planes : nullptr;
+        const CropRect crop = options
+                                  ? resolve_crop(options->has_crop, options->crop_x, options->crop_y,
+                                                 options->crop_width, options->crop_height, width, height)
+                                  : resolve_crop(false, 0.0, 0.0, 0.0, 0.0, width, height);
+        VideoScaler scaler;
+        const D3D11_VIDEO_PROCESSOR_COLOR_SPACE color_space = source_color_space(reader.Get(), height);
+        const bool ten_bit = output_subtype(reader.Get()) == MFVideoFormat_P010;
+        const DXGI_FORMAT source_format = ten_bit ? DXGI_FORMAT_P010 : DXGI_FORMAT_NV12;
+        UINT scaled_width = 0;
+        UINT scaled_height = 0;
+        if (options && scaled_size(crop, height, options->scale_height, scaled_width, scaled_height))
+        {
+            scaler.initialize(d3d, source_format, width, height, scaled_width, scaled_height, color_space);
+        }
+        if (ten_bit && !scaler.active())
+        {
+            scaler.initialize(d3d, source_format, width, height, crop.width, crop.height, color_space);
+        }
+        if (ten_bit && !scaler.active())
+        {
+            set_error(out_error, "no video processor converts P010 surfaces to NV12");
+            return false;
+        }
+        // Rectangle the gate and the staging copy read: the crop of each surface, or all of the scaler's output.
+        const CropRect delivered = scaler.active() ? scaler.output_rect() : crop;
+        StagingRing ring(readback_depth);
+        const CDxvaGateCallback gate_callback = options ? options->gate_callback : nullptr;
+        const CDxvaChangeCallback change_callback = options ? options->change_callback : nullptr;
+        LumaGate gate(readback_depth, gate_callback != nullptr, change_callback != nullptr,
+                      options ? options->gate_low : 0, options ? options->gate_high : 0);
         std::vector<uint8_t> plane;
         size_t stride = 0;
-        UINT uv_rows = (height + 1) / 2;
+        const UINT out_height = delivered.height;
+        // Luma-only output still stages NV12 (D3D11 copies both planes of a subresource) but skips the UV rows here.
+        const bool luma_only = options && options->luma_only;
+        UINT uv_rows = luma_only ? 0 : (out_height + 1) / 2;
+        SharedTextureScope textures;
+        const CropRect texture_rect = even_rect(delivered);
+        if (options && options->texture_output)
+        {
+            textures.pool = std::make_shared<SharedTexturePool>(texture_rect.width, texture_rect.height);
+        }
+        bool failed = false;
+
+        // Header of a delivered frame, before planes or a texture are attached.
+        auto describe = [&](const PendingReadback &pending) -> CDxvaFrame
+        {
+            CDxvaFrame frame{};
+            frame.width = delivered.width;
+            frame.height = delivered.height;
+            frame.pts_seconds = pending.timestamp >= 0
+                                    ? static_cast<double>(pending.timestamp) / 10000000.0
+                                    : -1.0;
+            frame.dts_seconds = pending.dts_seconds;
+            frame.index = pending.index;
+            frame.crop_x = crop.left;
+            frame.crop_y = crop.top;
+            frame.crop_width = crop.width;
+            frame.crop_height = crop.height;
+            frame.source_width = width;
+            frame.source_height = height;
+            frame.read_seconds = pending.read_seconds;
+            frame.copy_seconds = pending.copy_seconds;
+            frame.keyframe = pending.keyframe;
+            if (stream)
+            {
+                const prefetch_stream::Counters io = stream->take();
+                frame.stream_bytes = io.bytes_read;
+                frame.prefetch_hits = io.hits;
+                frame.prefetch_misses = io.misses;
+            }
+            return frame;
+        };
+
+        // Reads the gate verdict of the oldest queued frame and, if it passes, queues its staging copy.
+        // Verdicts are read in delivery order, so the change reference is always the last frame delivered.
+        auto resolve_oldest = [&]() -> bool
+        {
+            PendingReadback &pending = ring.pending.front();
+            if (!pending.gated || pending.resolved) { return true; }
+            auto judge = [&](const uint32_t *rows, uint32_t row_count, uint32_t row_width) -> bool
+            {
+                return gate_callback(context, rows, row_count, row_width, &pending.gate_score);
+            };
+            auto changed = [&](const uint32_t *sums, uint32_t sum_width, uint32_t sum_height) -> bool
+            {
+                return change_callback(context, sums, sum_width, sum_height);
+            };
+            std::string gate_error;
+            if (!resolve_gate(d3d, gate, pending.slot, ring.slots[pending.slot], judge, changed, pending.passed,
+                              pending.repeat, pending.gate_wait_seconds, gate_error))
+            {
+                set_error(out_error, gate_error);
+                failed = true;
+                return false;
+            }
+            pending.resolved = true;
+            return true;
+        };
+
+        // Maps the oldest queued staging texture and hands it to the callback.
+        // Returns false when decoding should stop; `failed` is set if that was caused by an error.
+        auto deliver_oldest = [&]() -> bool
+        {
+            // Only reached unresolved at depth 1 and while draining at end of stream.
+            if (!resolve_oldest()) { return false; }
+            PendingReadback pending = ring.pending.front();
+            ring.pending.pop_front();
+
+            uint8_t *y_data = nullptr;
+            uint8_t *uv_data = nullptr;
+            auto reserve = [&](size_t y_len, size_t uv_len, uint8_t *&y_out, uint8_t *&uv_out) -> bool
+            {
+                if (allocate_planes)
+                {
+                    if (!allocate_planes(context, y_len, uv_len, &y_out, &uv_out)) { return false; }
+                }
+                else
+                {
+                    plane.resize(y_len + uv_len);
+                    y_out = plane.data();
+                    uv_out = plane.data() + y_len;
+                }
+                y_data = y_out;
+                uv_data = uv_out;
+                return true;
+            };
+
+            CDxvaFrame frame = describe(pending);
+
+            const double gate_wait_seconds = pending.gate_wait_seconds;
+            std::string copy_error;
+            if (pending.gated && (!pending.passed || pending.repeat))
+            {
+                frame.readback_wait_seconds = gate_wait_seconds;
+                frame.gated = !pending.passed;
+                frame.gate_score = pending.gate_score;
+                frame.repeat = pending.repeat;
+                return callback(&frame, context);
+            }
+
+            double wait_seconds = 0.0;
+            double memcpy_seconds = 0.0;
+            if (!copy_frame_gpu(d3d, ring.slots[pending.slot], out_height, uv_rows, reserve, stride, wait_seconds, memcpy_seconds, copy_error))
+            {
+                set_error(out_error, copy_error.empty() ? "failed to copy DXVA surface to CPU" : copy_error);
+                failed = true;
+                return false;
+            }
+
+            const size_t y_len = stride * static_cast<size_t>(out_height);
+            const size_t uv_len = stride * static_cast<size_t>(uv_rows);
+
+            frame.y_data = y_data;
+            frame.y_len = y_len;
+            frame.y_stride = stride;
+            frame.uv_data = uv_data;
+            frame.uv_len = uv_len;
+            frame.uv_stride = luma_only ? 0 : stride;
+            frame.readback_wait_seconds = gate_wait_seconds + wait_seconds;
+            frame.memcpy_seconds = memcpy_seconds;
+
+            return callback(&frame, context);
+        };
+
+        DropUntil drop;
+        drop.arm(options ? options->drop_before_seconds : 0.0);
+        KeyframeScan scan(options ? options->scan_interval_seconds : 0.0);
+        UINT32 scan_rate_num = 0;
+        UINT32 scan_rate_den = 0;
+        if (scan.enabled())
+        {
+            ComPtr<IMFMediaType> scan_type;
+            HRESULT scan_hr = reader->GetCurrentMediaType(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), &scan_type);
+            if (SUCCEEDED(scan_hr))
+            {
+                MFGetAttributeRatio(scan_type.Get(), MF_MT_FRAME_RATE, &scan_rate_num, &scan_rate_den);
+            }
+        }
 
         uint64_t frame_index = has_start_frame ? start_frame : 0;
+        const uint32_t poll_interval = options && options->seek_poll_interval > 1 ? options->seek_poll_interval : 1;
+        uint32_t reads_since_poll = poll_interval;
+        double read_seconds = 0.0;
         for (;;)
         {
             CDxvaSeekRequest seek_request{};
-            int seek_action = seek_callback(context, &seek_request);
+            int seek_action = 0;
+            if (reads_since_poll >= poll_interval)
+            {
+                reads_since_poll = 0;
+                seek_action = seek_callback(context, &seek_request);
+            }
+            reads_since_poll += 1;
             if (seek_action == 1)
             {
                 break;
             }
             if (seek_action == 2)
             {
-                HRESULT flush_hr = reader->Flush(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM));
+                // Frames still in flight belong to the previous position.
+                ring.discard();
+
+                HRESULT flush_hr = flush_reader(reader.Get(), queue.Get());
                 if (FAILED(flush_hr))
                 {
                     set_error(out_error, hresult("Flush", flush_hr));
@@ -826,14 +2575,27 @@ extern "C"
                 }
 
                 frame_index = seek_request.start_frame;
+                drop.arm(seek_request.drop_before_seconds);
+                scan.restart(position_value);
                 continue;
             }
 
-            DWORD stream_index = 0;
+            if (scan.take_seek())
+            {
+                HRESULT scan_hr = seek_reader(reader.Get(), queue.Get(), scan.target);
+                if (FAILED(scan_hr))
+                {
+                    set_error(out_error, hresult("SetCurrentPosition(scan)", scan_hr));
+                    return false;
+                }
+            }
+
             DWORD flags = 0;
             LONGLONG timestamp = 0;
             ComPtr<IMFSample> sample;
-            HRESULT hr = reader->ReadSample(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), 0, &stream_index, &flags, &timestamp, &sample);
+            const double read_started = qpc_seconds();
+            HRESULT hr = read_sample(reader.Get(), queue.Get(), flags, timestamp, sample);
+            read_seconds += qpc_seconds() - read_started;
             if (FAILED(hr))
             {
                 set_error(out_error, hresult("ReadSample", hr));
@@ -841,10 +2603,39 @@ extern "C"
             }
             if (flags & MF_SOURCE_READERF_ENDOFSTREAM)
             {
+                while (!ring.pending.empty())
+                {
+                    if (!deliver_oldest()) { break; }
+                }
+                if (failed) { return false; }
                 break;
             }
             if ((flags & MF_SOURCE_READERF_STREAMTICK) || !sample) { continue; }
 
+            if (scan.enabled())
+            {
+                if (!scan.accept(timestamp)) { continue; }
+                frame_index = frame_index_at(timestamp, scan_rate_num, scan_rate_den, frame_index);
+            }
+
+            if (drop.drop(timestamp))
+            {
+                frame_index += 1;
+                continue;
+            }
+
+            if (select_callback)
+            {
+                const double pts_seconds = timestamp >= 0
+                                               ? static_cast<double>(timestamp) / 10000000.0
+                                               : -1.0;
+                if (!select_callback(context, pts_seconds, frame_index))
+                {
+                    frame_index += 1;
+                    continue;
+                }
+            }
+
             UINT64 decode_timestamp = 0;
             double dts_seconds = NAN;
             HRESULT dts_hr = sample->GetUINT64(MFSampleExtension_DecodeTimestamp, &decode_timestamp);
@@ -863,8 +2654,6 @@ extern "C"
 
             ComPtr<IMFDXGIBuffer> dxgi_buffer;
             HRESULT dxgi_hr = buffer.As(&dxgi_buffer);
-            plane.clear();
-
             if (FAILED(dxgi_hr))
             {
                 set_error(out_error, hresult("IMFMediaBuffer::QueryInterface(IMFDXGIBuffer)", dxgi_hr));
@@ -876,33 +2665,90 @@ extern "C"
                 return false;
             }
 
+            PendingReadback pending{};
+            pending.timestamp = timestamp;
+            pending.dts_seconds = dts_seconds;
+            pending.index = frame_index;
+            pending.read_seconds = read_seconds;
+            pending.keyframe = is_clean_point(sample.Get());
+            read_seconds = 0.0;
+
+            const double copy_started = qpc_seconds();
             std::string copy_error;
-            if (!copy_frame_gpu(dxgi_buffer.Get(), d3d, staging, height, uv_rows, plane, stride, copy_error))
+            ComPtr<ID3D11Texture2D> texture;
+            UINT subresource = 0;
+            D3D11_TEXTURE2D_DESC desc{};
+            if (!decoded_surface(dxgi_buffer.Get(), crop, texture, subresource, desc, copy_error))
             {
-                set_error(out_error, copy_error.empty() ? "failed to copy DXVA surface to CPU" : copy_error);
+                set_error(out_error, copy_error);
                 return false;
             }
+            ID3D11Texture2D *surface = texture.Get();
+            if (scaler.active())
+            {
+                if (!scaler.blit(d3d, texture.Get(), subresource, desc, crop, copy_error))
+                {
+                    set_error(out_error, copy_error);
+                    return false;
+                }
+                surface = scaler.output.Get();
+                subresource = 0;
+                desc = scaler.output_desc;
+            }
 
-            const size_t y_len = stride * static_cast<size_t>(height);
-            const size_t uv_len = stride * static_cast<size_t>(uv_rows);
+            if (textures.pool)
+            {
+                // The frame stays on the GPU: no staging ring, and the callback gets it as soon as the copy is queued.
+                SharedTexture *shared = acquire_shared_texture(textures.pool, d3d.device.Get(), copy_error);
+                bool busy = false;
+                if (!shared || !submit_texture_copy(surface, subresource, d3d, *shared, texture_rect, busy, copy_error))
+                {
+                    if (shared) { release_shared_texture(shared); }
+                    set_error(out_error, copy_error);
+                    return false;
+                }
+                if (busy)
+                {
+                    // A stuck renderer costs this frame, not the decode.
+                    release_shared_texture(shared, true);
+                    frame_index += 1;
+                    continue;
+                }
+                pending.copy_seconds = qpc_seconds() - copy_started;
+                CDxvaFrame frame = describe(pending);
+                frame.width = texture_rect.width;
+                frame.height = texture_rect.height;
+                frame.texture = shared;
+                frame.texture_handle = shared->shared_handle;
+                frame.texture_id = shared->id;
+                const bool keep_going = callback(&frame, context);
+                release_shared_texture(shared);
+                frame_index += 1;
+                if (!keep_going) { break; }
+                continue;
+            }
+            pending.copy_seconds = qpc_seconds() - copy_started;
 
-            CDxvaFrame frame{};
-            frame.y_data = plane.data();
-            frame.y_len = y_len;
-            frame.y_stride = stride;
-            frame.uv_data = plane.data() + y_len;
-            frame.uv_len = uv_len;
-            frame.uv_stride = stride;
-            frame.width = width;
-            frame.height = height;
-            frame.pts_seconds = timestamp >= 0
-                                    ? static_cast<double>(timestamp) / 10000000.0
-                                    : -1.0;
-            frame.dts_seconds = dts_seconds;
-            frame.index = frame_index;
+            if (ring.full() && !deliver_oldest())
+            {
+                if (failed) { return false; }
+                break;
+            }
 
-            if (!callback(&frame, context)) { break; }
+            const double submit_started = qpc_seconds();
+            pending.slot = ring.acquire();
+            pending.gated = gate.enabled() && submit_gate_pass(surface, subresource, desc, d3d, gate, pending.slot, delivered);
+            if (!pending.gated
+                && !submit_frame_copy(surface, subresource, desc, d3d, ring.slots[pending.slot], delivered, copy_error))
+            {
+                set_error(out_error, copy_error.empty() ? "failed to copy DXVA surface to CPU" : copy_error);
+                return false;
+            }
+            pending.copy_seconds += qpc_seconds() - submit_started;
+            ring.pending.push_back(pending);
             frame_index += 1;
+            // The oldest frame goes out after the next read; judging it now lets its copy overlap that read.
+            if (ring.slots.size() > 1 && ring.full() && !resolve_oldest()) { return false; }
         }
 
         return true;
@@ -1,27 +1,46 @@
 #[cfg(all(target_os = "windows", feature = "backend-dxva"))]
+use crate::adapter::{AdapterInfo, AdapterLease, AdapterLoad, AdapterScheduler, LeaseGroup};
+#[cfg(all(target_os = "windows", feature = "backend-dxva"))]
+use crate::backpressure::{Backpressure, PressureValve};
+#[cfg(all(target_os = "windows", feature = "backend-dxva"))]
 use crate::core::{
     DecoderController, DecoderError, DecoderProvider, DecoderResult, FrameStream, SeekInfo,
     SeekMode, SeekReceiver,
 };
 
 #[cfg(all(target_os = "windows", feature = "backend-dxva"))]
-use crate::core::{VideoFrame, spawn_stream_from_channel};
+use crate::change::{BlockSignature, ChangeDetection};
+#[cfg(all(target_os = "windows", feature = "backend-dxva"))]
+use crate::core::{
+    DecodePhase, DecoderStats, FrameCrop, FrameSink, RoiConfig, VideoFrame, spawn_batched_stream,
+    spawn_stream_from_channel,
+};
+use crate::gate::{GateVerdict, LumaGate};
+#[cfg(all(target_os = "windows", feature = "backend-dxva"))]
+use crate::index::{FrameIndex, IndexRecorder, Timeline};
+#[cfg(all(target_os = "windows", feature = "backend-dxva"))]
+use crate::pool::FramePool;
+#[cfg(all(target_os = "windows", feature = "backend-dxva"))]
+use crate::schedule::SampleSchedule;
+#[cfg(all(target_os = "windows", feature = "backend-dxva"))]
+use crate::segment::{SegmentCursor, SegmentStep, plan_segments, spawn_segmented_stream};
 
 #[cfg(all(target_os = "windows", feature = "backend-dxva"))]
 #[allow(unexpected_cfgs)]
 mod platform {
     use super::*;
     use std::ffi::{CStr, CString, c_char, c_void};
+    use std::num::NonZeroUsize;
     use std::path::{Path, PathBuf};
     use std::ptr;
     use std::slice;
-    use std::sync::Arc;
     use std::sync::atomic::{AtomicU64, Ordering};
-    use std::time::Duration;
-    use tokio::sync::mpsc::Sender;
+    use std::sync::{Arc, Mutex};
+    use std::time::{Duration, Instant};
 
     const BACKEND_NAME: &str = "dxva";
     const DEFAULT_CHANNEL_CAPACITY: usize = 16;
+    const DEFAULT_READBACK_DEPTH: usize = 3;
 
     #[repr(C)]
     struct CDxvaProbeResult {
@@ -47,14 +66,67 @@ mod platform {
         pts_seconds: f64,
         dts_seconds: f64,
         index: u64,
+        readback_wait_seconds: f64,
+        crop_x: u32,
+        crop_y: u32,
+        crop_width: u32,
+        crop_height: u32,
+        source_width: u32,
+        source_height: u32,
+        gated: bool,
+        gate_score: f32,
+        read_seconds: f64,
+        copy_seconds: f64,
+        memcpy_seconds: f64,
+        keyframe: bool,
+        texture: *mut c_void,
+        texture_handle: *mut c_void,
+        texture_id: u64,
+        repeat: bool,
+        stream_bytes: u64,
+        prefetch_hits: u64,
+        prefetch_misses: u64,
     }
 
     type CDxvaFrameCallback = unsafe extern "C" fn(*const CDxvaFrame, *mut c_void) -> bool;
+    type CDxvaSelectCallback = unsafe extern "C" fn(*mut c_void, f64, u64) -> bool;
+    type CDxvaPlaneAllocator =
+        unsafe extern "C" fn(*mut c_void, usize, usize, *mut *mut u8, *mut *mut u8) -> bool;
+    type CDxvaGateCallback =
+        unsafe extern "C" fn(*mut c_void, *const u32, u32, u32, *mut f32) -> bool;
+    type CDxvaChangeCallback = unsafe extern "C" fn(*mut c_void, *const u32, u32, u32) -> bool;
+
+    #[repr(C)]
+    struct CDxvaDecodeOptions {
+        readback_depth: u32,
+        select_callback: Option<CDxvaSelectCallback>,
+        scan_interval_seconds: f64,
+        has_crop: bool,
+        crop_x: f64,
+        crop_y: f64,
+        crop_width: f64,
+        crop_height: f64,
+        allocate_planes: Option<CDxvaPlaneAllocator>,
+        luma_only: bool,
+        read_ahead: u32,
+        gate_callback: Option<CDxvaGateCallback>,
+        gate_low: u8,
+        gate_high: u8,
+        scale_height: u32,
+        drop_before_seconds: f64,
+        seek_poll_interval: u32,
+        start_seconds: f64,
+        texture_output: bool,
+        change_callback: Option<CDxvaChangeCallback>,
+        prefetch_window: u32,
+        prefetch_map: bool,
+    }
     #[repr(C)]
     #[derive(Clone, Copy)]
     struct CDxvaSeekRequest {
         position_seconds: f64,
         start_frame: u64,
+        drop_before_seconds: f64,
     }
 
     type CDxvaSeekCallback = unsafe extern "C" fn(*mut c_void, *mut CDxvaSeekRequest) -> i32;
@@ -63,30 +135,347 @@ mod platform {
     const SEEK_ACTION_STOP: i32 = 1;
     const SEEK_ACTION_SEEK: i32 = 2;
 
+    #[repr(C)]
+    struct CDxvaContext {
+        _private: [u8; 0],
+    }
+
+    #[repr(C)]
+    struct CDxvaSession {
+        _private: [u8; 0],
+    }
+
+    #[repr(C)]
+    struct CDxvaAdapterInfo {
+        ordinal: u32,
+        vendor_id: u32,
+        device_id: u32,
+        dedicated_video_memory: u64,
+        description: *mut c_char,
+        luid: u64,
+    }
+
     #[allow(improper_ctypes)]
     unsafe extern "C" {
-        fn dxva_probe_total_frames(path: *const c_char, result: *mut CDxvaProbeResult) -> bool;
+        fn dxva_enumerate_adapters(
+            out: *mut CDxvaAdapterInfo,
+            capacity: u32,
+            out_count: *mut u32,
+            out_error: *mut *mut c_char,
+        ) -> bool;
+        fn dxva_context_create_for_adapter(
+            adapter_ordinal: i32,
+            out_error: *mut *mut c_char,
+        ) -> *mut CDxvaContext;
+        fn dxva_context_destroy(context: *mut CDxvaContext);
+        fn dxva_open(
+            context: *mut CDxvaContext,
+            path: *const c_char,
+            read_ahead: u32,
+            prefetch_window: u32,
+            prefetch_map: bool,
+            result: *mut CDxvaProbeResult,
+            out_session: *mut *mut CDxvaSession,
+        ) -> bool;
+        fn dxva_session_close(session: *mut CDxvaSession);
         fn dxva_decode(
+            context: *mut CDxvaContext,
+            session: *mut CDxvaSession,
             path: *const c_char,
             has_start_frame: bool,
             start_frame: u64,
+            options: *const CDxvaDecodeOptions,
             callback: CDxvaFrameCallback,
             context: *mut c_void,
             seek_callback: CDxvaSeekCallback,
             out_error: *mut *mut c_char,
         ) -> bool;
+        fn dxva_texture_retain(texture: *mut c_void);
+        fn dxva_texture_release(texture: *mut c_void);
         fn dxva_string_free(ptr: *mut c_char);
     }
 
+    /// `DXGI_FORMAT_NV12`, the pixel format of texture frames.
+    pub const DXGI_FORMAT_NV12: u32 = 103;
+
+    /// What the handle of a texture frame's [`NativeBuffer`](crate::NativeBuffer) points at when
+    /// decoding with [`OutputFormat::D3D11Texture`](crate::OutputFormat::D3D11Texture).
+    #[repr(C)]
+    pub struct DxvaTexture {
+        /// NT handle of the NV12 `ID3D11Texture2D`, for `ID3D11Device1::OpenSharedResource1` on the
+        /// same adapter. Hold its `IDXGIKeyedMutex` with key 0 while sampling. Valid as long as the
+        /// frame is.
+        pub shared_handle: *mut c_void,
+        /// Distinguishes textures for the life of the process, unlike handle values, which are
+        /// reused once a texture is freed.
+        pub id: u64,
+        pub width: u32,
+        pub height: u32,
+        texture: *mut c_void,
+    }
+
+    impl DxvaTexture {
+        pub fn from_native(buffer: &crate::NativeBuffer) -> Option<&Self> {
+            if buffer.backend() != BACKEND_NAME || buffer.pixel_format() != DXGI_FORMAT_NV12 {
+                return None;
+            }
+            // Only `handle_frame` builds dxva native buffers, always around a boxed `DxvaTexture`.
+            Some(unsafe { &*(buffer.handle() as *const Self) })
+        }
+    }
+
+    unsafe extern "C" fn release_texture(handle: *mut c_void) {
+        let texture = unsafe { Box::from_raw(handle as *mut DxvaTexture) };
+        unsafe { dxva_texture_release(texture.texture) };
+    }
+
+    /// Bridge runtime (MF plus the D3D11 device and DXGI device manager) reused by every probe and
+    /// decode on the same adapter instead of being set up per call.
+    struct BridgeContext {
+        raw: *mut CDxvaContext,
+        /// DXGI adapter the device was created on; `None` when the bridge picked it.
+        adapter: Option<u32>,
+    }
+
+    // The device is multithread-protected and the bridge only reads the runtime after creation.
+    unsafe impl Send for BridgeContext {}
+    unsafe impl Sync for BridgeContext {}
+
+    impl BridgeContext {
+        /// Returns the process-wide context for `adapter`, creating it on first use.
+        fn shared(adapter: Option<u32>) -> DecoderResult<Arc<Self>> {
+            static SHARED: Mutex<Vec<Arc<BridgeContext>>> = Mutex::new(Vec::new());
+            let mut contexts = SHARED
+                .lock()
+                .unwrap_or_else(|poisoned| poisoned.into_inner());
+            if let Some(context) = contexts.iter().find(|context| context.adapter == adapter) {
+                return Ok(context.clone());
+            }
+            let ordinal = adapter.map_or(-1, |ordinal| i32::try_from(ordinal).unwrap_or(i32::MAX));
+            let mut error_ptr: *mut c_char = ptr::null_mut();
+            let raw = unsafe { dxva_context_create_for_adapter(ordinal, &mut error_ptr) };
+            let bridge_error = take_bridge_string(error_ptr);
+            if raw.is_null() {
+                let message = bridge_error.unwrap_or_else(|| "context creation failed".to_string());
+                return Err(DecoderError::backend_failure(BACKEND_NAME, message));
+            }
+            let context = Arc::new(Self { raw, adapter });
+            contexts.push(context.clone());
+            Ok(context)
+        }
+
+        fn as_ptr(&self) -> *mut CDxvaContext {
+            self.raw
+        }
+    }
+
+    impl Drop for BridgeContext {
+        fn drop(&mut self) {
+            unsafe { dxva_context_destroy(self.raw) };
+        }
+    }
+
+    /// Hardware adapters of this machine, enumerated once per process. Empty when enumeration fails,
+    /// in which case every reader runs on the bridge's default adapter.
+    fn scheduler() -> &'static Arc<AdapterScheduler> {
+        crate::adapter::dxgi_scheduler(|| enumerate_adapters().unwrap_or_default())
+    }
+
+    fn enumerate_adapters() -> DecoderResult<Vec<AdapterInfo>> {
+        let mut count = 0u32;
+        let mut error_ptr: *mut c_char = ptr::null_mut();
+        let ok = unsafe { dxva_enumerate_adapters(ptr::null_mut(), 0, &mut count, &mut error_ptr) };
+        if let Some(message) = take_bridge_string(error_ptr).filter(|_| !ok) {
+            return Err(DecoderError::backend_failure(BACKEND_NAME, message));
+        }
+        let mut raw: Vec<CDxvaAdapterInfo> = (0..count)
+            .map(|_| CDxvaAdapterInfo {
+                ordinal: 0,
+                vendor_id: 0,
+                device_id: 0,
+                dedicated_video_memory: 0,
+                description: ptr::null_mut(),
+                luid: 0,
+            })
+            .collect();
+        let mut filled = 0u32;
+        let mut error_ptr: *mut c_char = ptr::null_mut();
+        let ok = unsafe {
+            dxva_enumerate_adapters(raw.as_mut_ptr(), count, &mut filled, &mut error_ptr)
+        };
+        let bridge_error = take_bridge_string(error_ptr);
+        // Descriptions are owned by us from here on, whatever else went wrong.
+        let adapters: Vec<AdapterInfo> = raw
+            .iter()
+            .take(filled.min(count) as usize)
+            .map(|info| AdapterInfo {
+                ordinal: info.ordinal,
+                name: take_bridge_string(info.description)
+                    .unwrap_or_else(|| format!("adapter {}", info.ordinal)),
+                vendor_id: info.vendor_id,
+                dedicated_memory: info.dedicated_video_memory,
+                luid: info.luid,
+            })
+            .collect();
+        if !ok {
+            let message = bridge_error.unwrap_or_else(|| "adapter enumeration failed".to_string());
+            return Err(DecoderError::backend_failure(BACKEND_NAME, message));
+        }
+        Ok(adapters)
+    }
+
+    /// Readers currently placed on each DXGI adapter, with the frames and throughput measured so far.
+    pub fn adapter_loads() -> Vec<AdapterLoad> {
+        scheduler().loads()
+    }
+
+    /// Caps the DXVA and MFT hardware readers running on one adapter at a time; later decodes wait
+    /// for a slot. The segment workers of a decode wait until every one of them has a slot, and
+    /// are fewer when the limit cannot hold them all.
+    pub fn set_sessions_per_adapter(limit: Option<NonZeroUsize>) {
+        scheduler().set_session_limit(limit);
+    }
+
+    /// Leases the adapter the scheduler weighs cheapest and returns its context. Adapters whose
+    /// device cannot be created leave the rotation; with none left the bridge picks the device.
+    /// A reader of `group` waits for its slot below the session limit; without one, or once its
+    /// lease has failed, it takes an adapter regardless of the limit.
+    fn lease_context(
+        stats: Option<&DecoderStats>,
+        group: Option<&LeaseGroup>,
+    ) -> DecoderResult<(Arc<BridgeContext>, Option<AdapterLease>)> {
+        let scheduler = scheduler();
+        let mut bounded = group.and_then(|group| group.take(scheduler));
+        while let Some(lease) = bounded.take().or_else(|| scheduler.lease()) {
+            let ordinal = lease.info().ordinal;
+            match BridgeContext::shared(Some(ordinal)) {
+                Ok(context) => {
+                    let lease = match stats {
+                        Some(stats) => lease.attach(stats),
+                        None => lease,
+                    };
+                    return Ok((context, Some(lease)));
+                }
+                Err(_) => scheduler.mark_failed(ordinal),
+            }
+        }
+        Ok((BridgeContext::shared(None)?, None))
+    }
+
+    static TEXTURE_ADAPTER: Mutex<Option<u64>> = Mutex::new(None);
+
+    /// Names, by DXGI LUID, the adapter a renderer opens texture frames on. `OpenSharedResource1`
+    /// only opens textures from a device on the same adapter, so texture decodes run there.
+    pub fn set_texture_adapter(luid: Option<u64>) {
+        *TEXTURE_ADAPTER
+            .lock()
+            .unwrap_or_else(|poisoned| poisoned.into_inner()) = luid;
+    }
+
+    /// Texture frames are decoded on the renderer's adapter instead of wherever the scheduler weighs
+    /// cheapest. Without a renderer adapter, or when the vendor filter leaves it out, they go
+    /// through the scheduler like any other reader.
+    fn reader_context(
+        texture_output: bool,
+        stats: Option<&DecoderStats>,
+        group: Option<&LeaseGroup>,
+    ) -> DecoderResult<(Arc<BridgeContext>, Option<AdapterLease>)> {
+        let luid = *TEXTURE_ADAPTER
+            .lock()
+            .unwrap_or_else(|poisoned| poisoned.into_inner());
+        let renderer = luid.filter(|_| texture_output).and_then(|luid| {
+            scheduler()
+                .adapters()
+                .find(|adapter| adapter.luid == luid)
+                .map(|adapter| adapter.ordinal)
+        });
+        if let Some(ordinal) = renderer
+            && let Ok(context) = BridgeContext::shared(Some(ordinal))
+        {
+            return Ok((context, None));
+        }
+        lease_context(stats, group)
+    }
+
+    /// Reader left open by the probe so the first decode does not open and negotiate the file again.
+    /// It keeps the probe's adapter lease, so the first reader decodes on that adapter instead of
+    /// wherever the scheduler would place it and keeps its slot counted until then.
+    struct ProbedSession {
+        raw: *mut CDxvaSession,
+        context: Arc<BridgeContext>,
+        lease: Option<AdapterLease>,
+    }
+
+    // The session is handed over to exactly one decode, which may run on another thread.
+    unsafe impl Send for ProbedSession {}
+
+    impl ProbedSession {
+        fn into_raw(mut self) -> *mut CDxvaSession {
+            std::mem::replace(&mut self.raw, ptr::null_mut())
+        }
+    }
+
+    impl Drop for ProbedSession {
+        fn drop(&mut self) {
+            if !self.raw.is_null() {
+                unsafe { dxva_session_close(self.raw) };
+            }
+        }
+    }
+
     pub struct DxvaProvider {
         input: PathBuf,
         metadata: crate::core::VideoMetadata,
+        session: Option<ProbedSession>,
         channel_capacity: usize,
         start_frame: Option<u64>,
+        readback_depth: usize,
+        samples_per_second: Option<u32>,
+        scan_interval: Option<Duration>,
+        crop: Option<RoiConfig>,
+        /// Frames whose planes the pool keeps idle.
+        pool_size: usize,
+        decode_workers: usize,
+        delivery_batch: usize,
+        luma_only: bool,
+        read_ahead: u32,
+        index: Option<Arc<FrameIndex>>,
+        index_cache: Option<PathBuf>,
+        luma_gate: Option<LumaGate>,
+        scale_height: u32,
+        texture_output: bool,
+        change_detection: Option<ChangeDetection>,
+        prefetch: Option<crate::config::Prefetch>,
+        backpressure: Backpressure,
     }
 
     impl DxvaProvider {}
 
+    /// Per-run knobs shared by every reader decoding this input.
+    #[derive(Clone)]
+    struct DecodeSettings {
+        session: Arc<Mutex<Option<ProbedSession>>>,
+        path: PathBuf,
+        readback_depth: usize,
+        samples_per_second: Option<u32>,
+        scan_interval: Option<Duration>,
+        crop: Option<RoiConfig>,
+        pool: FramePool,
+        timeline: Timeline,
+        luma_only: bool,
+        read_ahead: u32,
+        /// Set when this run decodes the whole file in order, so it can record the frame index.
+        index_cache: Option<PathBuf>,
+        luma_gate: Option<LumaGate>,
+        scale_height: u32,
+        texture_output: bool,
+        change_detection: Option<ChangeDetection>,
+        prefetch: Option<crate::config::Prefetch>,
+        backpressure: Backpressure,
+        /// Session-limit slots of this run's readers, one per segment worker.
+        leases: Arc<LeaseGroup>,
+    }
+
     impl DecoderProvider for DxvaProvider {
         fn new(config: &crate::config::Configuration) -> DecoderResult<Self> {
             let path = config.input.as_ref().ok_or_else(|| {
@@ -98,17 +487,56 @@ mod platform {
                     format!("input file {} does not exist", path.display()),
                 )));
             }
-            let metadata = probe_video_metadata(path)?;
+            let texture_output = config.output_format == crate::config::OutputFormat::D3D11Texture;
+            // The probe's reader and lease are kept for the first decode.
+            let (context, lease) = reader_context(texture_output, None, None)?;
+            let read_ahead = config
+                .read_ahead
+                .map_or(0, |n| u32::try_from(n.get()).unwrap_or(u32::MAX));
+            let (mut metadata, session) =
+                probe_video_metadata(&context, lease, path, read_ahead, config.prefetch)?;
+            let index = config
+                .index_cache
+                .as_deref()
+                .and_then(|dir| FrameIndex::load(dir, path))
+                .map(Arc::new);
+            if let Some(index) = index.as_ref() {
+                metadata.total_frames = Some(index.len());
+            }
             let capacity = config
                 .channel_capacity
                 .map(|n| n.get())
                 .unwrap_or(DEFAULT_CHANNEL_CAPACITY)
                 .max(1);
+            let readback_depth = config
+                .readback_depth
+                .map(|n| n.get())
+                .unwrap_or(DEFAULT_READBACK_DEPTH);
             Ok(Self {
                 input: path.to_path_buf(),
                 metadata,
+                session,
                 channel_capacity: capacity,
                 start_frame: config.start_frame,
+                readback_depth,
+                samples_per_second: config.samples_per_second.map(|n| n.get()),
+                scan_interval: config.scan.keyframe_interval(),
+                crop: config.crop,
+                pool_size: capacity
+                    + readback_depth
+                    + config.retained_frames.map_or(0, |n| n.get()),
+                decode_workers: config.decode_workers.map_or(1, |n| n.get()),
+                delivery_batch: config.delivery_batch.map_or(1, |n| n.get()),
+                luma_only: config.output_format == crate::config::OutputFormat::Luma,
+                read_ahead,
+                index,
+                index_cache: config.index_cache.clone(),
+                luma_gate: config.luma_gate,
+                scale_height: config.scale_height.map_or(0, |n| n.get()),
+                texture_output,
+                change_detection: config.change_detection,
+                prefetch: config.prefetch,
+                backpressure: config.backpressure,
             })
         }
 
@@ -117,49 +545,222 @@ mod platform {
         }
 
         fn open(self: Box<Self>) -> DecoderResult<(DecoderController, FrameStream)> {
-            let provider = *self;
+            let mut provider = *self;
             let capacity = provider.channel_capacity;
             let start_frame = provider.start_frame;
-            let fps = provider.metadata.fps;
-            let controller = DecoderController::new();
+            let mut settings = DecodeSettings {
+                session: Arc::new(Mutex::new(provider.session.take())),
+                path: provider.input.clone(),
+                readback_depth: provider.readback_depth,
+                samples_per_second: provider.samples_per_second,
+                scan_interval: provider.scan_interval,
+                crop: provider.crop,
+                pool: FramePool::new(provider.pool_size),
+                timeline: Timeline::new(provider.metadata.fps, provider.index.clone()),
+                luma_only: provider.luma_only,
+                read_ahead: provider.read_ahead,
+                index_cache: None,
+                luma_gate: provider.luma_gate,
+                scale_height: provider.scale_height,
+                texture_output: provider.texture_output,
+                change_detection: provider.change_detection,
+                prefetch: provider.prefetch,
+                backpressure: provider.backpressure,
+                leases: Arc::new(LeaseGroup::new(1)),
+            };
+            let mut controller = DecoderController::new();
             let seek_rx = controller.seek_receiver();
             let serial = controller.serial_handle();
-            let stream = spawn_stream_from_channel(capacity, move |tx| {
-                if let Err(err) = decode_dxva(
-                    provider.input.clone(),
-                    tx.clone(),
-                    start_frame,
-                    seek_rx,
-                    serial,
-                    fps,
-                ) {
-                    let _ = tx.blocking_send(Err(err));
+            let stats = controller.stats_handle();
+            // Keyframe scans already skip most of the stream; splitting them buys nothing.
+            // More workers than the session limit holds would never all get a slot.
+            let workers = if settings.scan_interval.is_some() {
+                1
+            } else {
+                let capacity = scheduler().session_capacity();
+                capacity.map_or(provider.decode_workers, |capacity| {
+                    provider.decode_workers.min(capacity)
+                })
+            };
+            let chunks = plan_segments(
+                &provider.metadata,
+                start_frame,
+                workers,
+                provider.index.as_deref(),
+            );
+            // Workers seek only between their own chunks, so the stream's controller cannot seek.
+            // The worker that takes the probe's session decodes under the probe's lease.
+            if let Some(chunks) = chunks.as_ref() {
+                controller.refuse_seeks();
+                let probed = settings
+                    .session
+                    .lock()
+                    .is_ok_and(|slot| slot.as_ref().is_some_and(|session| session.lease.is_some()));
+                let readers = workers.min(chunks.len());
+                settings.leases = Arc::new(LeaseGroup::new(readers - usize::from(probed)));
+            }
+            // Only a plain decode from the first frame sees every sample in order.
+            if provider.index.is_none()
+                && chunks.is_none()
+                && start_frame.is_none()
+                && settings.samples_per_second.is_none()
+                && settings.scan_interval.is_none()
+                && settings.backpressure == Backpressure::Block
+            {
+                settings.index_cache = provider.index_cache.clone();
+            }
+            let stream = match chunks {
+                Some(chunks) => {
+                    spawn_segmented_stream(capacity, chunks, workers, move |assigned, tx| {
+                        let Some(segments) = SegmentCursor::new(assigned) else {
+                            return;
+                        };
+                        let start = Some(segments.first_frame());
+                        if let Err(err) = decode_dxva(
+                            &settings,
+                            FrameSink::new(tx.clone()),
+                            start,
+                            Some(segments),
+                            seek_rx.clone(),
+                            serial.clone(),
+                            stats.clone(),
+                        ) {
+                            let _ = tx.blocking_send(Err(err));
+                        }
+                    })
                 }
-            });
+                None => {
+                    let run = move |sink: FrameSink| {
+                        let mut errors = sink.clone();
+                        if let Err(err) =
+                            decode_dxva(&settings, sink, start_frame, None, seek_rx, serial, stats)
+                        {
+                            errors.send(Err(err));
+                        }
+                    };
+                    if provider.delivery_batch > 1 {
+                        spawn_batched_stream(capacity, provider.delivery_batch, run)
+                    } else {
+                        spawn_stream_from_channel(capacity, move |tx| run(FrameSink::new(tx)))
+                    }
+                }
+            };
             Ok((controller, stream))
         }
     }
 
     fn decode_dxva(
-        path: PathBuf,
-        tx: Sender<DecoderResult<VideoFrame>>,
+        settings: &DecodeSettings,
+        sink: FrameSink,
         start_frame: Option<u64>,
+        segments: Option<SegmentCursor>,
         seek_rx: SeekReceiver,
         serial: Arc<AtomicU64>,
-        fps: Option<f64>,
+        stats: Arc<DecoderStats>,
     ) -> DecoderResult<()> {
-        let c_path = cstring_from_path(&path)?;
-        let mut context = DecodeContext::new(tx, seek_rx, serial, fps);
+        let c_path = cstring_from_path(&settings.path)?;
+        // The first reader to start gets the probe's session and decodes under its lease. Every other
+        // reader (each segment worker included) is placed on an adapter of its own choosing, once the
+        // decode's readers all have a slot below the session limit, and opens the file itself.
+        let probed = settings
+            .session
+            .lock()
+            .ok()
+            .and_then(|mut slot| slot.take());
+        let (bridge, lease, session) = match probed {
+            Some(mut probed) if probed.lease.is_some() => {
+                let lease = probed.lease.take().map(|lease| lease.attach(&stats));
+                let bridge = probed.context.clone();
+                (bridge, lease, probed.into_raw())
+            }
+            probed => {
+                let (bridge, lease) = reader_context(
+                    settings.texture_output,
+                    Some(&stats),
+                    Some(&settings.leases),
+                )?;
+                // A probe without a lease ran outside the scheduler; reuse it only on the same context.
+                let session = probed
+                    .filter(|session| Arc::ptr_eq(&session.context, &bridge))
+                    .map_or(ptr::null_mut(), ProbedSession::into_raw);
+                (bridge, lease, session)
+            }
+        };
+        let crop = settings.crop;
+        let scan_interval = settings.scan_interval;
+        let schedule = settings.samples_per_second.map(SampleSchedule::new);
+        let mut context = DecodeContext::new(
+            sink,
+            seek_rx,
+            serial,
+            stats,
+            schedule,
+            settings.pool.clone(),
+            settings.timeline.clone(),
+        )
+        .with_segments(segments)
+        .with_backpressure(settings.backpressure)
+        .with_gate(settings.luma_gate)
+        .with_change_detection(settings.change_detection);
+        context.lease = lease;
         let mut error_ptr: *mut c_char = ptr::null_mut();
-        let (has_start_frame, start_frame) = match start_frame {
-            Some(value) => (true, value),
-            None => (false, 0),
+        if settings.index_cache.is_some() {
+            context.recorder = Some(IndexRecorder::default());
+        }
+        // With an index the reader starts exactly on the keyframe before the requested frame.
+        let start_point = start_frame
+            .filter(|_| settings.timeline.index().is_some())
+            .and_then(|frame| settings.timeline.seek_point(frame));
+        let (has_start_frame, start_frame) =
+            match start_point.map(|point| point.frame).or(start_frame) {
+                Some(value) => (true, value),
+                None => (false, 0),
+            };
+        let options = CDxvaDecodeOptions {
+            readback_depth: u32::try_from(settings.readback_depth).unwrap_or(u32::MAX),
+            select_callback: (context.schedule.is_some() || context.valve.is_some())
+                .then_some(select_frame as CDxvaSelectCallback),
+            scan_interval_seconds: scan_interval.map_or(0.0, |interval| interval.as_secs_f64()),
+            has_crop: crop.is_some(),
+            crop_x: crop.map_or(0.0, |roi| f64::from(roi.x)),
+            crop_y: crop.map_or(0.0, |roi| f64::from(roi.y)),
+            crop_width: crop.map_or(0.0, |roi| f64::from(roi.width)),
+            crop_height: crop.map_or(0.0, |roi| f64::from(roi.height)),
+            allocate_planes: Some(allocate_planes),
+            luma_only: settings.luma_only,
+            read_ahead: settings.read_ahead,
+            gate_callback: settings
+                .luma_gate
+                .is_some()
+                .then_some(gate_frame as CDxvaGateCallback),
+            gate_low: settings.luma_gate.map_or(0, |gate| gate.range().0),
+            gate_high: settings.luma_gate.map_or(0, |gate| gate.range().1),
+            scale_height: settings.scale_height,
+            drop_before_seconds: context.pending_drop.map_or(0.0, |drop_until| {
+                drop_until.bridge_seconds(&settings.timeline)
+            }),
+            seek_poll_interval: u32::try_from(context.sink.batch()).unwrap_or(u32::MAX),
+            start_seconds: start_point.map_or(-1.0, |point| point.pts.as_secs_f64()),
+            texture_output: settings.texture_output,
+            change_callback: settings
+                .change_detection
+                .is_some()
+                .then_some(change_frame as CDxvaChangeCallback),
+            prefetch_window: settings
+                .prefetch
+                .map_or(0, |prefetch| prefetch.window_bytes.get()),
+            prefetch_map: settings
+                .prefetch
+                .is_some_and(|prefetch| prefetch.memory_map),
         };
         let ok = unsafe {
             dxva_decode(
+                bridge.as_ptr(),
+                session,
                 c_path.as_ptr(),
                 has_start_frame,
                 start_frame,
+                &options,
                 handle_frame,
                 &mut context as *mut _ as *mut c_void,
                 poll_seek_requests,
@@ -167,6 +768,7 @@ mod platform {
             )
         };
         let bridge_error = take_bridge_string(error_ptr);
+        context.flush();
         if let Some(err) = context.take_seek_error() {
             return Err(err);
         }
@@ -182,10 +784,22 @@ mod platform {
                 return Err(DecoderError::backend_failure(BACKEND_NAME, message));
             }
         }
+        if let Some(dir) = settings.index_cache.as_deref()
+            && let Some(index) = context.recorder.take().and_then(IndexRecorder::finish)
+        {
+            // The cache only saves the next open a decode pass; failing to write it is not an error.
+            let _ = index.store(dir, &settings.path);
+        }
         Ok(())
     }
 
-    fn probe_video_metadata(path: &Path) -> DecoderResult<crate::core::VideoMetadata> {
+    fn probe_video_metadata(
+        context: &Arc<BridgeContext>,
+        lease: Option<AdapterLease>,
+        path: &Path,
+        read_ahead: u32,
+        prefetch: Option<crate::config::Prefetch>,
+    ) -> DecoderResult<(crate::core::VideoMetadata, Option<ProbedSession>)> {
         use crate::core::VideoMetadata;
 
         let c_path = cstring_from_path(path)?;
@@ -198,7 +812,24 @@ mod platform {
             height: 0,
             error: ptr::null_mut(),
         };
-        let ok = unsafe { dxva_probe_total_frames(c_path.as_ptr(), &mut result) };
+        let mut raw_session: *mut CDxvaSession = ptr::null_mut();
+        let ok = unsafe {
+            dxva_open(
+                context.as_ptr(),
+                c_path.as_ptr(),
+                read_ahead,
+                prefetch.map_or(0, |prefetch| prefetch.window_bytes.get()),
+                prefetch.is_some_and(|prefetch| prefetch.memory_map),
+                &mut result,
+                &mut raw_session,
+            )
+        };
+        // Wrap first so the reader is closed on the error paths below.
+        let session = (!raw_session.is_null()).then(|| ProbedSession {
+            raw: raw_session,
+            context: context.clone(),
+            lease,
+        });
         let bridge_error = take_bridge_string(result.error);
         if !ok {
             let message = bridge_error.unwrap_or_else(|| "probe failed".to_string());
@@ -227,7 +858,7 @@ mod platform {
             metadata.height = Some(result.height);
         }
 
-        Ok(metadata)
+        Ok((metadata, session))
     }
 
     fn cstring_from_path(path: &Path) -> DecoderResult<CString> {
@@ -246,38 +877,100 @@ mod platform {
     }
 
     struct DecodeContext {
-        tx: Sender<DecoderResult<VideoFrame>>,
+        sink: FrameSink,
         seek_rx: SeekReceiver,
         serial: Arc<AtomicU64>,
+        stats: Arc<DecoderStats>,
+        schedule: Option<SampleSchedule>,
+        observed: u64,
+        valve: Option<PressureValve>,
+        pool: FramePool,
+        staged_planes: Option<(Vec<u8>, Vec<u8>)>,
+        segments: Option<SegmentCursor>,
+        gate: Option<LumaGate>,
+        change: Option<ChangeDetection>,
+        /// Signature and frame of the last readback that went out; repeats are clones of the frame.
+        reference: Option<(BlockSignature, VideoFrame)>,
+        /// Signature of the frame being read back, adopted as the reference once it is sent.
+        candidate: Option<BlockSignature>,
         current_serial: u64,
         pending_drop: Option<DropUntil>,
         seek_error: Option<DecoderError>,
         closed: bool,
-        fps: Option<f64>,
+        timeline: Timeline,
+        recorder: Option<IndexRecorder>,
+        /// Adapter this reader decodes on; counts every sample the bridge hands over.
+        lease: Option<AdapterLease>,
     }
 
     impl DecodeContext {
         fn new(
-            tx: Sender<DecoderResult<VideoFrame>>,
+            sink: FrameSink,
             seek_rx: SeekReceiver,
             serial: Arc<AtomicU64>,
-            fps: Option<f64>,
+            stats: Arc<DecoderStats>,
+            schedule: Option<SampleSchedule>,
+            pool: FramePool,
+            timeline: Timeline,
         ) -> Self {
             let current_serial = serial.load(Ordering::SeqCst);
             Self {
-                tx,
+                sink,
                 seek_rx,
                 serial,
+                stats,
+                schedule,
+                observed: 0,
+                valve: None,
+                pool,
+                staged_planes: None,
+                segments: None,
+                gate: None,
+                change: None,
+                reference: None,
+                candidate: None,
                 current_serial,
                 pending_drop: None,
                 seek_error: None,
                 closed: false,
-                fps,
+                timeline,
+                recorder: None,
+                lease: None,
+            }
+        }
+
+        /// Restricts decoding to a worker's chunks, starting with an accurate drop up to the first one.
+        fn with_segments(mut self, segments: Option<SegmentCursor>) -> Self {
+            if let Some(cursor) = segments.as_ref() {
+                self.pending_drop = Some(DropUntil::Frame(cursor.first_frame()));
             }
+            self.segments = segments;
+            self
+        }
+
+        fn with_backpressure(mut self, policy: Backpressure) -> Self {
+            self.valve = PressureValve::new(policy);
+            self
+        }
+
+        fn with_gate(mut self, gate: Option<LumaGate>) -> Self {
+            self.gate = gate;
+            self
+        }
+
+        fn with_change_detection(mut self, change: Option<ChangeDetection>) -> Self {
+            self.change = change;
+            self
         }
 
         fn is_closed(&self) -> bool {
-            self.closed || self.tx.is_closed()
+            self.closed || self.sink.is_closed()
+        }
+
+        fn flush(&mut self) {
+            if !self.sink.flush() {
+                self.closed = true;
+            }
         }
 
         fn apply_drop(&mut self, drop_until: Option<DropUntil>) {
@@ -289,7 +982,10 @@ mod platform {
         }
 
         fn send_frame(&mut self, frame: VideoFrame) -> bool {
-            if self.tx.blocking_send(Ok(frame)).is_ok() {
+            let started = Instant::now();
+            let sent = self.sink.send(Ok(frame));
+            self.stats.record(DecodePhase::Deliver, started.elapsed());
+            if sent {
                 true
             } else {
                 self.closed = true;
@@ -298,10 +994,64 @@ mod platform {
         }
 
         fn send_error(&mut self, error: DecoderError) {
-            let _ = self.tx.blocking_send(Err(error));
+            self.sink.send(Err(error));
             self.closed = true;
         }
 
+        fn should_read_back(&mut self, pts: Option<Duration>) -> bool {
+            let Some(schedule) = self.schedule.as_mut() else {
+                return true;
+            };
+            // Without a timestamp the sampler falls back to its own frame count, which we cannot mirror.
+            if pts.is_none() {
+                return true;
+            }
+            self.observed = self.observed.saturating_add(1);
+            schedule.should_sample(pts, self.observed)
+        }
+
+        /// Whether a sample the schedule kept is read back under the backpressure policy; the ones
+        /// it drops are counted in the run's stats.
+        fn relieve(&mut self, pts: Option<Duration>) -> bool {
+            let Some(valve) = self.valve.as_mut() else {
+                return true;
+            };
+            let admitted = valve.admit(pts, self.sink.has_room());
+            if !admitted {
+                self.stats.record_dropped();
+            }
+            admitted
+        }
+
+        /// Adopts the buffers handed out by `allocate_planes` if the bridge filled them for this frame.
+        fn take_staged_planes(&mut self, frame: &CDxvaFrame) -> Option<(Vec<u8>, Vec<u8>)> {
+            let (mut y_plane, mut uv_plane) = self.staged_planes.take()?;
+            if y_plane.as_ptr() != frame.y_data
+                || uv_plane.as_ptr() != frame.uv_data
+                || frame.y_len > y_plane.capacity()
+                || frame.uv_len > uv_plane.capacity()
+            {
+                self.pool.release(y_plane);
+                self.pool.release(uv_plane);
+                return None;
+            }
+            // The bridge wrote every byte of both planes before invoking the frame callback.
+            unsafe {
+                y_plane.set_len(frame.y_len);
+                uv_plane.set_len(frame.uv_len);
+            }
+            Some((y_plane, uv_plane))
+        }
+
+        /// Hands buffers from `allocate_planes` that no frame adopted back to the pool.
+        fn recycle_staged_planes(&mut self) {
+            if let Some((y_plane, uv_plane)) = self.staged_planes.take() {
+                self.pool.release(y_plane);
+                self.pool.release(uv_plane);
+            }
+        }
+
+        /// Backstop for the bridge's own drop, which only sees sample timestamps.
         fn should_skip_frame(&mut self, index: u64, pts: Option<Duration>) -> bool {
             let Some(drop_until) = self.pending_drop else {
                 return false;
@@ -325,18 +1075,39 @@ mod platform {
         }
         let frame = unsafe { &*frame };
         let context = unsafe { &mut *(context as *mut DecodeContext) };
+        let sent = deliver_frame(context, frame);
+        // Skipped, gated and repeated frames, and failed ones, leave their staged planes unadopted.
+        context.recycle_staged_planes();
+        sent
+    }
+
+    fn deliver_frame(context: &mut DecodeContext, frame: &CDxvaFrame) -> bool {
         if context.is_closed() {
             return false;
         }
-        if frame.y_data.is_null() || frame.uv_data.is_null() {
+        let planes = !frame.gated && !frame.repeat && frame.texture.is_null();
+        if planes && (frame.y_data.is_null() || (frame.uv_data.is_null() && frame.uv_len > 0)) {
             context.send_error(DecoderError::backend_failure(
                 BACKEND_NAME,
                 "NV12 plane pointer is null",
             ));
             return false;
         }
-        let y_data = unsafe { slice::from_raw_parts(frame.y_data, frame.y_len) };
-        let uv_data = unsafe { slice::from_raw_parts(frame.uv_data, frame.uv_len) };
+        if let Some(lease) = context.lease.as_mut() {
+            lease.record_frame();
+        }
+        let stats = &context.stats;
+        stats.record_seconds(DecodePhase::Read, frame.read_seconds);
+        stats.record_seconds(DecodePhase::Copy, frame.copy_seconds);
+        stats.record_seconds(DecodePhase::Map, frame.readback_wait_seconds);
+        if planes {
+            stats.record_seconds(DecodePhase::Memcpy, frame.memcpy_seconds);
+        }
+        stats.record_prefetch(
+            frame.stream_bytes,
+            frame.prefetch_hits,
+            frame.prefetch_misses,
+        );
         let pts = if frame.pts_seconds.is_finite() && frame.pts_seconds >= 0.0 {
             Some(Duration::from_secs_f64(frame.pts_seconds))
         } else {
@@ -347,12 +1118,88 @@ mod platform {
         } else {
             None
         };
+        if let Some(recorder) = context.recorder.as_mut() {
+            recorder.record(pts, frame.keyframe);
+        }
         let index = pts
-            .and_then(|pts| index_from_pts(pts, context.fps))
+            .and_then(|pts| context.timeline.frame_at(pts))
             .or(Some(frame.index));
         if context.should_skip_frame(index.unwrap_or(frame.index), pts) {
             return true;
         }
+        if let Some(segments) = context.segments.as_mut()
+            && !segments.admit(index.unwrap_or(frame.index))
+        {
+            return true;
+        }
+        let crop = (frame.width != frame.source_width || frame.height != frame.source_height)
+            .then_some(FrameCrop {
+                x: frame.crop_x,
+                y: frame.crop_y,
+                width: frame.crop_width,
+                height: frame.crop_height,
+                source_width: frame.source_width,
+                source_height: frame.source_height,
+            });
+        if !frame.texture.is_null() {
+            return send_texture(context, frame, pts, dts, index, crop);
+        }
+        if frame.repeat {
+            // Unchanged since the last readback: its planes go out again under this frame's timing.
+            let Some((_, previous)) = context.reference.as_ref() else {
+                context.send_error(DecoderError::backend_failure(
+                    BACKEND_NAME,
+                    "repeated frame has no previous readback",
+                ));
+                return false;
+            };
+            let frame_value = previous
+                .clone()
+                .with_pts(pts)
+                .with_dts(dts)
+                .with_index(index)
+                .with_serial(context.current_serial)
+                .with_repeat(true);
+            return context.send_frame(frame_value);
+        }
+        if frame.gated {
+            // Rejected by the GPU gate: no pixels were read back, only the verdict travels on.
+            let verdict = GateVerdict {
+                passed: false,
+                score: frame.gate_score,
+            };
+            return match VideoFrame::from_detection(
+                frame.width,
+                frame.height,
+                pts,
+                dts,
+                verdict.into_detection(),
+            ) {
+                Ok(frame_value) => {
+                    let frame_value = frame_value
+                        .with_index(index)
+                        .with_crop(crop)
+                        .with_serial(context.current_serial);
+                    context.send_frame(frame_value)
+                }
+                Err(err) => {
+                    context.send_error(err);
+                    false
+                }
+            };
+        }
+        let (y_plane, uv_plane) = context.take_staged_planes(frame).unwrap_or_else(|| {
+            let y_data = unsafe { slice::from_raw_parts(frame.y_data, frame.y_len) };
+            let uv_data: &[u8] = if frame.uv_len == 0 {
+                &[]
+            } else {
+                unsafe { slice::from_raw_parts(frame.uv_data, frame.uv_len) }
+            };
+            (
+                context.pool.copy_from(y_data),
+                context.pool.copy_from(uv_data),
+            )
+        });
         match VideoFrame::from_nv12_owned(
             frame.width,
             frame.height,
@@ -360,22 +1207,157 @@ mod platform {
             frame.uv_stride,
             pts,
             dts,
-            y_data.to_vec(),
-            uv_data.to_vec(),
+            y_plane,
+            uv_plane,
         ) {
             Ok(frame_value) => {
                 let frame_value = frame_value
                     .with_index(index)
+                    .with_crop(crop)
+                    .with_plane_recycler(context.pool.recycler())
+                    .with_serial(context.current_serial);
+                if let Some(signature) = context.candidate.take() {
+                    context.reference = Some((signature, frame_value.clone()));
+                }
+                context.send_frame(frame_value)
+            }
+            Err(err) => {
+                context.send_error(err);
+                false
+            }
+        }
+    }
+
+    /// Wraps the bridge's shared texture in a native frame holding its own reference.
+    fn send_texture(
+        context: &mut DecodeContext,
+        frame: &CDxvaFrame,
+        pts: Option<Duration>,
+        dts: Option<Duration>,
+        index: Option<u64>,
+        crop: Option<FrameCrop>,
+    ) -> bool {
+        unsafe { dxva_texture_retain(frame.texture) };
+        let handle = Box::into_raw(Box::new(DxvaTexture {
+            shared_handle: frame.texture_handle,
+            id: frame.texture_id,
+            width: frame.width,
+            height: frame.height,
+            texture: frame.texture,
+        }));
+        // The constructor only fails before it takes ownership of the handle.
+        match VideoFrame::from_native_handle(
+            frame.width,
+            frame.height,
+            pts,
+            dts,
+            index,
+            BACKEND_NAME,
+            DXGI_FORMAT_NV12,
+            handle.cast(),
+            release_texture,
+        ) {
+            Ok(frame_value) => {
+                let frame_value = frame_value
+                    .with_crop(crop)
                     .with_serial(context.current_serial);
                 context.send_frame(frame_value)
             }
             Err(err) => {
+                unsafe { release_texture(handle.cast()) };
                 context.send_error(err);
                 false
             }
         }
     }
 
+    unsafe extern "C" fn allocate_planes(
+        context: *mut c_void,
+        y_len: usize,
+        uv_len: usize,
+        y_out: *mut *mut u8,
+        uv_out: *mut *mut u8,
+    ) -> bool {
+        if context.is_null() || y_out.is_null() || uv_out.is_null() {
+            return false;
+        }
+        let context = unsafe { &mut *(context as *mut DecodeContext) };
+        let mut y_plane = context.pool.acquire(y_len);
+        let mut uv_plane = context.pool.acquire(uv_len);
+        unsafe {
+            *y_out = y_plane.as_mut_ptr();
+            *uv_out = uv_plane.as_mut_ptr();
+        }
+        context.staged_planes = Some((y_plane, uv_plane));
+        true
+    }
+
+    unsafe extern "C" fn select_frame(context: *mut c_void, pts_seconds: f64, _index: u64) -> bool {
+        if context.is_null() {
+            return false;
+        }
+        let context = unsafe { &mut *(context as *mut DecodeContext) };
+        if context.is_closed() {
+            return false;
+        }
+        let pts = if pts_seconds.is_finite() && pts_seconds >= 0.0 {
+            Some(Duration::from_secs_f64(pts_seconds))
+        } else {
+            None
+        };
+        context.should_read_back(pts) && context.relieve(pts)
+    }
+
+    /// Decides from the GPU row counts whether a frame is worth reading back.
+    unsafe extern "C" fn gate_frame(
+        context: *mut c_void,
+        rows: *const u32,
+        row_count: u32,
+        row_width: u32,
+        out_score: *mut f32,
+    ) -> bool {
+        if context.is_null() || rows.is_null() {
+            return true;
+        }
+        let context = unsafe { &mut *(context as *mut DecodeContext) };
+        let Some(gate) = context.gate else {
+            return true;
+        };
+        let rows = unsafe { slice::from_raw_parts(rows, row_count as usize) };
+        let verdict = gate.evaluate(rows, row_width);
+        if !out_score.is_null() {
+            unsafe { *out_score = verdict.score };
+        }
+        verdict.passed
+    }
+
+    /// Decides from the GPU block sums whether a frame changed since the last readback that went out.
+    unsafe extern "C" fn change_frame(
+        context: *mut c_void,
+        sums: *const u32,
+        width: u32,
+        height: u32,
+    ) -> bool {
+        if context.is_null() || sums.is_null() {
+            return true;
+        }
+        let context = unsafe { &mut *(context as *mut DecodeContext) };
+        let Some(change) = context.change else {
+            return true;
+        };
+        let sums =
+            unsafe { slice::from_raw_parts(sums, BlockSignature::block_count(width, height)) };
+        let signature = BlockSignature::new(width, height, sums);
+        let changed = context
+            .reference
+            .as_ref()
+            .is_none_or(|(reference, _)| change.changed(reference, &signature));
+        // Frames handle_frame drops before sending never become the reference; the next readback
+        // overwrites their candidate.
+        context.candidate = changed.then_some(signature);
+        changed
+    }
+
     unsafe extern "C" fn poll_seek_requests(
         context: *mut c_void,
         out_request: *mut CDxvaSeekRequest,
@@ -387,14 +1369,40 @@ mod platform {
         if context.is_closed() {
             return SEEK_ACTION_STOP;
         }
+        // Segmented workers seek only between their own chunks; their controller refuses seeks.
+        if let Some(segments) = context.segments.as_mut() {
+            return match segments.step() {
+                SegmentStep::Continue => SEEK_ACTION_CONTINUE,
+                SegmentStep::Finish => SEEK_ACTION_STOP,
+                SegmentStep::Seek(frame) => {
+                    let info = SeekInfo::Frame {
+                        frame,
+                        mode: SeekMode::Accurate,
+                    };
+                    apply_seek_plan(context, info, out_request)
+                }
+            };
+        }
         if !context.seek_rx.has_changed().unwrap_or(false) {
             return SEEK_ACTION_CONTINUE;
         }
         let Some(info) = *context.seek_rx.borrow_and_update() else {
             return SEEK_ACTION_CONTINUE;
         };
+        // Frames batched before the seek still go out ahead of the ones after it.
+        context.flush();
+        context.recorder = None;
+        context.reference = None;
         context.current_serial = context.serial.load(Ordering::SeqCst);
-        match compute_seek_plan(info, context.fps) {
+        apply_seek_plan(context, info, out_request)
+    }
+
+    fn apply_seek_plan(
+        context: &mut DecodeContext,
+        info: SeekInfo,
+        out_request: *mut CDxvaSeekRequest,
+    ) -> i32 {
+        match compute_seek_plan(info, &context.timeline) {
             Ok(plan) => {
                 context.apply_drop(plan.drop_until);
                 if !out_request.is_null() {
@@ -415,95 +1423,64 @@ mod platform {
         Timestamp(Duration),
     }
 
+    impl DropUntil {
+        /// Timestamp before which the bridge releases samples unread. A frame target maps to the midpoint
+        /// before it, matching the rounding in `Timeline::frame_at`, so the bridge never drops a frame that
+        /// `should_skip_frame` would keep.
+        fn bridge_seconds(self, timeline: &Timeline) -> f64 {
+            match self {
+                DropUntil::Frame(target) => timeline
+                    .drop_before(target)
+                    .map_or(0.0, |pts| pts.as_secs_f64()),
+                DropUntil::Timestamp(target) => target.as_secs_f64(),
+            }
+        }
+    }
+
     #[derive(Clone, Copy)]
     struct SeekPlan {
         request: CDxvaSeekRequest,
         drop_until: Option<DropUntil>,
     }
 
-    fn compute_seek_plan(info: SeekInfo, fps: Option<f64>) -> DecoderResult<SeekPlan> {
-        match info {
+    fn compute_seek_plan(info: SeekInfo, timeline: &Timeline) -> DecoderResult<SeekPlan> {
+        let (frame, mode, accurate_drop) = match info {
             SeekInfo::Frame { frame, mode } => {
-                let fps = fps.ok_or_else(|| {
-                    DecoderError::configuration(
-                        "dxva backend requires frame rate metadata to seek by frame",
-                    )
-                })?;
-                if !(fps.is_finite() && fps > 0.0) {
+                if !timeline.is_known() {
                     return Err(DecoderError::configuration(
                         "dxva backend requires frame rate metadata to seek by frame",
                     ));
                 }
-                let seconds = frame as f64 / fps;
-                if !seconds.is_finite() || seconds.is_sign_negative() {
-                    return Err(DecoderError::configuration("invalid seek timestamp"));
-                }
-                Ok(SeekPlan {
-                    request: CDxvaSeekRequest {
-                        position_seconds: seconds,
-                        start_frame: frame,
-                    },
-                    drop_until: match mode {
-                        SeekMode::Fast => None,
-                        SeekMode::Accurate => Some(DropUntil::Frame(frame)),
-                    },
-                })
+                (frame, mode, DropUntil::Frame(frame))
             }
             SeekInfo::Time { position, mode } => {
-                let fps = fps.ok_or_else(|| {
-                    DecoderError::configuration(
-                        "dxva backend requires frame rate metadata to seek by time",
-                    )
-                })?;
-                if !(fps.is_finite() && fps > 0.0) {
+                if !timeline.is_known() {
                     return Err(DecoderError::configuration(
                         "dxva backend requires frame rate metadata to seek by time",
                     ));
                 }
-                let seconds = position.as_secs_f64();
-                if !seconds.is_finite() || seconds.is_sign_negative() {
-                    return Err(DecoderError::configuration("invalid seek timestamp"));
-                }
-                let raw_frame = seconds * fps;
-                if !raw_frame.is_finite() || raw_frame.is_sign_negative() {
-                    return Err(DecoderError::configuration("invalid seek timestamp"));
-                }
-                let frame = match mode {
-                    SeekMode::Fast => raw_frame.round(),
-                    SeekMode::Accurate => raw_frame.floor(),
-                };
-                if frame < 0.0 || frame > u64::MAX as f64 {
-                    return Err(DecoderError::configuration("seek frame is out of range"));
-                }
-                Ok(SeekPlan {
-                    request: CDxvaSeekRequest {
-                        position_seconds: seconds,
-                        start_frame: frame as u64,
-                    },
-                    drop_until: match mode {
-                        SeekMode::Fast => None,
-                        SeekMode::Accurate => Some(DropUntil::Timestamp(position)),
-                    },
-                })
+                let frame = timeline
+                    .frame_for_time(position, mode == SeekMode::Accurate)
+                    .ok_or_else(|| DecoderError::configuration("seek frame is out of range"))?;
+                (frame, mode, DropUntil::Timestamp(position))
             }
-        }
-    }
-
-    fn index_from_pts(pts: Duration, fps: Option<f64>) -> Option<u64> {
-        let fps = fps?;
-        if !(fps.is_finite() && fps > 0.0) {
-            return None;
-        }
-        let seconds = pts.as_secs_f64();
-        if !seconds.is_finite() || seconds.is_sign_negative() {
-            return None;
-        }
-        let index = (seconds * fps).round();
-        if index.is_finite() && index >= 0.0 && index <= u64::MAX as f64 {
-            Some(index as u64)
-        } else {
-            None
-        }
+        };
+        let point = timeline
+            .seek_point(frame)
+            .ok_or_else(|| DecoderError::configuration("invalid seek timestamp"))?;
+        let drop_until = match mode {
+            SeekMode::Fast => None,
+            SeekMode::Accurate => Some(accurate_drop),
+        };
+        Ok(SeekPlan {
+            request: CDxvaSeekRequest {
+                position_seconds: point.pts.as_secs_f64(),
+                start_frame: point.frame,
+                drop_before_seconds: drop_until
+                    .map_or(0.0, |drop_until| drop_until.bridge_seconds(timeline)),
+            },
+            drop_until,
+        })
     }
 }
 
@@ -532,6 +1509,16 @@ mod platform {
             Err(DecoderError::unsupported("dxva"))
         }
     }
+
+    pub fn adapter_loads() -> Vec<crate::AdapterLoad> {
+        Vec::new()
+    }
+
+    pub fn set_sessions_per_adapter(_limit: Option<std::num::NonZeroUsize>) {}
+
+    pub fn set_texture_adapter(_luid: Option<u64>) {}
 }
 
-pub use platform::DxvaProvider;
+#[cfg(all(target_os = "windows", feature = "backend-dxva"))]
+pub use platform::{DXGI_FORMAT_NV12, DxvaTexture};
+pub use platform::{DxvaProvider, adapter_loads, set_sessions_per_adapter, set_texture_adapter};
@@ -23,6 +23,7 @@ pub struct FFmpegProvider {
     metadata: crate::core::VideoMetadata,
     channel_capacity: usize,
     start_frame: Option<u64>,
+    luma_only: bool,
 }
 
 impl DecoderProvider for FFmpegProvider {
@@ -50,6 +51,7 @@ impl DecoderProvider for FFmpegProvider {
             metadata,
             channel_capacity: capacity,
             start_frame: config.start_frame,
+            luma_only: config.output_format == crate::config::OutputFormat::Luma,
         })
     }
 
@@ -61,6 +63,7 @@ impl DecoderProvider for FFmpegProvider {
         let provider = *self;
         let capacity = provider.channel_capacity;
         let start_frame = provider.start_frame;
+        let luma_only = provider.luma_only;
         let controller = DecoderController::new();
         let seek_rx = controller.seek_receiver();
         let serial = controller.serial_handle();
@@ -68,6 +71,7 @@ impl DecoderProvider for FFmpegProvider {
             if let Err(err) = decode_ffmpeg(
                 provider.input.clone(),
                 start_frame,
+                luma_only,
                 tx.clone(),
                 seek_rx,
                 serial,
@@ -88,6 +92,7 @@ struct DecodeState {
     scaler: Option<Scaler>,
     source_format: Option<Pixel>,
     converted: ffmpeg::util::frame::Video,
+    luma_only: bool,
 }
 
 #[derive(Clone, Copy)]
@@ -106,6 +111,7 @@ enum DrainOutcome {
 fn decode_ffmpeg(
     input: PathBuf,
     start_frame: Option<u64>,
+    luma_only: bool,
     tx: Sender<DecoderResult<VideoFrame>>,
     mut seek_rx: SeekReceiver,
     serial: Arc<AtomicU64>,
@@ -139,6 +145,7 @@ fn decode_ffmpeg(
         scaler: None,
         source_format: None,
         converted: ffmpeg::util::frame::Video::empty(),
+        luma_only,
     };
 
     if let Some(start_frame) = start_frame
@@ -275,7 +282,14 @@ fn drain_decoder(
                 }
 
                 ensure_scaler(state, decoded)?;
-                let frame = build_frame(&state.converted, pts, dts, frame_index, current_serial)?;
+                let frame = build_frame(
+                    &state.converted,
+                    state.luma_only,
+                    pts,
+                    dts,
+                    frame_index,
+                    current_serial,
+                )?;
                 unsafe { ffmpeg::ffi::av_frame_unref(decoded.as_mut_ptr()) };
                 if tx.blocking_send(Ok(frame)).is_err() {
                     return Ok(DrainOutcome::Closed);
@@ -333,6 +347,7 @@ fn ensure_scaler(
 
 fn build_frame(
     converted: &ffmpeg::util::frame::Video,
+    luma_only: bool,
     pts: Option<Duration>,
     dts: Option<Duration>,
     frame_index: Option<u64>,
@@ -343,6 +358,10 @@ fn build_frame(
     let y_stride = converted.stride(0);
     let uv_stride = converted.stride(1);
     let y_plane = copy_plane(converted.data(0), y_stride, height as usize, "Y")?;
+    if luma_only {
+        return VideoFrame::from_luma_owned(width, height, y_stride, pts, dts, y_plane)
+            .map(|frame| frame.with_serial(serial).with_index(frame_index));
+    }
     let uv_rows = (height as usize).div_ceil(2);
     let uv_plane = copy_plane(converted.data(1), uv_stride, uv_rows, "UV")?;
     VideoFrame::from_nv12_owned(
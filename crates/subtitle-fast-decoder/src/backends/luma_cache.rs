@@ -0,0 +1,309 @@
+use std::sync::Arc;
+use std::sync::atomic::{AtomicU64, Ordering};
+
+use futures_util::StreamExt;
+use futures_util::stream::unfold;
+use tokio::sync::mpsc::Sender;
+
+use crate::config::{Configuration, OutputFormat};
+use crate::core::{
+    DecoderController, DecoderError, DecoderProvider, DecoderResult, DynDecoderProvider,
+    FrameStream, SeekInfo, SeekReceiver, VideoFrame, VideoMetadata, spawn_stream_from_channel,
+};
+use crate::luma_cache::{LumaCache, LumaCacheWriter};
+
+const DEFAULT_CHANNEL_CAPACITY: usize = 8;
+
+/// Replays a recorded luma cache as the decoded stream.
+pub struct LumaCacheProvider {
+    cache: LumaCache,
+    channel_capacity: usize,
+    start_frame: u64,
+    luma_only: bool,
+}
+
+impl DecoderProvider for LumaCacheProvider {
+    fn new(config: &Configuration) -> DecoderResult<Self> {
+        let settings = config.luma_cache.as_ref().ok_or_else(|| {
+            DecoderError::configuration("luma-cache backend requires a luma cache configuration")
+        })?;
+        let input = config.input.as_deref().ok_or_else(|| {
+            DecoderError::configuration("luma-cache backend requires SUBFAST_INPUT to be set")
+        })?;
+        let cache = LumaCache::open(settings, input).ok_or_else(|| {
+            DecoderError::configuration(format!(
+                "no luma cache of '{}' covers the ROI at {} samples per second",
+                input.display(),
+                settings.samples_per_second
+            ))
+        })?;
+        Ok(Self {
+            cache,
+            channel_capacity: config
+                .channel_capacity
+                .map_or(DEFAULT_CHANNEL_CAPACITY, |n| n.get())
+                .max(1),
+            start_frame: config.start_frame.unwrap_or(0),
+            luma_only: config.output_format == OutputFormat::Luma,
+        })
+    }
+
+    fn metadata(&self) -> VideoMetadata {
+        self.cache.metadata()
+    }
+
+    fn open(self: Box<Self>) -> DecoderResult<(DecoderController, FrameStream)> {
+        let provider = *self;
+        let controller = DecoderController::new();
+        let seek_rx = controller.seek_receiver();
+        let serial = controller.serial_handle();
+        let stream = spawn_stream_from_channel(provider.channel_capacity, move |tx| {
+            provider.replay(tx, seek_rx, serial);
+        });
+        Ok((controller, stream))
+    }
+}
+
+impl LumaCacheProvider {
+    fn replay(
+        self,
+        tx: Sender<DecoderResult<VideoFrame>>,
+        mut seek_rx: SeekReceiver,
+        serial: Arc<AtomicU64>,
+    ) {
+        let cache = &self.cache;
+        let mut plane = cache.plane();
+        let mut scratch = Vec::new();
+        let mut previous: Option<VideoFrame> = None;
+        let mut current_serial = serial.load(Ordering::SeqCst);
+        // Entries between the keyframe decoded from and `target` only rebuild the plane.
+        let mut slot = cache.key_before(cache.slot_at_or_after(self.start_frame));
+        let mut target = cache.slot_at_or_after(self.start_frame);
+        while slot < cache.len() {
+            if seek_rx.has_changed().unwrap_or(false)
+                && let Some(info) = *seek_rx.borrow_and_update()
+            {
+                current_serial = serial.load(Ordering::SeqCst);
+                target = match info {
+                    SeekInfo::Frame { frame, .. } => cache.slot_at_or_after(frame),
+                    SeekInfo::Time { position, .. } => cache.slot_at_time(position),
+                };
+                slot = cache.key_before(target);
+                previous = None;
+            }
+            if tx.is_closed() {
+                break;
+            }
+            if cache.decode(slot, &mut plane, &mut scratch).is_none() {
+                let _ = tx.blocking_send(Err(DecoderError::backend_failure(
+                    "luma-cache",
+                    format!("cache entry {slot} is damaged"),
+                )));
+                break;
+            }
+            if slot >= target {
+                let Some(entry) = cache.entry(slot) else {
+                    break;
+                };
+                let frame = match previous.as_ref() {
+                    // Repeats share the planes of the frame before them, as DXVA change detection does.
+                    Some(previous) if cache.is_repeat(slot) => {
+                        Ok(previous.clone().with_repeat(true))
+                    }
+                    _ => self.frame(&plane),
+                }
+                .map(|frame| {
+                    frame
+                        .with_pts(Some(entry.pts))
+                        .with_index(Some(entry.index))
+                        .with_crop(Some(cache.crop()))
+                        .with_serial(current_serial)
+                });
+                previous = frame
+                    .as_ref()
+                    .ok()
+                    .map(|frame| frame.clone().with_repeat(false));
+                if tx.blocking_send(frame).is_err() {
+                    break;
+                }
+            }
+            slot += 1;
+        }
+    }
+
+    fn frame(&self, plane: &[u8]) -> DecoderResult<VideoFrame> {
+        let (width, height) = (self.cache.width(), self.cache.height());
+        let stride = width as usize;
+        if self.luma_only {
+            return VideoFrame::from_luma_owned(width, height, stride, None, None, plane.to_vec());
+        }
+        let uv_plane = vec![128u8; stride * (height as usize).div_ceil(2)];
+        VideoFrame::from_nv12_owned(
+            width,
+            height,
+            stride,
+            stride,
+            None,
+            None,
+            plane.to_vec(),
+            uv_plane,
+        )
+    }
+}
+
+/// Decodes with the configured backend and records the luma cache from its stream. The cache is
+/// stored when the stream ends, unless the recording was abandoned or the decode failed.
+pub struct RecordingProvider {
+    inner: DynDecoderProvider,
+    writer: Option<LumaCacheWriter>,
+}
+
+impl DecoderProvider for RecordingProvider {
+    fn new(config: &Configuration) -> DecoderResult<Self> {
+        let mut inner_config = config.clone();
+        inner_config.luma_cache = None;
+        let inner = inner_config.create_provider()?;
+        // A cache starts at the first frame; a run that skips ahead just decodes.
+        let writer = match (&config.luma_cache, config.input.as_deref()) {
+            (Some(settings), Some(input)) if config.start_frame.unwrap_or(0) == 0 => {
+                LumaCacheWriter::create(settings, input).ok()
+            }
+            _ => None,
+        };
+        Ok(Self { inner, writer })
+    }
+
+    fn metadata(&self) -> VideoMetadata {
+        self.inner.metadata()
+    }
+
+    fn open(self: Box<Self>) -> DecoderResult<(DecoderController, FrameStream)> {
+        let Self { inner, writer } = *self;
+        let metadata = inner.metadata();
+        let (controller, stream) = inner.open()?;
+        let Some(writer) = writer else {
+            return Ok((controller, stream));
+        };
+        let recorded = unfold(
+            (stream, Some(writer)),
+            move |(mut stream, mut writer)| async move {
+                let item = stream.next().await;
+                match &item {
+                    Some(Ok(frame)) => {
+                        if let Some(writer) = writer.as_mut() {
+                            writer.record(frame);
+                        }
+                    }
+                    // Dropping the writer discards the partial recording.
+                    Some(Err(_)) => writer = None,
+                    None => {
+                        if let Some(writer) = writer.take() {
+                            let _ = writer.finish(metadata);
+                        }
+                    }
+                }
+                item.map(|item| (item, (stream, writer)))
+            },
+        );
+        Ok((controller, Box::pin(recorded)))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use std::fs;
+    use std::num::NonZeroU32;
+    use std::path::{Path, PathBuf};
+    use std::time::Duration;
+
+    use super::*;
+    use crate::config::Backend;
+    use crate::core::{RoiConfig, SeekMode};
+    use crate::luma_cache::LumaCacheConfig;
+
+    fn config(dir: &Path, input: PathBuf, backend: Backend) -> Configuration {
+        Configuration {
+            backend,
+            input: Some(input),
+            output_format: OutputFormat::Luma,
+            luma_cache: Some(LumaCacheConfig {
+                dir: dir.join("cache"),
+                samples_per_second: NonZeroU32::new(10).unwrap(),
+                roi: RoiConfig {
+                    x: 0.0,
+                    y: 0.75,
+                    width: 1.0,
+                    height: 0.25,
+                },
+                compress: true,
+            }),
+            ..Configuration::default()
+        }
+    }
+
+    async fn collect(mut stream: FrameStream) -> Vec<VideoFrame> {
+        let mut frames = Vec::new();
+        while let Some(frame) = stream.next().await {
+            frames.push(frame.unwrap());
+        }
+        frames
+    }
+
+    #[tokio::test(flavor = "multi_thread")]
+    async fn replay_matches_the_recorded_decode() {
+        let dir = std::env::temp_dir().join(format!("subfast-luma-replay-{}", std::process::id()));
+        fs::create_dir_all(&dir).unwrap();
+        let input = dir.join("input.mp4");
+        fs::write(&input, b"video").unwrap();
+
+        // The mock backend only runs under GitHub CI, so record from it directly.
+        let recording = config(&dir, input.clone(), Backend::Mock);
+        let mock = crate::backends::mock::MockProvider::new(&recording).unwrap();
+        let provider = Box::new(RecordingProvider {
+            inner: Box::new(mock),
+            writer: LumaCacheWriter::create(recording.luma_cache.as_ref().unwrap(), &input).ok(),
+        });
+        let (_controller, stream) = provider.open().unwrap();
+        let decoded = collect(stream).await;
+
+        let replay = config(&dir, input.clone(), Backend::LumaCache);
+        let provider = Box::new(LumaCacheProvider::new(&replay).unwrap()) as DynDecoderProvider;
+        assert_eq!(provider.metadata().total_frames, Some(120));
+        let (controller, stream) = provider.open().unwrap();
+        let replayed = collect(stream).await;
+
+        // 120 mock frames 16ms apart cover two seconds at ten samples each.
+        assert_eq!(replayed.len(), 20);
+        for frame in &replayed {
+            let index = frame.index().unwrap();
+            let source = &decoded[index as usize];
+            assert_eq!(frame.pts(), source.pts());
+            assert_eq!((frame.width(), frame.height()), (640, 90));
+            assert_eq!(frame.y_plane(), &source.y_plane()[270 * 640..]);
+            assert_eq!(frame.crop().unwrap().y, 270);
+        }
+        drop(controller);
+
+        let provider = Box::new(LumaCacheProvider::new(&replay).unwrap()) as DynDecoderProvider;
+        let (controller, mut stream) = provider.open().unwrap();
+        let _ = stream.next().await.unwrap().unwrap();
+        let serial = controller
+            .seek(SeekInfo::Frame {
+                frame: 60,
+                mode: SeekMode::Accurate,
+            })
+            .unwrap();
+        let sought = loop {
+            let frame = stream.next().await.unwrap().unwrap();
+            if frame.serial() == serial {
+                break frame;
+            }
+        };
+        assert!(sought.index().unwrap() >= 60);
+        assert!(sought.pts().unwrap() >= Duration::from_millis(960));
+        let source = &decoded[sought.index().unwrap() as usize];
+        assert_eq!(sought.y_plane(), &source.y_plane()[270 * 640..]);
+
+        fs::remove_dir_all(&dir).unwrap();
+    }
+}
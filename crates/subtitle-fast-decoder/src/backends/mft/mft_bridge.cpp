@@ -6,6 +6,8 @@
 
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#include <d3d11.h>
+#include <d3d11_4.h>
 #include <mfapi.h>
 #include <mfidl.h>
 #include <mfobjects.h>
@@ -15,12 +17,21 @@
 #include <combaseapi.h>
 #include <wrl/client.h>
 
+#include "../dxgi_adapters.h"
+#include "../prefetch_stream.h"
+#include "../stream_copy.h"
+
 #include <cmath>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdio>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <cstring>
+#include <deque>
 #include <string>
+#include <vector>
 
 namespace
 {
@@ -113,6 +124,326 @@ namespace
         std::string error() const { return hresult("MFStartup", result); }
     };
 
+    // D3D11 device hardware MFTs decode on, created once; without one the readers stay in software.
+    struct HardwareDevice
+    {
+        std::mutex mutex;
+        // DXGI adapter to create the device on; negative lets D3D pick the default hardware adapter.
+        int adapter_ordinal = -1;
+        bool attempted = false;
+        ComPtr<ID3D11Device> device;
+        ComPtr<IMFDXGIDeviceManager> manager;
+        UINT reset_token = 0;
+
+        ComPtr<IMFDXGIDeviceManager> acquire()
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (attempted) { return manager; }
+            attempted = true;
+
+            const D3D_FEATURE_LEVEL levels[] = {
+                D3D_FEATURE_LEVEL_11_1,
+                D3D_FEATURE_LEVEL_11_0,
+                D3D_FEATURE_LEVEL_10_1,
+                D3D_FEATURE_LEVEL_10_0,
+                D3D_FEATURE_LEVEL_9_3,
+            };
+            ComPtr<IDXGIAdapter1> adapter;
+            if (adapter_ordinal >= 0)
+            {
+                std::vector<dxgi_adapters::AdapterCandidate> candidates;
+                bool vendor_matched = false;
+                std::string ignored;
+                if (!dxgi_adapters::enumerate_adapters(candidates, vendor_matched, ignored)) { return {}; }
+                for (const dxgi_adapters::AdapterCandidate &candidate : candidates)
+                {
+                    if (candidate.ordinal == static_cast<UINT>(adapter_ordinal)) { adapter = candidate.adapter; }
+                }
+                if (!adapter) { return {}; }
+            }
+            const D3D_DRIVER_TYPE driver = adapter ? D3D_DRIVER_TYPE_UNKNOWN : D3D_DRIVER_TYPE_HARDWARE;
+            ComPtr<ID3D11Device> created;
+            HRESULT hr = D3D11CreateDevice(
+                adapter.Get(),
+                driver,
+                nullptr,
+                D3D11_CREATE_DEVICE_VIDEO_SUPPORT,
+                levels,
+                ARRAYSIZE(levels),
+                D3D11_SDK_VERSION,
+                &created,
+                nullptr,
+                nullptr);
+            if (hr == E_INVALIDARG)
+            {
+                // 11_1 is unknown to the Windows 7 runtime.
+                hr = D3D11CreateDevice(adapter.Get(), driver, nullptr, D3D11_CREATE_DEVICE_VIDEO_SUPPORT,
+                                       levels + 1, ARRAYSIZE(levels) - 1, D3D11_SDK_VERSION, &created, nullptr, nullptr);
+            }
+            if (FAILED(hr)) { return {}; }
+
+            ComPtr<IMFDXGIDeviceManager> created_manager;
+            if (FAILED(MFCreateDXGIDeviceManager(&reset_token, &created_manager))) { return {}; }
+            if (FAILED(created_manager->ResetDevice(created.Get(), reset_token))) { return {}; }
+
+            #if defined(__ID3D11Multithread_INTERFACE_DEFINED__)
+            ComPtr<ID3D11Multithread> multithread;
+            if (SUCCEEDED(created.As(&multithread)) && multithread)
+            {
+                multithread->SetMultithreadProtected(TRUE);
+            }
+            #endif
+            device = created;
+            manager = created_manager;
+            return manager;
+        }
+    };
+
+    // MF runtime shared by every probe and decode that is handed the same context.
+    struct BridgeRuntime
+    {
+        ScopedMediaFoundation media_foundation;
+        // Declared after media_foundation so the device is released before MFShutdown.
+        HardwareDevice hardware;
+    };
+
+    // Starts a call-local MF runtime unless a shared one is given.
+    bool acquire_runtime(BridgeRuntime *shared, std::unique_ptr<BridgeRuntime> &local, std::string &error)
+    {
+        if (shared)
+        {
+            return true;
+        }
+        local = std::make_unique<BridgeRuntime>();
+        if (!local->media_foundation.ok())
+        {
+            error = local->media_foundation.error();
+            return false;
+        }
+        return true;
+    }
+
+    // Keeps the process MTA alive while a reader outlives the thread that opened it. The entry points
+    // are resolved at runtime because they only exist on Windows 8 and later.
+    struct MtaUsage
+    {
+        void *cookie = nullptr;
+
+        MtaUsage()
+        {
+            using Increment = HRESULT(WINAPI *)(void **);
+            HMODULE ole = GetModuleHandleW(L"ole32.dll");
+            auto increment = ole ? reinterpret_cast<Increment>(GetProcAddress(ole, "CoIncrementMTAUsage")) : nullptr;
+            if (!increment || FAILED(increment(&cookie))) { cookie = nullptr; }
+        }
+
+        ~MtaUsage()
+        {
+            if (!cookie) { return; }
+            using Decrement = HRESULT(WINAPI *)(void *);
+            HMODULE ole = GetModuleHandleW(L"ole32.dll");
+            auto decrement = ole ? reinterpret_cast<Decrement>(GetProcAddress(ole, "CoDecrementMTAUsage")) : nullptr;
+            if (decrement) { decrement(cookie); }
+        }
+
+        MtaUsage(const MtaUsage &) = delete;
+        MtaUsage &operator=(const MtaUsage &) = delete;
+
+        bool held() const { return cookie != nullptr; }
+    };
+
+    // IMFSourceReaderCallback that turns the async reader back into a blocking `read`. Up to `depth`
+    // ReadSample requests stay outstanding, so demux and decode of later frames overlap the copy and
+    // delivery of the current one.
+    class AsyncReadQueue final : public IMFSourceReaderCallback
+    {
+    public:
+        explicit AsyncReadQueue(uint32_t depth) : depth_(depth > 0 ? depth : 1) {}
+
+        STDMETHODIMP QueryInterface(REFIID iid, void **out) override
+        {
+            if (!out) { return E_POINTER; }
+            if (iid == __uuidof(IUnknown) || iid == __uuidof(IMFSourceReaderCallback))
+            {
+                *out = static_cast<IMFSourceReaderCallback *>(this);
+                AddRef();
+                return S_OK;
+            }
+            *out = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        STDMETHODIMP_(ULONG) AddRef() override { return InterlockedIncrement(&refs_); }
+
+        STDMETHODIMP_(ULONG) Release() override
+        {
+            ULONG count = InterlockedDecrement(&refs_);
+            if (count == 0) { delete this; }
+            return count;
+        }
+
+        STDMETHODIMP OnReadSample(HRESULT status, DWORD, DWORD flags, LONGLONG timestamp, IMFSample *sample) override
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (outstanding_ > 0) { --outstanding_; }
+            if (!flushing_)
+            {
+                results_.push_back(Result{status, flags, timestamp, sample});
+            }
+            ready_.notify_all();
+            return S_OK;
+        }
+
+        STDMETHODIMP OnFlush(DWORD) override
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            flushing_ = false;
+            ready_.notify_all();
+            return S_OK;
+        }
+
+        STDMETHODIMP OnEvent(DWORD, IMFMediaEvent *) override { return S_OK; }
+
+        // Returns the next sample in stream order and tops the outstanding requests back up before the
+        // caller starts working on it.
+        HRESULT read(IMFSourceReader *reader, DWORD &flags, LONGLONG &timestamp, ComPtr<IMFSample> &sample)
+        {
+            HRESULT hr = request(reader);
+            if (FAILED(hr)) { return hr; }
+
+            Result result{};
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [&] { return !results_.empty() || outstanding_ == 0; });
+                if (results_.empty())
+                {
+                    // Nothing in flight and nothing queued: the stream already ended.
+                    flags = MF_SOURCE_READERF_ENDOFSTREAM;
+                    timestamp = 0;
+                    sample.Reset();
+                    return S_OK;
+                }
+                result = std::move(results_.front());
+                results_.pop_front();
+                if (FAILED(result.status) || (result.flags & MF_SOURCE_READERF_ENDOFSTREAM)) { ended_ = true; }
+            }
+
+            flags = result.flags;
+            timestamp = result.timestamp;
+            sample = std::move(result.sample);
+            if (FAILED(result.status)) { return result.status; }
+            return request(reader);
+        }
+
+        // Drops queued samples and cancels outstanding requests, returning once the reader confirms the flush.
+        HRESULT flush(IMFSourceReader *reader)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                flushing_ = true;
+                results_.clear();
+            }
+            HRESULT hr = reader->Flush(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM));
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (SUCCEEDED(hr)) { ready_.wait(lock, [&] { return !flushing_; }); }
+            flushing_ = false;
+            results_.clear();
+            outstanding_ = 0;
+            ended_ = false;
+            return hr;
+        }
+
+    private:
+        struct Result
+        {
+            HRESULT status = S_OK;
+            DWORD flags = 0;
+            LONGLONG timestamp = 0;
+            ComPtr<IMFSample> sample;
+        };
+
+        HRESULT request(IMFSourceReader *reader)
+        {
+            uint32_t needed = 0;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (ended_) { return S_OK; }
+                const size_t queued = results_.size() + outstanding_;
+                needed = queued < depth_ ? static_cast<uint32_t>(depth_ - queued) : 0;
+                outstanding_ += needed;
+            }
+            // Issued without the lock: the reader may complete a request on this thread.
+            for (uint32_t i = 0; i < needed; ++i)
+            {
+                HRESULT hr = reader->ReadSample(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), 0, nullptr, nullptr, nullptr, nullptr);
+                if (FAILED(hr))
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    const uint32_t unissued = needed - i;
+                    outstanding_ = outstanding_ > unissued ? outstanding_ - unissued : 0;
+                    return hr;
+                }
+            }
+            return S_OK;
+        }
+
+        ~AsyncReadQueue() = default;
+
+        volatile ULONG refs_ = 1;
+        const uint32_t depth_;
+        std::mutex mutex_;
+        std::condition_variable ready_;
+        std::deque<Result> results_;
+        uint32_t outstanding_ = 0;
+        bool flushing_ = false;
+        bool ended_ = false;
+    };
+
+    double qpc_seconds()
+    {
+        static const double frequency = []
+        {
+            LARGE_INTEGER value{};
+            QueryPerformanceFrequency(&value);
+            return static_cast<double>(value.QuadPart);
+        }();
+        LARGE_INTEGER now{};
+        QueryPerformanceCounter(&now);
+        return static_cast<double>(now.QuadPart) / frequency;
+    }
+
+    bool is_clean_point(IMFSample *sample)
+    {
+        UINT32 clean_point = 0;
+        return SUCCEEDED(sample->GetUINT32(MFSampleExtension_CleanPoint, &clean_point)) && clean_point != 0;
+    }
+
+    // Synchronous ReadSample unless the reader was opened with an AsyncReadQueue.
+    HRESULT read_sample(IMFSourceReader *reader, AsyncReadQueue *queue, DWORD &flags, LONGLONG &timestamp, ComPtr<IMFSample> &sample)
+    {
+        if (queue) { return queue->read(reader, flags, timestamp, sample); }
+        DWORD stream_index = 0;
+        return reader->ReadSample(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), 0, &stream_index, &flags, &timestamp, &sample);
+    }
+
+    HRESULT flush_reader(IMFSourceReader *reader, AsyncReadQueue *queue)
+    {
+        if (queue) { return queue->flush(reader); }
+        return reader->Flush(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM));
+    }
+
+    // Reader opened by a probe and kept, already negotiated, for the decode that follows.
+    struct ReaderSession
+    {
+        MtaUsage mta;
+        std::unique_ptr<BridgeRuntime> local_runtime;
+        ComPtr<IMFSourceReader> reader;
+        ComPtr<AsyncReadQueue> queue;
+        ComPtr<prefetch_stream::PrefetchStream> stream;
+        UINT32 width = 0;
+        UINT32 height = 0;
+    };
+
     std::wstring utf8_to_wide(const char *utf8, std::string &error)
     {
         if (!utf8) { error = "input path is null"; return {}; }
@@ -150,6 +481,24 @@ namespace
         {
             buffer = source_buffer;
             if (!buffer) { return E_POINTER; }
+
+            // Lock2DSize reports the real extent of the surface, so a multi-plane or GPU-backed buffer can be
+            // read in place instead of being flattened by ConvertToContiguousBuffer first.
+            ComPtr<IMF2DBuffer2> sized;
+            if (SUCCEEDED(buffer.As(&sized)) && sized)
+            {
+                BYTE *buffer_start = nullptr;
+                DWORD buffer_length = 0;
+                if (SUCCEEDED(sized->Lock2DSize(MF2DBuffer_LockFlags_Read, &data, &stride, &buffer_start, &buffer_length)))
+                {
+                    buffer2d = sized;
+                    size_t offset = data >= buffer_start ? static_cast<size_t>(data - buffer_start) : 0;
+                    contiguous_length = offset < buffer_length ? buffer_length - static_cast<DWORD>(offset) : 0;
+                    return S_OK;
+                }
+                data = nullptr;
+            }
+
             HRESULT hr = buffer.As(&buffer2d);
             if (SUCCEEDED(hr) && buffer2d && SUCCEEDED(buffer2d->Lock2D(&data, &stride)))
             {
@@ -205,16 +554,53 @@ namespace
         return S_OK;
     }
 
-    ComPtr<IMFSourceReader> open_reader(const std::wstring &wide_path, bool enable_video_processing, UINT32 *out_width, UINT32 *out_height, std::string &error)
+    // Attributes that keep async mode when the full set is rejected; null for a synchronous reader.
+    ComPtr<IMFAttributes> async_only_attributes(IMFSourceReaderCallback *async_callback)
+    {
+        ComPtr<IMFAttributes> attributes;
+        if (async_callback && SUCCEEDED(MFCreateAttributes(&attributes, 1)))
+        {
+            attributes->SetUnknown(MF_SOURCE_READER_ASYNC_CALLBACK, async_callback);
+        }
+        return attributes;
+    }
+
+    // Leaves `stream` null, so readers open the path themselves, unless `window` is set.
+    bool open_prefetch(const std::wstring &wide_path, uint32_t window, bool memory_map, ComPtr<prefetch_stream::PrefetchStream> &stream, std::string &error)
+    {
+        if (window == 0) { return true; }
+        HRESULT hr = prefetch_stream::PrefetchStream::open(wide_path, window, memory_map, stream);
+        if (FAILED(hr)) { error = hresult("PrefetchStream::open", hr); return false; }
+        return true;
+    }
+
+    // Each of open_best's attempts demuxes `stream` from the start.
+    HRESULT create_source_reader(const std::wstring &wide_path, IMFByteStream *stream, IMFAttributes *attributes, IMFSourceReader **reader)
+    {
+        if (!stream) { return MFCreateSourceReaderFromURL(wide_path.c_str(), attributes, reader); }
+        stream->SetCurrentPosition(0);
+        return MFCreateSourceReaderFromByteStream(stream, attributes, reader);
+    }
+
+    // A non-null `device_manager` lets the reader load hardware decoders; their output is still read back through
+    // the sample buffers, so the rest of the bridge does not care which decoder ran.
+    ComPtr<IMFSourceReader> open_reader(const std::wstring &wide_path, IMFByteStream *stream, IMFDXGIDeviceManager *device_manager, bool enable_video_processing, const GUID &subtype, IMFSourceReaderCallback *async_callback, UINT32 *out_width, UINT32 *out_height, std::string &error)
     {
         ComPtr<IMFAttributes> attributes;
-        if (enable_video_processing && FAILED(MFCreateAttributes(&attributes, 1))) { attributes.Reset(); }
-        if (attributes) { attributes->SetUINT32(MF_SOURCE_READER_ENABLE_VIDEO_PROCESSING, TRUE); }
+        if ((enable_video_processing || async_callback || device_manager) && FAILED(MFCreateAttributes(&attributes, 4))) { attributes.Reset(); }
+        if (attributes && enable_video_processing) { attributes->SetUINT32(MF_SOURCE_READER_ENABLE_VIDEO_PROCESSING, TRUE); }
+        if (attributes && async_callback) { attributes->SetUnknown(MF_SOURCE_READER_ASYNC_CALLBACK, async_callback); }
+        if (attributes && device_manager)
+        {
+            attributes->SetUINT32(MF_READWRITE_ENABLE_HARDWARE_TRANSFORMS, TRUE);
+            attributes->SetUnknown(MF_SOURCE_READER_D3D_MANAGER, device_manager);
+        }
 
         ComPtr<IMFSourceReader> reader;
-        HRESULT hr = MFCreateSourceReaderFromURL(wide_path.c_str(), attributes.Get(), &reader);
-        if (FAILED(hr) && hr == E_INVALIDARG) { hr = MFCreateSourceReaderFromURL(wide_path.c_str(), nullptr, &reader); }
-        if (FAILED(hr)) { error = hresult("MFCreateSourceReaderFromURL", hr); return {}; }
+        HRESULT hr = create_source_reader(wide_path, stream, attributes.Get(), &reader);
+        // A rejected hardware set falls through to open_best's software attempts instead.
+        if (FAILED(hr) && hr == E_INVALIDARG && !device_manager) { hr = create_source_reader(wide_path, stream, async_only_attributes(async_callback).Get(), &reader); }
+        if (FAILED(hr)) { error = hresult(stream ? "MFCreateSourceReaderFromByteStream" : "MFCreateSourceReaderFromURL", hr); return {}; }
 
         hr = reader->SetStreamSelection(static_cast<DWORD>(MF_SOURCE_READER_ALL_STREAMS), FALSE);
         if (FAILED(hr)) { error = hresult("SetStreamSelection", hr); return {}; }
@@ -222,7 +608,7 @@ namespace
         if (FAILED(hr)) { error = hresult("SetStreamSelection(video)", hr); return {}; }
 
         std::string format_error;
-        if (FAILED(set_format(reader.Get(), MFVideoFormat_NV12, out_width, out_height, format_error)))
+        if (FAILED(set_format(reader.Get(), subtype, out_width, out_height, format_error)))
         {
             error = std::move(format_error);
             reader.Reset();
@@ -230,10 +616,139 @@ namespace
         return reader;
     }
 
-    ComPtr<IMFSourceReader> open_best(const std::wstring &path, UINT32 *w, UINT32 *h, std::string &error)
+    // Subtype the reader currently delivers; GUID_NULL when it cannot be queried.
+    GUID output_subtype(IMFSourceReader *reader)
+    {
+        GUID subtype = GUID_NULL;
+        ComPtr<IMFMediaType> current;
+        if (SUCCEEDED(reader->GetCurrentMediaType(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), &current)))
+        {
+            current->GetGUID(MF_MT_SUBTYPE, &subtype);
+        }
+        return subtype;
+    }
+
+    // NV12 straight from the decoder, then P010 straight from it (10-bit streams; narrowed during the readback
+    // copy), then NV12 through the reader's video processor.
+    ComPtr<IMFSourceReader> open_native_first(const std::wstring &path, IMFByteStream *stream, IMFDXGIDeviceManager *device_manager, IMFSourceReaderCallback *async_callback, UINT32 *w, UINT32 *h, std::string &error)
+    {
+        std::string native_error;
+        ComPtr<IMFSourceReader> reader = open_reader(path, stream, device_manager, false, MFVideoFormat_NV12, async_callback, w, h, native_error);
+        if (!reader) { reader = open_reader(path, stream, device_manager, false, MFVideoFormat_P010, async_callback, w, h, native_error); }
+        return reader ? reader : open_reader(path, stream, device_manager, true, MFVideoFormat_NV12, async_callback, w, h, error);
+    }
+
+    // Hardware first when the runtime has a device, then the software reader.
+    ComPtr<IMFSourceReader> open_best(const std::wstring &path, IMFByteStream *stream, BridgeRuntime &runtime, IMFSourceReaderCallback *async_callback, UINT32 *w, UINT32 *h, std::string &error)
+    {
+        ComPtr<IMFDXGIDeviceManager> manager = runtime.hardware.acquire();
+        if (manager)
+        {
+            std::string hardware_error;
+            ComPtr<IMFSourceReader> reader = open_native_first(path, stream, manager.Get(), async_callback, w, h, hardware_error);
+            if (reader) { return reader; }
+        }
+        return open_native_first(path, stream, nullptr, async_callback, w, h, error);
+    }
+
+    // Run-up after an accurate seek: samples stamped before `until` are released without touching their pixels.
+    // The first sample at or past it (or without a timestamp) disarms the drop.
+    struct DropUntil
+    {
+        LONGLONG until = -1;
+
+        void arm(double seconds)
+        {
+            until = std::isfinite(seconds) && seconds > 0.0 ? static_cast<LONGLONG>(std::floor(seconds * 10000000.0)) : -1;
+        }
+
+        bool drop(LONGLONG timestamp)
+        {
+            if (until < 0) { return false; }
+            if (timestamp >= 0 && timestamp < until) { return true; }
+            until = -1;
+            return false;
+        }
+    };
+
+    // Keyframe scan: after each emitted frame the reader jumps `interval` ahead. Media Foundation lands on the
+    // keyframe at or before the target, which is emitted if it is newer than the last one; when the GOP is longer
+    // than the interval the landing repeats, so the target moves further out until the next keyframe is reached.
+    struct KeyframeScan
+    {
+        LONGLONG interval = 0;
+        LONGLONG target = 0;
+        LONGLONG last_emitted = -1;
+        bool seek_pending = false;
+        bool landed = true;
+
+        explicit KeyframeScan(double interval_seconds)
+            : interval(std::isfinite(interval_seconds) && interval_seconds > 0.0
+                           ? static_cast<LONGLONG>(std::llround(interval_seconds * 10000000.0))
+                           : 0)
+        {
+        }
+
+        bool enabled() const { return interval > 0; }
+
+        void restart(LONGLONG position)
+        {
+            target = position;
+            last_emitted = -1;
+            seek_pending = false;
+            landed = true;
+        }
+
+        bool accept(LONGLONG timestamp)
+        {
+            const bool first_after_seek = landed;
+            landed = false;
+            if (timestamp < 0) { return true; }
+            if (timestamp <= last_emitted)
+            {
+                if (first_after_seek)
+                {
+                    target += interval;
+                    seek_pending = true;
+                }
+                return false;
+            }
+            if (!first_after_seek && timestamp < target) { return false; }
+            last_emitted = timestamp;
+            target = timestamp + interval;
+            seek_pending = true;
+            return true;
+        }
+
+        bool take_seek()
+        {
+            if (!seek_pending) { return false; }
+            seek_pending = false;
+            landed = true;
+            return true;
+        }
+    };
+
+    HRESULT seek_reader(IMFSourceReader *reader, AsyncReadQueue *queue, LONGLONG position_value)
+    {
+        HRESULT hr = flush_reader(reader, queue);
+        if (FAILED(hr)) { return hr; }
+        PROPVARIANT position;
+        PropVariantInit(&position);
+        position.vt = VT_I8;
+        position.hVal.QuadPart = position_value;
+        hr = reader->SetCurrentPosition(GUID_NULL, position);
+        PropVariantClear(&position);
+        return hr;
+    }
+
+    uint64_t frame_index_at(LONGLONG timestamp, UINT32 frame_rate_num, UINT32 frame_rate_den, uint64_t fallback)
     {
-        ComPtr<IMFSourceReader> reader = open_reader(path, true, w, h, error);
-        return reader ? reader : open_reader(path, false, w, h, error);
+        if (timestamp < 0 || frame_rate_num == 0 || frame_rate_den == 0) { return fallback; }
+        long double seconds = static_cast<long double>(timestamp) / 10000000.0L;
+        long double frames = seconds * frame_rate_num / frame_rate_den;
+        if (!std::isfinite(frames) || frames < 0.0L) { return fallback; }
+        return static_cast<uint64_t>(std::llround(frames));
     }
 
 } // namespace
@@ -265,19 +780,142 @@ extern "C"
         double pts_seconds;
         double dts_seconds;
         uint64_t index;
+        // Per-stage timings. read_seconds includes reads of samples skipped before this one;
+        // lock_seconds covers fetching the sample buffer plus the buffer lock.
+        double read_seconds;
+        double lock_seconds;
+        // The sample carried MFSampleExtension_CleanPoint.
+        bool keyframe;
+        // Prefetch stream activity since the previous frame: bytes read from the file, and demuxer reads served
+        // from the read-ahead (hits) or left waiting on the file (misses). Zero without a prefetch stream.
+        uint64_t stream_bytes;
+        uint64_t prefetch_hits;
+        uint64_t prefetch_misses;
     };
 
     typedef bool(__cdecl *CMftFrameCallback)(const CMftFrame *, void *);
+    typedef bool(__cdecl *CMftSelectCallback)(void *, double, uint64_t);
+
+    struct CMftDecodeOptions
+    {
+        // Optional; asked before each readback by the sampler and the backpressure policy.
+        // Returning false releases the sample without locking or copying its buffer.
+        CMftSelectCallback select_callback;
+        // Seconds between emitted frames in keyframe scan mode; 0 decodes every frame.
+        double scan_interval_seconds;
+        // Hand over only the Y plane; frames arrive with a null, zero-length UV plane.
+        bool luma_only;
+        // ReadSample requests kept in flight by an async reader; 0 reads synchronously.
+        uint32_t read_ahead;
+        // Like CMftSeekRequest::drop_before_seconds, for the run-up to `start_frame`.
+        double drop_before_seconds;
+        // Samples read between calls to the seek callback; batched delivery polls once per batch. 0 polls every sample.
+        uint32_t seek_poll_interval;
+        // Exact position of `start_frame` when the caller has a frame index; negative derives it from MF_MT_FRAME_RATE.
+        double start_seconds;
+        // Demux through a PrefetchStream reading this many bytes ahead instead of the system file stream; 0 keeps
+        // the latter. prefetch_map reads local files from a mapped view instead.
+        uint32_t prefetch_window;
+        bool prefetch_map;
+    };
+
     struct CMftSeekRequest
     {
         double position_seconds;
         uint64_t start_frame;
+        // Samples stamped before this are dropped in the bridge; 0 keeps everything after the seek.
+        double drop_before_seconds;
     };
 
     typedef int(__cdecl *CMftSeekCallback)(void *, CMftSeekRequest *);
 
-    bool mft_probe_total_frames(const char *path, CMftProbeResult *result)
+    typedef struct CMftContext CMftContext;
+
+    struct CMftAdapterInfo
     {
+        uint32_t ordinal;
+        uint32_t vendor_id;
+        uint32_t device_id;
+        uint64_t dedicated_video_memory;
+        char *description;
+        uint64_t luid;
+    };
+
+    // Same contract as dxva_enumerate_adapters: fills up to `capacity` entries and reports the total in
+    // `out_count`. Descriptions are CoTaskMem strings for the caller to free.
+    bool mft_enumerate_adapters(CMftAdapterInfo *out, uint32_t capacity, uint32_t *out_count, char **out_error)
+    {
+        if (out_error) { *out_error = nullptr; }
+        if (out_count) { *out_count = 0; }
+        std::vector<dxgi_adapters::AdapterCandidate> candidates;
+        bool vendor_matched = false;
+        std::string error;
+        if (!dxgi_adapters::enumerate_adapters(candidates, vendor_matched, error))
+        {
+            set_error(out_error, error);
+            return false;
+        }
+        for (size_t index = 0; out && index < candidates.size() && index < capacity; ++index)
+        {
+            const DXGI_ADAPTER_DESC1 &desc = candidates[index].desc;
+            out[index].ordinal = candidates[index].ordinal;
+            out[index].vendor_id = desc.VendorId;
+            out[index].device_id = desc.DeviceId;
+            out[index].dedicated_video_memory = static_cast<uint64_t>(desc.DedicatedVideoMemory);
+            out[index].description = duplicate_string(dxgi_adapters::description(desc));
+            out[index].luid = dxgi_adapters::luid(desc);
+        }
+        if (out_count) { *out_count = static_cast<uint32_t>(candidates.size()); }
+        return true;
+    }
+
+    // Hardware readers of the runtime decode on DXGI adapter `adapter_ordinal`, whose device is created up front
+    // so an unusable adapter fails here; negative defers to D3D's default adapter on first use.
+    CMftContext *mft_context_create_for_adapter(int32_t adapter_ordinal, char **out_error)
+    {
+        if (out_error) { *out_error = nullptr; }
+        ScopedCoInitialize coinitialize;
+        if (!coinitialize.ok())
+        {
+            set_error(out_error, coinitialize.error());
+            return nullptr;
+        }
+
+        auto runtime = std::make_unique<BridgeRuntime>();
+        if (!runtime->media_foundation.ok())
+        {
+            set_error(out_error, runtime->media_foundation.error());
+            return nullptr;
+        }
+        runtime->hardware.adapter_ordinal = adapter_ordinal;
+        if (adapter_ordinal >= 0 && !runtime->hardware.acquire())
+        {
+            set_error(out_error, "no hardware decode device on DXGI adapter " + std::to_string(adapter_ordinal));
+            return nullptr;
+        }
+        return reinterpret_cast<CMftContext *>(runtime.release());
+    }
+
+    CMftContext *mft_context_create(char **out_error)
+    {
+        return mft_context_create_for_adapter(-1, out_error);
+    }
+
+    void mft_context_destroy(CMftContext *context)
+    {
+        if (!context) { return; }
+        ScopedCoInitialize coinitialize;
+        delete reinterpret_cast<BridgeRuntime *>(context);
+    }
+
+    typedef struct CMftSession CMftSession;
+
+    // Probes `path`. When `out_session` is given, the opened reader is kept there for `mft_decode`; a non-zero
+    // `read_ahead` opens it in async mode with that many outstanding reads. `prefetch_window` and `prefetch_map`
+    // are CMftDecodeOptions' fields, for the probe's reader.
+    bool mft_open(CMftContext *shared, const char *path, uint32_t read_ahead, uint32_t prefetch_window, bool prefetch_map, CMftProbeResult *result, CMftSession **out_session)
+    {
+        if (out_session) { *out_session = nullptr; }
         if (!result) { return false; }
         result->has_value = false;
         result->value = 0;
@@ -302,17 +940,27 @@ extern "C"
             return false;
         }
 
-        ScopedMediaFoundation media_foundation;
-        if (!media_foundation.ok())
+        std::unique_ptr<BridgeRuntime> local_runtime;
+        std::string runtime_error;
+        if (!acquire_runtime(reinterpret_cast<BridgeRuntime *>(shared), local_runtime, runtime_error))
         {
-            set_error(&result->error, media_foundation.error());
+            set_error(&result->error, runtime_error);
             return false;
         }
 
         std::string reader_error;
         UINT32 width = 0;
         UINT32 height = 0;
-        ComPtr<IMFSourceReader> reader = open_best(wide_path, &width, &height, reader_error);
+        ComPtr<AsyncReadQueue> queue;
+        if (out_session && read_ahead > 0) { queue.Attach(new AsyncReadQueue(read_ahead)); }
+        ComPtr<prefetch_stream::PrefetchStream> stream;
+        if (!open_prefetch(wide_path, prefetch_window, prefetch_map, stream, reader_error))
+        {
+            set_error(&result->error, reader_error);
+            return false;
+        }
+        BridgeRuntime &runtime = shared ? *reinterpret_cast<BridgeRuntime *>(shared) : *local_runtime;
+        ComPtr<IMFSourceReader> reader = open_best(wide_path, stream.Get(), runtime, queue.Get(), &width, &height, reader_error);
         if (!reader)
         {
             set_error(&result->error, reader_error);
@@ -390,18 +1038,45 @@ extern "C"
                 result->value = estimated;
             }
         }
+
+        if (out_session)
+        {
+            auto session = std::make_unique<ReaderSession>();
+            if (session->mta.held())
+            {
+                session->local_runtime = std::move(local_runtime);
+                session->reader = reader;
+                session->queue = queue;
+                session->stream = stream;
+                session->width = width;
+                session->height = height;
+                *out_session = reinterpret_cast<CMftSession *>(session.release());
+            }
+        }
         return true;
     }
 
+    void mft_session_close(CMftSession *session)
+    {
+        if (!session) { return; }
+        ScopedCoInitialize coinitialize;
+        delete reinterpret_cast<ReaderSession *>(session);
+    }
+
+    // Takes ownership of `session` (may be null), decoding from its reader instead of reopening `path`.
     bool mft_decode(
+        CMftContext *shared,
+        CMftSession *session,
         const char *path,
         bool has_start_frame,
         uint64_t start_frame,
+        const CMftDecodeOptions *options,
         CMftFrameCallback callback,
         void *context,
         CMftSeekCallback seek_callback,
         char **out_error)
     {
+        std::unique_ptr<ReaderSession> opened(reinterpret_cast<ReaderSession *>(session));
         if (out_error) { *out_error = nullptr; }
         if (!callback)
         {
@@ -429,16 +1104,36 @@ extern "C"
             return false;
         }
 
-        ScopedMediaFoundation media_foundation;
-        if (!media_foundation.ok())
+        std::unique_ptr<BridgeRuntime> local_runtime;
+        std::string runtime_error;
+        if (!opened && !acquire_runtime(reinterpret_cast<BridgeRuntime *>(shared), local_runtime, runtime_error))
         {
-            set_error(out_error, media_foundation.error());
+            set_error(out_error, runtime_error);
             return false;
         }
 
         std::string reader_error;
         UINT32 width = 0, height = 0;
-        ComPtr<IMFSourceReader> reader = open_best(wide_path, &width, &height, reader_error);
+        ComPtr<IMFSourceReader> reader;
+        ComPtr<AsyncReadQueue> queue;
+        ComPtr<prefetch_stream::PrefetchStream> stream;
+        if (opened)
+        {
+            queue = opened->queue;
+            stream = opened->stream;
+            reader = opened->reader;
+            width = opened->width;
+            height = opened->height;
+        }
+        else
+        {
+            if (options && options->read_ahead > 0) { queue.Attach(new AsyncReadQueue(options->read_ahead)); }
+            BridgeRuntime &runtime = shared ? *reinterpret_cast<BridgeRuntime *>(shared) : *local_runtime;
+            if (open_prefetch(wide_path, options ? options->prefetch_window : 0, options && options->prefetch_map, stream, reader_error))
+            {
+                reader = open_best(wide_path, stream.Get(), runtime, queue.Get(), &width, &height, reader_error);
+            }
+        }
         if (!reader)
         {
             set_error(out_error, reader_error);
@@ -447,29 +1142,40 @@ extern "C"
 
         if (has_start_frame)
         {
-            ComPtr<IMFMediaType> media_type;
-            HRESULT mt_hr = reader->GetCurrentMediaType(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), &media_type);
-            if (FAILED(mt_hr))
+            LONGLONG position_value = 0;
+            std::string position_error;
+            if (options && options->start_seconds >= 0.0)
             {
-                set_error(out_error, hresult("GetCurrentMediaType", mt_hr));
-                return false;
+                if (!compute_seek_seconds(options->start_seconds, position_value, position_error))
+                {
+                    set_error(out_error, position_error);
+                    return false;
+                }
             }
-
-            UINT32 frame_rate_num = 0;
-            UINT32 frame_rate_den = 0;
-            HRESULT fr_hr = MFGetAttributeRatio(media_type.Get(), MF_MT_FRAME_RATE, &frame_rate_num, &frame_rate_den);
-            if (FAILED(fr_hr))
+            else
             {
-                set_error(out_error, hresult("MFGetAttributeRatio", fr_hr));
-                return false;
-            }
+                ComPtr<IMFMediaType> media_type;
+                HRESULT mt_hr = reader->GetCurrentMediaType(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), &media_type);
+                if (FAILED(mt_hr))
+                {
+                    set_error(out_error, hresult("GetCurrentMediaType", mt_hr));
+                    return false;
+                }
 
-            LONGLONG position_value = 0;
-            std::string position_error;
-            if (!compute_seek_timestamp(start_frame, frame_rate_num, frame_rate_den, position_value, position_error))
-            {
-                set_error(out_error, position_error);
-                return false;
+                UINT32 frame_rate_num = 0;
+                UINT32 frame_rate_den = 0;
+                HRESULT fr_hr = MFGetAttributeRatio(media_type.Get(), MF_MT_FRAME_RATE, &frame_rate_num, &frame_rate_den);
+                if (FAILED(fr_hr))
+                {
+                    set_error(out_error, hresult("MFGetAttributeRatio", fr_hr));
+                    return false;
+                }
+
+                if (!compute_seek_timestamp(start_frame, frame_rate_num, frame_rate_den, position_value, position_error))
+                {
+                    set_error(out_error, position_error);
+                    return false;
+                }
             }
 
             PROPVARIANT position;
@@ -485,18 +1191,47 @@ extern "C"
             }
         }
 
+        const CMftSelectCallback select_callback = options ? options->select_callback : nullptr;
+        const bool luma_only = options && options->luma_only;
+        // P010 planes hold 16 bits per sample; they are narrowed into `narrowed` and handed over as NV12.
+        const bool ten_bit = output_subtype(reader.Get()) == MFVideoFormat_P010;
+        std::vector<uint8_t> narrowed;
+        DropUntil drop;
+        drop.arm(options ? options->drop_before_seconds : 0.0);
+        KeyframeScan scan(options ? options->scan_interval_seconds : 0.0);
+        UINT32 scan_rate_num = 0;
+        UINT32 scan_rate_den = 0;
+        if (scan.enabled())
+        {
+            ComPtr<IMFMediaType> scan_type;
+            HRESULT scan_hr = reader->GetCurrentMediaType(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), &scan_type);
+            if (SUCCEEDED(scan_hr))
+            {
+                MFGetAttributeRatio(scan_type.Get(), MF_MT_FRAME_RATE, &scan_rate_num, &scan_rate_den);
+            }
+        }
+
         uint64_t frame_index = has_start_frame ? start_frame : 0;
+        const uint32_t poll_interval = options && options->seek_poll_interval > 1 ? options->seek_poll_interval : 1;
+        uint32_t reads_since_poll = poll_interval;
+        double read_seconds = 0.0;
         for (;;)
         {
             CMftSeekRequest seek_request{};
-            int seek_action = seek_callback(context, &seek_request);
+            int seek_action = 0;
+            if (reads_since_poll >= poll_interval)
+            {
+                reads_since_poll = 0;
+                seek_action = seek_callback(context, &seek_request);
+            }
+            reads_since_poll += 1;
             if (seek_action == 1)
             {
                 break;
             }
             if (seek_action == 2)
             {
-                HRESULT flush_hr = reader->Flush(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM));
+                HRESULT flush_hr = flush_reader(reader.Get(), queue.Get());
                 if (FAILED(flush_hr))
                 {
                     set_error(out_error, hresult("Flush", flush_hr));
@@ -524,14 +1259,27 @@ extern "C"
                 }
 
                 frame_index = seek_request.start_frame;
+                drop.arm(seek_request.drop_before_seconds);
+                scan.restart(position_value);
                 continue;
             }
 
-            DWORD stream_index = 0;
+            if (scan.take_seek())
+            {
+                HRESULT scan_hr = seek_reader(reader.Get(), queue.Get(), scan.target);
+                if (FAILED(scan_hr))
+                {
+                    set_error(out_error, hresult("SetCurrentPosition(scan)", scan_hr));
+                    return false;
+                }
+            }
+
             DWORD flags = 0;
             LONGLONG timestamp = 0;
             ComPtr<IMFSample> sample;
-            HRESULT hr = reader->ReadSample(static_cast<DWORD>(MF_SOURCE_READER_FIRST_VIDEO_STREAM), 0, &stream_index, &flags, &timestamp, &sample);
+            const double read_started = qpc_seconds();
+            HRESULT hr = read_sample(reader.Get(), queue.Get(), flags, timestamp, sample);
+            read_seconds += qpc_seconds() - read_started;
             if (FAILED(hr))
             {
                 set_error(out_error, hresult("ReadSample", hr));
@@ -543,6 +1291,30 @@ extern "C"
             }
             if ((flags & MF_SOURCE_READERF_STREAMTICK) || !sample) { continue; }
 
+            if (scan.enabled())
+            {
+                if (!scan.accept(timestamp)) { continue; }
+                frame_index = frame_index_at(timestamp, scan_rate_num, scan_rate_den, frame_index);
+            }
+
+            if (drop.drop(timestamp))
+            {
+                frame_index += 1;
+                continue;
+            }
+
+            if (select_callback)
+            {
+                const double pts_seconds = timestamp >= 0
+                                               ? static_cast<double>(timestamp) / 10000000.0
+                                               : -1.0;
+                if (!select_callback(context, pts_seconds, frame_index))
+                {
+                    frame_index += 1;
+                    continue;
+                }
+            }
+
             UINT64 decode_timestamp = 0;
             double dts_seconds = NAN;
             HRESULT dts_hr = sample->GetUINT64(MFSampleExtension_DecodeTimestamp, &decode_timestamp);
@@ -551,8 +1323,16 @@ extern "C"
                 dts_seconds = static_cast<double>(decode_timestamp) / 10000000.0;
             }
 
+            const double lock_started = qpc_seconds();
+            // Single-buffer samples (every hardware decoder, most software ones) are locked directly; only
+            // multi-buffer samples pay for the contiguous copy.
             ComPtr<IMFMediaBuffer> buffer;
-            hr = sample->ConvertToContiguousBuffer(&buffer);
+            DWORD buffer_count = 0;
+            if (SUCCEEDED(sample->GetBufferCount(&buffer_count)) && buffer_count == 1)
+            {
+                hr = sample->GetBufferByIndex(0, &buffer);
+            }
+            if (!buffer) { hr = sample->ConvertToContiguousBuffer(&buffer); }
             if (FAILED(hr) || !buffer)
             {
                 set_error(out_error, hresult("ConvertToContiguousBuffer", hr));
@@ -560,7 +1340,7 @@ extern "C"
             }
 
             FrameLock lock;
-            hr = lock.lock(buffer.Get(), width);
+            hr = lock.lock(buffer.Get(), ten_bit ? width * 2 : width);
             if (FAILED(hr) || !lock.data)
             {
                 set_error(out_error, hresult("IMFMediaBuffer::Lock", hr));
@@ -572,6 +1352,7 @@ extern "C"
                 set_error(out_error, "MFT buffer missing NV12 data");
                 return false;
             }
+            const double lock_seconds = qpc_seconds() - lock_started;
 
             size_t stride = static_cast<size_t>(lock.stride >= 0 ? lock.stride : -lock.stride);
             size_t y_rows = static_cast<size_t>(height);
@@ -620,13 +1401,30 @@ extern "C"
                 return false;
             }
 
+            const uint8_t *y_data = reinterpret_cast<const uint8_t *>(lock.data);
+            const uint8_t *uv_data = y_data + uv_offset;
+            if (ten_bit)
+            {
+                // One pass over the locked buffer, as for NV12; the Rust side then copies cached memory.
+                const size_t narrow_y = y_len / 2;
+                const size_t narrow_uv = luma_only ? 0 : uv_len / 2;
+                if (narrowed.size() < narrow_y + narrow_uv) { narrowed.resize(narrow_y + narrow_uv); }
+                stream_copy::narrow16(narrowed.data(), y_data, narrow_y);
+                stream_copy::narrow16(narrowed.data() + narrow_y, uv_data, narrow_uv);
+                y_data = narrowed.data();
+                uv_data = narrowed.data() + narrow_y;
+                y_len = narrow_y;
+                uv_len = narrow_uv;
+                stride /= 2;
+            }
+
             CMftFrame frame{};
-            frame.y_data = reinterpret_cast<const uint8_t *>(lock.data);
+            frame.y_data = y_data;
             frame.y_len = y_len;
             frame.y_stride = stride;
-            frame.uv_data = reinterpret_cast<const uint8_t *>(lock.data) + uv_offset;
-            frame.uv_len = uv_len;
-            frame.uv_stride = stride;
+            frame.uv_data = luma_only ? nullptr : uv_data;
+            frame.uv_len = luma_only ? 0 : uv_len;
+            frame.uv_stride = luma_only ? 0 : stride;
             frame.width = width;
             frame.height = height;
             frame.pts_seconds = timestamp >= 0
@@ -634,6 +1432,17 @@ extern "C"
                                     : -1.0;
             frame.dts_seconds = dts_seconds;
             frame.index = frame_index;
+            frame.read_seconds = read_seconds;
+            frame.lock_seconds = lock_seconds;
+            frame.keyframe = is_clean_point(sample.Get());
+            read_seconds = 0.0;
+            if (stream)
+            {
+                const prefetch_stream::Counters io = stream->take();
+                frame.stream_bytes = io.bytes_read;
+                frame.prefetch_hits = io.hits;
+                frame.prefetch_misses = io.misses;
+            }
 
             if (!callback(&frame, context)) { break; }
             frame_index += 1;
@@ -650,6 +1459,13 @@ extern "C"
         }
     }
 
+    // Copies a locked plane into Rust-owned memory. Buffers backed by DXGI surfaces are mapped from
+    // write-combined staging memory, which plain loads read slowly.
+    void mft_copy_plane(uint8_t *dst, const uint8_t *src, size_t len)
+    {
+        if (dst && src && len > 0) { stream_copy::copy(dst, src, len); }
+    }
+
 } // extern "C"
 
 #else
@@ -1,11 +1,26 @@
 #[cfg(all(target_os = "windows", feature = "backend-mft"))]
+use crate::adapter::{AdapterInfo, AdapterLease, AdapterScheduler, LeaseGroup};
+#[cfg(all(target_os = "windows", feature = "backend-mft"))]
+use crate::backpressure::{Backpressure, PressureValve};
+#[cfg(all(target_os = "windows", feature = "backend-mft"))]
 use crate::core::{
     DecoderController, DecoderError, DecoderProvider, DecoderResult, FrameStream, SeekInfo,
     SeekMode, SeekReceiver,
 };
 
 #[cfg(all(target_os = "windows", feature = "backend-mft"))]
-use crate::core::{VideoFrame, spawn_stream_from_channel};
+use crate::core::{
+    DecodePhase, DecoderStats, FrameSink, VideoFrame, spawn_batched_stream,
+    spawn_stream_from_channel,
+};
+#[cfg(all(target_os = "windows", feature = "backend-mft"))]
+use crate::index::{FrameIndex, IndexRecorder, Timeline};
+#[cfg(all(target_os = "windows", feature = "backend-mft"))]
+use crate::pool::FramePool;
+#[cfg(all(target_os = "windows", feature = "backend-mft"))]
+use crate::schedule::SampleSchedule;
+#[cfg(all(target_os = "windows", feature = "backend-mft"))]
+use crate::segment::{SegmentCursor, SegmentStep, plan_segments, spawn_segmented_stream};
 
 #[cfg(all(target_os = "windows", feature = "backend-mft"))]
 #[allow(unexpected_cfgs)]
@@ -15,10 +30,9 @@ mod platform {
     use std::path::{Path, PathBuf};
     use std::ptr;
     use std::slice;
-    use std::sync::Arc;
     use std::sync::atomic::{AtomicU64, Ordering};
-    use std::time::Duration;
-    use tokio::sync::mpsc::Sender;
+    use std::sync::{Arc, Mutex};
+    use std::time::{Duration, Instant};
 
     const BACKEND_NAME: &str = "mft";
     const DEFAULT_CHANNEL_CAPACITY: usize = 16;
@@ -47,14 +61,35 @@ mod platform {
         pts_seconds: f64,
         dts_seconds: f64,
         index: u64,
+        read_seconds: f64,
+        lock_seconds: f64,
+        keyframe: bool,
+        stream_bytes: u64,
+        prefetch_hits: u64,
+        prefetch_misses: u64,
     }
 
     type CMftFrameCallback = unsafe extern "C" fn(*const CMftFrame, *mut c_void) -> bool;
+    type CMftSelectCallback = unsafe extern "C" fn(*mut c_void, f64, u64) -> bool;
+
+    #[repr(C)]
+    struct CMftDecodeOptions {
+        select_callback: Option<CMftSelectCallback>,
+        scan_interval_seconds: f64,
+        luma_only: bool,
+        read_ahead: u32,
+        drop_before_seconds: f64,
+        seek_poll_interval: u32,
+        start_seconds: f64,
+        prefetch_window: u32,
+        prefetch_map: bool,
+    }
     #[repr(C)]
     #[derive(Clone, Copy)]
     struct CMftSeekRequest {
         position_seconds: f64,
         start_frame: u64,
+        drop_before_seconds: f64,
     }
 
     type CMftSeekCallback = unsafe extern "C" fn(*mut c_void, *mut CMftSeekRequest) -> i32;
@@ -63,30 +98,252 @@ mod platform {
     const SEEK_ACTION_STOP: i32 = 1;
     const SEEK_ACTION_SEEK: i32 = 2;
 
+    #[repr(C)]
+    struct CMftContext {
+        _private: [u8; 0],
+    }
+
+    #[repr(C)]
+    struct CMftSession {
+        _private: [u8; 0],
+    }
+
+    #[repr(C)]
+    struct CMftAdapterInfo {
+        ordinal: u32,
+        vendor_id: u32,
+        device_id: u32,
+        dedicated_video_memory: u64,
+        description: *mut c_char,
+        luid: u64,
+    }
+
     #[allow(improper_ctypes)]
     unsafe extern "C" {
-        fn mft_probe_total_frames(path: *const c_char, result: *mut CMftProbeResult) -> bool;
+        fn mft_enumerate_adapters(
+            out: *mut CMftAdapterInfo,
+            capacity: u32,
+            out_count: *mut u32,
+            out_error: *mut *mut c_char,
+        ) -> bool;
+        fn mft_context_create_for_adapter(
+            adapter_ordinal: i32,
+            out_error: *mut *mut c_char,
+        ) -> *mut CMftContext;
+        fn mft_context_destroy(context: *mut CMftContext);
+        fn mft_open(
+            context: *mut CMftContext,
+            path: *const c_char,
+            read_ahead: u32,
+            prefetch_window: u32,
+            prefetch_map: bool,
+            result: *mut CMftProbeResult,
+            out_session: *mut *mut CMftSession,
+        ) -> bool;
+        fn mft_session_close(session: *mut CMftSession);
         fn mft_decode(
+            context: *mut CMftContext,
+            session: *mut CMftSession,
             path: *const c_char,
             has_start_frame: bool,
             start_frame: u64,
+            options: *const CMftDecodeOptions,
             callback: CMftFrameCallback,
             context: *mut c_void,
             seek_callback: CMftSeekCallback,
             out_error: *mut *mut c_char,
         ) -> bool;
         fn mft_string_free(ptr: *mut c_char);
+        fn mft_copy_plane(dst: *mut u8, src: *const u8, len: usize);
+    }
+
+    /// Bridge runtime (MF startup and the hardware readers' device) reused by every probe and decode
+    /// placed on the same adapter instead of being set up per call.
+    struct BridgeContext {
+        raw: *mut CMftContext,
+        /// DXGI adapter hardware readers decode on; `None` when D3D picks it.
+        adapter: Option<u32>,
+    }
+
+    // The bridge only reads the runtime after creation.
+    unsafe impl Send for BridgeContext {}
+    unsafe impl Sync for BridgeContext {}
+
+    impl BridgeContext {
+        /// Returns the process-wide context for `adapter`, creating it on first use.
+        fn shared(adapter: Option<u32>) -> DecoderResult<Arc<Self>> {
+            static SHARED: Mutex<Vec<Arc<BridgeContext>>> = Mutex::new(Vec::new());
+            let mut contexts = SHARED
+                .lock()
+                .unwrap_or_else(|poisoned| poisoned.into_inner());
+            if let Some(context) = contexts.iter().find(|context| context.adapter == adapter) {
+                return Ok(context.clone());
+            }
+            let ordinal = adapter.map_or(-1, |ordinal| i32::try_from(ordinal).unwrap_or(i32::MAX));
+            let mut error_ptr: *mut c_char = ptr::null_mut();
+            let raw = unsafe { mft_context_create_for_adapter(ordinal, &mut error_ptr) };
+            let bridge_error = take_bridge_string(error_ptr);
+            if raw.is_null() {
+                let message = bridge_error.unwrap_or_else(|| "context creation failed".to_string());
+                return Err(DecoderError::backend_failure(BACKEND_NAME, message));
+            }
+            let context = Arc::new(Self { raw, adapter });
+            contexts.push(context.clone());
+            Ok(context)
+        }
+
+        fn as_ptr(&self) -> *mut CMftContext {
+            self.raw
+        }
+    }
+
+    impl Drop for BridgeContext {
+        fn drop(&mut self) {
+            unsafe { mft_context_destroy(self.raw) };
+        }
+    }
+
+    /// The DXGI adapters DXVA schedules its readers over, so hardware MFT sessions count toward the
+    /// same per-adapter session limit.
+    fn scheduler() -> &'static Arc<AdapterScheduler> {
+        crate::adapter::dxgi_scheduler(|| enumerate_adapters().unwrap_or_default())
+    }
+
+    fn enumerate_adapters() -> DecoderResult<Vec<AdapterInfo>> {
+        let mut count = 0u32;
+        let mut error_ptr: *mut c_char = ptr::null_mut();
+        let ok = unsafe { mft_enumerate_adapters(ptr::null_mut(), 0, &mut count, &mut error_ptr) };
+        if let Some(message) = take_bridge_string(error_ptr).filter(|_| !ok) {
+            return Err(DecoderError::backend_failure(BACKEND_NAME, message));
+        }
+        let mut raw: Vec<CMftAdapterInfo> = (0..count)
+            .map(|_| CMftAdapterInfo {
+                ordinal: 0,
+                vendor_id: 0,
+                device_id: 0,
+                dedicated_video_memory: 0,
+                description: ptr::null_mut(),
+                luid: 0,
+            })
+            .collect();
+        let mut filled = 0u32;
+        let mut error_ptr: *mut c_char = ptr::null_mut();
+        let ok =
+            unsafe { mft_enumerate_adapters(raw.as_mut_ptr(), count, &mut filled, &mut error_ptr) };
+        let bridge_error = take_bridge_string(error_ptr);
+        // Descriptions are owned by us from here on, whatever else went wrong.
+        let adapters: Vec<AdapterInfo> = raw
+            .iter()
+            .take(filled.min(count) as usize)
+            .map(|info| AdapterInfo {
+                ordinal: info.ordinal,
+                name: take_bridge_string(info.description)
+                    .unwrap_or_else(|| format!("adapter {}", info.ordinal)),
+                vendor_id: info.vendor_id,
+                dedicated_memory: info.dedicated_video_memory,
+                luid: info.luid,
+            })
+            .collect();
+        if !ok {
+            let message = bridge_error.unwrap_or_else(|| "adapter enumeration failed".to_string());
+            return Err(DecoderError::backend_failure(BACKEND_NAME, message));
+        }
+        Ok(adapters)
+    }
+
+    /// Leases the adapter the scheduler weighs cheapest and returns its context. Adapters without a
+    /// usable hardware device leave the rotation; with none left D3D picks the device. A reader of
+    /// `group` waits for its slot below the session limit; without one, or once its lease has
+    /// failed, it takes an adapter regardless of the limit.
+    fn lease_context(
+        stats: Option<&DecoderStats>,
+        group: Option<&LeaseGroup>,
+    ) -> DecoderResult<(Arc<BridgeContext>, Option<AdapterLease>)> {
+        let scheduler = scheduler();
+        let mut bounded = group.and_then(|group| group.take(scheduler));
+        while let Some(lease) = bounded.take().or_else(|| scheduler.lease()) {
+            let ordinal = lease.info().ordinal;
+            match BridgeContext::shared(Some(ordinal)) {
+                Ok(context) => {
+                    let lease = match stats {
+                        Some(stats) => lease.attach(stats),
+                        None => lease,
+                    };
+                    return Ok((context, Some(lease)));
+                }
+                Err(_) => scheduler.mark_failed(ordinal),
+            }
+        }
+        Ok((BridgeContext::shared(None)?, None))
+    }
+
+    /// Reader left open by the probe so the first decode does not open and negotiate the file again.
+    /// It keeps the probe's adapter lease, so the first reader decodes on that adapter instead of
+    /// wherever the scheduler would place it and keeps its slot counted until then.
+    struct ProbedSession {
+        raw: *mut CMftSession,
+        context: Arc<BridgeContext>,
+        lease: Option<AdapterLease>,
+    }
+
+    // The session is handed over to exactly one decode, which may run on another thread.
+    unsafe impl Send for ProbedSession {}
+
+    impl ProbedSession {
+        fn into_raw(mut self) -> *mut CMftSession {
+            std::mem::replace(&mut self.raw, ptr::null_mut())
+        }
+    }
+
+    impl Drop for ProbedSession {
+        fn drop(&mut self) {
+            if !self.raw.is_null() {
+                unsafe { mft_session_close(self.raw) };
+            }
+        }
     }
 
     pub struct MftProvider {
         input: PathBuf,
         metadata: crate::core::VideoMetadata,
+        session: Option<ProbedSession>,
         channel_capacity: usize,
         start_frame: Option<u64>,
+        samples_per_second: Option<u32>,
+        scan_interval: Option<Duration>,
+        /// Frames whose planes the pool keeps idle.
+        pool_size: usize,
+        decode_workers: usize,
+        delivery_batch: usize,
+        luma_only: bool,
+        read_ahead: u32,
+        index: Option<Arc<FrameIndex>>,
+        index_cache: Option<PathBuf>,
+        prefetch: Option<crate::config::Prefetch>,
+        backpressure: Backpressure,
     }
 
     impl MftProvider {}
 
+    /// Per-run knobs shared by every reader decoding this input.
+    #[derive(Clone)]
+    struct DecodeSettings {
+        session: Arc<Mutex<Option<ProbedSession>>>,
+        path: PathBuf,
+        samples_per_second: Option<u32>,
+        scan_interval: Option<Duration>,
+        pool: FramePool,
+        timeline: Timeline,
+        luma_only: bool,
+        read_ahead: u32,
+        /// Set when this run decodes the whole file in order, so it can record the frame index.
+        index_cache: Option<PathBuf>,
+        prefetch: Option<crate::config::Prefetch>,
+        backpressure: Backpressure,
+        /// Session-limit slots of this run's readers, one per segment worker.
+        leases: Arc<LeaseGroup>,
+    }
+
     impl DecoderProvider for MftProvider {
         fn new(config: &crate::config::Configuration) -> DecoderResult<Self> {
             let path = config.input.as_ref().ok_or_else(|| {
@@ -98,7 +355,21 @@ mod platform {
                     format!("input file {} does not exist", path.display()),
                 )));
             }
-            let metadata = probe_video_metadata(path)?;
+            // The probe's reader and lease are kept for the first decode.
+            let (context, lease) = lease_context(None, None)?;
+            let read_ahead = config
+                .read_ahead
+                .map_or(0, |n| u32::try_from(n.get()).unwrap_or(u32::MAX));
+            let (mut metadata, session) =
+                probe_video_metadata(&context, lease, path, read_ahead, config.prefetch)?;
+            let index = config
+                .index_cache
+                .as_deref()
+                .and_then(|dir| FrameIndex::load(dir, path))
+                .map(Arc::new);
+            if let Some(index) = index.as_ref() {
+                metadata.total_frames = Some(index.len());
+            }
             let capacity = config
                 .channel_capacity
                 .map(|n| n.get())
@@ -107,8 +378,20 @@ mod platform {
             Ok(Self {
                 input: path.to_path_buf(),
                 metadata,
+                session,
                 channel_capacity: capacity,
                 start_frame: config.start_frame,
+                samples_per_second: config.samples_per_second.map(|n| n.get()),
+                scan_interval: config.scan.keyframe_interval(),
+                pool_size: capacity + config.retained_frames.map_or(0, |n| n.get()),
+                decode_workers: config.decode_workers.map_or(1, |n| n.get()),
+                delivery_batch: config.delivery_batch.map_or(1, |n| n.get()),
+                luma_only: config.output_format == crate::config::OutputFormat::Luma,
+                read_ahead,
+                index,
+                index_cache: config.index_cache.clone(),
+                prefetch: config.prefetch,
+                backpressure: config.backpressure,
             })
         }
 
@@ -117,49 +400,190 @@ mod platform {
         }
 
         fn open(self: Box<Self>) -> DecoderResult<(DecoderController, FrameStream)> {
-            let provider = *self;
+            let mut provider = *self;
             let capacity = provider.channel_capacity;
             let start_frame = provider.start_frame;
-            let fps = provider.metadata.fps;
-            let controller = DecoderController::new();
+            let mut settings = DecodeSettings {
+                session: Arc::new(Mutex::new(provider.session.take())),
+                path: provider.input.clone(),
+                samples_per_second: provider.samples_per_second,
+                scan_interval: provider.scan_interval,
+                pool: FramePool::new(provider.pool_size),
+                timeline: Timeline::new(provider.metadata.fps, provider.index.clone()),
+                luma_only: provider.luma_only,
+                read_ahead: provider.read_ahead,
+                index_cache: None,
+                prefetch: provider.prefetch,
+                backpressure: provider.backpressure,
+                leases: Arc::new(LeaseGroup::new(1)),
+            };
+            let mut controller = DecoderController::new();
             let seek_rx = controller.seek_receiver();
             let serial = controller.serial_handle();
-            let stream = spawn_stream_from_channel(capacity, move |tx| {
-                if let Err(err) = decode_mft(
-                    provider.input.clone(),
-                    tx.clone(),
-                    start_frame,
-                    seek_rx,
-                    serial,
-                    fps,
-                ) {
-                    let _ = tx.blocking_send(Err(err));
+            let stats = controller.stats_handle();
+            // Keyframe scans already skip most of the stream; splitting them buys nothing.
+            // More workers than the session limit holds would never all get a slot.
+            let workers = if settings.scan_interval.is_some() {
+                1
+            } else {
+                let capacity = scheduler().session_capacity();
+                capacity.map_or(provider.decode_workers, |capacity| {
+                    provider.decode_workers.min(capacity)
+                })
+            };
+            let chunks = plan_segments(
+                &provider.metadata,
+                start_frame,
+                workers,
+                provider.index.as_deref(),
+            );
+            // Workers seek only between their own chunks, so the stream's controller cannot seek.
+            // The worker that takes the probe's session decodes under the probe's lease.
+            if let Some(chunks) = chunks.as_ref() {
+                controller.refuse_seeks();
+                let probed = settings
+                    .session
+                    .lock()
+                    .is_ok_and(|slot| slot.as_ref().is_some_and(|session| session.lease.is_some()));
+                let readers = workers.min(chunks.len());
+                settings.leases = Arc::new(LeaseGroup::new(readers - usize::from(probed)));
+            }
+            // Only a plain decode from the first frame sees every sample in order.
+            if provider.index.is_none()
+                && chunks.is_none()
+                && start_frame.is_none()
+                && settings.samples_per_second.is_none()
+                && settings.scan_interval.is_none()
+                && settings.backpressure == Backpressure::Block
+            {
+                settings.index_cache = provider.index_cache.clone();
+            }
+            let stream = match chunks {
+                Some(chunks) => {
+                    spawn_segmented_stream(capacity, chunks, workers, move |assigned, tx| {
+                        let Some(segments) = SegmentCursor::new(assigned) else {
+                            return;
+                        };
+                        let start = Some(segments.first_frame());
+                        if let Err(err) = decode_mft(
+                            &settings,
+                            FrameSink::new(tx.clone()),
+                            start,
+                            Some(segments),
+                            seek_rx.clone(),
+                            serial.clone(),
+                            stats.clone(),
+                        ) {
+                            let _ = tx.blocking_send(Err(err));
+                        }
+                    })
                 }
-            });
+                None => {
+                    let run = move |sink: FrameSink| {
+                        let mut errors = sink.clone();
+                        if let Err(err) =
+                            decode_mft(&settings, sink, start_frame, None, seek_rx, serial, stats)
+                        {
+                            errors.send(Err(err));
+                        }
+                    };
+                    if provider.delivery_batch > 1 {
+                        spawn_batched_stream(capacity, provider.delivery_batch, run)
+                    } else {
+                        spawn_stream_from_channel(capacity, move |tx| run(FrameSink::new(tx)))
+                    }
+                }
+            };
             Ok((controller, stream))
         }
     }
 
     fn decode_mft(
-        path: PathBuf,
-        tx: Sender<DecoderResult<VideoFrame>>,
+        settings: &DecodeSettings,
+        sink: FrameSink,
         start_frame: Option<u64>,
+        segments: Option<SegmentCursor>,
         seek_rx: SeekReceiver,
         serial: Arc<AtomicU64>,
-        fps: Option<f64>,
+        stats: Arc<DecoderStats>,
     ) -> DecoderResult<()> {
-        let c_path = cstring_from_path(&path)?;
-        let mut context = DecodeContext::new(tx, seek_rx, serial, fps);
+        let c_path = cstring_from_path(&settings.path)?;
+        // The first reader to start gets the probe's session and decodes under its lease. Every other
+        // reader (each segment worker included) is placed on an adapter of its own choosing, once the
+        // decode's readers all have a slot below the session limit, and opens the file itself.
+        let probed = settings
+            .session
+            .lock()
+            .ok()
+            .and_then(|mut slot| slot.take());
+        let (bridge, lease, session) = match probed {
+            Some(mut probed) if probed.lease.is_some() => {
+                let lease = probed.lease.take().map(|lease| lease.attach(&stats));
+                let bridge = probed.context.clone();
+                (bridge, lease, probed.into_raw())
+            }
+            probed => {
+                let (bridge, lease) = lease_context(Some(&stats), Some(&settings.leases))?;
+                // A probe without a lease ran outside the scheduler; reuse it only on the same context.
+                let session = probed
+                    .filter(|session| Arc::ptr_eq(&session.context, &bridge))
+                    .map_or(ptr::null_mut(), ProbedSession::into_raw);
+                (bridge, lease, session)
+            }
+        };
+        let scan_interval = settings.scan_interval;
+        let schedule = settings.samples_per_second.map(SampleSchedule::new);
+        let mut context = DecodeContext::new(
+            sink,
+            seek_rx,
+            serial,
+            stats,
+            schedule,
+            settings.pool.clone(),
+            settings.timeline.clone(),
+        )
+        .with_segments(segments)
+        .with_backpressure(settings.backpressure);
+        context.lease = lease;
         let mut error_ptr: *mut c_char = ptr::null_mut();
-        let (has_start_frame, start_frame) = match start_frame {
-            Some(value) => (true, value),
-            None => (false, 0),
+        if settings.index_cache.is_some() {
+            context.recorder = Some(IndexRecorder::default());
+        }
+        // With an index the reader starts exactly on the keyframe before the requested frame.
+        let start_point = start_frame
+            .filter(|_| settings.timeline.index().is_some())
+            .and_then(|frame| settings.timeline.seek_point(frame));
+        let (has_start_frame, start_frame) =
+            match start_point.map(|point| point.frame).or(start_frame) {
+                Some(value) => (true, value),
+                None => (false, 0),
+            };
+        let options = CMftDecodeOptions {
+            select_callback: (context.schedule.is_some() || context.valve.is_some())
+                .then_some(select_frame as CMftSelectCallback),
+            scan_interval_seconds: scan_interval.map_or(0.0, |interval| interval.as_secs_f64()),
+            luma_only: settings.luma_only,
+            read_ahead: settings.read_ahead,
+            drop_before_seconds: context.pending_drop.map_or(0.0, |drop_until| {
+                drop_until.bridge_seconds(&settings.timeline)
+            }),
+            seek_poll_interval: u32::try_from(context.sink.batch()).unwrap_or(u32::MAX),
+            start_seconds: start_point.map_or(-1.0, |point| point.pts.as_secs_f64()),
+            prefetch_window: settings
+                .prefetch
+                .map_or(0, |prefetch| prefetch.window_bytes.get()),
+            prefetch_map: settings
+                .prefetch
+                .is_some_and(|prefetch| prefetch.memory_map),
         };
         let ok = unsafe {
             mft_decode(
+                bridge.as_ptr(),
+                session,
                 c_path.as_ptr(),
                 has_start_frame,
                 start_frame,
+                &options,
                 handle_frame,
                 &mut context as *mut _ as *mut c_void,
                 poll_seek_requests,
@@ -167,6 +591,7 @@ mod platform {
             )
         };
         let bridge_error = take_bridge_string(error_ptr);
+        context.flush();
         if let Some(err) = context.take_seek_error() {
             return Err(err);
         }
@@ -182,10 +607,22 @@ mod platform {
                 return Err(DecoderError::backend_failure(BACKEND_NAME, message));
             }
         }
+        if let Some(dir) = settings.index_cache.as_deref()
+            && let Some(index) = context.recorder.take().and_then(IndexRecorder::finish)
+        {
+            // The cache only saves the next open a decode pass; failing to write it is not an error.
+            let _ = index.store(dir, &settings.path);
+        }
         Ok(())
     }
 
-    fn probe_video_metadata(path: &Path) -> DecoderResult<crate::core::VideoMetadata> {
+    fn probe_video_metadata(
+        context: &Arc<BridgeContext>,
+        lease: Option<AdapterLease>,
+        path: &Path,
+        read_ahead: u32,
+        prefetch: Option<crate::config::Prefetch>,
+    ) -> DecoderResult<(crate::core::VideoMetadata, Option<ProbedSession>)> {
         use crate::core::VideoMetadata;
 
         let c_path = cstring_from_path(path)?;
@@ -198,7 +635,24 @@ mod platform {
             height: 0,
             error: ptr::null_mut(),
         };
-        let ok = unsafe { mft_probe_total_frames(c_path.as_ptr(), &mut result) };
+        let mut raw_session: *mut CMftSession = ptr::null_mut();
+        let ok = unsafe {
+            mft_open(
+                context.as_ptr(),
+                c_path.as_ptr(),
+                read_ahead,
+                prefetch.map_or(0, |prefetch| prefetch.window_bytes.get()),
+                prefetch.is_some_and(|prefetch| prefetch.memory_map),
+                &mut result,
+                &mut raw_session,
+            )
+        };
+        // Wrap first so the reader is closed on the error paths below.
+        let session = (!raw_session.is_null()).then(|| ProbedSession {
+            raw: raw_session,
+            context: context.clone(),
+            lease,
+        });
         let bridge_error = take_bridge_string(result.error);
         if !ok {
             let message = bridge_error.unwrap_or_else(|| "probe failed".to_string());
@@ -227,7 +681,7 @@ mod platform {
             metadata.height = Some(result.height);
         }
 
-        Ok(metadata)
+        Ok((metadata, session))
     }
 
     fn cstring_from_path(path: &Path) -> DecoderResult<CString> {
@@ -246,38 +700,78 @@ mod platform {
     }
 
     struct DecodeContext {
-        tx: Sender<DecoderResult<VideoFrame>>,
+        sink: FrameSink,
         seek_rx: SeekReceiver,
         serial: Arc<AtomicU64>,
+        stats: Arc<DecoderStats>,
+        schedule: Option<SampleSchedule>,
+        observed: u64,
+        valve: Option<PressureValve>,
+        pool: FramePool,
+        segments: Option<SegmentCursor>,
         current_serial: u64,
         pending_drop: Option<DropUntil>,
         seek_error: Option<DecoderError>,
         closed: bool,
-        fps: Option<f64>,
+        timeline: Timeline,
+        recorder: Option<IndexRecorder>,
+        /// Adapter this reader decodes on; counts every sample the bridge hands over.
+        lease: Option<AdapterLease>,
     }
 
     impl DecodeContext {
         fn new(
-            tx: Sender<DecoderResult<VideoFrame>>,
+            sink: FrameSink,
             seek_rx: SeekReceiver,
             serial: Arc<AtomicU64>,
-            fps: Option<f64>,
+            stats: Arc<DecoderStats>,
+            schedule: Option<SampleSchedule>,
+            pool: FramePool,
+            timeline: Timeline,
         ) -> Self {
             let current_serial = serial.load(Ordering::SeqCst);
             Self {
-                tx,
+                sink,
                 seek_rx,
                 serial,
+                stats,
+                schedule,
+                observed: 0,
+                valve: None,
+                pool,
+                segments: None,
                 current_serial,
                 pending_drop: None,
                 seek_error: None,
                 closed: false,
-                fps,
+                timeline,
+                recorder: None,
+                lease: None,
             }
         }
 
+        /// Restricts decoding to a worker's chunks, starting with an accurate drop up to the first one.
+        fn with_segments(mut self, segments: Option<SegmentCursor>) -> Self {
+            if let Some(cursor) = segments.as_ref() {
+                self.pending_drop = Some(DropUntil::Frame(cursor.first_frame()));
+            }
+            self.segments = segments;
+            self
+        }
+
+        fn with_backpressure(mut self, policy: Backpressure) -> Self {
+            self.valve = PressureValve::new(policy);
+            self
+        }
+
         fn is_closed(&self) -> bool {
-            self.closed || self.tx.is_closed()
+            self.closed || self.sink.is_closed()
+        }
+
+        fn flush(&mut self) {
+            if !self.sink.flush() {
+                self.closed = true;
+            }
         }
 
         fn apply_drop(&mut self, drop_until: Option<DropUntil>) {
@@ -289,7 +783,10 @@ mod platform {
         }
 
         fn send_frame(&mut self, frame: VideoFrame) -> bool {
-            if self.tx.blocking_send(Ok(frame)).is_ok() {
+            let started = Instant::now();
+            let sent = self.sink.send(Ok(frame));
+            self.stats.record(DecodePhase::Deliver, started.elapsed());
+            if sent {
                 true
             } else {
                 self.closed = true;
@@ -298,10 +795,36 @@ mod platform {
         }
 
         fn send_error(&mut self, error: DecoderError) {
-            let _ = self.tx.blocking_send(Err(error));
+            self.sink.send(Err(error));
             self.closed = true;
         }
 
+        fn should_read_back(&mut self, pts: Option<Duration>) -> bool {
+            let Some(schedule) = self.schedule.as_mut() else {
+                return true;
+            };
+            // Without a timestamp the sampler falls back to its own frame count, which we cannot mirror.
+            if pts.is_none() {
+                return true;
+            }
+            self.observed = self.observed.saturating_add(1);
+            schedule.should_sample(pts, self.observed)
+        }
+
+        /// Whether a sample the schedule kept is read back under the backpressure policy; the ones
+        /// it drops are counted in the run's stats.
+        fn relieve(&mut self, pts: Option<Duration>) -> bool {
+            let Some(valve) = self.valve.as_mut() else {
+                return true;
+            };
+            let admitted = valve.admit(pts, self.sink.has_room());
+            if !admitted {
+                self.stats.record_dropped();
+            }
+            admitted
+        }
+
+        /// Backstop for the bridge's own drop, which only sees sample timestamps.
         fn should_skip_frame(&mut self, index: u64, pts: Option<Duration>) -> bool {
             let Some(drop_until) = self.pending_drop else {
                 return false;
@@ -328,15 +851,33 @@ mod platform {
         if context.is_closed() {
             return false;
         }
-        if frame.y_data.is_null() || frame.uv_data.is_null() {
+        if frame.y_data.is_null() || (frame.uv_data.is_null() && frame.uv_len > 0) {
             context.send_error(DecoderError::backend_failure(
                 BACKEND_NAME,
                 "NV12 plane pointer is null",
             ));
             return false;
         }
+        if let Some(lease) = context.lease.as_mut() {
+            lease.record_frame();
+        }
+        context
+            .stats
+            .record_seconds(DecodePhase::Read, frame.read_seconds);
+        context
+            .stats
+            .record_seconds(DecodePhase::Map, frame.lock_seconds);
+        context.stats.record_prefetch(
+            frame.stream_bytes,
+            frame.prefetch_hits,
+            frame.prefetch_misses,
+        );
         let y_data = unsafe { slice::from_raw_parts(frame.y_data, frame.y_len) };
-        let uv_data = unsafe { slice::from_raw_parts(frame.uv_data, frame.uv_len) };
+        let uv_data: &[u8] = if frame.uv_len == 0 {
+            &[]
+        } else {
+            unsafe { slice::from_raw_parts(frame.uv_data, frame.uv_len) }
+        };
         let pts = if frame.pts_seconds.is_finite() && frame.pts_seconds >= 0.0 {
             Some(Duration::from_secs_f64(frame.pts_seconds))
         } else {
@@ -347,12 +888,33 @@ mod platform {
         } else {
             None
         };
+        if let Some(recorder) = context.recorder.as_mut() {
+            recorder.record(pts, frame.keyframe);
+        }
         let index = pts
-            .and_then(|pts| index_from_pts(pts, context.fps))
+            .and_then(|pts| context.timeline.frame_at(pts))
             .or(Some(frame.index));
         if context.should_skip_frame(index.unwrap_or(frame.index), pts) {
             return true;
         }
+        if let Some(segments) = context.segments.as_mut()
+            && !segments.admit(index.unwrap_or(frame.index))
+        {
+            return true;
+        }
+        // The locked buffer is only valid during this callback, so the row copy happens here.
+        let copy_started = Instant::now();
+        // SAFETY: mft_copy_plane writes all `len` bytes of the destination.
+        let copy = |dst, src, len| unsafe { mft_copy_plane(dst, src, len) };
+        let (y_plane, uv_plane) = unsafe {
+            (
+                context.pool.copy_with(y_data, copy),
+                context.pool.copy_with(uv_data, copy),
+            )
+        };
+        context
+            .stats
+            .record(DecodePhase::Memcpy, copy_started.elapsed());
         match VideoFrame::from_nv12_owned(
             frame.width,
             frame.height,
@@ -360,12 +922,13 @@ mod platform {
             frame.uv_stride,
             pts,
             dts,
-            y_data.to_vec(),
-            uv_data.to_vec(),
+            y_plane,
+            uv_plane,
         ) {
             Ok(frame_value) => {
                 let frame_value = frame_value
                     .with_index(index)
+                    .with_plane_recycler(context.pool.recycler())
                     .with_serial(context.current_serial);
                 context.send_frame(frame_value)
             }
@@ -376,6 +939,22 @@ mod platform {
         }
     }
 
+    unsafe extern "C" fn select_frame(context: *mut c_void, pts_seconds: f64, _index: u64) -> bool {
+        if context.is_null() {
+            return false;
+        }
+        let context = unsafe { &mut *(context as *mut DecodeContext) };
+        if context.is_closed() {
+            return false;
+        }
+        let pts = if pts_seconds.is_finite() && pts_seconds >= 0.0 {
+            Some(Duration::from_secs_f64(pts_seconds))
+        } else {
+            None
+        };
+        context.should_read_back(pts) && context.relieve(pts)
+    }
+
     unsafe extern "C" fn poll_seek_requests(
         context: *mut c_void,
         out_request: *mut CMftSeekRequest,
@@ -387,14 +966,39 @@ mod platform {
         if context.is_closed() {
             return SEEK_ACTION_STOP;
         }
+        // Segmented workers seek only between their own chunks; their controller refuses seeks.
+        if let Some(segments) = context.segments.as_mut() {
+            return match segments.step() {
+                SegmentStep::Continue => SEEK_ACTION_CONTINUE,
+                SegmentStep::Finish => SEEK_ACTION_STOP,
+                SegmentStep::Seek(frame) => {
+                    let info = SeekInfo::Frame {
+                        frame,
+                        mode: SeekMode::Accurate,
+                    };
+                    apply_seek_plan(context, info, out_request)
+                }
+            };
+        }
         if !context.seek_rx.has_changed().unwrap_or(false) {
             return SEEK_ACTION_CONTINUE;
         }
         let Some(info) = *context.seek_rx.borrow_and_update() else {
             return SEEK_ACTION_CONTINUE;
         };
+        // Frames batched before the seek still go out ahead of the ones after it.
+        context.flush();
+        context.recorder = None;
         context.current_serial = context.serial.load(Ordering::SeqCst);
-        match compute_seek_plan(info, context.fps) {
+        apply_seek_plan(context, info, out_request)
+    }
+
+    fn apply_seek_plan(
+        context: &mut DecodeContext,
+        info: SeekInfo,
+        out_request: *mut CMftSeekRequest,
+    ) -> i32 {
+        match compute_seek_plan(info, &context.timeline) {
             Ok(plan) => {
                 context.apply_drop(plan.drop_until);
                 if !out_request.is_null() {
@@ -415,95 +1019,64 @@ mod platform {
         Timestamp(Duration),
     }
 
+    impl DropUntil {
+        /// Timestamp before which the bridge releases samples unread. A frame target maps to the midpoint
+        /// before it, matching the rounding in `Timeline::frame_at`, so the bridge never drops a frame that
+        /// `should_skip_frame` would keep.
+        fn bridge_seconds(self, timeline: &Timeline) -> f64 {
+            match self {
+                DropUntil::Frame(target) => timeline
+                    .drop_before(target)
+                    .map_or(0.0, |pts| pts.as_secs_f64()),
+                DropUntil::Timestamp(target) => target.as_secs_f64(),
+            }
+        }
+    }
+
     #[derive(Clone, Copy)]
     struct SeekPlan {
         request: CMftSeekRequest,
         drop_until: Option<DropUntil>,
     }
 
-    fn compute_seek_plan(info: SeekInfo, fps: Option<f64>) -> DecoderResult<SeekPlan> {
-        match info {
+    fn compute_seek_plan(info: SeekInfo, timeline: &Timeline) -> DecoderResult<SeekPlan> {
+        let (frame, mode, accurate_drop) = match info {
             SeekInfo::Frame { frame, mode } => {
-                let fps = fps.ok_or_else(|| {
-                    DecoderError::configuration(
-                        "mft backend requires frame rate metadata to seek by frame",
-                    )
-                })?;
-                if !(fps.is_finite() && fps > 0.0) {
+                if !timeline.is_known() {
                     return Err(DecoderError::configuration(
                         "mft backend requires frame rate metadata to seek by frame",
                     ));
                 }
-                let seconds = frame as f64 / fps;
-                if !seconds.is_finite() || seconds.is_sign_negative() {
-                    return Err(DecoderError::configuration("invalid seek timestamp"));
-                }
-                Ok(SeekPlan {
-                    request: CMftSeekRequest {
-                        position_seconds: seconds,
-                        start_frame: frame,
-                    },
-                    drop_until: match mode {
-                        SeekMode::Fast => None,
-                        SeekMode::Accurate => Some(DropUntil::Frame(frame)),
-                    },
-                })
+                (frame, mode, DropUntil::Frame(frame))
             }
             SeekInfo::Time { position, mode } => {
-                let fps = fps.ok_or_else(|| {
-                    DecoderError::configuration(
-                        "mft backend requires frame rate metadata to seek by time",
-                    )
-                })?;
-                if !(fps.is_finite() && fps > 0.0) {
+                if !timeline.is_known() {
                     return Err(DecoderError::configuration(
                         "mft backend requires frame rate metadata to seek by time",
                     ));
                 }
-                let seconds = position.as_secs_f64();
-                if !seconds.is_finite() || seconds.is_sign_negative() {
-                    return Err(DecoderError::configuration("invalid seek timestamp"));
-                }
-                let raw_frame = seconds * fps;
-                if !raw_frame.is_finite() || raw_frame.is_sign_negative() {
-                    return Err(DecoderError::configuration("invalid seek timestamp"));
-                }
-                let frame = match mode {
-                    SeekMode::Fast => raw_frame.round(),
-                    SeekMode::Accurate => raw_frame.floor(),
-                };
-                if frame < 0.0 || frame > u64::MAX as f64 {
-                    return Err(DecoderError::configuration("seek frame is out of range"));
-                }
-                Ok(SeekPlan {
-                    request: CMftSeekRequest {
-                        position_seconds: seconds,
-                        start_frame: frame as u64,
-                    },
-                    drop_until: match mode {
-                        SeekMode::Fast => None,
-                        SeekMode::Accurate => Some(DropUntil::Timestamp(position)),
-                    },
-                })
+                let frame = timeline
+                    .frame_for_time(position, mode == SeekMode::Accurate)
+                    .ok_or_else(|| DecoderError::configuration("seek frame is out of range"))?;
+                (frame, mode, DropUntil::Timestamp(position))
             }
-        }
-    }
-
-    fn index_from_pts(pts: Duration, fps: Option<f64>) -> Option<u64> {
-        let fps = fps?;
-        if !(fps.is_finite() && fps > 0.0) {
-            return None;
-        }
-        let seconds = pts.as_secs_f64();
-        if !seconds.is_finite() || seconds.is_sign_negative() {
-            return None;
-        }
-        let index = (seconds * fps).round();
-        if index.is_finite() && index >= 0.0 && index <= u64::MAX as f64 {
-            Some(index as u64)
-        } else {
-            None
-        }
+        };
+        let point = timeline
+            .seek_point(frame)
+            .ok_or_else(|| DecoderError::configuration("invalid seek timestamp"))?;
+        let drop_until = match mode {
+            SeekMode::Fast => None,
+            SeekMode::Accurate => Some(accurate_drop),
+        };
+        Ok(SeekPlan {
+            request: CMftSeekRequest {
+                position_seconds: point.pts.as_secs_f64(),
+                start_frame: point.frame,
+                drop_before_seconds: drop_until
+                    .map_or(0.0, |drop_until| drop_until.bridge_seconds(timeline)),
+            },
+            drop_until,
+        })
     }
 }
 
@@ -20,6 +20,7 @@ pub struct MockProvider {
     frame_interval: Duration,
     channel_capacity: usize,
     start_frame: u64,
+    luma_only: bool,
 }
 
 impl MockProvider {
@@ -53,7 +54,7 @@ impl MockProvider {
                 chunk.fill(value);
             }
             let uv_rows = (self.height as usize).div_ceil(2);
-            let uv_stride = self.stride;
+            let uv_stride = if self.luma_only { 0 } else { self.stride };
             let uv_plane = vec![128u8; uv_stride * uv_rows];
             let pts = Some(Duration::from_millis((index * 16) as u64));
             if should_skip_frame(&mut pending_drop, index as u64, pts) {
@@ -101,6 +102,7 @@ impl DecoderProvider for MockProvider {
             frame_interval: Duration::from_millis(4),
             channel_capacity: capacity.max(1),
             start_frame: config.start_frame.unwrap_or(0),
+            luma_only: config.output_format == crate::config::OutputFormat::Luma,
         })
     }
 
@@ -226,6 +228,21 @@ mod tests {
             channel_capacity: None,
             output_format: crate::config::OutputFormat::Nv12,
             start_frame: None,
+            readback_depth: None,
+            samples_per_second: None,
+            crop: None,
+            retained_frames: None,
+            scan: crate::config::ScanMode::Full,
+            decode_workers: None,
+            read_ahead: None,
+            luma_gate: None,
+            scale_height: None,
+            delivery_batch: None,
+            index_cache: None,
+            change_detection: None,
+            prefetch: None,
+            luma_cache: None,
+            backpressure: crate::backpressure::Backpressure::Block,
         };
         let decoder = Box::new(MockProvider::new(&config).unwrap()) as DynDecoderProvider;
         let metadata = decoder.metadata();
@@ -238,6 +255,38 @@ mod tests {
         assert_eq!(frame.uv_plane().len(), 640 * 180);
     }
 
+    #[tokio::test(flavor = "multi_thread")]
+    async fn mock_backend_luma_output_drops_chroma() {
+        let config = crate::config::Configuration {
+            backend: crate::config::Backend::Mock,
+            input: None,
+            channel_capacity: None,
+            output_format: crate::config::OutputFormat::Luma,
+            start_frame: None,
+            readback_depth: None,
+            samples_per_second: None,
+            crop: None,
+            retained_frames: None,
+            scan: crate::config::ScanMode::Full,
+            decode_workers: None,
+            read_ahead: None,
+            luma_gate: None,
+            scale_height: None,
+            delivery_batch: None,
+            index_cache: None,
+            change_detection: None,
+            prefetch: None,
+            luma_cache: None,
+            backpressure: crate::backpressure::Backpressure::Block,
+        };
+        let decoder = Box::new(MockProvider::new(&config).unwrap()) as DynDecoderProvider;
+        let (_controller, mut stream) = decoder.open().unwrap();
+        let frame = stream.next().await.unwrap().unwrap();
+        assert_eq!(frame.data().len(), 640 * 360);
+        assert!(frame.uv_plane().is_empty());
+        assert_eq!(frame.uv_stride(), 0);
+    }
+
     #[tokio::test(flavor = "multi_thread")]
     async fn mock_backend_honors_start_frame() {
         let config = crate::config::Configuration {
@@ -246,6 +295,21 @@ mod tests {
             channel_capacity: None,
             output_format: crate::config::OutputFormat::Nv12,
             start_frame: Some(10),
+            readback_depth: None,
+            samples_per_second: None,
+            crop: None,
+            retained_frames: None,
+            scan: crate::config::ScanMode::Full,
+            decode_workers: None,
+            read_ahead: None,
+            luma_gate: None,
+            scale_height: None,
+            delivery_batch: None,
+            index_cache: None,
+            change_detection: None,
+            prefetch: None,
+            luma_cache: None,
+            backpressure: crate::backpressure::Backpressure::Block,
         };
         let decoder = Box::new(MockProvider::new(&config).unwrap()) as DynDecoderProvider;
         let (_controller, mut stream) = decoder.open().unwrap();
@@ -261,6 +325,21 @@ mod tests {
             channel_capacity: None,
             output_format: crate::config::OutputFormat::Nv12,
             start_frame: None,
+            readback_depth: None,
+            samples_per_second: None,
+            crop: None,
+            retained_frames: None,
+            scan: crate::config::ScanMode::Full,
+            decode_workers: None,
+            read_ahead: None,
+            luma_gate: None,
+            scale_height: None,
+            delivery_batch: None,
+            index_cache: None,
+            change_detection: None,
+            prefetch: None,
+            luma_cache: None,
+            backpressure: crate::backpressure::Backpressure::Block,
         };
         let decoder = Box::new(MockProvider::new(&config).unwrap()) as DynDecoderProvider;
         let (controller, mut stream) = decoder.open().unwrap();
@@ -291,6 +370,21 @@ mod tests {
             channel_capacity: None,
             output_format: crate::config::OutputFormat::Nv12,
             start_frame: None,
+            readback_depth: None,
+            samples_per_second: None,
+            crop: None,
+            retained_frames: None,
+            scan: crate::config::ScanMode::Full,
+            decode_workers: None,
+            read_ahead: None,
+            luma_gate: None,
+            scale_height: None,
+            delivery_batch: None,
+            index_cache: None,
+            change_detection: None,
+            prefetch: None,
+            luma_cache: None,
+            backpressure: crate::backpressure::Backpressure::Block,
         };
         let decoder = Box::new(MockProvider::new(&config).unwrap()) as DynDecoderProvider;
         let (controller, mut stream) = decoder.open().unwrap();
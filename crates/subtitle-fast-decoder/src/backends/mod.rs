@@ -1,3 +1,4 @@
+pub mod luma_cache;
 pub mod mock;
 
 #[cfg(feature = "backend-ffmpeg")]
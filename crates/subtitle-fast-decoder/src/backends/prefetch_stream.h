@@ -0,0 +1,479 @@
+// Read-ahead byte stream shared by the DXVA and MFT bridges.
+//
+// MFCreateSourceReaderFromURL demuxes through Media Foundation's file stream, one small synchronous read per
+// request, which leaves ReadSample waiting on the network for files on SMB shares or slow disks. PrefetchStream
+// serves the demuxer from chunks a worker thread reads ahead, in large sequential requests, up to `window`
+// bytes past the demuxer's last read; a read outside the buffered range restarts the worker there. Local files
+// can be mapped instead and read straight from the view, with PrefetchVirtualMemory hints a window ahead.
+// take() returns, and resets, the reads served without waiting (hits), those that waited (misses) and the
+// bytes read from the file.
+
+#ifndef SUBTITLE_FAST_PREFETCH_STREAM_H
+#define SUBTITLE_FAST_PREFETCH_STREAM_H
+
+#include <windows.h>
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mfobjects.h>
+#include <wrl/client.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace prefetch_stream
+{
+    using Microsoft::WRL::ComPtr;
+
+    constexpr uint64_t kMinWindow = 1ull << 20;
+    // The worker reads a quarter window at a time, within these bounds.
+    constexpr uint64_t kMinChunk = 256ull << 10;
+    constexpr uint64_t kMaxChunk = 8ull << 20;
+
+    struct Counters
+    {
+        uint64_t bytes_read = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    // Network paths are never mapped: a failed page-in would be an access violation instead of a read error.
+    inline bool is_local(const std::wstring &path)
+    {
+        wchar_t volume[MAX_PATH + 1] = {};
+        if (!GetVolumePathNameW(path.c_str(), volume, MAX_PATH)) { return false; }
+        return GetDriveTypeW(volume) != DRIVE_REMOTE;
+    }
+
+    // Resolved at runtime; the MinGW headers only declare it for Windows 8 targets.
+    inline void prefetch_range(const uint8_t *address, size_t bytes)
+    {
+        struct MemoryRange
+        {
+            PVOID address;
+            SIZE_T bytes;
+        };
+        using Prefetch = BOOL(WINAPI *)(HANDLE, ULONG_PTR, MemoryRange *, ULONG);
+        static const Prefetch prefetch = []
+        {
+            HMODULE kernel = GetModuleHandleW(L"kernel32.dll");
+            return kernel ? reinterpret_cast<Prefetch>(GetProcAddress(kernel, "PrefetchVirtualMemory")) : nullptr;
+        }();
+        if (!prefetch || bytes == 0) { return; }
+        MemoryRange range{const_cast<uint8_t *>(address), bytes};
+        prefetch(GetCurrentProcess(), 1, &range, 0);
+    }
+
+    // Byte count of a BeginRead, carried to EndRead as the async result's object.
+    class ReadResult final : public IUnknown
+    {
+    public:
+        explicit ReadResult(ULONG bytes) : bytes(bytes) {}
+
+        STDMETHODIMP QueryInterface(REFIID iid, void **out) override
+        {
+            if (!out) { return E_POINTER; }
+            if (iid == __uuidof(IUnknown))
+            {
+                *out = static_cast<IUnknown *>(this);
+                AddRef();
+                return S_OK;
+            }
+            *out = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        STDMETHODIMP_(ULONG) AddRef() override { return InterlockedIncrement(&refs_); }
+
+        STDMETHODIMP_(ULONG) Release() override
+        {
+            ULONG count = InterlockedDecrement(&refs_);
+            if (count == 0) { delete this; }
+            return count;
+        }
+
+        const ULONG bytes;
+
+    private:
+        ~ReadResult() = default;
+
+        volatile ULONG refs_ = 1;
+    };
+
+    // Read-only, seekable IMFByteStream over one file. Its attributes carry MF_BYTESTREAM_ORIGIN_NAME so the
+    // source resolver still picks the media source by extension.
+    class PrefetchStream final : public IMFByteStream, public IMFAttributes
+    {
+    public:
+        // `window` is clamped to kMinWindow; `memory_map` is ignored for network paths.
+        static HRESULT open(const std::wstring &path, uint64_t window, bool memory_map, ComPtr<PrefetchStream> &out)
+        {
+            ComPtr<PrefetchStream> stream;
+            stream.Attach(new PrefetchStream(std::max(window, kMinWindow)));
+            HRESULT hr = stream->initialize(path, memory_map && is_local(path));
+            if (FAILED(hr)) { return hr; }
+            out = std::move(stream);
+            return S_OK;
+        }
+
+        // Counters since the previous call.
+        Counters take()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Counters taken = counters_;
+            counters_ = Counters{};
+            return taken;
+        }
+
+        STDMETHODIMP QueryInterface(REFIID iid, void **out) override
+        {
+            if (!out) { return E_POINTER; }
+            if (iid == __uuidof(IUnknown) || iid == __uuidof(IMFByteStream))
+            {
+                *out = static_cast<IMFByteStream *>(this);
+            }
+            else if (iid == __uuidof(IMFAttributes))
+            {
+                *out = static_cast<IMFAttributes *>(this);
+            }
+            else
+            {
+                *out = nullptr;
+                return E_NOINTERFACE;
+            }
+            AddRef();
+            return S_OK;
+        }
+
+        STDMETHODIMP_(ULONG) AddRef() override { return InterlockedIncrement(&refs_); }
+
+        STDMETHODIMP_(ULONG) Release() override
+        {
+            ULONG count = InterlockedDecrement(&refs_);
+            if (count == 0) { delete this; }
+            return count;
+        }
+
+        STDMETHODIMP GetCapabilities(DWORD *capabilities) override
+        {
+            if (!capabilities) { return E_POINTER; }
+            *capabilities = MFBYTESTREAM_IS_READABLE | MFBYTESTREAM_IS_SEEKABLE;
+            return S_OK;
+        }
+
+        STDMETHODIMP GetLength(QWORD *length) override
+        {
+            if (!length) { return E_POINTER; }
+            *length = length_;
+            return S_OK;
+        }
+
+        STDMETHODIMP SetLength(QWORD) override { return E_ACCESSDENIED; }
+
+        STDMETHODIMP GetCurrentPosition(QWORD *position) override
+        {
+            if (!position) { return E_POINTER; }
+            std::lock_guard<std::mutex> lock(mutex_);
+            *position = position_;
+            return S_OK;
+        }
+
+        STDMETHODIMP SetCurrentPosition(QWORD position) override
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            position_ = position;
+            return S_OK;
+        }
+
+        STDMETHODIMP IsEndOfStream(BOOL *end) override
+        {
+            if (!end) { return E_POINTER; }
+            std::lock_guard<std::mutex> lock(mutex_);
+            *end = position_ >= length_ ? TRUE : FALSE;
+            return S_OK;
+        }
+
+        STDMETHODIMP Read(BYTE *buffer, ULONG wanted, ULONG *read) override
+        {
+            if (!buffer || !read) { return E_POINTER; }
+            std::unique_lock<std::mutex> lock(mutex_);
+            HRESULT hr = read_at(lock, position_, buffer, wanted, *read);
+            position_ += *read;
+            return hr;
+        }
+
+        // Completes before returning: buffered reads are a copy, and a miss would block a work queue thread
+        // on the same I/O either way.
+        STDMETHODIMP BeginRead(BYTE *buffer, ULONG wanted, IMFAsyncCallback *callback, IUnknown *state) override
+        {
+            if (!buffer || !callback) { return E_POINTER; }
+            ULONG read = 0;
+            HRESULT status = Read(buffer, wanted, &read);
+            ComPtr<ReadResult> object;
+            object.Attach(new ReadResult(read));
+            ComPtr<IMFAsyncResult> result;
+            HRESULT hr = MFCreateAsyncResult(object.Get(), callback, state, &result);
+            if (FAILED(hr)) { return hr; }
+            result->SetStatus(status);
+            return MFInvokeCallback(result.Get());
+        }
+
+        STDMETHODIMP EndRead(IMFAsyncResult *result, ULONG *read) override
+        {
+            if (!result || !read) { return E_POINTER; }
+            *read = 0;
+            ComPtr<IUnknown> object;
+            HRESULT hr = result->GetObject(&object);
+            if (FAILED(hr)) { return hr; }
+            *read = static_cast<ReadResult *>(object.Get())->bytes;
+            return result->GetStatus();
+        }
+
+        STDMETHODIMP Write(const BYTE *, ULONG, ULONG *) override { return E_ACCESSDENIED; }
+        STDMETHODIMP BeginWrite(const BYTE *, ULONG, IMFAsyncCallback *, IUnknown *) override { return E_ACCESSDENIED; }
+        STDMETHODIMP EndWrite(IMFAsyncResult *, ULONG *) override { return E_ACCESSDENIED; }
+
+        STDMETHODIMP Seek(MFBYTESTREAM_SEEK_ORIGIN origin, LONGLONG offset, DWORD, QWORD *current) override
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const LONGLONG base = origin == msoCurrent ? static_cast<LONGLONG>(position_) : 0;
+            if (base + offset < 0) { return E_INVALIDARG; }
+            position_ = static_cast<QWORD>(base + offset);
+            if (current) { *current = position_; }
+            return S_OK;
+        }
+
+        STDMETHODIMP Flush() override { return S_OK; }
+
+        // Readers that open_best discards close the stream they were given before the next attempt reuses it,
+        // so the file stays open until the last reference goes.
+        STDMETHODIMP Close() override { return S_OK; }
+
+        STDMETHODIMP GetItem(REFGUID key, PROPVARIANT *value) override { return attributes_->GetItem(key, value); }
+        STDMETHODIMP GetItemType(REFGUID key, MF_ATTRIBUTE_TYPE *type) override { return attributes_->GetItemType(key, type); }
+        STDMETHODIMP CompareItem(REFGUID key, REFPROPVARIANT value, BOOL *result) override { return attributes_->CompareItem(key, value, result); }
+        STDMETHODIMP Compare(IMFAttributes *other, MF_ATTRIBUTES_MATCH_TYPE type, BOOL *result) override { return attributes_->Compare(other, type, result); }
+        STDMETHODIMP GetUINT32(REFGUID key, UINT32 *value) override { return attributes_->GetUINT32(key, value); }
+        STDMETHODIMP GetUINT64(REFGUID key, UINT64 *value) override { return attributes_->GetUINT64(key, value); }
+        STDMETHODIMP GetDouble(REFGUID key, double *value) override { return attributes_->GetDouble(key, value); }
+        STDMETHODIMP GetGUID(REFGUID key, GUID *value) override { return attributes_->GetGUID(key, value); }
+        STDMETHODIMP GetStringLength(REFGUID key, UINT32 *length) override { return attributes_->GetStringLength(key, length); }
+        STDMETHODIMP GetString(REFGUID key, LPWSTR value, UINT32 size, UINT32 *length) override { return attributes_->GetString(key, value, size, length); }
+        STDMETHODIMP GetAllocatedString(REFGUID key, LPWSTR *value, UINT32 *length) override { return attributes_->GetAllocatedString(key, value, length); }
+        STDMETHODIMP GetBlobSize(REFGUID key, UINT32 *size) override { return attributes_->GetBlobSize(key, size); }
+        STDMETHODIMP GetBlob(REFGUID key, UINT8 *buffer, UINT32 size, UINT32 *written) override { return attributes_->GetBlob(key, buffer, size, written); }
+        STDMETHODIMP GetAllocatedBlob(REFGUID key, UINT8 **buffer, UINT32 *size) override { return attributes_->GetAllocatedBlob(key, buffer, size); }
+        STDMETHODIMP GetUnknown(REFGUID key, REFIID iid, LPVOID *out) override { return attributes_->GetUnknown(key, iid, out); }
+        STDMETHODIMP SetItem(REFGUID key, REFPROPVARIANT value) override { return attributes_->SetItem(key, value); }
+        STDMETHODIMP DeleteItem(REFGUID key) override { return attributes_->DeleteItem(key); }
+        STDMETHODIMP DeleteAllItems() override { return attributes_->DeleteAllItems(); }
+        STDMETHODIMP SetUINT32(REFGUID key, UINT32 value) override { return attributes_->SetUINT32(key, value); }
+        STDMETHODIMP SetUINT64(REFGUID key, UINT64 value) override { return attributes_->SetUINT64(key, value); }
+        STDMETHODIMP SetDouble(REFGUID key, double value) override { return attributes_->SetDouble(key, value); }
+        STDMETHODIMP SetGUID(REFGUID key, REFGUID value) override { return attributes_->SetGUID(key, value); }
+        STDMETHODIMP SetString(REFGUID key, LPCWSTR value) override { return attributes_->SetString(key, value); }
+        STDMETHODIMP SetBlob(REFGUID key, const UINT8 *buffer, UINT32 size) override { return attributes_->SetBlob(key, buffer, size); }
+        STDMETHODIMP SetUnknown(REFGUID key, IUnknown *value) override { return attributes_->SetUnknown(key, value); }
+        STDMETHODIMP LockStore() override { return attributes_->LockStore(); }
+        STDMETHODIMP UnlockStore() override { return attributes_->UnlockStore(); }
+        STDMETHODIMP GetCount(UINT32 *count) override { return attributes_->GetCount(count); }
+        STDMETHODIMP GetItemByIndex(UINT32 index, GUID *key, PROPVARIANT *value) override { return attributes_->GetItemByIndex(index, key, value); }
+        STDMETHODIMP CopyAllItems(IMFAttributes *destination) override { return attributes_->CopyAllItems(destination); }
+
+    private:
+        struct Chunk
+        {
+            uint64_t offset = 0;
+            std::vector<uint8_t> data;
+
+            uint64_t end() const { return offset + data.size(); }
+        };
+
+        explicit PrefetchStream(uint64_t window)
+            : window_(window), chunk_(std::clamp(window / 4, kMinChunk, kMaxChunk))
+        {
+        }
+
+        ~PrefetchStream()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                closing_ = true;
+            }
+            wanted_.notify_all();
+            if (worker_.joinable()) { worker_.join(); }
+            if (view_) { UnmapViewOfFile(view_); }
+            if (mapping_) { CloseHandle(mapping_); }
+            if (file_ != INVALID_HANDLE_VALUE) { CloseHandle(file_); }
+        }
+
+        HRESULT initialize(const std::wstring &path, bool memory_map)
+        {
+            HRESULT hr = MFCreateAttributes(&attributes_, 1);
+            if (FAILED(hr)) { return hr; }
+            attributes_->SetString(MF_BYTESTREAM_ORIGIN_NAME, path.c_str());
+
+            const DWORD flags = memory_map ? FILE_ATTRIBUTE_NORMAL : FILE_FLAG_SEQUENTIAL_SCAN;
+            file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, flags, nullptr);
+            if (file_ == INVALID_HANDLE_VALUE) { return HRESULT_FROM_WIN32(GetLastError()); }
+            LARGE_INTEGER size{};
+            if (!GetFileSizeEx(file_, &size)) { return HRESULT_FROM_WIN32(GetLastError()); }
+            length_ = static_cast<uint64_t>(size.QuadPart);
+
+            // Empty files cannot be mapped; they have nothing to read ahead either.
+            if (memory_map && length_ > 0 && length_ <= SIZE_MAX)
+            {
+                mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (mapping_) { view_ = static_cast<const uint8_t *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0)); }
+                if (view_) { return S_OK; }
+            }
+            worker_ = std::thread([this] { fetch_loop(); });
+            return S_OK;
+        }
+
+        HRESULT read_at(std::unique_lock<std::mutex> &lock, uint64_t offset, BYTE *out, ULONG wanted, ULONG &done)
+        {
+            done = 0;
+            if (wanted == 0 || offset >= length_) { return S_OK; }
+            return view_ ? read_mapped(offset, out, wanted, done) : read_buffered(lock, offset, out, wanted, done);
+        }
+
+        HRESULT read_mapped(uint64_t offset, BYTE *out, ULONG wanted, ULONG &done)
+        {
+            const uint64_t end = std::min<uint64_t>(offset + wanted, length_);
+            done = static_cast<ULONG>(end - offset);
+            std::memcpy(out, view_ + offset, done);
+            counters_.bytes_read += done;
+
+            const bool hinted = offset >= hinted_begin_ && end <= hinted_end_;
+            ++(hinted ? counters_.hits : counters_.misses);
+            if (!hinted || end + window_ / 2 > hinted_end_)
+            {
+                const uint64_t begin = hinted ? hinted_end_ : offset;
+                const uint64_t until = std::min(end + window_, length_);
+                if (until > begin) { prefetch_range(view_ + begin, static_cast<size_t>(until - begin)); }
+                hinted_begin_ = offset;
+                hinted_end_ = std::max(until, end);
+            }
+            return S_OK;
+        }
+
+        HRESULT read_buffered(std::unique_lock<std::mutex> &lock, uint64_t offset, BYTE *out, ULONG wanted, ULONG &done)
+        {
+            bool waited = false;
+            HRESULT hr = S_OK;
+            while (done < wanted && offset + done < length_)
+            {
+                const uint64_t at = offset + done;
+                auto chunk = std::find_if(chunks_.begin(), chunks_.end(), [&](const Chunk &candidate) { return at >= candidate.offset && at < candidate.end(); });
+                if (chunk != chunks_.end())
+                {
+                    const size_t skip = static_cast<size_t>(at - chunk->offset);
+                    const size_t count = std::min<size_t>(chunk->data.size() - skip, wanted - done);
+                    std::memcpy(out + done, chunk->data.data() + skip, count);
+                    done += static_cast<ULONG>(count);
+                    continue;
+                }
+                // Behind the buffer, or past the chunk the worker is reading: start over from here.
+                const uint64_t front = chunks_.empty() ? fetch_offset_ : chunks_.front().offset;
+                if (at < front || at >= fetch_offset_ + chunk_) { restart(at); }
+                if (FAILED(failure_))
+                {
+                    hr = done == 0 ? failure_ : S_OK;
+                    break;
+                }
+                consumer_ = at;
+                wanted_.notify_all();
+                waited = true;
+                arrived_.wait(lock);
+            }
+            ++(waited ? counters_.misses : counters_.hits);
+            consumer_ = offset + done;
+            // One chunk stays behind the demuxer for the short backward reads container parsers make.
+            while (!chunks_.empty() && chunks_.front().end() + chunk_ <= consumer_) { chunks_.pop_front(); }
+            wanted_.notify_all();
+            return hr;
+        }
+
+        void restart(uint64_t offset)
+        {
+            chunks_.clear();
+            fetch_offset_ = offset;
+            consumer_ = offset;
+            failure_ = S_OK;
+            ++generation_;
+        }
+
+        void fetch_loop()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (;;)
+            {
+                wanted_.wait(lock, [&] { return closing_ || (SUCCEEDED(failure_) && fetch_offset_ < length_ && fetch_offset_ < consumer_ + window_); });
+                if (closing_) { return; }
+                const uint64_t offset = fetch_offset_;
+                const uint64_t generation = generation_;
+                Chunk chunk{offset, std::vector<uint8_t>(static_cast<size_t>(std::min(chunk_, length_ - offset)))};
+                lock.unlock();
+
+                OVERLAPPED position{};
+                position.Offset = static_cast<DWORD>(offset);
+                position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+                DWORD got = 0;
+                HRESULT hr = ReadFile(file_, chunk.data.data(), static_cast<DWORD>(chunk.data.size()), &got, &position) ? S_OK : HRESULT_FROM_WIN32(GetLastError());
+                if (SUCCEEDED(hr) && got == 0) { hr = HRESULT_FROM_WIN32(ERROR_HANDLE_EOF); }
+
+                lock.lock();
+                if (generation != generation_) { continue; }
+                if (FAILED(hr))
+                {
+                    failure_ = hr;
+                }
+                else
+                {
+                    chunk.data.resize(got);
+                    fetch_offset_ += got;
+                    counters_.bytes_read += got;
+                    chunks_.push_back(std::move(chunk));
+                }
+                arrived_.notify_all();
+            }
+        }
+
+        volatile ULONG refs_ = 1;
+        const uint64_t window_;
+        const uint64_t chunk_;
+        ComPtr<IMFAttributes> attributes_;
+        HANDLE file_ = INVALID_HANDLE_VALUE;
+        HANDLE mapping_ = nullptr;
+        const uint8_t *view_ = nullptr;
+        uint64_t length_ = 0;
+
+        std::mutex mutex_;
+        // Worker: more to read; demuxer: a chunk arrived or a read failed.
+        std::condition_variable wanted_;
+        std::condition_variable arrived_;
+        std::thread worker_;
+        QWORD position_ = 0;
+        Counters counters_;
+        // Buffered reading: chunks cover [front offset, fetch_offset_) without gaps; the worker stays within
+        // `window_` of consumer_, the end of the demuxer's last read.
+        std::deque<Chunk> chunks_;
+        uint64_t fetch_offset_ = 0;
+        uint64_t consumer_ = 0;
+        uint64_t generation_ = 0;
+        HRESULT failure_ = S_OK;
+        bool closing_ = false;
+        // Mapped reading: the range last passed to PrefetchVirtualMemory.
+        uint64_t hinted_begin_ = 0;
+        uint64_t hinted_end_ = 0;
+    };
+}
+
+#endif
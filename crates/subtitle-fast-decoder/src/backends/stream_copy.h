@@ -0,0 +1,194 @@
+// Plane copy kernel shared by the DXVA and MFT bridges.
+//
+// Mapped staging textures and locked DXGI-backed sample buffers are often uncached or write-combined, where
+// ordinary loads are serialised and cost several ms per 4K frame. On x86 with SSE4.1 the source is read with
+// MOVNTDQA streaming loads, a cache line at a time, and stored with AVX2 when the CPU and OS support it;
+// everything else falls back to std::memcpy. The kernel is picked once per process. narrow16() reads 10-bit
+// planes the same way and keeps their high bytes.
+
+#ifndef SUBTITLE_FAST_STREAM_COPY_H
+#define SUBTITLE_FAST_STREAM_COPY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define STREAM_COPY_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(STREAM_COPY_X86) && (defined(__GNUC__) || defined(__clang__))
+#define STREAM_COPY_TARGET(features) __attribute__((target(features)))
+#else
+#define STREAM_COPY_TARGET(features)
+#endif
+
+namespace stream_copy
+{
+    // Below this the setup costs more than the uncached loads it saves.
+    constexpr size_t kMinStreamBytes = 4096;
+
+    enum class Kernel
+    {
+        Memcpy,
+        Sse41,
+        Avx2,
+    };
+
+#if defined(STREAM_COPY_X86)
+    inline Kernel detect_kernel()
+    {
+#if defined(_MSC_VER)
+        int regs[4] = {};
+        __cpuid(regs, 0);
+        const int max_leaf = regs[0];
+        __cpuid(regs, 1);
+        const bool sse41 = (regs[2] & (1 << 19)) != 0;
+        const bool osxsave = (regs[2] & (1 << 27)) != 0;
+        const bool avx = (regs[2] & (1 << 28)) != 0;
+        bool avx2 = false;
+        if (max_leaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6)
+        {
+            __cpuidex(regs, 7, 0);
+            avx2 = (regs[1] & (1 << 5)) != 0;
+        }
+#else
+        __builtin_cpu_init();
+        const bool sse41 = __builtin_cpu_supports("sse4.1");
+        const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+        if (!sse41) { return Kernel::Memcpy; }
+        return avx2 ? Kernel::Avx2 : Kernel::Sse41;
+    }
+
+    inline Kernel kernel()
+    {
+        static const Kernel selected = detect_kernel();
+        return selected;
+    }
+
+    // Both kernels expect a 16-byte aligned `src` and a multiple of 64 bytes.
+    STREAM_COPY_TARGET("sse4.1")
+    inline void copy_lines_sse41(uint8_t *dst, const uint8_t *src, size_t len)
+    {
+        for (size_t offset = 0; offset < len; offset += 64)
+        {
+            __m128i *line = reinterpret_cast<__m128i *>(const_cast<uint8_t *>(src + offset));
+            const __m128i a = _mm_stream_load_si128(line);
+            const __m128i b = _mm_stream_load_si128(line + 1);
+            const __m128i c = _mm_stream_load_si128(line + 2);
+            const __m128i d = _mm_stream_load_si128(line + 3);
+            __m128i *out = reinterpret_cast<__m128i *>(dst + offset);
+            _mm_storeu_si128(out, a);
+            _mm_storeu_si128(out + 1, b);
+            _mm_storeu_si128(out + 2, c);
+            _mm_storeu_si128(out + 3, d);
+        }
+    }
+
+    STREAM_COPY_TARGET("avx2")
+    inline void copy_lines_avx2(uint8_t *dst, const uint8_t *src, size_t len)
+    {
+        for (size_t offset = 0; offset < len; offset += 64)
+        {
+            __m128i *line = reinterpret_cast<__m128i *>(const_cast<uint8_t *>(src + offset));
+            const __m128i a = _mm_stream_load_si128(line);
+            const __m128i b = _mm_stream_load_si128(line + 1);
+            const __m128i c = _mm_stream_load_si128(line + 2);
+            const __m128i d = _mm_stream_load_si128(line + 3);
+            __m256i *out = reinterpret_cast<__m256i *>(dst + offset);
+            _mm256_storeu_si256(out, _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1));
+            _mm256_storeu_si256(out + 1, _mm256_inserti128_si256(_mm256_castsi128_si256(c), d, 1));
+        }
+    }
+
+    // 16 uncached bytes of 16-bit samples per load; the high bytes of 32 samples are stored per iteration.
+    STREAM_COPY_TARGET("sse4.1")
+    inline void narrow_lines_sse41(uint8_t *dst, const uint8_t *src, size_t samples)
+    {
+        for (size_t sample = 0; sample < samples; sample += 32)
+        {
+            __m128i *line = reinterpret_cast<__m128i *>(const_cast<uint8_t *>(src + sample * 2));
+            const __m128i a = _mm_srli_epi16(_mm_stream_load_si128(line), 8);
+            const __m128i b = _mm_srli_epi16(_mm_stream_load_si128(line + 1), 8);
+            const __m128i c = _mm_srli_epi16(_mm_stream_load_si128(line + 2), 8);
+            const __m128i d = _mm_srli_epi16(_mm_stream_load_si128(line + 3), 8);
+            __m128i *out = reinterpret_cast<__m128i *>(dst + sample);
+            _mm_storeu_si128(out, _mm_packus_epi16(a, b));
+            _mm_storeu_si128(out + 1, _mm_packus_epi16(c, d));
+        }
+    }
+#endif
+
+    // Copies `len` bytes out of (possibly write-combined) `src`.
+    inline void copy(void *dst, const void *src, size_t len)
+    {
+#if defined(STREAM_COPY_X86)
+        const Kernel selected = kernel();
+        if (selected != Kernel::Memcpy && len >= kMinStreamBytes)
+        {
+            uint8_t *out = static_cast<uint8_t *>(dst);
+            const uint8_t *in = static_cast<const uint8_t *>(src);
+            const size_t head = (16 - (reinterpret_cast<uintptr_t>(in) & 15)) & 15;
+            if (head > 0)
+            {
+                std::memcpy(out, in, head);
+                out += head;
+                in += head;
+                len -= head;
+            }
+            const size_t body = len & ~static_cast<size_t>(63);
+            if (selected == Kernel::Avx2) { copy_lines_avx2(out, in, body); }
+            else { copy_lines_sse41(out, in, body); }
+            if (len > body) { std::memcpy(out + body, in + body, len - body); }
+            return;
+        }
+#endif
+        std::memcpy(dst, src, len);
+    }
+
+    // Narrows `samples` little-endian 16-bit samples with their significant bits at the top (P010) to their high
+    // bytes, i.e. the 8-bit value of a 10-bit sample, reading `src` the way copy() does.
+    inline void narrow16(uint8_t *dst, const void *src, size_t samples)
+    {
+        const uint8_t *in = static_cast<const uint8_t *>(src);
+#if defined(STREAM_COPY_X86)
+        if (kernel() != Kernel::Memcpy && samples * 2 >= kMinStreamBytes && (reinterpret_cast<uintptr_t>(in) & 1) == 0)
+        {
+            const size_t head = ((16 - (reinterpret_cast<uintptr_t>(in) & 15)) & 15) / 2;
+            for (size_t sample = 0; sample < head; ++sample) { dst[sample] = in[sample * 2 + 1]; }
+            dst += head;
+            in += head * 2;
+            samples -= head;
+            const size_t body = samples & ~static_cast<size_t>(31);
+            narrow_lines_sse41(dst, in, body);
+            dst += body;
+            in += body * 2;
+            samples -= body;
+        }
+#endif
+        for (size_t sample = 0; sample < samples; ++sample) { dst[sample] = in[sample * 2 + 1]; }
+    }
+
+    // Copies `rows` rows of `row_bytes` each. When both pitches equal `row_bytes` the plane is one
+    // contiguous block and goes through a single copy.
+    inline void copy_plane(uint8_t *dst, size_t dst_pitch, const uint8_t *src, size_t src_pitch, size_t row_bytes, size_t rows)
+    {
+        if (rows == 0 || row_bytes == 0) { return; }
+        if (dst_pitch == row_bytes && src_pitch == row_bytes)
+        {
+            copy(dst, src, row_bytes * rows);
+            return;
+        }
+        for (size_t row = 0; row < rows; ++row)
+        {
+            copy(dst + row * dst_pitch, src + row * src_pitch, row_bytes);
+        }
+    }
+} // namespace stream_copy
+
+#endif // SUBTITLE_FAST_STREAM_COPY_H
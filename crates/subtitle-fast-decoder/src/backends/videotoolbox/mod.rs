@@ -215,14 +215,18 @@ mod platform {
             let serial = controller.serial_handle();
             let stream = spawn_stream_from_channel(capacity, move |tx| {
                 let result = match output_format {
-                    OutputFormat::Nv12 => decode_videotoolbox_nv12(
-                        path.clone(),
-                        tx.clone(),
-                        start_frame,
-                        seek_rx,
-                        serial.clone(),
-                        fps,
-                    ),
+                    // Chroma comes out of the same copy here, so luma requests get full NV12.
+                    // Texture output is rejected by validation before a provider is built.
+                    OutputFormat::Nv12 | OutputFormat::Luma | OutputFormat::D3D11Texture => {
+                        decode_videotoolbox_nv12(
+                            path.clone(),
+                            tx.clone(),
+                            start_frame,
+                            seek_rx,
+                            serial.clone(),
+                            fps,
+                        )
+                    }
                     OutputFormat::CVPixelBuffer => decode_videotoolbox_handle(
                         path.clone(),
                         tx.clone(),
@@ -0,0 +1,173 @@
+//! What DXVA/MFT do with a decoded sample while the consumer is behind.
+//!
+//! A full channel blocks the decode loop in `FrameSink::send`, which stalls the bridge's `ReadSample`
+//! loop and, for DXVA, keeps decoder surfaces out of the pool; a slow detector or OCR then builds up
+//! seconds of lag. The bridges ask before reading a sample back, so a policy other than `Block` can
+//! drop it there, at no copy cost, whenever the channel has no room. Dropped samples are counted in
+//! `DecoderStatsSnapshot::dropped_frames`.
+
+use std::fmt;
+use std::num::NonZeroU32;
+use std::str::FromStr;
+use std::time::Duration;
+
+use crate::core::DecoderError;
+use crate::schedule::SampleSchedule;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum Backpressure {
+    /// Wait for room; every frame is delivered.
+    #[default]
+    Block,
+    /// Drop the frames a detection sampler at this rate would discard; the ones it keeps still wait.
+    Unsampled { samples_per_second: NonZeroU32 },
+    /// Drop every frame decoded while the channel is full. The frames already queued are still
+    /// delivered, so lag stays within the channel capacity; a consumer that wants only the newest frame
+    /// drains what is queued, as the video player does.
+    DropWhenFull,
+}
+
+impl Backpressure {
+    pub fn as_str(&self) -> &'static str {
+        match self {
+            Backpressure::Block => "block",
+            Backpressure::Unsampled { .. } => "unsampled",
+            Backpressure::DropWhenFull => "drop",
+        }
+    }
+}
+
+impl fmt::Display for Backpressure {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        match self {
+            Backpressure::Unsampled { samples_per_second } => {
+                write!(f, "unsampled:{samples_per_second}")
+            }
+            other => f.write_str(other.as_str()),
+        }
+    }
+}
+
+/// Parses `block`, `drop` or `unsampled:<samples per second>`.
+impl FromStr for Backpressure {
+    type Err = DecoderError;
+
+    fn from_str(s: &str) -> Result<Self, Self::Err> {
+        let value = s.trim().to_ascii_lowercase();
+        match value.split_once(':') {
+            None if value == "block" => Ok(Backpressure::Block),
+            None if value == "drop" => Ok(Backpressure::DropWhenFull),
+            Some(("unsampled", rate)) => rate
+                .parse()
+                .ok()
+                .and_then(NonZeroU32::new)
+                .map(|samples_per_second| Backpressure::Unsampled { samples_per_second })
+                .ok_or_else(|| {
+                    DecoderError::configuration(format!(
+                        "backpressure '{s}' needs a positive sampling rate"
+                    ))
+                }),
+            _ => Err(DecoderError::configuration(format!(
+                "unknown backpressure policy '{s}' (expected block, drop or unsampled:<rate>)"
+            ))),
+        }
+    }
+}
+
+/// One reader's view of a policy other than `Block`. Only the DXVA and MFT readers consult one.
+#[derive(Debug)]
+#[cfg_attr(
+    not(any(
+        all(target_os = "windows", feature = "backend-dxva"),
+        all(target_os = "windows", feature = "backend-mft")
+    )),
+    allow(dead_code)
+)]
+pub(crate) struct PressureValve {
+    schedule: Option<SampleSchedule>,
+    observed: u64,
+}
+
+#[cfg_attr(
+    not(any(
+        all(target_os = "windows", feature = "backend-dxva"),
+        all(target_os = "windows", feature = "backend-mft")
+    )),
+    allow(dead_code)
+)]
+impl PressureValve {
+    pub(crate) fn new(policy: Backpressure) -> Option<Self> {
+        let schedule = match policy {
+            Backpressure::Block => return None,
+            Backpressure::Unsampled { samples_per_second } => {
+                Some(SampleSchedule::new(samples_per_second.get()))
+            }
+            Backpressure::DropWhenFull => None,
+        };
+        Some(Self {
+            schedule,
+            observed: 0,
+        })
+    }
+
+    /// Whether the sample stamped `pts` is read back, given whether the channel has room for it.
+    /// The schedule sees every sample, so it stays in step with the sampler whether or not the
+    /// channel is full.
+    pub(crate) fn admit(&mut self, pts: Option<Duration>, has_room: bool) -> bool {
+        let needed = match self.schedule.as_mut() {
+            // Without a timestamp the sampler falls back to its own frame count, which we cannot mirror.
+            Some(_) if pts.is_none() => true,
+            Some(schedule) => {
+                self.observed = self.observed.saturating_add(1);
+                schedule.should_sample(pts, self.observed)
+            }
+            None => false,
+        };
+        needed || has_room
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn at(millis: u64) -> Option<Duration> {
+        Some(Duration::from_millis(millis))
+    }
+
+    #[test]
+    fn policies_parse_and_print() {
+        assert_eq!(
+            "block".parse::<Backpressure>().unwrap(),
+            Backpressure::Block
+        );
+        assert_eq!(
+            " Drop".parse::<Backpressure>().unwrap(),
+            Backpressure::DropWhenFull
+        );
+        let unsampled: Backpressure = "unsampled:7".parse().unwrap();
+        assert_eq!(unsampled.to_string(), "unsampled:7");
+        assert!("unsampled:0".parse::<Backpressure>().is_err());
+        assert!("latest".parse::<Backpressure>().is_err());
+    }
+
+    #[test]
+    fn full_channel_drops_only_what_the_policy_allows() {
+        assert!(PressureValve::new(Backpressure::Block).is_none());
+
+        let mut drop = PressureValve::new(Backpressure::DropWhenFull).unwrap();
+        assert!(drop.admit(at(0), true));
+        assert!(!drop.admit(at(40), false));
+
+        // Two samples a second of 25 fps: frames 0 and 13 (0 ms and 520 ms) are the sampler's.
+        let mut unsampled = PressureValve::new(Backpressure::Unsampled {
+            samples_per_second: NonZeroU32::new(2).unwrap(),
+        })
+        .unwrap();
+        let kept: Vec<u64> = (0..25)
+            .filter(|frame| unsampled.admit(at(frame * 40), *frame == 5))
+            .collect();
+        assert_eq!(kept, vec![0, 5, 13]);
+        assert!(unsampled.admit(None, false));
+    }
+}
@@ -0,0 +1,104 @@
+//! Frame change detection on per-block luma sums computed next to the decoder.
+//!
+//! A backend that supports it (DXVA) sums the luma of every `BLOCK`-square block of the delivered
+//! picture. A frame whose block means all stay within `threshold` levels of the last frame it read
+//! back skips the readback; it is delivered with that frame's planes and marked with
+//! `VideoFrame::repeats_previous`, so downstream stages can reuse what they computed for it.
+
+/// Side of the blocks the backend sums over, in pixels of the delivered picture.
+pub const BLOCK: u32 = 16;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ChangeDetection {
+    /// Largest change of any block's mean luma, in 8-bit levels, that still counts as unchanged.
+    pub threshold: u8,
+}
+
+/// Block luma sums of one `width`x`height` picture, row-major.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct BlockSignature {
+    width: u32,
+    height: u32,
+    sums: Vec<u32>,
+}
+
+impl BlockSignature {
+    /// Number of sums a `width`x`height` picture has; blocks on the right and bottom edges are partial.
+    pub fn block_count(width: u32, height: u32) -> usize {
+        width.div_ceil(BLOCK) as usize * height.div_ceil(BLOCK) as usize
+    }
+
+    pub fn new(width: u32, height: u32, sums: &[u32]) -> Self {
+        Self {
+            width,
+            height,
+            sums: sums.to_vec(),
+        }
+    }
+}
+
+impl ChangeDetection {
+    /// Whether `current` differs from `reference` enough to be read back. Pictures of another size
+    /// always do.
+    pub fn changed(&self, reference: &BlockSignature, current: &BlockSignature) -> bool {
+        if reference.width != current.width
+            || reference.height != current.height
+            || reference.sums.len() != current.sums.len()
+        {
+            return true;
+        }
+        let columns = current.width.div_ceil(BLOCK).max(1) as usize;
+        let threshold = u64::from(self.threshold);
+        reference
+            .sums
+            .iter()
+            .zip(&current.sums)
+            .enumerate()
+            .any(|(block, (&before, &after))| {
+                let x = (block % columns) as u32 * BLOCK;
+                let y = (block / columns) as u32 * BLOCK;
+                let pixels =
+                    u64::from(BLOCK.min(current.width - x) * BLOCK.min(current.height - y));
+                u64::from(before.abs_diff(after)) > threshold * pixels
+            })
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const DETECTION: ChangeDetection = ChangeDetection { threshold: 2 };
+
+    fn uniform(width: u32, height: u32, level: u32) -> BlockSignature {
+        let columns = width.div_ceil(BLOCK);
+        let sums: Vec<u32> = (0..BlockSignature::block_count(width, height))
+            .map(|block| {
+                let x = (block as u32 % columns) * BLOCK;
+                let y = (block as u32 / columns) * BLOCK;
+                level * BLOCK.min(width - x) * BLOCK.min(height - y)
+            })
+            .collect();
+        BlockSignature::new(width, height, &sums)
+    }
+
+    #[test]
+    fn small_drift_is_unchanged_and_one_block_is_enough_to_change() {
+        let reference = uniform(40, 20, 100);
+        assert_eq!(BlockSignature::block_count(40, 20), 6);
+        assert!(!DETECTION.changed(&reference, &uniform(40, 20, 102)));
+        assert!(DETECTION.changed(&reference, &uniform(40, 20, 103)));
+
+        let mut sums = reference.sums.clone();
+        // The partial bottom-right block holds 8x4 pixels.
+        sums[5] += 3 * 32;
+        assert!(DETECTION.changed(&reference, &BlockSignature::new(40, 20, &sums)));
+        sums[5] -= 32;
+        assert!(!DETECTION.changed(&reference, &BlockSignature::new(40, 20, &sums)));
+    }
+
+    #[test]
+    fn another_picture_size_is_a_change() {
+        assert!(DETECTION.changed(&uniform(32, 32, 90), &uniform(48, 32, 90)));
+    }
+}
@@ -1,17 +1,24 @@
 use std::env;
 use std::fmt;
-use std::num::NonZeroUsize;
+use std::num::{NonZeroU32, NonZeroUsize};
 use std::path::PathBuf;
 use std::str::FromStr;
+use std::time::Duration;
 
 #[cfg(feature = "backend-ffmpeg")]
 use std::sync::OnceLock;
 
-use crate::core::{DecoderError, DecoderProvider, DecoderResult, DynDecoderProvider};
+use crate::backpressure::Backpressure;
+use crate::change::ChangeDetection;
+use crate::core::{DecoderError, DecoderProvider, DecoderResult, DynDecoderProvider, RoiConfig};
+use crate::gate::LumaGate;
+use crate::luma_cache::LumaCacheConfig;
 
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
 pub enum Backend {
     Mock,
+    /// Replays the ROI luma cache recorded by an earlier decode of the input.
+    LumaCache,
     #[cfg(feature = "backend-ffmpeg")]
     FFmpeg,
     #[cfg(all(feature = "backend-videotoolbox", target_os = "macos"))]
@@ -27,6 +34,12 @@ pub enum OutputFormat {
     #[default]
     Nv12,
     CVPixelBuffer,
+    /// NV12 frames whose UV plane is left empty (zero stride), for consumers that only read
+    /// `y_plane()`. VideoToolbox still delivers full NV12.
+    Luma,
+    /// Native frames holding a shared NV12 `ID3D11Texture2D` that stays on the GPU, for renderers
+    /// that sample it directly. DXVA only.
+    D3D11Texture,
 }
 
 impl OutputFormat {
@@ -34,16 +47,70 @@ impl OutputFormat {
         match self {
             OutputFormat::Nv12 => "nv12",
             OutputFormat::CVPixelBuffer => "cvpixelbuffer",
+            OutputFormat::Luma => "luma",
+            OutputFormat::D3D11Texture => "d3d11texture",
         }
     }
 }
 
+/// How much of the stream a backend emits.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum ScanMode {
+    #[default]
+    Full,
+    /// Seek keyframe to keyframe, emitting roughly one frame per `interval` with its true pts/index.
+    /// Only the DXVA and MFT backends support it.
+    Keyframes { interval: Duration },
+}
+
+impl ScanMode {
+    pub fn as_str(&self) -> &'static str {
+        match self {
+            ScanMode::Full => "full",
+            ScanMode::Keyframes { .. } => "keyframes",
+        }
+    }
+
+    /// Interval handed to the bridges; `None` decodes every frame.
+    pub fn keyframe_interval(&self) -> Option<Duration> {
+        match self {
+            ScanMode::Full => None,
+            ScanMode::Keyframes { interval } => Some(*interval),
+        }
+    }
+}
+
+/// Read-ahead byte stream the DXVA/MFT source reader demuxes from instead of opening the path, for
+/// inputs on network shares or slow disks. A worker thread reads `window_bytes` ahead of the
+/// demuxer in large sequential requests; a seek restarts it at the new position.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Prefetch {
+    pub window_bytes: NonZeroU32,
+    /// Read local files from a memory mapping, with prefetch hints a window ahead, instead of
+    /// buffering them; network paths are always buffered.
+    pub memory_map: bool,
+}
+
+impl Prefetch {
+    pub const DEFAULT_WINDOW_MIB: u32 = 32;
+
+    /// `None` unless the window fits the bridges' 32-bit byte count.
+    pub fn from_mib(window_mib: NonZeroU32, memory_map: bool) -> Option<Self> {
+        let window_bytes = window_mib.get().checked_mul(1 << 20)?;
+        Some(Self {
+            window_bytes: NonZeroU32::new(window_bytes)?,
+            memory_map,
+        })
+    }
+}
+
 impl FromStr for Backend {
     type Err = DecoderError;
 
     fn from_str(s: &str) -> Result<Self, Self::Err> {
         match s.to_ascii_lowercase().as_str() {
             "mock" => Ok(Backend::Mock),
+            "luma-cache" => Ok(Backend::LumaCache),
             #[cfg(feature = "backend-ffmpeg")]
             "ffmpeg" => Ok(Backend::FFmpeg),
             #[cfg(all(feature = "backend-videotoolbox", target_os = "macos"))]
@@ -63,6 +130,7 @@ impl Backend {
     pub fn as_str(&self) -> &'static str {
         match self {
             Backend::Mock => "mock",
+            Backend::LumaCache => "luma-cache",
             #[cfg(feature = "backend-ffmpeg")]
             Backend::FFmpeg => "ffmpeg",
             #[cfg(all(feature = "backend-videotoolbox", target_os = "macos"))]
@@ -143,6 +211,48 @@ pub struct Configuration {
     pub channel_capacity: Option<NonZeroUsize>,
     pub output_format: OutputFormat,
     pub start_frame: Option<u64>,
+    /// Number of GPU staging textures cycled during readback (DXVA only).
+    pub readback_depth: Option<NonZeroUsize>,
+    /// Detection sampling rate; when set, DXVA/MFT skip readback of frames the sampler would drop.
+    pub samples_per_second: Option<NonZeroU32>,
+    /// Normalized source region to read back; DXVA copies only this band off the GPU and tags
+    /// frames with their `FrameCrop`. Other backends ignore it and deliver full frames.
+    pub crop: Option<RoiConfig>,
+    /// Frames the consumer keeps alive past the channel (e.g. sampler history). DXVA/MFT recycle up
+    /// to channel capacity plus this many NV12 buffers.
+    pub retained_frames: Option<NonZeroUsize>,
+    pub scan: ScanMode,
+    /// Parallel source readers for one file (DXVA/MFT). Each decodes every n-th short frame range
+    /// and the stream is merged back in order; the controller of a segmented stream refuses seeks.
+    pub decode_workers: Option<NonZeroUsize>,
+    /// ReadSample requests kept in flight by the DXVA/MFT async source reader; `None` keeps the
+    /// synchronous reader.
+    pub read_ahead: Option<NonZeroUsize>,
+    /// GPU luma pre-filter (DXVA). Frames with no plausible subtitle band in the delivered picture
+    /// skip readback and arrive without pixels, carrying their detection result. Others ignore it.
+    pub luma_gate: Option<LumaGate>,
+    /// Source height to resample to on the GPU before readback (DXVA); the crop band scales by the same
+    /// factor and frames keep the covered source area in their `FrameCrop`. Others ignore it.
+    pub scale_height: Option<NonZeroU32>,
+    /// Frames DXVA/MFT hand over per channel item; the bridge then also polls for seeks once per batch
+    /// instead of once per sample. Frames wait until their batch fills, so leave it unset for playback.
+    pub delivery_batch: Option<NonZeroUsize>,
+    /// Directory for per-file frame indexes (DXVA/MFT). A full sequential decode records every frame's
+    /// pts and keyframe flag there; later opens of the unchanged file seek and number frames from it.
+    pub index_cache: Option<PathBuf>,
+    /// GPU change detection (DXVA). Frames whose delivered picture matches the last one read back
+    /// block for block skip readback and arrive as repeats sharing its planes. Others ignore it.
+    pub change_detection: Option<ChangeDetection>,
+    /// Read-ahead byte stream for the DXVA/MFT source reader; `None` lets Media Foundation read the
+    /// file itself. Others ignore it.
+    pub prefetch: Option<Prefetch>,
+    /// ROI luma cache. Other backends record it while decoding from the first frame; the
+    /// `luma-cache` backend replays it.
+    pub luma_cache: Option<LumaCacheConfig>,
+    /// What DXVA/MFT do with a decoded sample while the channel is full. Segmented decodes must
+    /// block so their chunks join up, so `create_provider` rejects any other policy with
+    /// `decode_workers` above one. Others ignore it.
+    pub backpressure: Backpressure,
 }
 
 impl Default for Configuration {
@@ -157,6 +267,21 @@ impl Default for Configuration {
             channel_capacity: None,
             output_format: OutputFormat::Nv12,
             start_frame: None,
+            readback_depth: None,
+            samples_per_second: None,
+            crop: None,
+            retained_frames: None,
+            scan: ScanMode::Full,
+            decode_workers: None,
+            read_ahead: None,
+            luma_gate: None,
+            scale_height: None,
+            delivery_batch: None,
+            index_cache: None,
+            change_detection: None,
+            prefetch: None,
+            luma_cache: None,
+            backpressure: Backpressure::Block,
         }
     }
 }
@@ -191,6 +316,115 @@ impl Configuration {
             })?;
             config.start_frame = Some(parsed);
         }
+        if let Ok(depth) = env::var("SUBFAST_READBACK_DEPTH") {
+            let parsed: usize = depth.parse().map_err(|_| {
+                DecoderError::configuration(format!(
+                    "failed to parse SUBFAST_READBACK_DEPTH='{depth}' as a positive integer"
+                ))
+            })?;
+            let Some(value) = NonZeroUsize::new(parsed) else {
+                return Err(DecoderError::configuration(
+                    "SUBFAST_READBACK_DEPTH must be greater than zero",
+                ));
+            };
+            config.readback_depth = Some(value);
+        }
+        if let Ok(workers) = env::var("SUBFAST_DECODE_WORKERS") {
+            let parsed: usize = workers.parse().map_err(|_| {
+                DecoderError::configuration(format!(
+                    "failed to parse SUBFAST_DECODE_WORKERS='{workers}' as a positive integer"
+                ))
+            })?;
+            let Some(value) = NonZeroUsize::new(parsed) else {
+                return Err(DecoderError::configuration(
+                    "SUBFAST_DECODE_WORKERS must be greater than zero",
+                ));
+            };
+            config.decode_workers = Some(value);
+        }
+        if let Ok(read_ahead) = env::var("SUBFAST_READ_AHEAD") {
+            let parsed: usize = read_ahead.parse().map_err(|_| {
+                DecoderError::configuration(format!(
+                    "failed to parse SUBFAST_READ_AHEAD='{read_ahead}' as a positive integer"
+                ))
+            })?;
+            let Some(value) = NonZeroUsize::new(parsed) else {
+                return Err(DecoderError::configuration(
+                    "SUBFAST_READ_AHEAD must be greater than zero",
+                ));
+            };
+            config.read_ahead = Some(value);
+        }
+        if let Ok(height) = env::var("SUBFAST_SCALE_HEIGHT") {
+            let parsed: u32 = height.parse().map_err(|_| {
+                DecoderError::configuration(format!(
+                    "failed to parse SUBFAST_SCALE_HEIGHT='{height}' as a positive integer"
+                ))
+            })?;
+            let Some(value) = NonZeroU32::new(parsed) else {
+                return Err(DecoderError::configuration(
+                    "SUBFAST_SCALE_HEIGHT must be greater than zero",
+                ));
+            };
+            config.scale_height = Some(value);
+        }
+        if let Ok(batch) = env::var("SUBFAST_DELIVERY_BATCH") {
+            let parsed: usize = batch.parse().map_err(|_| {
+                DecoderError::configuration(format!(
+                    "failed to parse SUBFAST_DELIVERY_BATCH='{batch}' as a positive integer"
+                ))
+            })?;
+            let Some(value) = NonZeroUsize::new(parsed) else {
+                return Err(DecoderError::configuration(
+                    "SUBFAST_DELIVERY_BATCH must be greater than zero",
+                ));
+            };
+            config.delivery_batch = Some(value);
+        }
+        if let Ok(path) = env::var("SUBFAST_INDEX_CACHE") {
+            config.index_cache = Some(PathBuf::from(path));
+        }
+        if let Ok(threshold) = env::var("SUBFAST_CHANGE_THRESHOLD") {
+            let parsed: u8 = threshold.parse().map_err(|_| {
+                DecoderError::configuration(format!(
+                    "failed to parse SUBFAST_CHANGE_THRESHOLD='{threshold}' as a luma level (0-255)"
+                ))
+            })?;
+            config.change_detection = Some(ChangeDetection { threshold: parsed });
+        }
+        let memory_map = match env::var("SUBFAST_PREFETCH_MAP") {
+            Ok(value) => match value.to_ascii_lowercase().as_str() {
+                "1" | "true" | "yes" => true,
+                "0" | "false" | "no" => false,
+                _ => {
+                    return Err(DecoderError::configuration(format!(
+                        "failed to parse SUBFAST_PREFETCH_MAP='{value}' as a boolean"
+                    )));
+                }
+            },
+            Err(_) => false,
+        };
+        if let Ok(window) = env::var("SUBFAST_PREFETCH_MIB") {
+            let parsed: u32 = window.parse().map_err(|_| {
+                DecoderError::configuration(format!(
+                    "failed to parse SUBFAST_PREFETCH_MIB='{window}' as a positive integer"
+                ))
+            })?;
+            let Some(prefetch) =
+                NonZeroU32::new(parsed).and_then(|mib| Prefetch::from_mib(mib, memory_map))
+            else {
+                return Err(DecoderError::configuration(
+                    "SUBFAST_PREFETCH_MIB must be between 1 and 4095",
+                ));
+            };
+            config.prefetch = Some(prefetch);
+        } else if memory_map {
+            config.prefetch = NonZeroU32::new(Prefetch::DEFAULT_WINDOW_MIB)
+                .and_then(|mib| Prefetch::from_mib(mib, true));
+        }
+        if let Ok(policy) = env::var("SUBFAST_BACKPRESSURE") {
+            config.backpressure = policy.parse()?;
+        }
         Ok(config)
     }
 
@@ -200,6 +434,14 @@ impl Configuration {
 
     pub fn create_provider(&self) -> DecoderResult<DynDecoderProvider> {
         self.validate_output_format()?;
+        self.validate_scan_mode()?;
+        self.validate_backpressure()?;
+
+        if self.luma_cache.is_some() && self.backend != Backend::LumaCache {
+            return Ok(Box::new(
+                crate::backends::luma_cache::RecordingProvider::new(self)?,
+            ));
+        }
 
         match self.backend {
             Backend::Mock => {
@@ -209,6 +451,9 @@ impl Configuration {
                     Ok(Box::new(crate::backends::mock::MockProvider::new(self)?))
                 }
             }
+            Backend::LumaCache => Ok(Box::new(
+                crate::backends::luma_cache::LumaCacheProvider::new(self)?,
+            )),
             #[cfg(feature = "backend-ffmpeg")]
             Backend::FFmpeg => Ok(Box::new(crate::backends::ffmpeg::FFmpegProvider::new(
                 self,
@@ -230,7 +475,7 @@ impl Configuration {
 impl Configuration {
     fn validate_output_format(&self) -> DecoderResult<()> {
         match self.output_format {
-            OutputFormat::Nv12 => Ok(()),
+            OutputFormat::Nv12 | OutputFormat::Luma => Ok(()),
             OutputFormat::CVPixelBuffer => {
                 #[cfg(all(feature = "backend-videotoolbox", target_os = "macos"))]
                 {
@@ -245,7 +490,58 @@ impl Configuration {
                     self.backend.as_str()
                 )))
             }
+            OutputFormat::D3D11Texture => {
+                #[cfg(all(feature = "backend-dxva", target_os = "windows"))]
+                {
+                    if self.backend == Backend::Dxva {
+                        return Ok(());
+                    }
+                }
+
+                Err(DecoderError::configuration(format!(
+                    "output format '{}' is only supported by dxva backend (selected: {})",
+                    self.output_format.as_str(),
+                    self.backend.as_str()
+                )))
+            }
+        }
+    }
+}
+
+impl Configuration {
+    fn validate_scan_mode(&self) -> DecoderResult<()> {
+        let ScanMode::Keyframes { interval } = self.scan else {
+            return Ok(());
+        };
+        if interval.is_zero() {
+            return Err(DecoderError::configuration(
+                "keyframe scan interval must be greater than zero",
+            ));
+        }
+        match self.backend {
+            #[cfg(all(feature = "backend-dxva", target_os = "windows"))]
+            Backend::Dxva => Ok(()),
+            #[cfg(all(feature = "backend-mft", target_os = "windows"))]
+            Backend::Mft => Ok(()),
+            other => Err(DecoderError::configuration(format!(
+                "scan mode '{}' is only supported by dxva and mft backends (selected: {})",
+                self.scan.as_str(),
+                other.as_str()
+            ))),
+        }
+    }
+}
+
+impl Configuration {
+    fn validate_backpressure(&self) -> DecoderResult<()> {
+        let segmented = self.decode_workers.is_some_and(|workers| workers.get() > 1);
+        if segmented && self.backpressure != Backpressure::Block {
+            return Err(DecoderError::configuration(format!(
+                "backpressure '{}' would drop frames a segmented decode needs; use 'block' or a single decode worker",
+                self.backpressure
+            )));
         }
+        Ok(())
     }
 }
 
@@ -1,6 +1,6 @@
 use std::pin::Pin;
-use std::sync::Arc;
 use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, Mutex};
 use std::time::Duration;
 
 use futures_core::Stream;
@@ -9,7 +9,8 @@ use tokio::sync::mpsc::{self, Sender};
 use tokio::sync::watch;
 
 pub use subtitle_fast_types::{
-    DecoderError, DecoderResult, FrameBuffer, NativeBuffer, Nv12Buffer, VideoFrame,
+    DecoderError, DecoderResult, FrameBuffer, FrameCrop, NativeBuffer, Nv12Buffer, PlaneRecycler,
+    RoiConfig, SubtitleDetectionResult, VideoFrame,
 };
 
 pub type FrameStream = Pin<Box<dyn Stream<Item = DecoderResult<VideoFrame>> + Send>>;
@@ -33,6 +34,9 @@ pub type SeekReceiver = watch::Receiver<Option<SeekInfo>>;
 pub struct DecoderController {
     seek_tx: watch::Sender<Option<SeekInfo>>,
     serial: Arc<AtomicU64>,
+    stats: Arc<DecoderStats>,
+    /// Cleared for decodes that cannot follow a seek, e.g. segmented ones; `seek` then fails.
+    seekable: bool,
 }
 
 impl Default for DecoderController {
@@ -47,9 +51,23 @@ impl DecoderController {
         Self {
             seek_tx,
             serial: Arc::new(AtomicU64::new(0)),
+            stats: Arc::new(DecoderStats::default()),
+            seekable: true,
         }
     }
 
+    /// Called for segmented DXVA/MFT decodes, whose workers seek only between their own chunks.
+    #[cfg_attr(
+        not(any(
+            all(target_os = "windows", feature = "backend-dxva"),
+            all(target_os = "windows", feature = "backend-mft")
+        )),
+        allow(dead_code)
+    )]
+    pub(crate) fn refuse_seeks(&mut self) {
+        self.seekable = false;
+    }
+
     pub(crate) fn seek_receiver(&self) -> SeekReceiver {
         self.seek_tx.subscribe()
     }
@@ -58,11 +76,25 @@ impl DecoderController {
         Arc::clone(&self.serial)
     }
 
+    /// Shared counters, e.g. for a UI that keeps polling them after handing the controller off.
+    pub fn stats_handle(&self) -> Arc<DecoderStats> {
+        Arc::clone(&self.stats)
+    }
+
     pub fn serial(&self) -> u64 {
         self.serial.load(Ordering::SeqCst)
     }
 
+    pub fn stats(&self) -> DecoderStatsSnapshot {
+        self.stats.snapshot()
+    }
+
     pub fn seek(&self, info: SeekInfo) -> DecoderResult<u64> {
+        if !self.seekable {
+            return Err(DecoderError::configuration(
+                "a segmented decode (decode_workers > 1) cannot seek; use a single worker",
+            ));
+        }
         let serial = self.serial.fetch_add(1, Ordering::SeqCst).wrapping_add(1);
         self.seek_tx
             .send(Some(info))
@@ -71,6 +103,257 @@ impl DecoderController {
     }
 }
 
+/// Stages of the decode loop timed by the hardware backends.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum DecodePhase {
+    /// `ReadSample`: demux and decode until the reader hands out the next sample.
+    Read,
+    /// Queueing the GPU work for a frame: scaling, the gate pass and `CopySubresourceRegion`.
+    Copy,
+    /// Blocked in `Map` (MFT: the buffer lock) until the frame's memory is readable.
+    Map,
+    /// Copying plane rows into CPU memory.
+    Memcpy,
+    /// Handing frames to the stream, including time blocked on a full channel.
+    Deliver,
+}
+
+impl DecodePhase {
+    pub const ALL: [DecodePhase; 5] = [
+        DecodePhase::Read,
+        DecodePhase::Copy,
+        DecodePhase::Map,
+        DecodePhase::Memcpy,
+        DecodePhase::Deliver,
+    ];
+
+    pub fn as_str(self) -> &'static str {
+        match self {
+            DecodePhase::Read => "read",
+            DecodePhase::Copy => "copy",
+            DecodePhase::Map => "map",
+            DecodePhase::Memcpy => "memcpy",
+            DecodePhase::Deliver => "deliver",
+        }
+    }
+}
+
+/// Histogram buckets per phase: bucket `i` counts samples shorter than `2^i` microseconds and the
+/// last one everything longer.
+pub const PHASE_BUCKETS: usize = 20;
+
+#[derive(Debug, Default)]
+struct PhaseCounter {
+    count: AtomicU64,
+    total_ns: AtomicU64,
+    max_ns: AtomicU64,
+    buckets: [AtomicU64; PHASE_BUCKETS],
+}
+
+impl PhaseCounter {
+    #[cfg_attr(
+        not(any(
+            all(target_os = "windows", feature = "backend-dxva"),
+            all(target_os = "windows", feature = "backend-mft")
+        )),
+        allow(dead_code)
+    )]
+    fn record(&self, elapsed: Duration) {
+        let nanos = u64::try_from(elapsed.as_nanos()).unwrap_or(u64::MAX);
+        let micros = nanos / 1_000;
+        let bucket = (u64::BITS - micros.leading_zeros()) as usize;
+        self.count.fetch_add(1, Ordering::Relaxed);
+        self.total_ns.fetch_add(nanos, Ordering::Relaxed);
+        self.max_ns.fetch_max(nanos, Ordering::Relaxed);
+        self.buckets[bucket.min(PHASE_BUCKETS - 1)].fetch_add(1, Ordering::Relaxed);
+    }
+
+    fn snapshot(&self) -> PhaseStats {
+        PhaseStats {
+            count: self.count.load(Ordering::Relaxed),
+            total: Duration::from_nanos(self.total_ns.load(Ordering::Relaxed)),
+            max: Duration::from_nanos(self.max_ns.load(Ordering::Relaxed)),
+            histogram: std::array::from_fn(|bucket| self.buckets[bucket].load(Ordering::Relaxed)),
+        }
+    }
+}
+
+/// Counters updated by the decode thread while a stream is running.
+#[derive(Debug, Default)]
+pub struct DecoderStats {
+    phases: [PhaseCounter; DecodePhase::ALL.len()],
+    /// Frames per GPU adapter, in the order the run first used them.
+    adapters: Mutex<Vec<(String, Arc<AtomicU64>)>>,
+    prefetch: PrefetchCounter,
+    dropped: AtomicU64,
+}
+
+#[derive(Debug, Default)]
+struct PrefetchCounter {
+    bytes_read: AtomicU64,
+    hits: AtomicU64,
+    misses: AtomicU64,
+}
+
+// Fed by the DXVA and MFT decode loops; the other backends report no phase timings.
+#[cfg_attr(
+    not(any(
+        all(target_os = "windows", feature = "backend-dxva"),
+        all(target_os = "windows", feature = "backend-mft")
+    )),
+    allow(dead_code)
+)]
+impl DecoderStats {
+    pub(crate) fn record(&self, phase: DecodePhase, elapsed: Duration) {
+        self.phases[phase as usize].record(elapsed);
+    }
+
+    /// Records a duration reported by a bridge; negative or non-finite values mean "not measured".
+    pub(crate) fn record_seconds(&self, phase: DecodePhase, seconds: f64) {
+        if seconds.is_finite() && seconds >= 0.0 {
+            self.record(phase, Duration::from_secs_f64(seconds));
+        }
+    }
+
+    /// Prefetch stream activity a bridge reported with a frame.
+    pub(crate) fn record_prefetch(&self, bytes_read: u64, hits: u64, misses: u64) {
+        let prefetch = &self.prefetch;
+        prefetch.bytes_read.fetch_add(bytes_read, Ordering::Relaxed);
+        prefetch.hits.fetch_add(hits, Ordering::Relaxed);
+        prefetch.misses.fetch_add(misses, Ordering::Relaxed);
+    }
+
+    /// A decoded sample the backpressure policy dropped instead of reading back.
+    pub(crate) fn record_dropped(&self) {
+        self.dropped.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+impl DecoderStats {
+    /// Frame counter for `adapter`, shared by every reader of this run that decodes on it.
+    pub(crate) fn adapter_counter(&self, adapter: &str) -> Arc<AtomicU64> {
+        let mut adapters = self
+            .adapters
+            .lock()
+            .unwrap_or_else(|poisoned| poisoned.into_inner());
+        if let Some((_, counter)) = adapters.iter().find(|(name, _)| name == adapter) {
+            return counter.clone();
+        }
+        let counter = Arc::new(AtomicU64::new(0));
+        adapters.push((adapter.to_string(), counter.clone()));
+        counter
+    }
+
+    pub fn snapshot(&self) -> DecoderStatsSnapshot {
+        let adapters = self
+            .adapters
+            .lock()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+            .iter()
+            .map(|(name, frames)| AdapterUsage {
+                name: name.clone(),
+                frames: frames.load(Ordering::Relaxed),
+            })
+            .collect();
+        DecoderStatsSnapshot {
+            phases: std::array::from_fn(|phase| self.phases[phase].snapshot()),
+            adapters,
+            prefetch: PrefetchStats {
+                bytes_read: self.prefetch.bytes_read.load(Ordering::Relaxed),
+                hits: self.prefetch.hits.load(Ordering::Relaxed),
+                misses: self.prefetch.misses.load(Ordering::Relaxed),
+            },
+            dropped_frames: self.dropped.load(Ordering::Relaxed),
+        }
+    }
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub struct PhaseStats {
+    pub count: u64,
+    pub total: Duration,
+    pub max: Duration,
+    /// Sample counts per bucket, see [`PHASE_BUCKETS`].
+    pub histogram: [u64; PHASE_BUCKETS],
+}
+
+impl PhaseStats {
+    pub fn average(&self) -> Option<Duration> {
+        if self.count == 0 {
+            return None;
+        }
+        let count = u32::try_from(self.count).unwrap_or(u32::MAX);
+        Some(self.total / count)
+    }
+
+    /// Upper edge of the bucket holding quantile `q`, so accurate to a factor of two.
+    pub fn quantile(&self, q: f64) -> Option<Duration> {
+        if self.count == 0 {
+            return None;
+        }
+        let rank = ((q.clamp(0.0, 1.0) * self.count as f64).ceil() as u64).max(1);
+        let mut seen = 0u64;
+        for (bucket, &count) in self.histogram.iter().enumerate() {
+            seen += count;
+            if seen >= rank && bucket + 1 < PHASE_BUCKETS {
+                return Some(Duration::from_micros(1 << bucket).min(self.max));
+            }
+        }
+        Some(self.max)
+    }
+}
+
+/// Frames one GPU adapter decoded for a run.
+#[derive(Debug, Clone, PartialEq, Eq, Default)]
+pub struct AdapterUsage {
+    pub name: String,
+    pub frames: u64,
+}
+
+/// Reads of a `Prefetch` byte stream: demuxer requests served from the read-ahead (hits) or left
+/// waiting on the file (misses), and the bytes read from the file for them.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub struct PrefetchStats {
+    pub bytes_read: u64,
+    pub hits: u64,
+    pub misses: u64,
+}
+
+impl PrefetchStats {
+    /// `None` when no prefetch stream was read.
+    pub fn hit_rate(&self) -> Option<f64> {
+        let requests = self.hits + self.misses;
+        (requests > 0).then(|| self.hits as f64 / requests as f64)
+    }
+}
+
+#[derive(Debug, Clone, PartialEq, Eq, Default)]
+pub struct DecoderStatsSnapshot {
+    /// Indexed by `DecodePhase`; phases a backend does not have stay empty.
+    pub phases: [PhaseStats; DecodePhase::ALL.len()],
+    /// Adapters the run's readers were scheduled on; empty for backends without adapter scheduling.
+    pub adapters: Vec<AdapterUsage>,
+    /// Summed over every reader of the run; zero unless it decoded with `Configuration::prefetch`.
+    pub prefetch: PrefetchStats,
+    /// Samples dropped before readback under a `Backpressure` policy other than `Block`.
+    pub dropped_frames: u64,
+}
+
+impl DecoderStatsSnapshot {
+    pub fn phase(&self, phase: DecodePhase) -> &PhaseStats {
+        &self.phases[phase as usize]
+    }
+
+    /// Frames read back from GPU or decoder memory.
+    pub fn readback_frames(&self) -> u64 {
+        self.phase(DecodePhase::Map).count
+    }
+
+    pub fn average_readback_wait(&self) -> Option<Duration> {
+        self.phase(DecodePhase::Map).average()
+    }
+}
+
 #[derive(Debug, Clone, Copy, PartialEq, Default)]
 pub struct VideoMetadata {
     pub duration: Option<Duration>,
@@ -138,6 +421,117 @@ pub fn spawn_stream_from_channel(
     Box::pin(stream)
 }
 
+/// Sending half handed to blocking decode loops. A batched sink queues frames and sends them as one channel
+/// item once `batch` are ready (errors go out at once); clones share the channel but start with an empty batch.
+pub struct FrameSink {
+    channel: SinkChannel,
+    pending: Vec<DecoderResult<VideoFrame>>,
+    batch: usize,
+}
+
+enum SinkChannel {
+    Single(Sender<DecoderResult<VideoFrame>>),
+    Batched(Sender<Vec<DecoderResult<VideoFrame>>>),
+}
+
+impl FrameSink {
+    pub fn new(tx: Sender<DecoderResult<VideoFrame>>) -> Self {
+        Self {
+            channel: SinkChannel::Single(tx),
+            pending: Vec::new(),
+            batch: 1,
+        }
+    }
+
+    /// Frames per channel item; 1 for an unbatched sink.
+    pub fn batch(&self) -> usize {
+        self.batch
+    }
+
+    pub fn is_closed(&self) -> bool {
+        match &self.channel {
+            SinkChannel::Single(tx) => tx.is_closed(),
+            SinkChannel::Batched(tx) => tx.is_closed(),
+        }
+    }
+
+    /// Whether `send` would return without waiting for the consumer.
+    pub fn has_room(&self) -> bool {
+        match &self.channel {
+            SinkChannel::Single(tx) => tx.capacity() > 0,
+            SinkChannel::Batched(tx) => self.pending.len() + 1 < self.batch || tx.capacity() > 0,
+        }
+    }
+
+    /// Returns false once the receiving stream is gone.
+    pub fn send(&mut self, item: DecoderResult<VideoFrame>) -> bool {
+        let tx = match &self.channel {
+            SinkChannel::Single(tx) => return tx.blocking_send(item).is_ok(),
+            SinkChannel::Batched(tx) => tx,
+        };
+        let urgent = item.is_err();
+        self.pending.push(item);
+        if !urgent && self.pending.len() < self.batch {
+            return !tx.is_closed();
+        }
+        self.flush()
+    }
+
+    /// Sends the queued frames now, e.g. before a seek or when the decode loop returns.
+    pub fn flush(&mut self) -> bool {
+        let SinkChannel::Batched(tx) = &self.channel else {
+            return !self.is_closed();
+        };
+        if self.pending.is_empty() {
+            return !tx.is_closed();
+        }
+        let batch = std::mem::replace(&mut self.pending, Vec::with_capacity(self.batch));
+        tx.blocking_send(batch).is_ok()
+    }
+}
+
+impl Clone for FrameSink {
+    fn clone(&self) -> Self {
+        let channel = match &self.channel {
+            SinkChannel::Single(tx) => SinkChannel::Single(tx.clone()),
+            SinkChannel::Batched(tx) => SinkChannel::Batched(tx.clone()),
+        };
+        Self {
+            channel,
+            pending: Vec::new(),
+            batch: self.batch,
+        }
+    }
+}
+
+/// Like `spawn_stream_from_channel`, but the task's frames cross the channel `batch` at a time.
+pub fn spawn_batched_stream(
+    capacity: usize,
+    batch: usize,
+    task: impl FnOnce(FrameSink) + Send + 'static,
+) -> FrameStream {
+    let batch = batch.max(1);
+    let (tx, rx) = mpsc::channel(capacity.div_ceil(batch).max(1));
+    let sink = FrameSink {
+        channel: SinkChannel::Batched(tx),
+        pending: Vec::with_capacity(batch),
+        batch,
+    };
+    tokio::task::spawn_blocking(move || task(sink));
+    let stream = unfold(
+        (rx, Vec::new().into_iter()),
+        |(mut receiver, mut ready)| async move {
+            loop {
+                if let Some(item) = ready.next() {
+                    return Some((item, (receiver, ready)));
+                }
+                ready = receiver.recv().await?.into_iter();
+            }
+        },
+    );
+    Box::pin(stream)
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -167,6 +561,88 @@ mod tests {
         assert_eq!(frame.index(), None);
     }
 
+    #[test]
+    fn decoder_stats_track_phases() {
+        let controller = DecoderController::new();
+        let stats = controller.stats_handle();
+        stats.record(DecodePhase::Map, Duration::from_millis(2));
+        stats.record(DecodePhase::Map, Duration::from_millis(6));
+        stats.record_seconds(DecodePhase::Read, 0.000_5);
+        stats.record_seconds(DecodePhase::Read, f64::NAN);
+        let snapshot = controller.stats();
+        let map = snapshot.phase(DecodePhase::Map);
+        assert_eq!(map.count, 2);
+        assert_eq!(map.total, Duration::from_millis(8));
+        assert_eq!(map.max, Duration::from_millis(6));
+        assert_eq!(snapshot.readback_frames(), 2);
+        assert_eq!(
+            snapshot.average_readback_wait(),
+            Some(Duration::from_millis(4))
+        );
+        // 2ms lands in the bucket ending at 2048us, 6ms in the one ending at 8192us.
+        assert_eq!(map.quantile(0.5), Some(Duration::from_micros(2048)));
+        assert_eq!(map.quantile(1.0), Some(Duration::from_millis(6)));
+        assert_eq!(snapshot.phase(DecodePhase::Read).count, 1);
+        assert_eq!(snapshot.phase(DecodePhase::Deliver).quantile(0.9), None);
+        assert_eq!(snapshot.prefetch.hit_rate(), None);
+    }
+
+    #[test]
+    fn decoder_stats_sum_prefetch_reports() {
+        let controller = DecoderController::new();
+        let stats = controller.stats_handle();
+        stats.record_prefetch(8 << 20, 30, 1);
+        stats.record_prefetch(0, 9, 0);
+        let prefetch = controller.stats().prefetch;
+        assert_eq!(prefetch.bytes_read, 8 << 20);
+        assert_eq!((prefetch.hits, prefetch.misses), (39, 1));
+        assert_eq!(prefetch.hit_rate(), Some(0.975));
+    }
+
+    #[test]
+    fn frame_sink_has_room_until_the_channel_fills() {
+        let frame = || VideoFrame::from_luma_owned(2, 2, 2, None, None, vec![0; 4]);
+        let (tx, mut rx) = mpsc::channel(1);
+        let mut sink = FrameSink::new(tx);
+        assert!(sink.has_room());
+        assert!(sink.send(frame()));
+        assert!(!sink.has_room());
+        rx.try_recv().unwrap().unwrap();
+        assert!(sink.has_room());
+
+        // A batched sink has room while its batch is filling, whatever the channel holds.
+        let (tx, _rx) = mpsc::channel(1);
+        let mut sink = FrameSink {
+            channel: SinkChannel::Batched(tx),
+            pending: Vec::new(),
+            batch: 2,
+        };
+        assert!(sink.send(frame()) && sink.send(frame()));
+        assert!(sink.has_room());
+        assert!(sink.send(frame()));
+        assert!(!sink.has_room());
+    }
+
+    #[test]
+    fn controller_refusing_seeks_reports_them() {
+        let mut controller = DecoderController::new();
+        let mut seeks = controller.seek_receiver();
+        let info = SeekInfo::Frame {
+            frame: 10,
+            mode: SeekMode::Accurate,
+        };
+        assert_eq!(controller.seek(info).unwrap(), 1);
+        seeks.borrow_and_update();
+
+        controller.refuse_seeks();
+        assert!(matches!(
+            controller.seek(info),
+            Err(DecoderError::Configuration { .. })
+        ));
+        assert!(!seeks.has_changed().unwrap());
+        assert_eq!(controller.serial(), 1);
+    }
+
     #[tokio::test(flavor = "multi_thread")]
     async fn spawn_stream_from_channel_pushes_values() {
         let stream = spawn_stream_from_channel(2, move |tx| {
@@ -187,4 +663,28 @@ mod tests {
         let frame = stream.next().await.unwrap().unwrap();
         assert_eq!(frame.data(), &[1, 2, 3, 4]);
     }
+
+    #[tokio::test(flavor = "multi_thread")]
+    async fn batched_stream_flattens_batches_in_order() {
+        let stream = spawn_batched_stream(8, 3, move |mut sink| {
+            for index in 0..7 {
+                let frame =
+                    VideoFrame::from_nv12_owned(2, 2, 2, 2, None, None, vec![0; 4], vec![128; 2])
+                        .unwrap()
+                        .with_index(Some(index));
+                assert!(sink.send(Ok(frame)));
+            }
+            // The last partial batch only goes out on flush.
+            assert!(sink.flush());
+            sink.send(Err(DecoderError::configuration("done")));
+        });
+        let items: Vec<_> = stream.collect().await;
+        assert_eq!(items.len(), 8);
+        let indices: Vec<u64> = items[..7]
+            .iter()
+            .map(|item| item.as_ref().unwrap().index().unwrap())
+            .collect();
+        assert_eq!(indices, (0..7).collect::<Vec<_>>());
+        assert!(items[7].is_err());
+    }
 }
@@ -0,0 +1,125 @@
+//! Luma pre-filter evaluated on per-row counts computed next to the decoder.
+//!
+//! A backend that supports it (DXVA) counts, for every row of the delivered picture, the pixels whose
+//! luma lies in `target ± delta`. Only frames whose counts could hold a subtitle band are read back;
+//! the rest are delivered through `VideoFrame::from_detection` without pixels. The rule is kept
+//! looser than the CPU detectors so it only rejects frames they would find empty.
+
+use crate::core::SubtitleDetectionResult;
+
+/// Rows with fewer in-band pixels count as empty.
+const MIN_ROW_PIXELS: u32 = 2;
+/// Empty rows tolerated inside one band; matches the detectors' vertical gap bridging.
+const MAX_ROW_GAP: usize = 12;
+/// Shortest band, in rows, that can still become a detected region.
+const MIN_BAND_ROWS: usize = 8;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct LumaGate {
+    pub target: u8,
+    pub delta: u8,
+}
+
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct GateVerdict {
+    pub passed: bool,
+    /// In-band pixel density of the strongest band, 0 when there is none.
+    pub score: f32,
+}
+
+impl GateVerdict {
+    /// Detection result handed downstream for a frame the gate rejected.
+    pub fn into_detection(self) -> SubtitleDetectionResult {
+        SubtitleDetectionResult {
+            max_score: self.score,
+            ..SubtitleDetectionResult::empty()
+        }
+    }
+}
+
+impl LumaGate {
+    /// Inclusive luma range counted by the backend, saturating like the detectors' masks.
+    pub fn range(&self) -> (u8, u8) {
+        (
+            self.target.saturating_sub(self.delta),
+            self.target.saturating_add(self.delta),
+        )
+    }
+
+    /// `rows[y]` is the number of in-band pixels in row `y` of a `width`-pixel-wide picture.
+    pub fn evaluate(&self, rows: &[u32], width: u32) -> GateVerdict {
+        let width = width.max(1) as f32;
+        let mut passed = false;
+        let mut score = 0f32;
+        let mut band: Option<(usize, usize, u64)> = None;
+        let mut close = |start: usize, end: usize, mass: u64| {
+            let rows = end - start;
+            let density = mass as f32 / (rows as f32 * width);
+            if rows >= MIN_BAND_ROWS {
+                passed = true;
+                score = score.max(density);
+            }
+        };
+        for (y, &count) in rows.iter().enumerate() {
+            if count < MIN_ROW_PIXELS {
+                continue;
+            }
+            band = match band {
+                Some((start, end, mass)) if y - end <= MAX_ROW_GAP => {
+                    Some((start, y + 1, mass + u64::from(count)))
+                }
+                Some((start, end, mass)) => {
+                    close(start, end, mass);
+                    Some((y, y + 1, u64::from(count)))
+                }
+                None => Some((y, y + 1, u64::from(count))),
+            };
+        }
+        if let Some((start, end, mass)) = band {
+            close(start, end, mass);
+        }
+        GateVerdict { passed, score }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const GATE: LumaGate = LumaGate {
+        target: 230,
+        delta: 12,
+    };
+
+    #[test]
+    fn rejects_frames_without_a_tall_enough_band() {
+        let mut rows = vec![0u32; 100];
+        for row in &mut rows[40..45] {
+            *row = 300;
+        }
+        rows[90] = 1;
+        let verdict = GATE.evaluate(&rows, 1920);
+        assert!(!verdict.passed);
+        assert!(!verdict.into_detection().has_subtitle);
+    }
+
+    #[test]
+    fn bridges_short_gaps_between_text_rows() {
+        let mut rows = vec![0u32; 100];
+        for y in (20..40).step_by(5) {
+            rows[y] = 100;
+        }
+        let verdict = GATE.evaluate(&rows, 1000);
+        assert!(verdict.passed);
+        assert!(verdict.score > 0.0);
+    }
+
+    #[test]
+    fn range_saturates() {
+        let gate = LumaGate {
+            target: 250,
+            delta: 12,
+        };
+        assert_eq!(gate.range(), (238, 255));
+    }
+}
@@ -0,0 +1,424 @@
+//! Frame index recorded during a full decode and cached on disk per input file.
+//!
+//! The bridges only know the nominal frame rate, which misnumbers variable-rate files and says
+//! nothing about where keyframes are. One complete sequential decode records every frame's pts and
+//! clean-point flag. The index is stored under the configured cache directory, keyed by the input's
+//! path, length and modification time, and later opens of the unchanged file seek from it.
+
+use std::fs;
+use std::io;
+use std::path::{Path, PathBuf};
+use std::sync::Arc;
+use std::time::{Duration, UNIX_EPOCH};
+
+const MAGIC: &[u8; 4] = b"SFIX";
+const VERSION: u32 = 1;
+
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct FrameIndex {
+    /// Presentation timestamps in frame order, strictly increasing.
+    pts: Vec<Duration>,
+    /// Frames the decoder flagged as clean points, ascending.
+    keyframes: Vec<u64>,
+}
+
+impl FrameIndex {
+    pub fn len(&self) -> u64 {
+        self.pts.len() as u64
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.pts.is_empty()
+    }
+
+    pub fn keyframes(&self) -> &[u64] {
+        &self.keyframes
+    }
+
+    pub fn pts(&self, frame: u64) -> Option<Duration> {
+        usize::try_from(frame)
+            .ok()
+            .and_then(|frame| self.pts.get(frame).copied())
+    }
+
+    /// Frame whose pts is closest to `pts`.
+    pub fn nearest(&self, pts: Duration) -> Option<u64> {
+        let after = self.pts.partition_point(|value| *value < pts);
+        let candidate = match (after.checked_sub(1), self.pts.get(after)) {
+            (Some(before), Some(next)) if *next - pts < pts - self.pts[before] => after,
+            (Some(before), _) => before,
+            (None, Some(_)) => after,
+            (None, None) => return None,
+        };
+        Some(candidate as u64)
+    }
+
+    /// First frame shown at or after `pts`.
+    pub fn at_or_after(&self, pts: Duration) -> Option<u64> {
+        let frame = self.pts.partition_point(|value| *value < pts);
+        (frame < self.pts.len()).then_some(frame as u64)
+    }
+
+    /// Last keyframe at or before `frame`.
+    pub fn keyframe_before(&self, frame: u64) -> Option<u64> {
+        let count = self.keyframes.partition_point(|key| *key <= frame);
+        count.checked_sub(1).map(|slot| self.keyframes[slot])
+    }
+
+    /// Halfway between `frame` and the one before it: dropping samples stamped earlier never drops
+    /// `frame` itself, even with jittery timestamps.
+    pub fn drop_before(&self, frame: u64) -> Option<Duration> {
+        let pts = self.pts(frame)?;
+        let previous = frame.checked_sub(1).and_then(|previous| self.pts(previous));
+        Some(previous.map_or(Duration::ZERO, |previous| previous + (pts - previous) / 2))
+    }
+
+    /// Reads the cached index for `input`, or `None` when there is none or the file changed since.
+    pub fn load(cache_dir: &Path, input: &Path) -> Option<Self> {
+        let identity = FileIdentity::of(input).ok()?;
+        let bytes = fs::read(identity.cache_path(cache_dir, "idx")).ok()?;
+        Self::decode(&bytes, &identity)
+    }
+
+    pub fn store(&self, cache_dir: &Path, input: &Path) -> io::Result<()> {
+        let identity = FileIdentity::of(input)?;
+        fs::create_dir_all(cache_dir)?;
+        let path = identity.cache_path(cache_dir, "idx");
+        // Write aside and rename so a concurrent reader never sees a partial file.
+        let staging = path.with_extension(format!("{}.tmp", std::process::id()));
+        fs::write(&staging, self.encode(&identity))?;
+        fs::rename(&staging, &path)
+    }
+
+    fn encode(&self, identity: &FileIdentity) -> Vec<u8> {
+        let path = identity.path_bytes();
+        let mut out =
+            Vec::with_capacity(48 + path.len() + (self.pts.len() + self.keyframes.len()) * 8);
+        out.extend_from_slice(MAGIC);
+        out.extend_from_slice(&VERSION.to_le_bytes());
+        out.extend_from_slice(&identity.len.to_le_bytes());
+        out.extend_from_slice(&identity.modified_ns.to_le_bytes());
+        out.extend_from_slice(&(path.len() as u64).to_le_bytes());
+        out.extend_from_slice(&path);
+        out.extend_from_slice(&self.len().to_le_bytes());
+        out.extend_from_slice(&(self.keyframes.len() as u64).to_le_bytes());
+        for pts in &self.pts {
+            let nanos = u64::try_from(pts.as_nanos()).unwrap_or(u64::MAX);
+            out.extend_from_slice(&nanos.to_le_bytes());
+        }
+        for key in &self.keyframes {
+            out.extend_from_slice(&key.to_le_bytes());
+        }
+        out
+    }
+
+    fn decode(bytes: &[u8], identity: &FileIdentity) -> Option<Self> {
+        let mut reader = ByteReader(bytes);
+        if reader.take(4)? != MAGIC
+            || reader.u32()? != VERSION
+            || reader.u64()? != identity.len
+            || reader.u64()? != identity.modified_ns
+        {
+            return None;
+        }
+        let path_len = usize::try_from(reader.u64()?).ok()?;
+        if reader.take(path_len)? != identity.path_bytes() {
+            return None;
+        }
+        let frames = usize::try_from(reader.u64()?).ok()?;
+        let keys = usize::try_from(reader.u64()?).ok()?;
+        if frames.checked_add(keys)?.checked_mul(8)? != reader.0.len() {
+            return None;
+        }
+        let mut recorder = IndexRecorder::default();
+        let mut keyframes = Vec::with_capacity(keys);
+        let pts: Vec<Duration> = (0..frames)
+            .map(|_| reader.u64().map(Duration::from_nanos))
+            .collect::<Option<_>>()?;
+        for _ in 0..keys {
+            keyframes.push(reader.u64()?);
+        }
+        // Replay through the recorder so a damaged file fails the same checks a live decode does.
+        let mut next_key = keyframes.iter().peekable();
+        for (frame, pts) in pts.into_iter().enumerate() {
+            let keyframe = next_key.next_if_eq(&&(frame as u64)).is_some();
+            recorder.record(Some(pts), keyframe);
+        }
+        if next_key.next().is_some() {
+            return None;
+        }
+        recorder.finish()
+    }
+}
+
+/// Collects the index during a decode. Any gap (a seek, a missing or out-of-order pts) abandons it,
+/// since a partial index would misnumber every frame after the gap.
+#[derive(Debug, Default)]
+pub struct IndexRecorder {
+    pts: Vec<Duration>,
+    keyframes: Vec<u64>,
+    broken: bool,
+}
+
+impl IndexRecorder {
+    pub fn record(&mut self, pts: Option<Duration>, keyframe: bool) {
+        if self.broken {
+            return;
+        }
+        let Some(pts) = pts.filter(|pts| self.pts.last().is_none_or(|last| pts > last)) else {
+            self.abandon();
+            return;
+        };
+        if keyframe {
+            self.keyframes.push(self.pts.len() as u64);
+        }
+        self.pts.push(pts);
+    }
+
+    pub fn abandon(&mut self) {
+        self.broken = true;
+        self.pts = Vec::new();
+        self.keyframes = Vec::new();
+    }
+
+    pub fn finish(self) -> Option<FrameIndex> {
+        (!self.broken && !self.pts.is_empty()).then_some(FrameIndex {
+            pts: self.pts,
+            keyframes: self.keyframes,
+        })
+    }
+}
+
+/// Maps frame indexes to timestamps: exactly from a recorded index, otherwise by nominal frame rate.
+#[derive(Debug, Clone, Default)]
+pub struct Timeline {
+    fps: Option<f64>,
+    index: Option<Arc<FrameIndex>>,
+}
+
+/// Where a reader is positioned to decode up to some frame, and the index of the first frame it yields.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct SeekPoint {
+    pub frame: u64,
+    pub pts: Duration,
+}
+
+impl Timeline {
+    pub fn new(fps: Option<f64>, index: Option<Arc<FrameIndex>>) -> Self {
+        Self {
+            fps: fps.filter(|fps| fps.is_finite() && *fps > 0.0),
+            index,
+        }
+    }
+
+    pub fn index(&self) -> Option<&FrameIndex> {
+        self.index.as_deref()
+    }
+
+    /// Whether frames can be located at all; without an index this needs the frame rate.
+    pub fn is_known(&self) -> bool {
+        self.fps.is_some() || self.index.is_some()
+    }
+
+    pub fn frame_at(&self, pts: Duration) -> Option<u64> {
+        if let Some(frame) = self.index().and_then(|index| index.nearest(pts)) {
+            return Some(frame);
+        }
+        self.scaled(pts.as_secs_f64(), f64::round)
+    }
+
+    pub fn pts_of(&self, frame: u64) -> Option<Duration> {
+        if let Some(pts) = self.index().and_then(|index| index.pts(frame)) {
+            return Some(pts);
+        }
+        let fps = self.fps?;
+        Duration::try_from_secs_f64(frame as f64 / fps).ok()
+    }
+
+    /// Frame a time seek resolves to: the first shown at or after `position` when `accurate`,
+    /// otherwise the nearest.
+    pub fn frame_for_time(&self, position: Duration, accurate: bool) -> Option<u64> {
+        let indexed = self.index().and_then(|index| {
+            if accurate {
+                index.at_or_after(position)
+            } else {
+                index.nearest(position)
+            }
+        });
+        if indexed.is_some() {
+            return indexed;
+        }
+        let round = if accurate { f64::floor } else { f64::round };
+        self.scaled(position.as_secs_f64(), round)
+    }
+
+    /// Timestamp before which samples leading up to `frame` can be dropped unread.
+    pub fn drop_before(&self, frame: u64) -> Option<Duration> {
+        if let Some(pts) = self.index().and_then(|index| index.drop_before(frame)) {
+            return Some(pts);
+        }
+        let fps = self.fps?;
+        Duration::try_from_secs_f64((frame as f64 - 0.5).max(0.0) / fps).ok()
+    }
+
+    /// Seek target for decoding `frame`. With an index this is the keyframe before it, so the reader
+    /// lands exactly there; otherwise it is the frame's nominal time and the reader finds the keyframe.
+    pub fn seek_point(&self, frame: u64) -> Option<SeekPoint> {
+        if let Some(index) = self.index()
+            && let Some(key) = index.keyframe_before(frame)
+            && let Some(pts) = index.pts(key)
+        {
+            return Some(SeekPoint { frame: key, pts });
+        }
+        Some(SeekPoint {
+            frame,
+            pts: self.pts_of(frame)?,
+        })
+    }
+
+    fn scaled(&self, seconds: f64, round: fn(f64) -> f64) -> Option<u64> {
+        let frame = round(seconds * self.fps?);
+        (frame.is_finite() && frame >= 0.0 && frame <= u64::MAX as f64).then_some(frame as u64)
+    }
+}
+
+/// Canonical path, length and modification time of an input; caches keyed by it go stale with the file.
+pub(crate) struct FileIdentity {
+    path: PathBuf,
+    pub(crate) len: u64,
+    pub(crate) modified_ns: u64,
+}
+
+impl FileIdentity {
+    pub(crate) fn of(input: &Path) -> io::Result<Self> {
+        let path = fs::canonicalize(input)?;
+        let metadata = fs::metadata(&path)?;
+        let modified = metadata
+            .modified()?
+            .duration_since(UNIX_EPOCH)
+            .unwrap_or_default();
+        Ok(Self {
+            path,
+            len: metadata.len(),
+            modified_ns: u64::try_from(modified.as_nanos()).unwrap_or(u64::MAX),
+        })
+    }
+
+    pub(crate) fn path_bytes(&self) -> Vec<u8> {
+        self.path.to_string_lossy().into_owned().into_bytes()
+    }
+
+    /// One file per input, named by an FNV-1a hash of its canonical path; the header disambiguates.
+    pub(crate) fn cache_path(&self, cache_dir: &Path, extension: &str) -> PathBuf {
+        let hash = self
+            .path_bytes()
+            .iter()
+            .fold(0xcbf2_9ce4_8422_2325u64, |hash, byte| {
+                (hash ^ u64::from(*byte)).wrapping_mul(0x0000_0100_0000_01b3)
+            });
+        cache_dir.join(format!("{hash:016x}.{extension}"))
+    }
+}
+
+pub(crate) struct ByteReader<'a>(pub(crate) &'a [u8]);
+
+impl<'a> ByteReader<'a> {
+    pub(crate) fn take(&mut self, len: usize) -> Option<&'a [u8]> {
+        if self.0.len() < len {
+            return None;
+        }
+        let (head, tail) = self.0.split_at(len);
+        self.0 = tail;
+        Some(head)
+    }
+
+    pub(crate) fn u32(&mut self) -> Option<u32> {
+        self.take(4)?.try_into().ok().map(u32::from_le_bytes)
+    }
+
+    pub(crate) fn u64(&mut self) -> Option<u64> {
+        self.take(8)?.try_into().ok().map(u64::from_le_bytes)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn vfr_index() -> FrameIndex {
+        // 40ms frames, then 20ms frames from frame 3; keyframes at 0 and 4.
+        let mut recorder = IndexRecorder::default();
+        for (frame, millis) in [0u64, 40, 80, 120, 140, 160, 180].into_iter().enumerate() {
+            recorder.record(
+                Some(Duration::from_millis(millis)),
+                frame == 0 || frame == 4,
+            );
+        }
+        recorder.finish().unwrap()
+    }
+
+    #[test]
+    fn timeline_uses_recorded_pts_and_keyframes() {
+        let timeline = Timeline::new(Some(25.0), Some(Arc::new(vfr_index())));
+        assert_eq!(timeline.frame_at(Duration::from_millis(161)), Some(5));
+        assert_eq!(timeline.pts_of(6), Some(Duration::from_millis(180)));
+        assert_eq!(
+            timeline.frame_for_time(Duration::from_millis(125), true),
+            Some(4)
+        );
+        assert_eq!(
+            timeline.frame_for_time(Duration::from_millis(125), false),
+            Some(3)
+        );
+        assert_eq!(timeline.drop_before(4), Some(Duration::from_millis(130)));
+        assert_eq!(
+            timeline.seek_point(6),
+            Some(SeekPoint {
+                frame: 4,
+                pts: Duration::from_millis(140)
+            })
+        );
+        assert_eq!(timeline.seek_point(3).unwrap().frame, 0);
+    }
+
+    #[test]
+    fn timeline_falls_back_to_frame_rate() {
+        let timeline = Timeline::new(Some(25.0), None);
+        assert_eq!(timeline.frame_at(Duration::from_millis(161)), Some(4));
+        assert_eq!(timeline.drop_before(4), Some(Duration::from_millis(140)));
+        assert_eq!(
+            timeline.seek_point(4),
+            Some(SeekPoint {
+                frame: 4,
+                pts: Duration::from_millis(160)
+            })
+        );
+        assert!(!Timeline::new(None, None).is_known());
+    }
+
+    #[test]
+    fn recorder_abandons_out_of_order_frames() {
+        let mut recorder = IndexRecorder::default();
+        recorder.record(Some(Duration::from_millis(40)), true);
+        recorder.record(Some(Duration::from_millis(40)), false);
+        recorder.record(Some(Duration::from_millis(80)), false);
+        assert!(recorder.finish().is_none());
+    }
+
+    #[test]
+    fn cache_round_trips_and_rejects_changed_files() {
+        let dir = std::env::temp_dir().join(format!("subfast-index-test-{}", std::process::id()));
+        let cache = dir.join("cache");
+        fs::create_dir_all(&dir).unwrap();
+        let input = dir.join("input.mp4");
+        fs::write(&input, b"video").unwrap();
+
+        let index = vfr_index();
+        index.store(&cache, &input).unwrap();
+        assert_eq!(FrameIndex::load(&cache, &input), Some(index));
+
+        fs::write(&input, b"another video").unwrap();
+        assert_eq!(FrameIndex::load(&cache, &input), None);
+        fs::remove_dir_all(&dir).unwrap();
+    }
+}
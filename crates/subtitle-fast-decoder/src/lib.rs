@@ -1,10 +1,28 @@
+pub mod adapter;
 pub mod backends;
+pub mod backpressure;
+pub mod change;
 pub mod config;
 pub mod core;
+pub mod gate;
+pub mod index;
+pub mod luma_cache;
+pub mod pool;
+pub mod schedule;
+pub mod segment;
 
-pub use config::{Backend, Configuration, OutputFormat};
+pub use adapter::{AdapterInfo, AdapterLease, AdapterLoad, AdapterScheduler};
+pub use backpressure::Backpressure;
+pub use change::ChangeDetection;
+pub use config::{Backend, Configuration, OutputFormat, Prefetch, ScanMode};
 pub use core::{
-    DecoderController, DecoderError, DecoderProvider, DecoderResult, DynDecoderProvider,
-    FrameBuffer, FrameStream, NativeBuffer, Nv12Buffer, SeekInfo, SeekMode, VideoFrame,
-    VideoMetadata,
+    AdapterUsage, DecodePhase, DecoderController, DecoderError, DecoderProvider, DecoderResult,
+    DecoderStats, DecoderStatsSnapshot, DynDecoderProvider, FrameBuffer, FrameCrop, FrameStream,
+    NativeBuffer, Nv12Buffer, PhaseStats, PlaneRecycler, PrefetchStats, RoiConfig, SeekInfo,
+    SeekMode, VideoFrame, VideoMetadata,
 };
+pub use gate::LumaGate;
+pub use index::FrameIndex;
+pub use luma_cache::{LumaCache, LumaCacheConfig, LumaCacheWriter};
+pub use pool::FramePool;
+pub use schedule::SampleSchedule;
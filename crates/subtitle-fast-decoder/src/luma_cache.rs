@@ -0,0 +1,939 @@
+//! ROI luma cache: the sampled detection band of one decode, stored per input file for replay.
+//!
+//! Tuning detection thresholds, the comparator or the ROI otherwise means decoding the whole file
+//! again. A recording decode keeps the luma of every frame the detection sampler would pick, cut to
+//! the configured ROI, in a file under the cache directory keyed like the frame index. A later run
+//! at the same sampling rate whose ROI lies inside the recorded one replays it from a memory mapping
+//! through the `luma-cache` backend instead of decoding.
+//!
+//! The file holds the encoded frames back to back, then a table of `ENTRY_LEN`-byte entries, then
+//! the header followed by its length and `MAGIC`. Compressed files predict each frame from the one
+//! before it, keyframes (every `KEY_INTERVAL` entries) from their left neighbours, and store the
+//! residual with zero runs collapsed.
+
+use std::fs::{self, File};
+use std::io::{self, BufWriter, Write};
+use std::num::NonZeroU32;
+use std::path::{Path, PathBuf};
+use std::time::Duration;
+
+use memmap2::Mmap;
+
+use crate::core::{FrameBuffer, FrameCrop, RoiConfig, VideoFrame, VideoMetadata};
+use crate::index::{ByteReader, FileIdentity};
+use crate::schedule::SampleSchedule;
+
+const MAGIC: &[u8; 4] = b"SFLC";
+const VERSION: u32 = 1;
+const EXTENSION: &str = "luma";
+const ENTRY_LEN: usize = 32;
+/// Entries between keyframes in compressed files; a seek decodes at most this many to land.
+const KEY_INTERVAL: usize = 32;
+/// Slack when comparing normalized ROIs, well under a pixel of any real picture.
+const ROI_EPSILON: f32 = 1e-4;
+
+const FLAG_KEY: u32 = 1;
+/// Same band as the entry before it; stores no data.
+const FLAG_REPEAT: u32 = 2;
+
+/// Zero runs shorter than this stay in the literal they interrupt.
+const MIN_ZERO_RUN: usize = 3;
+const MAX_LITERAL: usize = 128;
+const ZERO_RUN: u8 = 0x80;
+
+#[derive(Debug, Clone, PartialEq)]
+pub struct LumaCacheConfig {
+    pub dir: PathBuf,
+    /// Detection sampling rate; only the frames its schedule picks are stored.
+    pub samples_per_second: NonZeroU32,
+    /// Normalized source region stored. A replay needs its ROI inside the recorded one.
+    pub roi: RoiConfig,
+    /// Delta-encode frames; larger files otherwise, but each frame replays as a plain copy.
+    pub compress: bool,
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub(crate) struct Entry {
+    pub(crate) index: u64,
+    pub(crate) pts: Duration,
+    offset: u64,
+    len: u32,
+    flags: u32,
+}
+
+impl Entry {
+    fn is_key(&self) -> bool {
+        self.flags & FLAG_KEY != 0
+    }
+}
+
+/// Picture size and placement shared by every frame of a recording.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+struct Layout {
+    width: u32,
+    height: u32,
+    crop: FrameCrop,
+}
+
+impl Layout {
+    fn plane_len(&self) -> usize {
+        self.width as usize * self.height as usize
+    }
+}
+
+/// A recorded cache, memory-mapped for replay.
+pub struct LumaCache {
+    map: Mmap,
+    layout: Layout,
+    compressed: bool,
+    metadata: VideoMetadata,
+    entries: Vec<Entry>,
+}
+
+impl LumaCache {
+    /// Opens the cache recorded for `input`, or `None` when there is none, the file changed since,
+    /// or it was recorded at another sampling rate or for an ROI that does not cover `config.roi`.
+    pub fn open(config: &LumaCacheConfig, input: &Path) -> Option<Self> {
+        let identity = FileIdentity::of(input).ok()?;
+        let file = File::open(identity.cache_path(&config.dir, EXTENSION)).ok()?;
+        // SAFETY: cache files are written aside and renamed into place, never modified in place, so
+        // the mapped file does not change under the mapping.
+        let map = unsafe { Mmap::map(&file) }.ok()?;
+        let (header, entries) = decode_trailer(&map, &identity)?;
+        if header.samples_per_second != config.samples_per_second.get()
+            || !covers(&header.roi, &config.roi)
+        {
+            return None;
+        }
+        Some(Self {
+            map,
+            layout: header.layout,
+            compressed: header.compressed,
+            metadata: header.metadata,
+            entries,
+        })
+    }
+
+    pub fn len(&self) -> usize {
+        self.entries.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.entries.is_empty()
+    }
+
+    /// Metadata the recording decoder reported for the whole input.
+    pub fn metadata(&self) -> VideoMetadata {
+        self.metadata
+    }
+
+    pub fn width(&self) -> u32 {
+        self.layout.width
+    }
+
+    pub fn height(&self) -> u32 {
+        self.layout.height
+    }
+
+    /// Placement of the stored band in the source picture; replayed frames carry it.
+    pub fn crop(&self) -> FrameCrop {
+        self.layout.crop
+    }
+
+    pub(crate) fn entry(&self, slot: usize) -> Option<&Entry> {
+        self.entries.get(slot)
+    }
+
+    pub(crate) fn is_repeat(&self, slot: usize) -> bool {
+        self.entries
+            .get(slot)
+            .is_some_and(|entry| entry.flags & FLAG_REPEAT != 0)
+    }
+
+    /// First entry at or after source frame `frame`.
+    pub(crate) fn slot_at_or_after(&self, frame: u64) -> usize {
+        self.entries.partition_point(|entry| entry.index < frame)
+    }
+
+    /// First entry shown at or after `pts`.
+    pub(crate) fn slot_at_time(&self, pts: Duration) -> usize {
+        self.entries.partition_point(|entry| entry.pts < pts)
+    }
+
+    /// Keyframe entry a decode reaching `slot` has to start from.
+    pub(crate) fn key_before(&self, slot: usize) -> usize {
+        let slot = slot.min(self.entries.len().saturating_sub(1));
+        self.entries[..=slot]
+            .iter()
+            .rposition(Entry::is_key)
+            .unwrap_or(0)
+    }
+
+    /// A tightly packed plane sized for one frame.
+    pub(crate) fn plane(&self) -> Vec<u8> {
+        vec![0u8; self.layout.plane_len()]
+    }
+
+    /// Reconstructs entry `slot` in `plane`, which must hold entry `slot - 1` unless `slot` is a
+    /// keyframe. `None` when the stored data does not decode to a whole frame.
+    pub(crate) fn decode(
+        &self,
+        slot: usize,
+        plane: &mut [u8],
+        scratch: &mut Vec<u8>,
+    ) -> Option<()> {
+        let entry = self.entries.get(slot)?;
+        if entry.flags & FLAG_REPEAT != 0 {
+            return Some(());
+        }
+        let start = usize::try_from(entry.offset).ok()?;
+        let data = self
+            .map
+            .get(start..start.checked_add(entry.len as usize)?)?;
+        if !self.compressed {
+            plane.copy_from_slice(data);
+            return Some(());
+        }
+        if entry.is_key() {
+            unpack(data, plane)?;
+            let width = self.layout.width as usize;
+            for row in plane.chunks_mut(width) {
+                for x in 1..row.len() {
+                    row[x] = row[x].wrapping_add(row[x - 1]);
+                }
+            }
+        } else {
+            scratch.resize(plane.len(), 0);
+            unpack(data, scratch)?;
+            for (value, residual) in plane.iter_mut().zip(scratch.iter()) {
+                *value = value.wrapping_add(*residual);
+            }
+        }
+        Some(())
+    }
+}
+
+/// Records a cache from the frames of one decode, offered in stream order. Anything that would
+/// make the replay differ from the decode (a seek, a gap in the timestamps, a frame without pixels
+/// or of another size) abandons it, and nothing is stored.
+pub struct LumaCacheWriter {
+    roi: RoiConfig,
+    compress: bool,
+    samples_per_second: u32,
+    identity: FileIdentity,
+    path: PathBuf,
+    staging: PathBuf,
+    file: Option<BufWriter<File>>,
+    schedule: SampleSchedule,
+    observed: u64,
+    serial: Option<u64>,
+    band: Option<Band>,
+    entries: Vec<Entry>,
+    offset: u64,
+    previous: Vec<u8>,
+    current: Vec<u8>,
+    packed: Vec<u8>,
+    residual: Vec<u8>,
+}
+
+impl LumaCacheWriter {
+    pub fn create(config: &LumaCacheConfig, input: &Path) -> io::Result<Self> {
+        let identity = FileIdentity::of(input)?;
+        fs::create_dir_all(&config.dir)?;
+        let path = identity.cache_path(&config.dir, EXTENSION);
+        // Write aside and rename so a concurrent reader never maps a partial file.
+        let staging = path.with_extension(format!("{EXTENSION}.{}.tmp", std::process::id()));
+        let file = BufWriter::with_capacity(1 << 20, File::create(&staging)?);
+        Ok(Self {
+            roi: clamp_roi(&config.roi),
+            compress: config.compress,
+            samples_per_second: config.samples_per_second.get(),
+            identity,
+            path,
+            staging,
+            file: Some(file),
+            schedule: SampleSchedule::new(config.samples_per_second.get()),
+            observed: 0,
+            serial: None,
+            band: None,
+            entries: Vec::new(),
+            offset: 0,
+            previous: Vec::new(),
+            current: Vec::new(),
+            packed: Vec::new(),
+            residual: Vec::new(),
+        })
+    }
+
+    pub fn is_abandoned(&self) -> bool {
+        self.file.is_none()
+    }
+
+    pub fn abandon(&mut self) {
+        if self.file.take().is_some() {
+            let _ = fs::remove_file(&self.staging);
+        }
+    }
+
+    /// Stores `frame` if the detection sampler would pick it.
+    pub fn record(&mut self, frame: &VideoFrame) {
+        if self.is_abandoned() {
+            return;
+        }
+        self.observed += 1;
+        let Some(pts) = frame.pts() else {
+            self.abandon();
+            return;
+        };
+        if *self.serial.get_or_insert(frame.serial()) != frame.serial()
+            || self.entries.last().is_some_and(|last| pts <= last.pts)
+        {
+            self.abandon();
+            return;
+        }
+        if !self.schedule.should_sample(Some(pts), self.observed) {
+            return;
+        }
+        let index = frame.index().unwrap_or(self.observed - 1);
+        if self.store(frame, index, pts).is_err() {
+            self.abandon();
+        }
+    }
+
+    fn store(&mut self, frame: &VideoFrame, index: u64, pts: Duration) -> io::Result<()> {
+        let unusable = || io::Error::new(io::ErrorKind::InvalidData, "frame cannot be cached");
+        if !matches!(frame.buffer(), FrameBuffer::Nv12(_)) || !frame.has_pixels() {
+            return Err(unusable());
+        }
+        let band = Band::of(frame, &self.roi).ok_or_else(unusable)?;
+        if *self.band.get_or_insert(band) != band {
+            return Err(unusable());
+        }
+        let layout = band.layout;
+        band.copy(frame, &mut self.current).ok_or_else(unusable)?;
+
+        let slot = self.entries.len();
+        let mut flags = 0;
+        if slot > 0 && self.current == self.previous {
+            flags = FLAG_REPEAT;
+        } else if !self.compress || slot.is_multiple_of(KEY_INTERVAL) {
+            flags = FLAG_KEY;
+        }
+        let data: &[u8] = if flags & FLAG_REPEAT != 0 {
+            &[]
+        } else if !self.compress {
+            &self.current
+        } else {
+            self.residual.clear();
+            if flags & FLAG_KEY != 0 {
+                for row in self.current.chunks(layout.width as usize) {
+                    let mut left = 0u8;
+                    for &value in row {
+                        self.residual.push(value.wrapping_sub(left));
+                        left = value;
+                    }
+                }
+            } else {
+                self.residual.extend(
+                    self.current
+                        .iter()
+                        .zip(&self.previous)
+                        .map(|(current, previous)| current.wrapping_sub(*previous)),
+                );
+            }
+            self.packed.clear();
+            pack(&self.residual, &mut self.packed);
+            &self.packed
+        };
+        let file = self.file.as_mut().ok_or_else(unusable)?;
+        file.write_all(data)?;
+        let len = u32::try_from(data.len()).map_err(|_| unusable())?;
+        self.entries.push(Entry {
+            index,
+            pts,
+            offset: self.offset,
+            len,
+            flags,
+        });
+        self.offset += u64::from(len);
+        std::mem::swap(&mut self.previous, &mut self.current);
+        Ok(())
+    }
+
+    /// Writes the table and header and moves the cache into place. Returns whether a cache was
+    /// stored; an abandoned or empty recording stores nothing.
+    pub fn finish(mut self, metadata: VideoMetadata) -> io::Result<bool> {
+        let Some(layout) = self.band.map(|band| band.layout) else {
+            self.abandon();
+            return Ok(false);
+        };
+        let Some(mut file) = self.file.take() else {
+            return Ok(false);
+        };
+        let header = Header {
+            samples_per_second: self.samples_per_second,
+            roi: self.roi,
+            layout,
+            compressed: self.compress,
+            metadata,
+            entries: self.entries.len() as u64,
+            table_offset: self.offset,
+        };
+        let written = (|| {
+            for entry in &self.entries {
+                file.write_all(&entry.encode())?;
+            }
+            let header = header.encode(&self.identity);
+            file.write_all(&header)?;
+            file.write_all(&(header.len() as u64).to_le_bytes())?;
+            file.write_all(MAGIC)?;
+            file.into_inner().map_err(io::IntoInnerError::into_error)?;
+            fs::rename(&self.staging, &self.path)
+        })();
+        if written.is_err() {
+            let _ = fs::remove_file(&self.staging);
+        }
+        written.map(|()| true)
+    }
+}
+
+impl Drop for LumaCacheWriter {
+    fn drop(&mut self) {
+        self.abandon();
+    }
+}
+
+/// Pixel rectangle of a frame that covers the cached ROI, and where it sits in the source.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+struct Band {
+    x: u32,
+    y: u32,
+    layout: Layout,
+}
+
+impl Band {
+    fn of(frame: &VideoFrame, roi: &RoiConfig) -> Option<Self> {
+        let (frame_width, frame_height) = (frame.width(), frame.height());
+        let region = clamp_roi(&frame.roi_in_frame(roi));
+        let (x0, x1) = pixel_span(region.x, region.width, frame_width);
+        let (y0, y1) = pixel_span(region.y, region.height, frame_height);
+        if x1 <= x0 || y1 <= y0 {
+            return None;
+        }
+        let base = frame.crop().unwrap_or(FrameCrop {
+            x: 0,
+            y: 0,
+            width: frame_width,
+            height: frame_height,
+            source_width: frame_width,
+            source_height: frame_height,
+        });
+        let to_source = |pixel: u32, covered: u32, size: u32| {
+            (u64::from(pixel) * u64::from(covered) / u64::from(size)) as u32
+        };
+        let (sx0, sx1) = (
+            to_source(x0, base.width, frame_width),
+            to_source(x1, base.width, frame_width),
+        );
+        let (sy0, sy1) = (
+            to_source(y0, base.height, frame_height),
+            to_source(y1, base.height, frame_height),
+        );
+        Some(Self {
+            x: x0,
+            y: y0,
+            layout: Layout {
+                width: x1 - x0,
+                height: y1 - y0,
+                crop: FrameCrop {
+                    x: base.x + sx0,
+                    y: base.y + sy0,
+                    width: sx1 - sx0,
+                    height: sy1 - sy0,
+                    source_width: base.source_width,
+                    source_height: base.source_height,
+                },
+            },
+        })
+    }
+
+    fn copy(&self, frame: &VideoFrame, out: &mut Vec<u8>) -> Option<()> {
+        let stride = frame.y_stride();
+        let plane = frame.y_plane();
+        let width = self.layout.width as usize;
+        out.clear();
+        for row in self.y as usize..(self.y + self.layout.height) as usize {
+            let start = row * stride + self.x as usize;
+            out.extend_from_slice(plane.get(start..start + width)?);
+        }
+        Some(())
+    }
+}
+
+fn pixel_span(start: f32, extent: f32, size: u32) -> (u32, u32) {
+    let size_f = size as f32;
+    let first = ((start * size_f).floor() as u32).min(size);
+    let last = (((start + extent) * size_f).ceil() as u32).min(size);
+    (first, last)
+}
+
+fn clamp_roi(roi: &RoiConfig) -> RoiConfig {
+    let x = roi.x.clamp(0.0, 1.0);
+    let y = roi.y.clamp(0.0, 1.0);
+    RoiConfig {
+        x,
+        y,
+        width: (roi.x + roi.width).clamp(0.0, 1.0) - x,
+        height: (roi.y + roi.height).clamp(0.0, 1.0) - y,
+    }
+}
+
+fn covers(recorded: &RoiConfig, wanted: &RoiConfig) -> bool {
+    let wanted = clamp_roi(wanted);
+    wanted.x + ROI_EPSILON >= recorded.x
+        && wanted.y + ROI_EPSILON >= recorded.y
+        && wanted.x + wanted.width <= recorded.x + recorded.width + ROI_EPSILON
+        && wanted.y + wanted.height <= recorded.y + recorded.height + ROI_EPSILON
+}
+
+/// Appends `residual` with zero runs collapsed: a control byte below `ZERO_RUN` is followed by that
+/// many plus one literal bytes, `ZERO_RUN` by the LEB128 length of a run of zeros.
+fn pack(residual: &[u8], out: &mut Vec<u8>) {
+    let mut literal_start = 0;
+    let mut pos = 0;
+    while pos < residual.len() {
+        let zeros = residual[pos..]
+            .iter()
+            .take_while(|value| **value == 0)
+            .count();
+        if zeros < MIN_ZERO_RUN {
+            pos += zeros.max(1);
+            continue;
+        }
+        push_literal(&residual[literal_start..pos], out);
+        out.push(ZERO_RUN);
+        let mut run = zeros as u64;
+        while run >= 0x80 {
+            out.push((run & 0x7f) as u8 | 0x80);
+            run >>= 7;
+        }
+        out.push(run as u8);
+        pos += zeros;
+        literal_start = pos;
+    }
+    push_literal(&residual[literal_start..], out);
+}
+
+fn push_literal(literal: &[u8], out: &mut Vec<u8>) {
+    for chunk in literal.chunks(MAX_LITERAL) {
+        out.push((chunk.len() - 1) as u8);
+        out.extend_from_slice(chunk);
+    }
+}
+
+/// Inverse of `pack`; `None` unless `packed` expands to exactly `out.len()` bytes.
+fn unpack(mut packed: &[u8], out: &mut [u8]) -> Option<()> {
+    let mut pos = 0usize;
+    while let Some((&control, rest)) = packed.split_first() {
+        packed = rest;
+        if control == ZERO_RUN {
+            let mut run = 0u64;
+            let mut shift = 0;
+            loop {
+                let (&byte, rest) = packed.split_first()?;
+                packed = rest;
+                run |= u64::from(byte & 0x7f) << shift;
+                if byte & 0x80 == 0 {
+                    break;
+                }
+                shift += 7;
+                if shift >= 64 {
+                    return None;
+                }
+            }
+            let end = pos.checked_add(usize::try_from(run).ok()?)?;
+            out.get_mut(pos..end)?.fill(0);
+            pos = end;
+        } else if control < ZERO_RUN {
+            let len = usize::from(control) + 1;
+            let literal = packed.get(..len)?;
+            out.get_mut(pos..pos + len)?.copy_from_slice(literal);
+            packed = &packed[len..];
+            pos += len;
+        } else {
+            return None;
+        }
+    }
+    (pos == out.len()).then_some(())
+}
+
+struct Header {
+    samples_per_second: u32,
+    roi: RoiConfig,
+    layout: Layout,
+    compressed: bool,
+    metadata: VideoMetadata,
+    entries: u64,
+    table_offset: u64,
+}
+
+impl Header {
+    fn encode(&self, identity: &FileIdentity) -> Vec<u8> {
+        let path = identity.path_bytes();
+        let mut out = Vec::with_capacity(128 + path.len());
+        out.extend_from_slice(MAGIC);
+        out.extend_from_slice(&VERSION.to_le_bytes());
+        out.extend_from_slice(&identity.len.to_le_bytes());
+        out.extend_from_slice(&identity.modified_ns.to_le_bytes());
+        out.extend_from_slice(&(path.len() as u64).to_le_bytes());
+        out.extend_from_slice(&path);
+        out.extend_from_slice(&self.samples_per_second.to_le_bytes());
+        for value in [self.roi.x, self.roi.y, self.roi.width, self.roi.height] {
+            out.extend_from_slice(&value.to_bits().to_le_bytes());
+        }
+        let crop = self.layout.crop;
+        for value in [
+            self.layout.width,
+            self.layout.height,
+            crop.x,
+            crop.y,
+            crop.width,
+            crop.height,
+            crop.source_width,
+            crop.source_height,
+            u32::from(self.compressed),
+        ] {
+            out.extend_from_slice(&value.to_le_bytes());
+        }
+        // Absent metadata is stored as all ones.
+        let metadata = self.metadata;
+        for value in [
+            metadata.duration.map_or(u64::MAX, |duration| {
+                u64::try_from(duration.as_nanos()).unwrap_or(u64::MAX - 1)
+            }),
+            metadata.fps.map_or(u64::MAX, f64::to_bits),
+            metadata.width.map_or(u64::MAX, u64::from),
+            metadata.height.map_or(u64::MAX, u64::from),
+            metadata.total_frames.unwrap_or(u64::MAX),
+            self.entries,
+            self.table_offset,
+        ] {
+            out.extend_from_slice(&value.to_le_bytes());
+        }
+        out
+    }
+
+    fn decode(bytes: &[u8], identity: &FileIdentity) -> Option<Self> {
+        let mut reader = ByteReader(bytes);
+        if reader.take(4)? != MAGIC
+            || reader.u32()? != VERSION
+            || reader.u64()? != identity.len
+            || reader.u64()? != identity.modified_ns
+        {
+            return None;
+        }
+        let path_len = usize::try_from(reader.u64()?).ok()?;
+        if reader.take(path_len)? != identity.path_bytes() {
+            return None;
+        }
+        let samples_per_second = reader.u32()?;
+        let mut roi = [0f32; 4];
+        for value in &mut roi {
+            *value = f32::from_bits(reader.u32()?);
+        }
+        let mut fields = [0u32; 9];
+        for value in &mut fields {
+            *value = reader.u32()?;
+        }
+        let [
+            width,
+            height,
+            x,
+            y,
+            crop_width,
+            crop_height,
+            source_width,
+            source_height,
+            compressed,
+        ] = fields;
+        let present = |value: u64| (value != u64::MAX).then_some(value);
+        let duration = present(reader.u64()?).map(Duration::from_nanos);
+        let fps = present(reader.u64()?).map(f64::from_bits);
+        let metadata_width = present(reader.u64()?).and_then(|value| u32::try_from(value).ok());
+        let metadata_height = present(reader.u64()?).and_then(|value| u32::try_from(value).ok());
+        let total_frames = present(reader.u64()?);
+        let entries = reader.u64()?;
+        let table_offset = reader.u64()?;
+        if !reader.0.is_empty() || width == 0 || height == 0 || compressed > 1 {
+            return None;
+        }
+        Some(Self {
+            samples_per_second,
+            roi: RoiConfig {
+                x: roi[0],
+                y: roi[1],
+                width: roi[2],
+                height: roi[3],
+            },
+            layout: Layout {
+                width,
+                height,
+                crop: FrameCrop {
+                    x,
+                    y,
+                    width: crop_width,
+                    height: crop_height,
+                    source_width,
+                    source_height,
+                },
+            },
+            compressed: compressed == 1,
+            metadata: VideoMetadata {
+                duration,
+                fps,
+                width: metadata_width,
+                height: metadata_height,
+                total_frames,
+            },
+            entries,
+            table_offset,
+        })
+    }
+}
+
+impl Entry {
+    fn encode(&self) -> [u8; ENTRY_LEN] {
+        let mut out = [0u8; ENTRY_LEN];
+        let nanos = u64::try_from(self.pts.as_nanos()).unwrap_or(u64::MAX);
+        out[0..8].copy_from_slice(&self.index.to_le_bytes());
+        out[8..16].copy_from_slice(&nanos.to_le_bytes());
+        out[16..24].copy_from_slice(&self.offset.to_le_bytes());
+        out[24..28].copy_from_slice(&self.len.to_le_bytes());
+        out[28..32].copy_from_slice(&self.flags.to_le_bytes());
+        out
+    }
+
+    fn decode(bytes: &[u8]) -> Option<Self> {
+        let mut reader = ByteReader(bytes);
+        Some(Self {
+            index: reader.u64()?,
+            pts: Duration::from_nanos(reader.u64()?),
+            offset: reader.u64()?,
+            len: reader.u32()?,
+            flags: reader.u32()?,
+        })
+    }
+}
+
+/// Reads the trailer and table of a mapped cache, checking every entry lies in the data region and
+/// the first is a keyframe.
+fn decode_trailer(bytes: &[u8], identity: &FileIdentity) -> Option<(Header, Vec<Entry>)> {
+    let trailer = bytes.len().checked_sub(12)?;
+    if &bytes[trailer + 8..] != MAGIC {
+        return None;
+    }
+    let header_len = usize::try_from(u64::from_le_bytes(
+        bytes[trailer..trailer + 8].try_into().ok()?,
+    ))
+    .ok()?;
+    let header_start = trailer.checked_sub(header_len)?;
+    let header = Header::decode(&bytes[header_start..trailer], identity)?;
+    let table_start = usize::try_from(header.table_offset).ok()?;
+    let count = usize::try_from(header.entries).ok()?;
+    if table_start.checked_add(count.checked_mul(ENTRY_LEN)?)? != header_start || count == 0 {
+        return None;
+    }
+    let plane_len = header.layout.plane_len();
+    let mut entries: Vec<Entry> = Vec::with_capacity(count);
+    for raw in bytes[table_start..header_start].chunks_exact(ENTRY_LEN) {
+        let entry = Entry::decode(raw)?;
+        let end = entry.offset.checked_add(u64::from(entry.len))?;
+        let ordered = entries
+            .last()
+            .is_none_or(|last| entry.index > last.index && entry.pts > last.pts);
+        let sized =
+            header.compressed || entry.flags & FLAG_REPEAT != 0 || entry.len as usize == plane_len;
+        if end > header.table_offset || !ordered || !sized || entry.flags > FLAG_REPEAT {
+            return None;
+        }
+        entries.push(entry);
+    }
+    if !entries[0].is_key() {
+        return None;
+    }
+    Some((header, entries))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const BAND: RoiConfig = RoiConfig {
+        x: 0.0,
+        y: 0.5,
+        width: 1.0,
+        height: 0.5,
+    };
+
+    fn frame(index: u64, level: u8) -> VideoFrame {
+        // 64x32 with a 16px bright bar moving across the bottom half.
+        let mut plane = vec![16u8; 64 * 32];
+        for row in 16..32 {
+            for x in 0..16 {
+                plane[row * 64 + (index as usize * 4 + x) % 64] = level;
+            }
+        }
+        VideoFrame::from_luma_owned(
+            64,
+            32,
+            64,
+            Some(Duration::from_millis(index * 40)),
+            None,
+            plane,
+        )
+        .unwrap()
+        .with_index(Some(index))
+    }
+
+    fn temp_dir(label: &str) -> PathBuf {
+        let dir = std::env::temp_dir().join(format!("subfast-luma-{label}-{}", std::process::id()));
+        fs::create_dir_all(&dir).unwrap();
+        dir
+    }
+
+    fn config(dir: &Path, compress: bool) -> LumaCacheConfig {
+        LumaCacheConfig {
+            dir: dir.join("cache"),
+            samples_per_second: NonZeroU32::new(5).unwrap(),
+            roi: BAND,
+            compress,
+        }
+    }
+
+    fn replay(cache: &LumaCache) -> Vec<Vec<u8>> {
+        let mut plane = cache.plane();
+        let mut scratch = Vec::new();
+        (0..cache.len())
+            .map(|slot| {
+                cache.decode(slot, &mut plane, &mut scratch).unwrap();
+                plane.clone()
+            })
+            .collect()
+    }
+
+    #[test]
+    fn pack_round_trips_runs_and_literals() {
+        let mut residual = vec![0u8; 300];
+        residual[0] = 7;
+        residual[5] = 1;
+        residual[6] = 0;
+        residual[7] = 2;
+        residual.extend((0..200).map(|value| value as u8 | 1));
+        let mut packed = Vec::new();
+        pack(&residual, &mut packed);
+        assert!(packed.len() < residual.len());
+        let mut out = vec![0xffu8; residual.len()];
+        unpack(&packed, &mut out).unwrap();
+        assert_eq!(out, residual);
+        assert!(unpack(&packed, &mut vec![0u8; residual.len() + 1]).is_none());
+    }
+
+    #[test]
+    fn cache_replays_sampled_band_and_rejects_other_runs() {
+        let dir = temp_dir("round-trip");
+        let input = dir.join("input.mp4");
+        fs::write(&input, b"video").unwrap();
+        let metadata = VideoMetadata {
+            total_frames: Some(75),
+            fps: Some(25.0),
+            ..VideoMetadata::default()
+        };
+
+        for compress in [false, true] {
+            let config = config(&dir, compress);
+            let mut writer = LumaCacheWriter::create(&config, &input).unwrap();
+            let mut expected = Vec::new();
+            let mut schedule = SampleSchedule::new(5);
+            for index in 0..75 {
+                // Frames 40 onwards repeat frame 40.
+                let frame =
+                    frame(index.min(40), 235).with_pts(Some(Duration::from_millis(index * 40)));
+                let frame = frame.with_index(Some(index));
+                writer.record(&frame);
+                if schedule.should_sample(frame.pts(), index + 1) {
+                    expected.push((index, frame.y_plane()[16 * 64..].to_vec()));
+                }
+            }
+            assert!(writer.finish(metadata).unwrap());
+
+            let cache = LumaCache::open(&config, &input).unwrap();
+            assert_eq!(cache.metadata(), metadata);
+            assert_eq!((cache.width(), cache.height()), (64, 16));
+            assert_eq!(cache.crop().y, 16);
+            assert_eq!(cache.len(), expected.len());
+            let indexes: Vec<u64> = (0..cache.len())
+                .map(|slot| cache.entry(slot).unwrap().index)
+                .collect();
+            assert_eq!(
+                indexes,
+                expected.iter().map(|(index, _)| *index).collect::<Vec<_>>()
+            );
+            let planes: Vec<Vec<u8>> = expected.into_iter().map(|(_, plane)| plane).collect();
+            assert_eq!(replay(&cache), planes);
+            assert!(cache.is_repeat(cache.len() - 1));
+
+            let narrower = LumaCacheConfig {
+                roi: RoiConfig {
+                    x: 0.25,
+                    y: 0.75,
+                    width: 0.5,
+                    height: 0.25,
+                },
+                ..config.clone()
+            };
+            assert!(LumaCache::open(&narrower, &input).is_some());
+            let wider = LumaCacheConfig {
+                roi: RoiConfig {
+                    x: 0.0,
+                    y: 0.25,
+                    width: 1.0,
+                    height: 0.75,
+                },
+                ..config.clone()
+            };
+            assert!(LumaCache::open(&wider, &input).is_none());
+            let denser = LumaCacheConfig {
+                samples_per_second: NonZeroU32::new(10).unwrap(),
+                ..config.clone()
+            };
+            assert!(LumaCache::open(&denser, &input).is_none());
+        }
+
+        fs::write(&input, b"another video").unwrap();
+        assert!(LumaCache::open(&config(&dir, true), &input).is_none());
+        fs::remove_dir_all(&dir).unwrap();
+    }
+
+    #[test]
+    fn gaps_abandon_the_recording() {
+        let dir = temp_dir("abandon");
+        let input = dir.join("input.mp4");
+        fs::write(&input, b"video").unwrap();
+        let config = config(&dir, true);
+
+        let mut writer = LumaCacheWriter::create(&config, &input).unwrap();
+        writer.record(&frame(0, 235));
+        writer.record(&frame(1, 235).with_serial(1));
+        assert!(writer.is_abandoned());
+        assert!(!writer.finish(VideoMetadata::default()).unwrap());
+        assert!(LumaCache::open(&config, &input).is_none());
+
+        let mut writer = LumaCacheWriter::create(&config, &input).unwrap();
+        writer.record(&frame(0, 235));
+        writer.record(&frame(1, 235).with_pts(None));
+        assert!(writer.is_abandoned());
+        drop(writer);
+        assert_eq!(fs::read_dir(dir.join("cache")).unwrap().count(), 0);
+        fs::remove_dir_all(&dir).unwrap();
+    }
+}
@@ -0,0 +1,192 @@
+//! Recycled NV12 plane allocations shared by the hardware backends.
+//!
+//! Frames built from pooled planes return their buffers here when the last clone is dropped, so
+//! long runs reuse a steady set of large allocations instead of faulting in fresh pages per frame.
+
+use std::sync::{Arc, Mutex};
+
+use subtitle_fast_types::PlaneRecycler;
+
+/// Planes an NV12 frame returns to the pool: Y and UV.
+const PLANES_PER_FRAME: usize = 2;
+
+#[derive(Clone)]
+pub struct FramePool {
+    inner: Arc<PoolInner>,
+}
+
+struct PoolInner {
+    free: Mutex<Vec<Vec<u8>>>,
+    /// Idle plane buffers kept, `PLANES_PER_FRAME` per frame.
+    limit: usize,
+}
+
+impl FramePool {
+    /// Creates a pool that keeps the planes of at most `frames` idle frames.
+    pub fn new(frames: usize) -> Self {
+        Self {
+            inner: Arc::new(PoolInner {
+                free: Mutex::new(Vec::new()),
+                limit: frames.max(1) * PLANES_PER_FRAME,
+            }),
+        }
+    }
+
+    /// Returns an empty buffer with room for at least `len` bytes.
+    pub fn acquire(&self, len: usize) -> Vec<u8> {
+        if len == 0 {
+            // Luma-only frames have an empty UV plane; never hand out a real buffer for it.
+            return Vec::new();
+        }
+        if let Ok(mut free) = self.inner.free.lock() {
+            // The smallest buffer that fits, and at most a quarter oversized: a UV plane is half its
+            // Y plane, so it must never take an idle Y buffer that the next Y request then misses.
+            let slot = free
+                .iter()
+                .enumerate()
+                .filter(|(_, plane)| plane.capacity() >= len && plane.capacity() - len <= len / 4)
+                .min_by_key(|(_, plane)| plane.capacity())
+                .map(|(slot, _)| slot);
+            if let Some(slot) = slot {
+                return free.swap_remove(slot);
+            }
+        }
+        Vec::with_capacity(len)
+    }
+
+    /// Copies `data` into a pooled buffer.
+    pub fn copy_from(&self, data: &[u8]) -> Vec<u8> {
+        let mut plane = self.acquire(data.len());
+        plane.extend_from_slice(data);
+        plane
+    }
+
+    /// Copies `data` into a pooled buffer through `copy(dst, src, len)` instead of a plain memcpy, for
+    /// sources a native kernel reads faster (write-combined mappings).
+    ///
+    /// # Safety
+    /// `copy` must write all `len` bytes at `dst`.
+    pub unsafe fn copy_with(
+        &self,
+        data: &[u8],
+        copy: impl FnOnce(*mut u8, *const u8, usize),
+    ) -> Vec<u8> {
+        let mut plane = self.acquire(data.len());
+        if data.is_empty() {
+            return plane;
+        }
+        copy(plane.as_mut_ptr(), data.as_ptr(), data.len());
+        // SAFETY: `acquire` reserved `data.len()` bytes and the caller guarantees `copy` initialised them.
+        unsafe { plane.set_len(data.len()) };
+        plane
+    }
+
+    /// Returns a buffer from `acquire` that never made it into a frame.
+    pub fn release(&self, plane: Vec<u8>) {
+        self.inner.recycle(plane);
+    }
+
+    pub fn recycler(&self) -> Arc<dyn PlaneRecycler> {
+        self.inner.clone()
+    }
+
+    pub fn idle(&self) -> usize {
+        self.inner.free.lock().map(|free| free.len()).unwrap_or(0)
+    }
+}
+
+impl PlaneRecycler for PoolInner {
+    fn recycle(&self, mut plane: Vec<u8>) {
+        if plane.capacity() == 0 {
+            return;
+        }
+        plane.clear();
+        let Ok(mut free) = self.free.lock() else {
+            return;
+        };
+        if free.len() >= self.limit {
+            // Evict the oldest buffer so sizes from a previous resolution age out.
+            free.remove(0);
+        }
+        free.push(plane);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use subtitle_fast_types::VideoFrame;
+
+    fn pooled_frame(pool: &FramePool) -> VideoFrame {
+        let mut y_plane = pool.acquire(64 * 4);
+        y_plane.resize(64 * 4, 16);
+        let mut uv_plane = pool.acquire(64 * 2);
+        uv_plane.resize(64 * 2, 128);
+        VideoFrame::from_nv12_owned(64, 4, 64, 64, None, None, y_plane, uv_plane)
+            .unwrap()
+            .with_plane_recycler(pool.recycler())
+    }
+
+    #[test]
+    fn planes_return_to_pool_after_last_clone_drops() {
+        let pool = FramePool::new(4);
+        let frame = pooled_frame(&pool);
+        let y_ptr = frame.y_plane().as_ptr();
+        let clone = frame.clone();
+        drop(frame);
+        assert_eq!(pool.idle(), 0);
+        drop(clone);
+        assert_eq!(pool.idle(), 2);
+
+        let reused = pooled_frame(&pool);
+        assert_eq!(reused.y_plane().as_ptr(), y_ptr);
+        assert_eq!(pool.idle(), 0);
+    }
+
+    #[test]
+    fn copy_with_fills_whole_plane() {
+        let pool = FramePool::new(2);
+        let data: Vec<u8> = (0..=255).collect();
+        let plane = unsafe {
+            pool.copy_with(&data, |dst, src, len| {
+                std::ptr::copy_nonoverlapping(src, dst, len)
+            })
+        };
+        assert_eq!(plane, data);
+        assert!(unsafe { pool.copy_with(&[], |_, _, _| unreachable!()) }.is_empty());
+    }
+
+    #[test]
+    fn pool_keeps_the_planes_of_at_most_limit_frames() {
+        let pool = FramePool::new(3);
+        let frames: Vec<_> = (0..4).map(|_| pooled_frame(&pool)).collect();
+        drop(frames);
+        assert_eq!(pool.idle(), 3 * PLANES_PER_FRAME);
+    }
+
+    #[test]
+    fn released_buffers_are_reused() {
+        let pool = FramePool::new(4);
+        let plane = pool.acquire(256);
+        let ptr = plane.as_ptr();
+        pool.release(plane);
+        assert_eq!(pool.idle(), 1);
+        let reused = pool.acquire(240);
+        assert_eq!(reused.as_ptr(), ptr);
+    }
+
+    #[test]
+    fn y_and_uv_planes_keep_their_own_buffers() {
+        let pool = FramePool::new(2);
+        let first = pooled_frame(&pool);
+        let pointers = (first.y_plane().as_ptr(), first.uv_plane().as_ptr());
+        drop(first);
+        for _ in 0..8 {
+            let frame = pooled_frame(&pool);
+            assert_eq!(
+                (frame.y_plane().as_ptr(), frame.uv_plane().as_ptr()),
+                pointers
+            );
+        }
+    }
+}
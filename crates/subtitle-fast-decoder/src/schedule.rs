@@ -0,0 +1,104 @@
+use std::time::Duration;
+
+const EPSILON: f64 = 1e-6;
+
+/// Picks the first frame at or after each `i / samples_per_second` offset within every second.
+///
+/// The detection sampler and the sampler-aware backends share this schedule so a backend can
+/// skip readback for exactly the frames the sampler would discard.
+#[derive(Debug, Clone)]
+pub struct SampleSchedule {
+    samples_per_second: u32,
+    current_second: Option<u64>,
+    targets: Vec<f64>,
+    next_target_idx: usize,
+}
+
+impl SampleSchedule {
+    pub fn new(samples_per_second: u32) -> Self {
+        let samples = samples_per_second.max(1);
+        let mut targets = Vec::with_capacity(samples as usize);
+        for i in 0..samples {
+            let target = if i == 0 {
+                0.0
+            } else {
+                i as f64 / samples as f64
+            };
+            targets.push(target);
+        }
+
+        Self {
+            samples_per_second: samples,
+            current_second: None,
+            targets,
+            next_target_idx: 0,
+        }
+    }
+
+    pub fn samples_per_second(&self) -> u32 {
+        self.samples_per_second
+    }
+
+    /// `processed_index` is the 1-based count of frames observed so far and is only used when
+    /// the frame has no timestamp.
+    pub fn should_sample(&mut self, timestamp: Option<Duration>, processed_index: u64) -> bool {
+        let (second_index, elapsed) = self.resolve_second(timestamp, processed_index);
+
+        if self.current_second != Some(second_index) {
+            self.current_second = Some(second_index);
+            self.next_target_idx = 0;
+        }
+
+        let mut should_sample = false;
+        while self.next_target_idx < self.targets.len()
+            && elapsed + EPSILON >= self.targets[self.next_target_idx]
+        {
+            should_sample = true;
+            self.next_target_idx += 1;
+        }
+
+        should_sample
+    }
+
+    fn resolve_second(&self, timestamp: Option<Duration>, processed_index: u64) -> (u64, f64) {
+        if let Some(ts) = timestamp {
+            let second_index = ts.as_secs();
+            let fractional = ts
+                .checked_sub(Duration::from_secs(second_index))
+                .unwrap_or_else(|| Duration::from_secs(0))
+                .as_secs_f64();
+            return (second_index, fractional);
+        }
+
+        let samples = self.samples_per_second as u64;
+        let processed = processed_index.saturating_sub(1);
+        let second_index = processed / samples;
+        let offset = processed.saturating_sub(second_index * samples);
+        let elapsed = offset as f64 / self.samples_per_second as f64;
+        (second_index, elapsed)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn picks_first_frame_after_each_target() {
+        let mut schedule = SampleSchedule::new(2);
+        let picked: Vec<u64> = (0..60u64)
+            .filter(|&index| {
+                let pts = Duration::from_secs_f64(index as f64 / 30.0);
+                schedule.should_sample(Some(pts), index + 1)
+            })
+            .collect();
+        assert_eq!(picked, vec![0, 15, 30, 45]);
+    }
+
+    #[test]
+    fn falls_back_to_frame_count_without_timestamps() {
+        let mut schedule = SampleSchedule::new(1);
+        assert!(schedule.should_sample(None, 1));
+        assert!(schedule.should_sample(None, 2));
+    }
+}
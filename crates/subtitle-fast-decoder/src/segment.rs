@@ -0,0 +1,284 @@
+//! Parallel segmented decoding.
+//!
+//! The frame range is cut into short chunks that are dealt round-robin to several workers, each
+//! running its own bridge reader. A worker decodes one chunk, then seeks to its next one; the
+//! merger drains worker channels chunk by chunk so the resulting stream stays in index order.
+
+use std::collections::VecDeque;
+use std::ops::Range;
+
+use futures_util::stream::unfold;
+use tokio::sync::mpsc::{self, Receiver, Sender};
+
+use crate::core::{DecoderResult, FrameStream, VideoFrame, VideoMetadata};
+use crate::index::FrameIndex;
+
+/// Length of one chunk. Per-worker buffering is one chunk of frames, so keep it short; it still has
+/// to be long enough that the keyframe run-up after each seek stays a small fraction of the work.
+pub const SEGMENT_SECONDS: f64 = 2.0;
+
+/// Splits `start..total` into consecutive chunks of `chunk_frames` frames.
+pub fn plan_chunks(start: u64, total: u64, chunk_frames: u64) -> Vec<Range<u64>> {
+    let chunk_frames = chunk_frames.max(1);
+    let mut chunks = Vec::new();
+    let mut begin = start;
+    while begin < total {
+        let end = begin.saturating_add(chunk_frames).min(total);
+        chunks.push(begin..end);
+        begin = end;
+    }
+    chunks
+}
+
+/// Frames per chunk for the given frame rate.
+pub fn chunk_frames(fps: f64) -> Option<u64> {
+    if !(fps.is_finite() && fps > 0.0) {
+        return None;
+    }
+    Some((fps * SEGMENT_SECONDS).ceil().max(1.0) as u64)
+}
+
+/// Moves every boundary between chunks forward to the next of `keyframes`, so each seek to a chunk lands
+/// on a keyframe and decodes no run-up from the previous GOP. Chunks a move swallows are dropped.
+pub fn align_to_keyframes(chunks: Vec<Range<u64>>, keyframes: &[u64]) -> Vec<Range<u64>> {
+    let (Some(first), Some(last)) = (chunks.first(), chunks.last()) else {
+        return chunks;
+    };
+    let (start, end) = (first.start, last.end);
+    let mut aligned = Vec::with_capacity(chunks.len());
+    let mut begin = start;
+    for chunk in &chunks[..chunks.len() - 1] {
+        let slot = keyframes.partition_point(|key| *key < chunk.end);
+        let boundary = keyframes.get(slot).map_or(end, |key| (*key).min(end));
+        if boundary > begin {
+            aligned.push(begin..boundary);
+            begin = boundary;
+        }
+    }
+    if begin < end {
+        aligned.push(begin..end);
+    }
+    aligned
+}
+
+/// Chunks for a segmented decode, or `None` when the input cannot or need not be split. With a frame
+/// index the chunks start on keyframes; without one they are cut by frame count, and each worker
+/// decodes up to a GOP of run-up after every seek.
+pub fn plan_segments(
+    metadata: &VideoMetadata,
+    start_frame: Option<u64>,
+    workers: usize,
+    index: Option<&FrameIndex>,
+) -> Option<Vec<Range<u64>>> {
+    if workers < 2 {
+        return None;
+    }
+    let chunk = chunk_frames(metadata.fps?)?;
+    let mut chunks = plan_chunks(start_frame.unwrap_or(0), metadata.total_frames?, chunk);
+    if let Some(index) = index.filter(|index| !index.keyframes().is_empty()) {
+        chunks = align_to_keyframes(chunks, index.keyframes());
+    }
+    (chunks.len() > 1).then_some(chunks)
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum SegmentStep {
+    Continue,
+    Seek(u64),
+    Finish,
+}
+
+/// Tracks which of a worker's chunks is being decoded.
+pub struct SegmentCursor {
+    current: Range<u64>,
+    pending: VecDeque<Range<u64>>,
+    advance: bool,
+}
+
+impl SegmentCursor {
+    pub fn new(chunks: Vec<Range<u64>>) -> Option<Self> {
+        let mut pending: VecDeque<_> = chunks.into();
+        let current = pending.pop_front()?;
+        Some(Self {
+            current,
+            pending,
+            advance: false,
+        })
+    }
+
+    pub fn first_frame(&self) -> u64 {
+        self.current.start
+    }
+
+    /// Returns whether a frame belongs to the current chunk; the first frame past it ends the chunk.
+    pub fn admit(&mut self, index: u64) -> bool {
+        if self.advance {
+            return false;
+        }
+        if index >= self.current.end {
+            self.advance = true;
+            return false;
+        }
+        index >= self.current.start
+    }
+
+    /// Polled between samples; yields the seek to the next chunk once the current one is done.
+    pub fn step(&mut self) -> SegmentStep {
+        if !self.advance {
+            return SegmentStep::Continue;
+        }
+        self.advance = false;
+        match self.pending.pop_front() {
+            Some(next) => {
+                let start = next.start;
+                self.current = next;
+                SegmentStep::Seek(start)
+            }
+            None => SegmentStep::Finish,
+        }
+    }
+}
+
+/// Runs `task` once per worker with that worker's chunks and merges the results in chunk order.
+pub fn spawn_segmented_stream<F>(
+    capacity: usize,
+    chunks: Vec<Range<u64>>,
+    workers: usize,
+    task: F,
+) -> FrameStream
+where
+    F: Fn(Vec<Range<u64>>, Sender<DecoderResult<VideoFrame>>) + Send + Sync + Clone + 'static,
+{
+    let workers = workers.clamp(1, chunks.len().max(1));
+    let worker_capacity = chunks
+        .iter()
+        .map(|chunk| (chunk.end - chunk.start) as usize)
+        .max()
+        .unwrap_or(1)
+        .max(capacity);
+
+    let mut receivers = Vec::with_capacity(workers);
+    for worker in 0..workers {
+        let assigned: Vec<_> = chunks
+            .iter()
+            .skip(worker)
+            .step_by(workers)
+            .cloned()
+            .collect();
+        let (tx, rx) = mpsc::channel(worker_capacity);
+        let task = task.clone();
+        tokio::task::spawn_blocking(move || task(assigned, tx));
+        receivers.push(rx);
+    }
+
+    let (tx, rx) = mpsc::channel(capacity.max(1));
+    tokio::spawn(merge_chunks(chunks, receivers, tx));
+    Box::pin(unfold(rx, |mut receiver| async {
+        receiver.recv().await.map(|item| (item, receiver))
+    }))
+}
+
+async fn merge_chunks(
+    chunks: Vec<Range<u64>>,
+    mut receivers: Vec<Receiver<DecoderResult<VideoFrame>>>,
+    tx: Sender<DecoderResult<VideoFrame>>,
+) {
+    let workers = receivers.len();
+    let mut peeked: Vec<Option<VideoFrame>> = (0..workers).map(|_| None).collect();
+    for (position, chunk) in chunks.iter().enumerate() {
+        let worker = position % workers;
+        loop {
+            let item = match peeked[worker].take() {
+                Some(frame) => Some(Ok(frame)),
+                None => receivers[worker].recv().await,
+            };
+            let Some(item) = item else {
+                break;
+            };
+            let frame = match item {
+                Ok(frame) => frame,
+                Err(err) => {
+                    let _ = tx.send(Err(err)).await;
+                    return;
+                }
+            };
+            if let Some(index) = frame.index() {
+                if index >= chunk.end {
+                    // First frame of this worker's next chunk.
+                    peeked[worker] = Some(frame);
+                    break;
+                }
+                if index < chunk.start {
+                    continue;
+                }
+            }
+            if tx.send(Ok(frame)).await.is_err() {
+                return;
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use tokio_stream::StreamExt;
+
+    fn frame(index: u64) -> VideoFrame {
+        VideoFrame::from_nv12_owned(2, 2, 2, 2, None, None, vec![0; 4], vec![128; 2])
+            .unwrap()
+            .with_index(Some(index))
+    }
+
+    #[test]
+    fn plan_chunks_covers_range() {
+        let chunks = plan_chunks(5, 30, 10);
+        assert_eq!(chunks, vec![5..15, 15..25, 25..30]);
+        assert!(plan_chunks(30, 30, 10).is_empty());
+    }
+
+    #[test]
+    fn chunk_boundaries_move_to_the_next_keyframe() {
+        let chunks = plan_chunks(0, 40, 10);
+        assert_eq!(
+            align_to_keyframes(chunks.clone(), &[0, 12, 18, 24, 36]),
+            vec![0..12, 12..24, 24..36, 36..40]
+        );
+        // A GOP longer than a chunk swallows the chunks inside it.
+        assert_eq!(align_to_keyframes(chunks, &[0, 25]), vec![0..25, 25..40]);
+    }
+
+    #[test]
+    fn cursor_seeks_to_next_chunk_after_boundary() {
+        let mut cursor = SegmentCursor::new(vec![0..4, 8..12]).unwrap();
+        assert_eq!(cursor.first_frame(), 0);
+        assert!(cursor.admit(3));
+        assert_eq!(cursor.step(), SegmentStep::Continue);
+        assert!(!cursor.admit(4));
+        assert!(!cursor.admit(5));
+        assert_eq!(cursor.step(), SegmentStep::Seek(8));
+        assert!(!cursor.admit(7));
+        assert!(cursor.admit(8));
+        assert!(!cursor.admit(12));
+        assert_eq!(cursor.step(), SegmentStep::Finish);
+    }
+
+    #[tokio::test(flavor = "multi_thread")]
+    async fn segmented_stream_merges_in_index_order() {
+        let chunks = plan_chunks(0, 20, 3);
+        let stream = spawn_segmented_stream(2, chunks, 3, |assigned, tx| {
+            for chunk in assigned {
+                for index in chunk {
+                    if tx.blocking_send(Ok(frame(index))).is_err() {
+                        return;
+                    }
+                }
+            }
+        });
+        let indices: Vec<u64> = stream
+            .map(|item| item.unwrap().index().unwrap())
+            .collect()
+            .await;
+        assert_eq!(indices, (0..20).collect::<Vec<_>>());
+    }
+}
@@ -1,4 +1,6 @@
-use subtitle_fast_decoder::{Backend, Configuration, DecoderError, OutputFormat};
+use subtitle_fast_decoder::{
+    Backend, Backpressure, Configuration, DecoderError, OutputFormat, ScanMode,
+};
 
 #[test]
 fn handle_output_rejects_non_videotoolbox_backend() {
@@ -8,6 +10,21 @@ fn handle_output_rejects_non_videotoolbox_backend() {
         channel_capacity: None,
         output_format: OutputFormat::CVPixelBuffer,
         start_frame: None,
+        readback_depth: None,
+        samples_per_second: None,
+        crop: None,
+        retained_frames: None,
+        scan: ScanMode::Full,
+        decode_workers: None,
+        read_ahead: None,
+        luma_gate: None,
+        scale_height: None,
+        delivery_batch: None,
+        index_cache: None,
+        change_detection: None,
+        prefetch: None,
+        luma_cache: None,
+        backpressure: Backpressure::Block,
     };
 
     let err = match config.create_provider() {
@@ -23,3 +40,38 @@ fn handle_output_rejects_non_videotoolbox_backend() {
         other => panic!("unexpected error: {other:?}"),
     }
 }
+
+#[test]
+fn texture_output_rejects_non_dxva_backend() {
+    let config = Configuration {
+        backend: Backend::Mock,
+        input: None,
+        channel_capacity: None,
+        output_format: OutputFormat::D3D11Texture,
+        start_frame: None,
+        readback_depth: None,
+        samples_per_second: None,
+        crop: None,
+        retained_frames: None,
+        scan: ScanMode::Full,
+        decode_workers: None,
+        read_ahead: None,
+        luma_gate: None,
+        scale_height: None,
+        delivery_batch: None,
+        index_cache: None,
+        change_detection: None,
+        prefetch: None,
+        luma_cache: None,
+        backpressure: Backpressure::Block,
+    };
+
+    match config.create_provider() {
+        Err(DecoderError::Configuration { message }) => {
+            assert!(message.contains("dxva"));
+            assert!(message.contains(OutputFormat::D3D11Texture.as_str()));
+        }
+        Err(other) => panic!("unexpected error: {other:?}"),
+        Ok(_) => panic!("expected output format validation to fail"),
+    }
+}
@@ -0,0 +1,65 @@
+use std::time::Duration;
+
+use subtitle_fast_decoder::{
+    Backend, Backpressure, Configuration, DecoderError, OutputFormat, ScanMode,
+};
+
+fn mock_config(scan: ScanMode) -> Configuration {
+    Configuration {
+        backend: Backend::Mock,
+        input: None,
+        channel_capacity: None,
+        output_format: OutputFormat::Nv12,
+        start_frame: None,
+        readback_depth: None,
+        samples_per_second: None,
+        crop: None,
+        retained_frames: None,
+        scan,
+        decode_workers: None,
+        read_ahead: None,
+        luma_gate: None,
+        scale_height: None,
+        delivery_batch: None,
+        index_cache: None,
+        change_detection: None,
+        prefetch: None,
+        luma_cache: None,
+        backpressure: Backpressure::Block,
+    }
+}
+
+#[test]
+fn keyframe_scan_rejects_unsupported_backend() {
+    let config = mock_config(ScanMode::Keyframes {
+        interval: Duration::from_secs(1),
+    });
+
+    let err = match config.create_provider() {
+        Ok(_) => panic!("expected scan mode validation to fail"),
+        Err(err) => err,
+    };
+
+    match err {
+        DecoderError::Configuration { message } => {
+            assert!(message.contains("keyframes"));
+            assert!(message.contains("mock"));
+        }
+        other => panic!("unexpected error: {other:?}"),
+    }
+}
+
+#[test]
+fn keyframe_scan_rejects_zero_interval() {
+    let config = mock_config(ScanMode::Keyframes {
+        interval: Duration::ZERO,
+    });
+
+    match config.create_provider() {
+        Err(DecoderError::Configuration { message }) => {
+            assert!(message.contains("greater than zero"));
+        }
+        Err(other) => panic!("unexpected error: {other:?}"),
+        Ok(_) => panic!("expected scan mode validation to fail"),
+    }
+}
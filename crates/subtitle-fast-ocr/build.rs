@@ -1,4 +1,4 @@
-#[cfg(target_os = "macos")]
+#[cfg(any(target_os = "macos", target_os = "windows"))]
 use std::env;
 
 #[cfg(target_os = "macos")]
@@ -24,7 +24,38 @@ fn build_vision_bridge() {
 #[cfg(not(target_os = "macos"))]
 fn build_vision_bridge() {}
 
+#[cfg(target_os = "windows")]
+fn build_windows_ocr_bridge() {
+    if env::var("CARGO_FEATURE_ENGINE_WINDOWS_OCR").is_err() {
+        return;
+    }
+
+    println!("cargo:rerun-if-changed=src/backends/windows_ocr/windows_ocr_bridge.cpp");
+    // C++/WinRT headers ship with the Windows SDK for MSVC only; fail here rather than deep in the compile.
+    if env::var("CARGO_CFG_TARGET_ENV").as_deref() != Ok("msvc") {
+        panic!(
+            "engine-windows-ocr needs a *-windows-msvc target with the Windows SDK's C++/WinRT headers"
+        );
+    }
+
+    let mut build = cc::Build::new();
+    build.file("src/backends/windows_ocr/windows_ocr_bridge.cpp");
+    build.cpp(true);
+    build.flag_if_supported("/std:c++17");
+    build.flag_if_supported("-std=c++17");
+    // C++/WinRT reports failures as exceptions.
+    build.flag_if_supported("/EHsc");
+    build.compile("windows_ocr_bridge");
+
+    println!("cargo:rustc-link-lib=windowsapp");
+    println!("cargo:rustc-link-lib=ole32");
+}
+
+#[cfg(not(target_os = "windows"))]
+fn build_windows_ocr_bridge() {}
+
 fn main() {
     println!("cargo:rerun-if-changed=build.rs");
     build_vision_bridge();
+    build_windows_ocr_bridge();
 }
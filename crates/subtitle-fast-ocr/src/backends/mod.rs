@@ -1,2 +1,4 @@
 #[cfg(all(feature = "engine-vision", target_os = "macos"))]
 pub mod vision;
+#[cfg(all(feature = "engine-windows-ocr", target_os = "windows"))]
+pub mod windows_ocr;
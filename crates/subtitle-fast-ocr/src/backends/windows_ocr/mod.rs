@@ -0,0 +1,473 @@
+use std::ffi::{CStr, CString, c_char, c_void};
+use std::ptr::{self, NonNull};
+use std::slice;
+use std::sync::Mutex;
+
+use crate::{LumaPlane, OcrEngine, OcrError, OcrRegion, OcrRequest, OcrResponse, OcrText};
+
+/// Rows and columns around each region in a stacked bitmap, so lines of neighbouring regions stay apart.
+const REGION_MARGIN: u32 = 8;
+
+#[repr(C)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+struct CWindowsOcrBand {
+    src_x: u32,
+    src_y: u32,
+    width: u32,
+    height: u32,
+    dst_x: u32,
+    dst_y: u32,
+    slot_top: u32,
+    slot_height: u32,
+    fill: u8,
+}
+
+#[repr(C)]
+#[derive(Clone, Copy)]
+struct CWindowsOcrRect {
+    x: f32,
+    y: f32,
+    width: f32,
+    height: f32,
+}
+
+#[repr(C)]
+struct CWindowsOcrLine {
+    rect: CWindowsOcrRect,
+    text: *mut c_char,
+}
+
+#[repr(C)]
+struct CWindowsOcrResult {
+    lines: *mut CWindowsOcrLine,
+    count: usize,
+    error: *mut c_char,
+}
+
+unsafe extern "C" {
+    fn windows_ocr_create(
+        languages: *const *const c_char,
+        languages_count: usize,
+        out_error: *mut *mut c_char,
+    ) -> *mut c_void;
+
+    fn windows_ocr_destroy(recognizer: *mut c_void);
+
+    fn windows_ocr_max_dimension(recognizer: *mut c_void) -> u32;
+
+    #[allow(clippy::too_many_arguments)]
+    fn windows_ocr_recognize(
+        recognizer: *mut c_void,
+        data: *const u8,
+        plane_width: u32,
+        plane_height: u32,
+        stride: usize,
+        bitmap_width: u32,
+        bitmap_height: u32,
+        bands: *const CWindowsOcrBand,
+        bands_count: usize,
+    ) -> CWindowsOcrResult;
+
+    fn windows_ocr_result_destroy(result: CWindowsOcrResult);
+
+    fn windows_ocr_string_free(ptr: *mut c_char);
+}
+
+struct OwnedWindowsOcrResult {
+    raw: CWindowsOcrResult,
+}
+
+impl OwnedWindowsOcrResult {
+    fn new(raw: CWindowsOcrResult) -> Self {
+        Self { raw }
+    }
+
+    fn error_message(&self) -> Option<String> {
+        if self.raw.error.is_null() {
+            None
+        } else {
+            Some(
+                unsafe { CStr::from_ptr(self.raw.error) }
+                    .to_string_lossy()
+                    .into_owned(),
+            )
+        }
+    }
+
+    fn lines(&self) -> &[CWindowsOcrLine] {
+        if self.raw.count == 0 || self.raw.lines.is_null() {
+            &[]
+        } else {
+            unsafe { slice::from_raw_parts(self.raw.lines, self.raw.count) }
+        }
+    }
+}
+
+impl Drop for OwnedWindowsOcrResult {
+    fn drop(&mut self) {
+        unsafe {
+            windows_ocr_result_destroy(CWindowsOcrResult {
+                lines: self.raw.lines,
+                count: self.raw.count,
+                error: self.raw.error,
+            });
+        }
+        self.raw.lines = ptr::null_mut();
+        self.raw.error = ptr::null_mut();
+        self.raw.count = 0;
+    }
+}
+
+/// A `Windows.Media.Ocr` recognizer; creating one loads its language model.
+#[derive(Debug)]
+struct Recognizer(NonNull<c_void>);
+
+// SAFETY: the bridge's recognizer wraps an agile WinRT object, and the engine's pool hands each one to a
+// single request at a time.
+unsafe impl Send for Recognizer {}
+
+impl Drop for Recognizer {
+    fn drop(&mut self) {
+        unsafe { windows_ocr_destroy(self.0.as_ptr()) };
+    }
+}
+
+/// Regions of one request stacked top to bottom into a bitmap that a single `RecognizeAsync` reads.
+#[derive(Debug, Default, PartialEq, Eq)]
+struct Stack {
+    width: u32,
+    height: u32,
+    bands: Vec<CWindowsOcrBand>,
+}
+
+impl Stack {
+    /// Maps a line from bitmap pixels back onto the plane, clipped to the band its centre falls in.
+    fn place(&self, rect: CWindowsOcrRect) -> Option<OcrRegion> {
+        let centre = rect.y + rect.height / 2.0;
+        let band = self.bands.iter().find(|band| {
+            centre >= band.slot_top as f32 && centre < (band.slot_top + band.slot_height) as f32
+        })?;
+        let left = (rect.x - band.dst_x as f32).clamp(0.0, band.width as f32);
+        let right = (rect.x + rect.width - band.dst_x as f32).clamp(0.0, band.width as f32);
+        let top = (rect.y - band.dst_y as f32).clamp(0.0, band.height as f32);
+        let bottom = (rect.y + rect.height - band.dst_y as f32).clamp(0.0, band.height as f32);
+        (right > left && bottom > top).then(|| {
+            OcrRegion::new(
+                band.src_x as f32 + left,
+                band.src_y as f32 + top,
+                right - left,
+                bottom - top,
+            )
+        })
+    }
+}
+
+/// Clips `regions` (plane pixels) to the plane and stacks them, in order, into as few bitmaps as fit within
+/// `max_dimension` either way. Regions larger than that are cut to it.
+fn plan_stacks(
+    plane_width: u32,
+    plane_height: u32,
+    regions: &[OcrRegion],
+    max_dimension: u32,
+) -> Vec<Stack> {
+    let limit = max_dimension.saturating_sub(2 * REGION_MARGIN);
+    let mut stacks = Vec::new();
+    if limit == 0 {
+        return stacks;
+    }
+    let mut current = Stack::default();
+    for region in regions {
+        // `as` saturates negative and NaN edges to zero.
+        let left = (region.x.floor() as u32).min(plane_width);
+        let top = (region.y.floor() as u32).min(plane_height);
+        let right = ((region.x + region.width).ceil() as u32).min(plane_width);
+        let bottom = ((region.y + region.height).ceil() as u32).min(plane_height);
+        if right <= left || bottom <= top {
+            continue;
+        }
+        let width = (right - left).min(limit);
+        let height = (bottom - top).min(limit);
+        let slot_height = height + 2 * REGION_MARGIN;
+        if current.height + slot_height > max_dimension {
+            stacks.push(std::mem::take(&mut current));
+        }
+        current.bands.push(CWindowsOcrBand {
+            src_x: left,
+            src_y: top,
+            width,
+            height,
+            dst_x: REGION_MARGIN,
+            dst_y: current.height + REGION_MARGIN,
+            slot_top: current.height,
+            slot_height,
+            fill: 0,
+        });
+        current.width = current.width.max(width + 2 * REGION_MARGIN);
+        current.height += slot_height;
+    }
+    if !current.bands.is_empty() {
+        stacks.push(current);
+    }
+    stacks
+}
+
+/// Mean luma along the edge of the band's source rectangle, which the margins around it are painted with
+/// so the recognizer sees no border.
+fn border_fill(plane: &LumaPlane<'_>, band: &CWindowsOcrBand) -> u8 {
+    let data = plane.data();
+    let stride = plane.stride();
+    let (x, y, width, height) = (
+        band.src_x as usize,
+        band.src_y as usize,
+        band.width as usize,
+        band.height as usize,
+    );
+    let row = |r: usize| &data[(y + r) * stride + x..(y + r) * stride + x + width];
+    let mut sum: u64 = 0;
+    let mut count: u64 = 0;
+    for r in [0, height - 1] {
+        sum += row(r).iter().map(|&value| u64::from(value)).sum::<u64>();
+        count += width as u64;
+    }
+    for r in 1..height.saturating_sub(1) {
+        let pixels = row(r);
+        sum += u64::from(pixels[0]) + u64::from(pixels[width - 1]);
+        count += 2;
+    }
+    (sum / count.max(1)) as u8
+}
+
+#[derive(Debug, Clone, Default)]
+pub struct WindowsOcrConfig {
+    /// BCP-47 tags tried in order; the first with an installed OCR language pack is used. Empty uses the
+    /// user's profile languages.
+    pub languages: Vec<String>,
+}
+
+/// `Windows.Media.Ocr` reading the luma plane directly as a Gray8 bitmap. All regions of a request are stacked
+/// into one bitmap, so a frame costs one recognition however many lines it has. Recognizers are pooled and
+/// reused across requests; concurrent requests each take their own.
+#[derive(Debug)]
+pub struct WindowsOcrEngine {
+    languages: Vec<CString>,
+    max_dimension: u32,
+    idle: Mutex<Vec<Recognizer>>,
+}
+
+impl WindowsOcrEngine {
+    pub fn new() -> Result<Self, OcrError> {
+        Self::with_config(WindowsOcrConfig::default())
+    }
+
+    pub fn with_config(config: WindowsOcrConfig) -> Result<Self, OcrError> {
+        let mut languages = Vec::with_capacity(config.languages.len());
+        for value in config.languages {
+            let trimmed = value.trim();
+            if trimmed.is_empty() {
+                continue;
+            }
+            let cstr = CString::new(trimmed).map_err(|_| {
+                OcrError::backend(
+                    "windows OCR language contains interior null byte and cannot be used",
+                )
+            })?;
+            if !languages.iter().any(|existing| existing == &cstr) {
+                languages.push(cstr);
+            }
+        }
+        let mut engine = Self {
+            languages,
+            max_dimension: 0,
+            idle: Mutex::new(Vec::new()),
+        };
+        // A missing language pack fails here rather than on the first frame.
+        let recognizer = engine.create_recognizer()?;
+        engine.max_dimension = unsafe { windows_ocr_max_dimension(recognizer.0.as_ptr()) };
+        engine.check_in(recognizer);
+        Ok(engine)
+    }
+
+    fn create_recognizer(&self) -> Result<Recognizer, OcrError> {
+        let language_ptrs: Vec<*const c_char> =
+            self.languages.iter().map(|lang| lang.as_ptr()).collect();
+        let (languages_ptr, languages_count) = if language_ptrs.is_empty() {
+            (ptr::null(), 0)
+        } else {
+            (language_ptrs.as_ptr(), language_ptrs.len())
+        };
+        let mut error: *mut c_char = ptr::null_mut();
+        let raw = unsafe { windows_ocr_create(languages_ptr, languages_count, &mut error) };
+        let message = (!error.is_null()).then(|| {
+            let message = unsafe { CStr::from_ptr(error) }
+                .to_string_lossy()
+                .into_owned();
+            unsafe { windows_ocr_string_free(error) };
+            message
+        });
+        NonNull::new(raw).map(Recognizer).ok_or_else(|| {
+            OcrError::backend(
+                message.unwrap_or_else(|| "windows OCR engine failed to initialize".to_string()),
+            )
+        })
+    }
+
+    fn check_out(&self) -> Result<Recognizer, OcrError> {
+        let idle = self
+            .idle
+            .lock()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+            .pop();
+        match idle {
+            Some(recognizer) => Ok(recognizer),
+            None => self.create_recognizer(),
+        }
+    }
+
+    fn check_in(&self, recognizer: Recognizer) {
+        self.idle
+            .lock()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+            .push(recognizer);
+    }
+
+    fn recognize_stack(
+        &self,
+        recognizer: &Recognizer,
+        plane: &LumaPlane<'_>,
+        stack: &Stack,
+        texts: &mut Vec<OcrText>,
+    ) -> Result<(), OcrError> {
+        let raw = unsafe {
+            windows_ocr_recognize(
+                recognizer.0.as_ptr(),
+                plane.data().as_ptr(),
+                plane.width(),
+                plane.height(),
+                plane.stride(),
+                stack.width,
+                stack.height,
+                stack.bands.as_ptr(),
+                stack.bands.len(),
+            )
+        };
+        let owned = OwnedWindowsOcrResult::new(raw);
+        if let Some(message) = owned.error_message() {
+            return Err(OcrError::backend(message));
+        }
+        for line in owned.lines() {
+            if line.text.is_null() {
+                continue;
+            }
+            let text = unsafe { CStr::from_ptr(line.text) }
+                .to_string_lossy()
+                .into_owned();
+            if text.trim().is_empty() {
+                continue;
+            }
+            // Windows.Media.Ocr reports no confidence.
+            if let Some(region) = stack.place(line.rect) {
+                texts.push(OcrText::new(region, text));
+            }
+        }
+        Ok(())
+    }
+}
+
+impl OcrEngine for WindowsOcrEngine {
+    fn name(&self) -> &'static str {
+        "windows_media_ocr"
+    }
+
+    fn recognize(&self, request: &OcrRequest<'_>) -> Result<OcrResponse, OcrError> {
+        let plane = request.plane();
+        if plane.data().is_empty() || plane.stride() < plane.width() as usize {
+            return Ok(OcrResponse::empty());
+        }
+        let whole_plane = [OcrRegion::new(
+            0.0,
+            0.0,
+            plane.width() as f32,
+            plane.height() as f32,
+        )];
+        let regions = match request.regions() {
+            [] => &whole_plane[..],
+            regions => regions,
+        };
+        let mut stacks = plan_stacks(plane.width(), plane.height(), regions, self.max_dimension);
+        for band in stacks.iter_mut().flat_map(|stack| stack.bands.iter_mut()) {
+            band.fill = border_fill(plane, band);
+        }
+
+        let recognizer = self.check_out()?;
+        let mut texts = Vec::new();
+        let outcome = stacks
+            .iter()
+            .try_for_each(|stack| self.recognize_stack(&recognizer, plane, stack, &mut texts));
+        self.check_in(recognizer);
+        outcome?;
+        Ok(OcrResponse::new(texts))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn rect(x: f32, y: f32, width: f32, height: f32) -> CWindowsOcrRect {
+        CWindowsOcrRect {
+            x,
+            y,
+            width,
+            height,
+        }
+    }
+
+    #[test]
+    fn regions_stack_into_bitmaps_that_fit() {
+        let regions = [
+            OcrRegion::new(100.0, 900.0, 800.0, 60.0),
+            OcrRegion::new(-20.0, 1000.0, 200.0, 200.0),
+            OcrRegion::new(5000.0, 0.0, 10.0, 10.0),
+            OcrRegion::new(0.0, 0.0, 1920.0, 40.0),
+        ];
+        let stacks = plan_stacks(1920, 1080, &regions, 200);
+        // The off-plane region is gone, the one past the left edge is clipped and the last needs a second bitmap.
+        assert_eq!(stacks.len(), 2);
+        let first = &stacks[0];
+        assert_eq!(first.bands.len(), 2);
+        assert_eq!((first.bands[0].src_x, first.bands[0].src_y), (100, 900));
+        assert_eq!((first.bands[1].src_x, first.bands[1].width), (0, 180));
+        assert_eq!(first.bands[1].height, 80);
+        assert_eq!(first.height, 76 + 96);
+        assert!(first.width <= 200 && first.height <= 200);
+        assert_eq!(stacks[1].bands[0].dst_y, REGION_MARGIN);
+    }
+
+    #[test]
+    fn lines_map_back_to_their_region() {
+        let regions = [
+            OcrRegion::new(100.0, 900.0, 800.0, 60.0),
+            OcrRegion::new(300.0, 120.0, 400.0, 40.0),
+        ];
+        let stacks = plan_stacks(1920, 1080, &regions, 2600);
+        let stack = &stacks[0];
+        let first = stack.place(rect(18.0, 20.0, 300.0, 30.0)).unwrap();
+        assert_eq!(first, OcrRegion::new(110.0, 912.0, 300.0, 30.0));
+        // A line in the second slot, spilling into the margin, is clipped to the second region.
+        let second = stack.place(rect(4.0, 84.0, 100.0, 30.0)).unwrap();
+        assert_eq!(second, OcrRegion::new(300.0, 120.0, 96.0, 30.0));
+        assert!(stack.place(rect(0.0, 500.0, 10.0, 10.0)).is_none());
+    }
+
+    #[test]
+    fn margins_take_the_region_border_luma() {
+        let mut data = vec![200u8; 8 * 6];
+        data[2 * 8 + 3] = 0;
+        let plane = LumaPlane::from_parts(8, 6, 8, &data).unwrap();
+        let band = plan_stacks(8, 6, &[OcrRegion::new(2.0, 1.0, 3.0, 3.0)], 64)[0].bands[0];
+        // The dark pixel is the centre of the 3x3 region, so the border is uniform.
+        assert_eq!(border_fill(&plane, &band), 200);
+        let band = plan_stacks(8, 6, &[OcrRegion::new(3.0, 2.0, 2.0, 1.0)], 64)[0].bands[0];
+        assert_eq!(border_fill(&plane, &band), 100);
+    }
+}
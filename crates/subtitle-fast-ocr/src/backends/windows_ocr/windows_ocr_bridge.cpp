@@ -0,0 +1,332 @@
+#ifdef _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <combaseapi.h>
+#include <MemoryBuffer.h>
+
+#include <winrt/base.h>
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Foundation.Collections.h>
+#include <winrt/Windows.Globalization.h>
+#include <winrt/Windows.Graphics.Imaging.h>
+#include <winrt/Windows.Media.Ocr.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    namespace globalization = winrt::Windows::Globalization;
+    namespace imaging = winrt::Windows::Graphics::Imaging;
+    namespace ocr = winrt::Windows::Media::Ocr;
+
+    std::string hresult(const char *label, HRESULT hr)
+    {
+        char buffer[80];
+        std::snprintf(buffer, sizeof(buffer), "%s failed: 0x%08lx", label, static_cast<unsigned long>(hr));
+        return buffer;
+    }
+
+    std::string describe(const char *label, const winrt::hresult_error &error)
+    {
+        std::string message = winrt::to_string(error.message());
+        if (message.empty()) { return hresult(label, error.code()); }
+        return std::string(label) + " failed: " + message;
+    }
+
+    char *duplicate_string(const std::string &value)
+    {
+        char *buffer = static_cast<char *>(CoTaskMemAlloc(value.size() + 1));
+        if (buffer) { std::memcpy(buffer, value.c_str(), value.size() + 1); }
+        return buffer;
+    }
+
+    void set_error(char **out, const std::string &message)
+    {
+        if (out) { *out = duplicate_string(message); }
+    }
+
+    // Waiting on a WinRT operation from a single-threaded apartment deadlocks, so every calling thread joins
+    // the MTA on first use and stays in it; threads a host already made STA get an error instead.
+    bool ensure_apartment(std::string &error)
+    {
+        thread_local const HRESULT joined = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+        if (SUCCEEDED(joined)) { return true; }
+        APTTYPE type = APTTYPE_CURRENT;
+        APTTYPEQUALIFIER qualifier = APTTYPEQUALIFIER_NONE;
+        if (joined == RPC_E_CHANGED_MODE && SUCCEEDED(CoGetApartmentType(&type, &qualifier)) && type == APTTYPE_MTA)
+        {
+            return true;
+        }
+        error = joined == RPC_E_CHANGED_MODE ? "Windows OCR cannot run on a single-threaded apartment thread"
+                                             : hresult("CoInitializeEx", joined);
+        return false;
+    }
+
+    struct Recognizer
+    {
+        ocr::OcrEngine engine{nullptr};
+        uint32_t max_dimension = 0;
+    };
+} // namespace
+
+extern "C"
+{
+
+    // Source pixels of one region and where they land in the stacked bitmap. Rows slot_top..slot_top+slot_height
+    // belong to the band and are painted with fill before the region is copied in.
+    struct CWindowsOcrBand
+    {
+        uint32_t src_x;
+        uint32_t src_y;
+        uint32_t width;
+        uint32_t height;
+        uint32_t dst_x;
+        uint32_t dst_y;
+        uint32_t slot_top;
+        uint32_t slot_height;
+        uint8_t fill;
+    };
+
+    struct CWindowsOcrRect
+    {
+        float x;
+        float y;
+        float width;
+        float height;
+    };
+
+    // A recognized line, in bitmap pixels.
+    struct CWindowsOcrLine
+    {
+        CWindowsOcrRect rect;
+        char *text;
+    };
+
+    struct CWindowsOcrResult
+    {
+        CWindowsOcrLine *lines;
+        size_t count;
+        char *error;
+    };
+
+    // Tries `languages` (BCP-47 tags) in order; with none, the user's profile languages.
+    void *windows_ocr_create(const char *const *languages, size_t languages_count, char **out_error)
+    {
+        std::string error;
+        if (!ensure_apartment(error))
+        {
+            set_error(out_error, error);
+            return nullptr;
+        }
+        try
+        {
+            ocr::OcrEngine engine{nullptr};
+            for (size_t i = 0; i < languages_count && !engine; ++i)
+            {
+                if (!languages || !languages[i] || !languages[i][0]) { continue; }
+                globalization::Language language(winrt::to_hstring(std::string_view(languages[i])));
+                if (ocr::OcrEngine::IsLanguageSupported(language))
+                {
+                    engine = ocr::OcrEngine::TryCreateFromLanguage(language);
+                }
+            }
+            if (!engine && languages_count == 0)
+            {
+                engine = ocr::OcrEngine::TryCreateFromUserProfileLanguages();
+            }
+            if (!engine)
+            {
+                set_error(out_error, languages_count == 0
+                                         ? "no OCR language pack is installed for the user's languages"
+                                         : "no OCR language pack is installed for the requested languages");
+                return nullptr;
+            }
+            auto *recognizer = new Recognizer();
+            recognizer->engine = engine;
+            recognizer->max_dimension = ocr::OcrEngine::MaxImageDimension();
+            return recognizer;
+        }
+        catch (const winrt::hresult_error &e)
+        {
+            set_error(out_error, describe("OcrEngine", e));
+        }
+        catch (const std::exception &e)
+        {
+            set_error(out_error, e.what());
+        }
+        return nullptr;
+    }
+
+    void windows_ocr_destroy(void *handle)
+    {
+        delete static_cast<Recognizer *>(handle);
+    }
+
+    // Largest bitmap width or height the recognizer accepts.
+    uint32_t windows_ocr_max_dimension(void *handle)
+    {
+        auto *recognizer = static_cast<Recognizer *>(handle);
+        return recognizer ? recognizer->max_dimension : 0;
+    }
+
+    // Stacks `bands` of the luma plane into one Gray8 bitmap of bitmap_width x bitmap_height and recognizes it
+    // with a single RecognizeAsync.
+    CWindowsOcrResult windows_ocr_recognize(
+        void *handle,
+        const uint8_t *data,
+        uint32_t plane_width,
+        uint32_t plane_height,
+        size_t stride,
+        uint32_t bitmap_width,
+        uint32_t bitmap_height,
+        const CWindowsOcrBand *bands,
+        size_t bands_count)
+    {
+        CWindowsOcrResult result{};
+        auto *recognizer = static_cast<Recognizer *>(handle);
+        if (!recognizer || !data || !bands || bands_count == 0 || bitmap_width == 0 || bitmap_height == 0 ||
+            bitmap_width > recognizer->max_dimension || bitmap_height > recognizer->max_dimension ||
+            stride < plane_width)
+        {
+            result.error = duplicate_string("invalid input for Windows OCR");
+            return result;
+        }
+        std::string error;
+        if (!ensure_apartment(error))
+        {
+            result.error = duplicate_string(error);
+            return result;
+        }
+
+        std::vector<CWindowsOcrLine> lines;
+        try
+        {
+            imaging::SoftwareBitmap bitmap(
+                imaging::BitmapPixelFormat::Gray8,
+                static_cast<int32_t>(bitmap_width),
+                static_cast<int32_t>(bitmap_height),
+                imaging::BitmapAlphaMode::Ignore);
+            {
+                imaging::BitmapBuffer buffer = bitmap.LockBuffer(imaging::BitmapBufferAccessMode::Write);
+                const imaging::BitmapPlaneDescription plane = buffer.GetPlaneDescription(0);
+                winrt::Windows::Foundation::IMemoryBufferReference reference = buffer.CreateReference();
+                auto access = reference.as<::Windows::Foundation::IMemoryBufferByteAccess>();
+                uint8_t *bytes = nullptr;
+                UINT32 capacity = 0;
+                winrt::check_hresult(access->GetBuffer(&bytes, &capacity));
+                uint8_t *origin = bytes + plane.StartIndex;
+                const size_t pitch = static_cast<size_t>(plane.Stride);
+                for (size_t i = 0; i < bands_count; ++i)
+                {
+                    const CWindowsOcrBand &band = bands[i];
+                    if (band.slot_top > bitmap_height || band.slot_height > bitmap_height - band.slot_top ||
+                        band.dst_x > bitmap_width || band.width > bitmap_width - band.dst_x ||
+                        band.dst_y < band.slot_top || band.dst_y > band.slot_top + band.slot_height ||
+                        band.height > band.slot_top + band.slot_height - band.dst_y ||
+                        band.src_x > plane_width || band.width > plane_width - band.src_x ||
+                        band.src_y > plane_height || band.height > plane_height - band.src_y)
+                    {
+                        reference.Close();
+                        buffer.Close();
+                        result.error = duplicate_string("invalid band for Windows OCR");
+                        return result;
+                    }
+                    for (uint32_t row = 0; row < band.slot_height; ++row)
+                    {
+                        std::memset(origin + (band.slot_top + row) * pitch, band.fill, bitmap_width);
+                    }
+                    for (uint32_t row = 0; row < band.height; ++row)
+                    {
+                        std::memcpy(
+                            origin + (band.dst_y + row) * pitch + band.dst_x,
+                            data + (band.src_y + row) * stride + band.src_x,
+                            band.width);
+                    }
+                }
+                reference.Close();
+                buffer.Close();
+            }
+
+            const ocr::OcrResult recognized = recognizer->engine.RecognizeAsync(bitmap).get();
+            for (const ocr::OcrLine &line : recognized.Lines())
+            {
+                float left = (std::numeric_limits<float>::max)();
+                float top = (std::numeric_limits<float>::max)();
+                float right = (std::numeric_limits<float>::lowest)();
+                float bottom = (std::numeric_limits<float>::lowest)();
+                for (const ocr::OcrWord &word : line.Words())
+                {
+                    const winrt::Windows::Foundation::Rect box = word.BoundingRect();
+                    left = (std::min)(left, box.X);
+                    top = (std::min)(top, box.Y);
+                    right = (std::max)(right, box.X + box.Width);
+                    bottom = (std::max)(bottom, box.Y + box.Height);
+                }
+                const std::string text = winrt::to_string(line.Text());
+                if (right <= left || bottom <= top || text.empty()) { continue; }
+                char *copy = duplicate_string(text);
+                if (!copy) { continue; }
+                lines.push_back(CWindowsOcrLine{{left, top, right - left, bottom - top}, copy});
+            }
+        }
+        catch (const winrt::hresult_error &e)
+        {
+            error = describe("Windows.Media.Ocr", e);
+        }
+        catch (const std::exception &e)
+        {
+            error = e.what();
+        }
+
+        if (error.empty() && !lines.empty())
+        {
+            result.lines = static_cast<CWindowsOcrLine *>(CoTaskMemAlloc(lines.size() * sizeof(CWindowsOcrLine)));
+            if (result.lines)
+            {
+                std::memcpy(result.lines, lines.data(), lines.size() * sizeof(CWindowsOcrLine));
+                result.count = lines.size();
+                return result;
+            }
+            error = "failed to allocate the Windows OCR result";
+        }
+        for (CWindowsOcrLine &line : lines)
+        {
+            CoTaskMemFree(line.text);
+        }
+        if (!error.empty()) { result.error = duplicate_string(error); }
+        return result;
+    }
+
+    void windows_ocr_result_destroy(CWindowsOcrResult result)
+    {
+        if (result.lines)
+        {
+            for (size_t i = 0; i < result.count; ++i)
+            {
+                CoTaskMemFree(result.lines[i].text);
+            }
+            CoTaskMemFree(result.lines);
+        }
+        CoTaskMemFree(result.error);
+    }
+
+    void windows_ocr_string_free(char *ptr)
+    {
+        if (ptr)
+        {
+            CoTaskMemFree(ptr);
+        }
+    }
+
+} // extern "C"
+
+#endif
@@ -8,6 +8,8 @@ mod response;
 
 #[cfg(all(feature = "engine-vision", target_os = "macos"))]
 pub use backends::vision::{VisionOcrConfig, VisionOcrEngine};
+#[cfg(all(feature = "engine-windows-ocr", target_os = "windows"))]
+pub use backends::windows_ocr::{WindowsOcrConfig, WindowsOcrEngine};
 pub use engine::{NoopOcrEngine, OcrEngine};
 pub use error::OcrError;
 pub use plane::LumaPlane;
@@ -24,9 +24,24 @@ pub struct VideoFrame {
     index: Option<u64>,
     pts: Option<Duration>,
     dts: Option<Duration>,
+    crop: Option<FrameCrop>,
+    detection: Option<SubtitleDetectionResult>,
+    repeat: bool,
     buffer: FrameBuffer,
 }
 
+/// Placement of a cropped frame inside the decoded source picture, in pixels.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct FrameCrop {
+    pub x: u32,
+    pub y: u32,
+    /// Source pixels covered by the frame; larger than the frame itself when the backend scaled it.
+    pub width: u32,
+    pub height: u32,
+    pub source_width: u32,
+    pub source_height: u32,
+}
+
 #[derive(Clone)]
 pub enum FrameBuffer {
     Nv12(Nv12Buffer),
@@ -37,8 +52,36 @@ pub enum FrameBuffer {
 pub struct Nv12Buffer {
     y_stride: usize,
     uv_stride: usize,
-    y_plane: Arc<[u8]>,
-    uv_plane: Arc<[u8]>,
+    // Vec-backed so owned planes are adopted without another copy.
+    y_plane: Arc<PlaneStorage>,
+    uv_plane: Arc<PlaneStorage>,
+}
+
+/// Receives plane allocations back once the last frame referencing them is dropped.
+pub trait PlaneRecycler: Send + Sync {
+    fn recycle(&self, plane: Vec<u8>);
+}
+
+struct PlaneStorage {
+    data: Vec<u8>,
+    recycler: Option<Arc<dyn PlaneRecycler>>,
+}
+
+impl PlaneStorage {
+    fn new(data: Vec<u8>) -> Arc<Self> {
+        Arc::new(Self {
+            data,
+            recycler: None,
+        })
+    }
+}
+
+impl Drop for PlaneStorage {
+    fn drop(&mut self) {
+        if let Some(recycler) = self.recycler.take() {
+            recycler.recycle(std::mem::take(&mut self.data));
+        }
+    }
 }
 
 #[derive(Clone)]
@@ -87,11 +130,11 @@ impl Nv12Buffer {
     }
 
     pub fn y_plane(&self) -> &[u8] {
-        &self.y_plane
+        &self.y_plane.data
     }
 
     pub fn uv_plane(&self) -> &[u8] {
-        &self.uv_plane
+        &self.uv_plane.data
     }
 }
 
@@ -105,12 +148,15 @@ impl fmt::Debug for VideoFrame {
                 .field("format", &"nv12")
                 .field("y_stride", &buffer.y_stride)
                 .field("uv_stride", &buffer.uv_stride)
-                .field("y_bytes", &buffer.y_plane.len())
-                .field("uv_bytes", &buffer.uv_plane.len())
+                .field("y_bytes", &buffer.y_plane.data.len())
+                .field("uv_bytes", &buffer.uv_plane.data.len())
                 .field("pts", &self.pts)
                 .field("dts", &self.dts)
                 .field("serial", &self.serial)
                 .field("index", &self.index)
+                .field("crop", &self.crop)
+                .field("detection", &self.detection)
+                .field("repeat", &self.repeat)
                 .finish(),
             FrameBuffer::Native(buffer) => f
                 .debug_struct("VideoFrame")
@@ -124,6 +170,7 @@ impl fmt::Debug for VideoFrame {
                 .field("dts", &self.dts)
                 .field("serial", &self.serial)
                 .field("index", &self.index)
+                .field("crop", &self.crop)
                 .finish(),
         }
     }
@@ -184,15 +231,45 @@ impl VideoFrame {
             dts,
             serial: 0,
             index: None,
+            crop: None,
+            detection: None,
+            repeat: false,
             buffer: FrameBuffer::Nv12(Nv12Buffer {
                 y_stride,
                 uv_stride,
-                y_plane: Arc::from(y_plane.into_boxed_slice()),
-                uv_plane: Arc::from(uv_plane.into_boxed_slice()),
+                y_plane: PlaneStorage::new(y_plane),
+                uv_plane: PlaneStorage::new(uv_plane),
             }),
         })
     }
 
+    /// Builds a luma-only frame: the NV12 buffer carries `y_plane` and an empty, zero-stride UV plane.
+    pub fn from_luma_owned(
+        width: u32,
+        height: u32,
+        y_stride: usize,
+        pts: Option<Duration>,
+        dts: Option<Duration>,
+        y_plane: Vec<u8>,
+    ) -> DecoderResult<Self> {
+        Self::from_nv12_owned(width, height, y_stride, 0, pts, dts, y_plane, Vec::new())
+    }
+
+    /// Builds a frame without pixels that carries a detection result computed before readback
+    /// (e.g. a GPU pre-filter that rejected it). Both planes are empty with zero strides.
+    pub fn from_detection(
+        width: u32,
+        height: u32,
+        pts: Option<Duration>,
+        dts: Option<Duration>,
+        detection: SubtitleDetectionResult,
+    ) -> DecoderResult<Self> {
+        let mut frame =
+            Self::from_nv12_owned(width, height, 0, 0, pts, dts, Vec::new(), Vec::new())?;
+        frame.detection = Some(detection);
+        Ok(frame)
+    }
+
     #[allow(clippy::too_many_arguments)]
     pub fn from_native_handle(
         width: u32,
@@ -216,6 +293,9 @@ impl VideoFrame {
             dts,
             serial: 0,
             index,
+            crop: None,
+            detection: None,
+            repeat: false,
             buffer: FrameBuffer::Native(NativeBuffer {
                 backend,
                 pixel_format,
@@ -248,6 +328,82 @@ impl VideoFrame {
         self.index
     }
 
+    pub fn crop(&self) -> Option<FrameCrop> {
+        self.crop
+    }
+
+    /// Detection result the decoder already settled for this frame; detectors should use it as is.
+    pub fn detection(&self) -> Option<&SubtitleDetectionResult> {
+        self.detection.as_ref()
+    }
+
+    /// Set by a backend that found the picture unchanged since the frame it last read back and
+    /// delivered that frame's planes again (DXVA change detection).
+    pub fn repeats_previous(&self) -> bool {
+        self.repeat
+    }
+
+    /// Whether both frames are backed by the same NV12 plane allocations, as a repeat and the frame
+    /// it repeats are. Native frames never share pixels by this test.
+    pub fn shares_pixels(&self, other: &VideoFrame) -> bool {
+        match (&self.buffer, &other.buffer) {
+            (FrameBuffer::Nv12(a), FrameBuffer::Nv12(b)) => {
+                Arc::ptr_eq(&a.y_plane, &b.y_plane) && Arc::ptr_eq(&a.uv_plane, &b.uv_plane)
+            }
+            _ => false,
+        }
+    }
+
+    /// Whether the frame carries pixel data. Frames built by `from_detection` do not.
+    pub fn has_pixels(&self) -> bool {
+        match &self.buffer {
+            FrameBuffer::Nv12(buffer) => !buffer.y_plane.data.is_empty(),
+            FrameBuffer::Native(_) => true,
+        }
+    }
+
+    /// Maps an ROI normalized to the source picture into this frame's normalized coordinates.
+    pub fn roi_in_frame(&self, roi: &RoiConfig) -> RoiConfig {
+        let Some(crop) = self.crop else {
+            return *roi;
+        };
+        if self.width == 0 || self.height == 0 {
+            return *roi;
+        }
+        let (x, width) = map_roi_axis(roi.x, roi.width, crop.x, crop.source_width, crop.width);
+        let (y, height) = map_roi_axis(roi.y, roi.height, crop.y, crop.source_height, crop.height);
+        RoiConfig {
+            x,
+            y,
+            width,
+            height,
+        }
+    }
+
+    /// Inverse of `roi_in_frame`: maps an ROI normalized to this frame back onto the source picture.
+    pub fn roi_in_source(&self, roi: &RoiConfig) -> RoiConfig {
+        let Some(crop) = self.crop else {
+            return *roi;
+        };
+        if crop.source_width == 0 || crop.source_height == 0 {
+            return *roi;
+        }
+        let (x, width) = map_roi_axis(roi.x, roi.width, 0, crop.width, crop.source_width);
+        let (y, height) = map_roi_axis(roi.y, roi.height, 0, crop.height, crop.source_height);
+        RoiConfig {
+            x: x + crop.x as f32 / crop.source_width as f32,
+            y: y + crop.y as f32 / crop.source_height as f32,
+            width,
+            height,
+        }
+    }
+
+    /// Whether the backend resampled the frame, so it holds fewer pixels than the source area it covers.
+    pub fn is_scaled(&self) -> bool {
+        self.crop
+            .is_some_and(|crop| crop.width != self.width || crop.height != self.height)
+    }
+
     pub fn buffer(&self) -> &FrameBuffer {
         &self.buffer
     }
@@ -276,15 +432,15 @@ impl VideoFrame {
     }
 
     pub fn data(&self) -> &[u8] {
-        &self.expect_nv12().y_plane
+        self.expect_nv12().y_plane()
     }
 
     pub fn y_plane(&self) -> &[u8] {
-        &self.expect_nv12().y_plane
+        self.expect_nv12().y_plane()
     }
 
     pub fn uv_plane(&self) -> &[u8] {
-        &self.expect_nv12().uv_plane
+        self.expect_nv12().uv_plane()
     }
 
     pub fn with_serial(mut self, serial: u64) -> Self {
@@ -305,6 +461,29 @@ impl VideoFrame {
         self.index = index;
     }
 
+    /// Hands the NV12 plane allocations to `recycler` when the last clone of this frame is dropped.
+    /// Planes already shared with another frame are left untouched.
+    pub fn with_plane_recycler(mut self, recycler: Arc<dyn PlaneRecycler>) -> Self {
+        if let FrameBuffer::Nv12(buffer) = &mut self.buffer {
+            for plane in [&mut buffer.y_plane, &mut buffer.uv_plane] {
+                if let Some(storage) = Arc::get_mut(plane) {
+                    storage.recycler = Some(Arc::clone(&recycler));
+                }
+            }
+        }
+        self
+    }
+
+    pub fn with_repeat(mut self, repeat: bool) -> Self {
+        self.repeat = repeat;
+        self
+    }
+
+    pub fn with_crop(mut self, crop: Option<FrameCrop>) -> Self {
+        self.crop = crop;
+        self
+    }
+
     pub fn with_pts(mut self, pts: Option<Duration>) -> Self {
         self.pts = pts;
         self
@@ -337,6 +516,14 @@ fn nv12_uv_rows(height: u32) -> usize {
     (height as usize).div_ceil(2)
 }
 
+fn map_roi_axis(start: f32, extent: f32, offset: u32, source: u32, size: u32) -> (f32, f32) {
+    let source = source as f32;
+    let size = size as f32;
+    let begin = ((start * source - offset as f32) / size).clamp(0.0, 1.0);
+    let end = (((start + extent) * source - offset as f32) / size).clamp(0.0, 1.0);
+    (begin, (end - begin).max(0.0))
+}
+
 #[derive(Debug, Error)]
 pub enum DecoderError {
     #[error("backend {backend} is not supported in this build")]
@@ -466,3 +653,127 @@ impl OcrResponse {
         Self { texts: Vec::new() }
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn band_frame() -> VideoFrame {
+        VideoFrame::from_nv12_owned(
+            1920,
+            270,
+            1920,
+            1920,
+            None,
+            None,
+            vec![0; 1920 * 270],
+            vec![0; 1920 * 135],
+        )
+        .unwrap()
+        .with_crop(Some(FrameCrop {
+            x: 0,
+            y: 810,
+            width: 1920,
+            height: 270,
+            source_width: 1920,
+            source_height: 1080,
+        }))
+    }
+
+    #[test]
+    fn roi_in_frame_maps_source_roi_into_crop() {
+        let frame = band_frame();
+        let roi = RoiConfig {
+            x: 0.25,
+            y: 0.875,
+            width: 0.5,
+            height: 0.5,
+        };
+        let mapped = frame.roi_in_frame(&roi);
+        assert!((mapped.x - 0.25).abs() < 1e-6);
+        assert!((mapped.width - 0.5).abs() < 1e-6);
+        assert!((mapped.y - 0.5).abs() < 1e-6);
+        assert!((mapped.height - 0.5).abs() < 1e-6);
+    }
+
+    #[test]
+    fn scaled_frames_map_rois_both_ways() {
+        // The 1920x270 band scaled to half size.
+        let frame = VideoFrame::from_nv12_owned(
+            960,
+            136,
+            960,
+            960,
+            None,
+            None,
+            vec![0; 960 * 136],
+            vec![0; 960 * 68],
+        )
+        .unwrap()
+        .with_crop(band_frame().crop());
+        assert!(frame.is_scaled());
+        assert!(!band_frame().is_scaled());
+        let roi = RoiConfig {
+            x: 0.25,
+            y: 0.875,
+            width: 0.5,
+            height: 0.0625,
+        };
+        let mapped = frame.roi_in_frame(&roi);
+        assert!((mapped.y - 0.5).abs() < 1e-6);
+        assert!((mapped.height - 0.25).abs() < 1e-6);
+        let back = frame.roi_in_source(&mapped);
+        assert!((back.x - roi.x).abs() < 1e-6);
+        assert!((back.y - roi.y).abs() < 1e-6);
+        assert!((back.width - roi.width).abs() < 1e-6);
+        assert!((back.height - roi.height).abs() < 1e-6);
+    }
+
+    #[test]
+    fn from_nv12_owned_adopts_plane_allocations() {
+        let y_plane = vec![1; 64 * 4];
+        let uv_plane = vec![2; 64 * 2];
+        let y_ptr = y_plane.as_ptr();
+        let uv_ptr = uv_plane.as_ptr();
+        let frame =
+            VideoFrame::from_nv12_owned(64, 4, 64, 64, None, None, y_plane, uv_plane).unwrap();
+        assert_eq!(frame.y_plane().as_ptr(), y_ptr);
+        assert_eq!(frame.uv_plane().as_ptr(), uv_ptr);
+    }
+
+    #[test]
+    fn roi_in_frame_is_identity_without_crop() {
+        let frame = band_frame().with_crop(None);
+        let roi = RoiConfig {
+            x: 0.1,
+            y: 0.2,
+            width: 0.3,
+            height: 0.4,
+        };
+        assert_eq!(frame.roi_in_frame(&roi), roi);
+    }
+
+    #[test]
+    fn from_detection_builds_planeless_frame() {
+        let frame =
+            VideoFrame::from_detection(1920, 270, None, None, SubtitleDetectionResult::empty())
+                .unwrap()
+                .with_index(Some(7));
+        assert!(!frame.has_pixels());
+        assert!(frame.y_plane().is_empty());
+        assert_eq!(frame.stride(), 0);
+        assert!(!frame.detection().unwrap().has_subtitle);
+        assert!(band_frame().has_pixels());
+        assert!(band_frame().detection().is_none());
+    }
+
+    #[test]
+    fn repeats_share_the_planes_they_repeat() {
+        let frame = band_frame();
+        let repeat = frame.clone().with_index(Some(9)).with_repeat(true);
+        assert!(repeat.repeats_previous());
+        assert!(!frame.repeats_previous());
+        assert!(repeat.shares_pixels(&frame));
+        assert!(!band_frame().shares_pixels(&frame));
+    }
+}
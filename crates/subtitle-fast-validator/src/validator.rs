@@ -57,6 +57,10 @@ impl ProcessingOperations {
         frame: VideoFrame,
         roi: Option<RoiConfig>,
     ) -> Result<SubtitleDetectionResult, SubtitleDetectionError> {
+        // Settled by the decoder (e.g. rejected by a GPU pre-filter); such frames carry no pixels.
+        if let Some(detection) = frame.detection() {
+            return Ok(detection.clone());
+        }
         if let Some(pipeline) = self.detection.as_ref() {
             pipeline.process(&frame, roi).await
         } else {
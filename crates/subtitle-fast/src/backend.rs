@@ -1,10 +1,16 @@
+use std::num::{NonZeroU32, NonZeroUsize};
+use std::path::PathBuf;
+use std::sync::Arc;
 use std::time::Instant;
 
 use futures_util::StreamExt;
-use indicatif::{ProgressBar, ProgressStyle};
-use subtitle_fast_decoder::{Backend, Configuration};
-use subtitle_fast_types::DecoderError;
+use indicatif::{MultiProgress, ProgressBar, ProgressStyle};
+use subtitle_fast_decoder::{Backend, Configuration, LumaCache, LumaCacheConfig};
+use subtitle_fast_types::{DecoderError, RoiConfig};
+use tokio::sync::Semaphore;
+use tokio::task::JoinSet;
 
+use crate::settings::{EffectiveSettings, default_luma_cache};
 use crate::stage;
 
 const COL_AVG: &str = "\x1b[33m"; // yellow-ish for averages
@@ -18,12 +24,80 @@ pub struct ExecutionPlan {
     pub pipeline: stage::PipelineConfig,
 }
 
+/// Inputs decoded by one process. Up to `jobs` pipelines run at once on the shared runtime, so the
+/// CPU stages of one input overlap the decode of another, and they share the decoder's per-adapter
+/// devices and the OCR engine.
+pub struct BatchPlan {
+    pub plans: Vec<ExecutionPlan>,
+    pub jobs: NonZeroUsize,
+}
+
 pub async fn run(plan: ExecutionPlan) -> Result<(), DecoderError> {
+    run_plan(plan, None).await
+}
+
+/// A single input runs as `run` does. Otherwise inputs start in order as pipelines finish, each
+/// with its own progress bar, and a failed input does not stop the others.
+pub async fn run_batch(batch: BatchPlan) -> Result<(), DecoderError> {
+    let BatchPlan { mut plans, jobs } = batch;
+    if plans.len() == 1 {
+        return run(plans.remove(0)).await;
+    }
+
+    let total = plans.len();
+    let bars = MultiProgress::new();
+    let permits = Arc::new(Semaphore::new(jobs.get()));
+    let mut tasks = JoinSet::new();
+    for plan in plans {
+        let Ok(permit) = permits.clone().acquire_owned().await else {
+            break;
+        };
+        let bars = bars.clone();
+        tasks.spawn(async move {
+            let _permit = permit;
+            let input = plan.config.input.clone().unwrap_or_default();
+            let result = run_plan(plan, Some(&bars)).await;
+            if let Err(err) = &result {
+                log(Some(&bars), &format!("{}: {err}", input.display()));
+            }
+            result.is_ok()
+        });
+    }
+
+    let mut failed = 0usize;
+    while let Some(joined) = tasks.join_next().await {
+        match joined {
+            Ok(true) => {}
+            Ok(false) => failed += 1,
+            Err(err) => {
+                failed += 1;
+                log(Some(&bars), &format!("batch pipeline aborted: {err}"));
+            }
+        }
+    }
+    if failed > 0 {
+        return Err(DecoderError::configuration(format!(
+            "{failed} of {total} inputs failed"
+        )));
+    }
+    Ok(())
+}
+
+async fn run_plan(plan: ExecutionPlan, bars: Option<&MultiProgress>) -> Result<(), DecoderError> {
     let ExecutionPlan {
         config,
         backend_locked,
         pipeline,
     } = plan;
+    let label = match bars {
+        Some(_) => batch_label(config.input.as_ref()),
+        None => "detect".to_string(),
+    };
+    // Batch status lines name their input.
+    let tag = match bars {
+        Some(_) => format!("{label}: "),
+        None => String::new(),
+    };
 
     let available = Configuration::available_backends();
     if available.is_empty() {
@@ -31,7 +105,7 @@ pub async fn run(plan: ExecutionPlan) -> Result<(), DecoderError> {
             "no decoding backend available; rebuild with a backend feature such as \"backend-ffmpeg\"",
         ));
     }
-    if !available.contains(&config.backend) {
+    if config.backend != Backend::LumaCache && !available.contains(&config.backend) {
         return Err(DecoderError::unsupported(config.backend.as_str()));
     }
 
@@ -49,28 +123,37 @@ pub async fn run(plan: ExecutionPlan) -> Result<(), DecoderError> {
 
         let provider = match provider_result {
             Ok(provider) => {
-                eprintln!(
-                    "initialized decoder backend '{}' in {:.2?}",
-                    attempt_config.backend.as_str(),
-                    provider_elapsed
+                log(
+                    bars,
+                    &format!(
+                        "{tag}initialized decoder backend '{}' in {:.2?}",
+                        attempt_config.backend.as_str(),
+                        provider_elapsed
+                    ),
                 );
                 provider
             }
             Err(err) => {
-                eprintln!(
-                    "decoder backend '{}' failed to initialize in {:.2?}: {err}",
-                    attempt_config.backend.as_str(),
-                    provider_elapsed
+                log(
+                    bars,
+                    &format!(
+                        "{tag}decoder backend '{}' failed to initialize in {:.2?}: {err}",
+                        attempt_config.backend.as_str(),
+                        provider_elapsed
+                    ),
                 );
                 if !backend_locked
                     && let Some(next_backend) = select_next_backend(&available, &tried)
                 {
                     let failed_backend = attempt_config.backend;
-                    eprintln!(
-                        "backend {failed} failed to initialize ({reason}); trying {next}",
-                        failed = failed_backend.as_str(),
-                        reason = err,
-                        next = next_backend.as_str()
+                    log(
+                        bars,
+                        &format!(
+                            "{tag}backend {failed} failed to initialize ({reason}); trying {next}",
+                            failed = failed_backend.as_str(),
+                            reason = err,
+                            next = next_backend.as_str()
+                        ),
                     );
                     attempt_config.backend = next_backend;
                     continue;
@@ -82,7 +165,11 @@ pub async fn run(plan: ExecutionPlan) -> Result<(), DecoderError> {
         let pipeline_result = stage::build_pipeline(provider, &pipeline);
 
         let outcome = match pipeline_result {
-            Ok(pipeline_streams) => drive_pipeline(pipeline_streams, &pipeline.output.path).await,
+            Ok(pipeline_streams) => {
+                let progress =
+                    PipelineProgressBar::new(label.clone(), pipeline_streams.total_frames, bars);
+                drive_pipeline(pipeline_streams, &pipeline.output.path, progress).await
+            }
             Err(err) => Err((err, 0)),
         };
 
@@ -94,11 +181,14 @@ pub async fn run(plan: ExecutionPlan) -> Result<(), DecoderError> {
                     && let Some(next_backend) = select_next_backend(&available, &tried)
                 {
                     let failed_backend = attempt_config.backend;
-                    eprintln!(
-                        "backend {failed} failed to decode ({reason}); trying {next}",
-                        failed = failed_backend.as_str(),
-                        reason = err,
-                        next = next_backend.as_str()
+                    log(
+                        bars,
+                        &format!(
+                            "{tag}backend {failed} failed to decode ({reason}); trying {next}",
+                            failed = failed_backend.as_str(),
+                            reason = err,
+                            next = next_backend.as_str()
+                        ),
                     );
                     attempt_config.backend = next_backend;
                     continue;
@@ -109,6 +199,38 @@ pub async fn run(plan: ExecutionPlan) -> Result<(), DecoderError> {
     }
 }
 
+/// ROI luma cache for a run with `settings`; `None` when it is off or there is no cache directory.
+pub fn luma_cache_config(settings: &EffectiveSettings) -> Option<LumaCacheConfig> {
+    if !settings.decoder.luma_cache {
+        return None;
+    }
+    Some(LumaCacheConfig {
+        dir: default_luma_cache()?,
+        samples_per_second: NonZeroU32::new(settings.detection.samples_per_second)?,
+        roi: settings.detection.roi.unwrap_or(RoiConfig {
+            x: 0.0,
+            y: 0.0,
+            width: 1.0,
+            height: 1.0,
+        }),
+        compress: settings.decoder.luma_cache_compress,
+    })
+}
+
+/// Hands `cache` to the decode: the `luma-cache` backend replays it when one recorded for the input
+/// covers the run, the configured backend records it otherwise. Returns whether the run replays.
+pub fn attach_luma_cache(config: &mut Configuration, cache: LumaCacheConfig) -> bool {
+    let replay = config
+        .input
+        .as_deref()
+        .is_some_and(|input| LumaCache::open(&cache, input).is_some());
+    if replay {
+        config.backend = Backend::LumaCache;
+    }
+    config.luma_cache = Some(cache);
+    replay
+}
+
 pub fn display_available_backends() {
     let names: Vec<&'static str> = Configuration::available_backends()
         .iter()
@@ -126,6 +248,21 @@ pub fn parse_backend(value: &str) -> Result<Backend, DecoderError> {
     Backend::from_str(value)
 }
 
+/// Status lines go above the bars while a batch draws them.
+fn log(bars: Option<&MultiProgress>, message: &str) {
+    match bars {
+        Some(bars) => bars.suspend(|| eprintln!("{message}")),
+        None => eprintln!("{message}"),
+    }
+}
+
+fn batch_label(input: Option<&PathBuf>) -> String {
+    input.and_then(|path| path.file_stem()).map_or_else(
+        || "detect".to_string(),
+        |stem| stem.to_string_lossy().into_owned(),
+    )
+}
+
 fn select_next_backend(available: &[Backend], tried: &[Backend]) -> Option<Backend> {
     available
         .iter()
@@ -136,11 +273,11 @@ fn select_next_backend(available: &[Backend], tried: &[Backend]) -> Option<Backe
 async fn drive_pipeline(
     pipeline: stage::PipelineOutputs,
     output_path: &std::path::Path,
+    mut progress: PipelineProgressBar,
 ) -> Result<(), (DecoderError, u64)> {
     let mut processed = 0;
     let mut subtitles: Vec<stage::MergedSubtitle> = Vec::new();
     let mut stream = pipeline.stream;
-    let mut progress = PipelineProgressBar::new("detect", pipeline.total_frames);
 
     while let Some(event) = stream.next().await {
         match event {
@@ -170,7 +307,7 @@ struct PipelineProgressBar {
 }
 
 impl PipelineProgressBar {
-    fn new(label: &'static str, total_frames: Option<u64>) -> Self {
+    fn new(label: String, total_frames: Option<u64>, bars: Option<&MultiProgress>) -> Self {
         let bar = match total_frames {
             Some(total) => {
                 let bar = ProgressBar::new(total);
@@ -184,6 +321,10 @@ impl PipelineProgressBar {
             }
         };
         bar.set_prefix(label);
+        let bar = match bars {
+            Some(bars) => bars.add(bar),
+            None => bar,
+        };
 
         Self {
             bar,
@@ -80,6 +80,70 @@ pub struct CliArgs {
     )]
     pub decoder_channel_capacity: Option<usize>,
 
+    /// Skip GPU readback for frames the detection sampler discards (hardware backends only)
+    #[arg(long = "decoder-sampled-readback", id = "decoder_sampled_readback")]
+    pub decoder_sampled_readback: bool,
+
+    /// Read back only the detection ROI from the GPU (DXVA only)
+    #[arg(long = "decoder-gpu-crop", id = "decoder_gpu_crop")]
+    pub decoder_gpu_crop: bool,
+
+    /// Score frames on the GPU and read back only those that may hold subtitles (DXVA only)
+    #[arg(long = "decoder-gpu-gate", id = "decoder_gpu_gate")]
+    pub decoder_gpu_gate: bool,
+
+    /// Scale frames on the GPU as if the source were this many rows tall; OCR re-reads regions at full size (DXVA only)
+    #[arg(
+        long = "decoder-detection-height",
+        id = "decoder_detection_height",
+        value_parser = clap::value_parser!(u32)
+    )]
+    pub decoder_detection_height: Option<u32>,
+
+    /// Hash the detection area on the GPU and skip readback of frames within this many luma levels of the last one read back (DXVA only)
+    #[arg(
+        long = "decoder-change-threshold",
+        id = "decoder_change_threshold",
+        value_parser = parse_u8_byte
+    )]
+    pub decoder_change_threshold: Option<u8>,
+
+    /// Hardware decode sessions one GPU runs at a time; further decodes wait for a free one (DXVA only)
+    #[arg(
+        long = "decoder-sessions-per-adapter",
+        id = "decoder_sessions_per_adapter",
+        value_parser = parse_positive_u32
+    )]
+    pub decoder_sessions_per_adapter: Option<u32>,
+
+    /// Demux through a read-ahead buffer of this many MiB, for inputs on network shares or slow disks (DXVA/MFT only)
+    #[arg(
+        long = "decoder-prefetch-mib",
+        id = "decoder_prefetch_mib",
+        value_parser = parse_positive_u32
+    )]
+    pub decoder_prefetch_mib: Option<u32>,
+
+    /// Read local inputs from a memory mapping for the read-ahead instead of buffering them (DXVA/MFT only)
+    #[arg(long = "decoder-prefetch-map", id = "decoder_prefetch_map")]
+    pub decoder_prefetch_map: bool,
+
+    /// Keep the sampled ROI luma of the first full decode on disk and replay it while the input, sampling rate and an ROI inside the cached one stay the same
+    #[arg(long = "decoder-luma-cache", id = "decoder_luma_cache")]
+    pub decoder_luma_cache: bool,
+
+    /// Delta-encode the luma cache: a fraction of the size, replayed somewhat slower
+    #[arg(
+        long = "decoder-luma-cache-compress",
+        id = "decoder_luma_cache_compress"
+    )]
+    pub decoder_luma_cache_compress: bool,
+
+    /// What the decoder does with frames while detection falls behind: block, drop those detection
+    /// would not sample (unsampled), or drop those decoded while the queue is full (drop; DXVA/MFT only)
+    #[arg(long = "decoder-backpressure", id = "decoder_backpressure")]
+    pub decoder_backpressure: Option<String>,
+
     /// Override the detector target value (0-255)
     #[arg(long = "detector-target", value_parser = parse_u8_byte)]
     pub detector_target: Option<u8>,
@@ -96,12 +160,16 @@ pub struct CliArgs {
     #[arg(long = "roi", value_name = "X,Y,W,H", value_parser = parse_roi)]
     pub roi: Option<RoiConfig>,
 
-    /// Output subtitle file path
+    /// Output subtitle file path; with several inputs, the directory the subtitle files go to
     #[arg(short = 'o', long = "output")]
     pub output: Option<PathBuf>,
 
-    /// Input video path
-    pub input: Option<PathBuf>,
+    /// Inputs decoded at the same time when several are given
+    #[arg(short = 'j', long = "jobs", value_parser = parse_positive_u32)]
+    pub jobs: Option<u32>,
+
+    /// Input video paths; several run as one batch in this process
+    pub inputs: Vec<PathBuf>,
 }
 
 fn parse_u8_byte(value: &str) -> Result<u8, String> {
@@ -185,6 +253,17 @@ mod tests {
         assert!(parse_roi("0.1").is_err());
     }
 
+    #[test]
+    fn several_inputs_make_a_batch() {
+        let args = CliArgs::try_parse_from(["subtitle-fast", "-j", "3", "a.mp4", "b.mp4"]).unwrap();
+        assert_eq!(args.jobs, Some(3));
+        assert_eq!(
+            args.inputs,
+            vec![PathBuf::from("a.mp4"), PathBuf::from("b.mp4")]
+        );
+        assert!(CliArgs::try_parse_from(["subtitle-fast", "--jobs", "0", "a.mp4"]).is_err());
+    }
+
     #[test]
     fn parse_roi_rejects_negative_values() {
         assert!(parse_roi("-0.1,0.0,0.5,0.5").is_err());
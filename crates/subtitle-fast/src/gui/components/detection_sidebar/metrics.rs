@@ -9,6 +9,7 @@ use tokio::time::MissedTickBehavior;
 use crate::gui::icons::{Icon, icon_sm};
 use crate::gui::runtime;
 use crate::stage::PipelineProgress;
+use subtitle_fast_decoder::{DecodePhase, DecoderStatsSnapshot};
 
 use super::DetectionHandle;
 
@@ -17,6 +18,8 @@ const PROGRESS_STEP: f64 = 0.001;
 
 pub struct DetectionMetrics {
     progress: PipelineProgress,
+    /// Last decoder timings seen; kept after the run ends so completed runs still show them.
+    decoder: DecoderStatsSnapshot,
     progress_task: Option<Task<()>>,
     handle: DetectionHandle,
 }
@@ -26,6 +29,7 @@ impl DetectionMetrics {
         let progress = handle.progress_snapshot();
         Self {
             progress,
+            decoder: DecoderStatsSnapshot::default(),
             progress_task: None,
             handle,
         }
@@ -42,6 +46,20 @@ impl DetectionMetrics {
         if self.progress != effective {
             self.progress = effective;
         }
+        match self.handle.decoder_stats() {
+            Some(stats) => self.decoder = stats,
+            None if !run_state.is_running() && !self.progress.completed => {
+                self.decoder = DecoderStatsSnapshot::default();
+            }
+            None => {}
+        }
+    }
+
+    fn phase_ms(&self, phase: DecodePhase) -> f64 {
+        self.decoder
+            .phase(phase)
+            .average()
+            .map_or(0.0, |average| average.as_secs_f64() * 1000.0)
     }
 
     fn ensure_progress_listener(&mut self, window: &mut Window, cx: &mut Context<Self>) {
@@ -246,6 +264,33 @@ impl Render for DetectionMetrics {
                 value_color,
                 cx,
             ))
+            .child(self.metric_row(
+                "detection-metric-decode-read",
+                Icon::Film,
+                "Decode",
+                Self::format_rate(self.phase_ms(DecodePhase::Read), "ms"),
+                label_color,
+                value_color,
+                cx,
+            ))
+            .child(self.metric_row(
+                "detection-metric-decode-map",
+                Icon::Gauge,
+                "GPU wait",
+                Self::format_rate(self.phase_ms(DecodePhase::Map), "ms"),
+                label_color,
+                value_color,
+                cx,
+            ))
+            .child(self.metric_row(
+                "detection-metric-decode-deliver",
+                Icon::Inbox,
+                "Backpressure",
+                Self::format_rate(self.phase_ms(DecodePhase::Deliver), "ms"),
+                label_color,
+                value_color,
+                cx,
+            ))
             .child(self.metric_row(
                 "detection-metric-detect",
                 Icon::Scan,
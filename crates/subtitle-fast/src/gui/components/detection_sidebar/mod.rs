@@ -14,7 +14,7 @@ use crate::stage::{
     self, MergedSubtitle, PipelineConfig, PipelineHandle, PipelineProgress, SubtitleUpdate,
     SubtitleUpdateKind, TimedSubtitle,
 };
-use subtitle_fast_decoder::{Backend, Configuration};
+use subtitle_fast_decoder::{Backend, Configuration, DecoderStatsSnapshot};
 use subtitle_fast_types::{DecoderError, RoiConfig};
 use subtitle_fast_validator::subtitle_detection::{DEFAULT_DELTA, DEFAULT_TARGET};
 
@@ -105,6 +105,10 @@ impl DetectionHandle {
         self.inner.progress_snapshot()
     }
 
+    pub fn decoder_stats(&self) -> Option<DecoderStatsSnapshot> {
+        self.inner.decoder_stats()
+    }
+
     pub fn run_state(&self) -> DetectionRunState {
         self.inner.run_state()
     }
@@ -197,6 +201,11 @@ impl DetectionPipelineInner {
         self.progress_rx.borrow().clone()
     }
 
+    fn decoder_stats(&self) -> Option<DecoderStatsSnapshot> {
+        let slot = self.pause_handle.lock().ok()?;
+        slot.as_ref().map(PipelineHandle::decoder_stats)
+    }
+
     fn run_state(&self) -> DetectionRunState {
         *self.state_rx.borrow()
     }
@@ -230,6 +239,18 @@ impl DetectionPipelineInner {
             decoder: DecoderSettings {
                 backend: None,
                 channel_capacity: None,
+                sampled_readback: false,
+                gpu_crop: false,
+                gpu_gate: false,
+                detection_height: None,
+                change_threshold: None,
+                sessions_per_adapter: None,
+                prefetch_mib: None,
+                prefetch_map: false,
+                // Re-detection with other thresholds or a smaller ROI replays the first decode.
+                luma_cache: true,
+                luma_cache_compress: true,
+                backpressure: subtitle_fast_decoder::Backpressure::Block,
             },
             output: OutputSettings { path: None },
         };
@@ -504,7 +525,7 @@ async fn run_detection_task(
         inner.finish();
         return;
     }
-    if !available.contains(&config.backend) {
+    if config.backend != Backend::LumaCache && !available.contains(&config.backend) {
         eprintln!(
             "detection start failed: backend '{}' is unavailable",
             config.backend.as_str()
@@ -653,16 +674,24 @@ fn build_detection_plan(
         Some(name) => Some(parse_backend_value(name)?),
         None => None,
     };
-    let backend_locked = backend_override.is_some() || env_backend_present;
+    let mut backend_locked = backend_override.is_some() || env_backend_present;
     if let Some(backend_value) = backend_override {
         config.backend = backend_value;
     }
     config.input = Some(input.to_path_buf());
+    if config.index_cache.is_none() {
+        config.index_cache = crate::settings::default_index_cache();
+    }
     if let Some(capacity) = settings.decoder.channel_capacity
         && let Some(non_zero) = NonZeroUsize::new(capacity)
     {
         config.channel_capacity = Some(non_zero);
     }
+    if let Some(cache) = crate::backend::luma_cache_config(settings)
+        && crate::backend::attach_luma_cache(&mut config, cache)
+    {
+        backend_locked = true;
+    }
 
     Ok(DetectionPlan {
         config,
@@ -0,0 +1,120 @@
+//! Recently shown frames of the open video, keyed by frame index.
+//!
+//! Scrubbing back and forth over a few seconds would otherwise flush and reposition the decoder on
+//! every seek. Entries are weighed by their pixel bytes and the least recently used ones are evicted
+//! once the budget is exceeded.
+
+use std::collections::{BTreeMap, HashMap};
+
+struct Entry<T> {
+    value: T,
+    bytes: usize,
+    stamp: u64,
+}
+
+pub(crate) struct FrameCache<T> {
+    budget: usize,
+    used: usize,
+    next_stamp: u64,
+    entries: HashMap<u64, Entry<T>>,
+    /// Frame indices by last use, oldest first.
+    order: BTreeMap<u64, u64>,
+}
+
+impl<T: Clone> FrameCache<T> {
+    pub(crate) fn new(budget: usize) -> Self {
+        Self {
+            budget,
+            used: 0,
+            next_stamp: 0,
+            entries: HashMap::new(),
+            order: BTreeMap::new(),
+        }
+    }
+
+    /// Frames larger than the whole budget are not kept.
+    pub(crate) fn insert(&mut self, index: u64, value: T, bytes: usize) {
+        self.remove(index);
+        if bytes > self.budget {
+            return;
+        }
+        let stamp = self.stamp();
+        self.entries.insert(
+            index,
+            Entry {
+                value,
+                bytes,
+                stamp,
+            },
+        );
+        self.order.insert(stamp, index);
+        self.used += bytes;
+        while self.used > self.budget {
+            let Some((_, oldest)) = self.order.pop_first() else {
+                break;
+            };
+            if let Some(entry) = self.entries.remove(&oldest) {
+                self.used -= entry.bytes;
+            }
+        }
+    }
+
+    pub(crate) fn get(&mut self, index: u64) -> Option<T> {
+        let stamp = self.stamp();
+        let entry = self.entries.get_mut(&index)?;
+        self.order.remove(&entry.stamp);
+        self.order.insert(stamp, index);
+        entry.stamp = stamp;
+        Some(entry.value.clone())
+    }
+
+    pub(crate) fn clear(&mut self) {
+        self.entries.clear();
+        self.order.clear();
+        self.used = 0;
+    }
+
+    fn remove(&mut self, index: u64) {
+        if let Some(entry) = self.entries.remove(&index) {
+            self.order.remove(&entry.stamp);
+            self.used -= entry.bytes;
+        }
+    }
+
+    fn stamp(&mut self) -> u64 {
+        self.next_stamp += 1;
+        self.next_stamp
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn evicts_least_recently_used_over_budget() {
+        let mut cache = FrameCache::new(30);
+        cache.insert(1, "a", 10);
+        cache.insert(2, "b", 10);
+        cache.insert(3, "c", 10);
+        assert_eq!(cache.get(1), Some("a"));
+        cache.insert(4, "d", 10);
+        assert_eq!(cache.get(2), None);
+        assert_eq!(cache.get(1), Some("a"));
+        assert_eq!(cache.get(3), Some("c"));
+        assert_eq!(cache.get(4), Some("d"));
+    }
+
+    #[test]
+    fn reinserting_replaces_and_oversized_frames_are_skipped() {
+        let mut cache = FrameCache::new(20);
+        cache.insert(1, "a", 10);
+        cache.insert(1, "b", 15);
+        assert_eq!(cache.get(1), Some("b"));
+        cache.insert(2, "c", 25);
+        assert_eq!(cache.get(2), None);
+        assert_eq!(cache.get(1), Some("b"));
+        cache.clear();
+        assert_eq!(cache.get(1), None);
+    }
+}
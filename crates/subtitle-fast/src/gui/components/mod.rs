@@ -1,5 +1,6 @@
 pub mod color_picker;
 pub mod detection_sidebar;
+mod frame_cache;
 pub mod sidebar;
 pub mod task_sidebar;
 pub mod titlebar;
@@ -8,11 +8,12 @@ use futures_channel::mpsc::{
     unbounded as unbounded_frame_channel,
 };
 use gpui::{
-    Context, Frame, ObjectFit, Render, Task, VideoHandle, Window, div, prelude::*, rgb, video,
+    Context, Frame, ObjectFit, Render, Task, VideoFrame as SurfaceFrame, VideoHandle, Window, div,
+    prelude::*, rgb, video,
 };
 use subtitle_fast_decoder::{
-    Backend, Configuration, DecoderController, FrameStream, OutputFormat, SeekInfo, SeekMode,
-    VideoFrame, VideoMetadata,
+    Backend, Backpressure, Configuration, DecoderController, FrameStream, OutputFormat, ScanMode,
+    SeekInfo, SeekMode, VideoFrame, VideoMetadata,
 };
 use tokio::sync::{
     mpsc::{UnboundedReceiver, UnboundedSender, unbounded_channel},
@@ -20,7 +21,16 @@ use tokio::sync::{
 };
 use tokio_stream::StreamExt;
 
+use super::frame_cache::FrameCache;
 use crate::gui::runtime;
+
+/// Decoded frames kept around the scrub position, by pixel bytes.
+const SCRUB_CACHE_BYTES: usize = 256 << 20;
+/// Texture frames kept for scrubbing: as many as gpui's DirectX renderer keeps opened
+/// (`SHARED_TEXTURE_CACHE_SIZE`), so a hit is drawn without opening its handle again.
+#[cfg(target_os = "windows")]
+const SCRUB_CACHE_TEXTURES: usize = 16;
+
 #[derive(Clone, Copy, Debug)]
 pub struct Nv12FrameInfo {
     pub width: u32,
@@ -290,9 +300,12 @@ struct PreprocessorEntry {
 
 pub struct VideoPlayer {
     handle: VideoHandle,
-    receiver: Receiver<Frame>,
+    receiver: Receiver<SurfaceFrame>,
     frame_ready_rx: Option<FrameReadyReceiver<()>>,
     frame_ready_task: Option<Task<()>>,
+    /// Whether the renderer's adapter has been passed to the DXVA texture decodes.
+    #[cfg(target_os = "windows")]
+    adapter_reported: bool,
 }
 
 impl VideoPlayer {
@@ -312,6 +325,8 @@ impl VideoPlayer {
                 receiver,
                 frame_ready_rx: Some(frame_ready_rx),
                 frame_ready_task: None,
+                #[cfg(target_os = "windows")]
+                adapter_reported: false,
             },
             control,
             info,
@@ -339,11 +354,24 @@ impl VideoPlayer {
         });
         self.frame_ready_task = Some(task);
     }
+
+    /// Texture frames only open on the adapter the window renders on.
+    #[cfg(target_os = "windows")]
+    fn report_adapter(&mut self, window: &Window) {
+        if self.adapter_reported {
+            return;
+        }
+        self.adapter_reported = true;
+        let luid = window.gpu_specs().and_then(|specs| specs.adapter_luid);
+        subtitle_fast_decoder::backends::dxva::set_texture_adapter(luid);
+    }
 }
 
 impl Render for VideoPlayer {
     fn render(&mut self, window: &mut Window, cx: &mut Context<Self>) -> impl IntoElement {
         self.ensure_frame_listener(window, cx);
+        #[cfg(target_os = "windows")]
+        self.report_adapter(window);
         let mut latest = None;
         for frame in self.receiver.try_iter() {
             latest = Some(frame);
@@ -364,10 +392,19 @@ struct DecoderSession {
     controller: DecoderController,
     stream: FrameStream,
     frame_duration: Option<Duration>,
+    output_format: OutputFormat,
+}
+
+#[derive(Clone)]
+enum CachedFrame {
+    Planes(CachedPlanes),
+    /// DXVA frame left on the GPU; the renderer samples the shared texture directly.
+    #[cfg(target_os = "windows")]
+    Texture(gpui::SharedTexture),
 }
 
 #[derive(Clone)]
-struct CachedFrame {
+struct CachedPlanes {
     width: u32,
     height: u32,
     y_stride: usize,
@@ -376,22 +413,97 @@ struct CachedFrame {
     uv_plane: Arc<[u8]>,
 }
 
+impl CachedFrame {
+    fn bytes(&self) -> usize {
+        match self {
+            CachedFrame::Planes(planes) => planes.y_plane.len() + planes.uv_plane.len(),
+            // Weighed so no more than SCRUB_CACHE_TEXTURES fit, whatever their size.
+            #[cfg(target_os = "windows")]
+            CachedFrame::Texture(texture) => {
+                (texture.width() as usize * texture.height() as usize * 3 / 2)
+                    .max(SCRUB_CACHE_BYTES / SCRUB_CACHE_TEXTURES)
+            }
+        }
+    }
+}
+
 struct SeekTiming {
     serial: u64,
 }
 
+/// Frames shown since the file was opened. Seeks landing on one of them are answered without the
+/// decoder; while paused or scrubbing the decoder is only repositioned once playback resumes.
+struct ScrubCache {
+    frames: FrameCache<CachedFrame>,
+    deferred_seek: Option<(SeekInfo, Option<u64>)>,
+}
+
+impl ScrubCache {
+    fn new() -> Self {
+        Self {
+            frames: FrameCache::new(SCRUB_CACHE_BYTES),
+            deferred_seek: None,
+        }
+    }
+
+    /// Cached frames stop matching the playback format when preprocessors switch it.
+    fn reset(&mut self) {
+        self.frames.clear();
+        self.deferred_seek = None;
+    }
+}
+
+/// DXVA playback keeps frames on the GPU and hands the shared texture straight to the renderer.
+/// Preprocessors rewrite CPU planes, so NV12 is decoded while any is installed.
+fn playback_format(backend: Backend, preprocessors: &[PreprocessorEntry]) -> OutputFormat {
+    #[cfg(target_os = "windows")]
+    {
+        if backend == Backend::Dxva && preprocessors.is_empty() {
+            return OutputFormat::D3D11Texture;
+        }
+    }
+    #[cfg(not(target_os = "windows"))]
+    let _ = (backend, preprocessors);
+    OutputFormat::Nv12
+}
+
+/// True when the running session decodes into a format the current preprocessors cannot use.
+fn session_format_stale(
+    session: Option<&DecoderSession>,
+    backend: Backend,
+    preprocessors: &[PreprocessorEntry],
+) -> bool {
+    session.is_some_and(|session| session.output_format != playback_format(backend, preprocessors))
+}
+
 fn open_session(
     backend: Backend,
     input_path: &PathBuf,
     start_frame: Option<u64>,
+    output_format: OutputFormat,
     info: &VideoPlayerInfoHandle,
 ) -> Option<DecoderSession> {
     let config = Configuration {
         backend,
         input: Some(input_path.clone()),
         channel_capacity: None,
-        output_format: OutputFormat::Nv12,
+        output_format,
         start_frame,
+        readback_depth: None,
+        samples_per_second: None,
+        crop: None,
+        retained_frames: None,
+        scan: ScanMode::Full,
+        decode_workers: None,
+        read_ahead: None,
+        luma_gate: None,
+        scale_height: None,
+        delivery_batch: None,
+        index_cache: crate::settings::default_index_cache(),
+        change_detection: None,
+        prefetch: None,
+        luma_cache: None,
+        backpressure: Backpressure::DropWhenFull,
     };
 
     let provider = match config.create_provider() {
@@ -422,6 +534,7 @@ fn open_session(
         controller,
         stream,
         frame_duration,
+        output_format,
     })
 }
 
@@ -440,6 +553,8 @@ fn handle_command(
     open_start_frame: &mut Option<u64>,
     preprocessors: &mut Vec<PreprocessorEntry>,
     refresh_cached: &mut bool,
+    scrub_cache: &mut ScrubCache,
+    last_frame: &mut Option<CachedFrame>,
     info: &VideoPlayerInfoHandle,
 ) -> bool {
     match command {
@@ -454,6 +569,7 @@ fn handle_command(
             *seek_timing = None;
             *open_requested = true;
             *open_start_frame = options.start_frame;
+            scrub_cache.reset();
             info.set_metadata(VideoMetadata::default());
             info.reset_for_open(options.paused);
         }
@@ -497,6 +613,19 @@ fn handle_command(
                 }),
             };
             info.apply_seek_preview(seek);
+            scrub_cache.deferred_seek = None;
+            if let Some(hit) = pending_seek_frame.and_then(|frame| scrub_cache.frames.get(frame)) {
+                *last_frame = Some(hit);
+                *refresh_cached = true;
+                info.update_playback(|state| state.has_frame = true);
+                if session.is_some() && (*paused || *scrubbing) {
+                    scrub_cache.deferred_seek = Some((seek, *pending_seek_frame));
+                    *pending_seek = None;
+                    *pending_seek_frame = None;
+                    *seek_timing = None;
+                    return true;
+                }
+            }
             if let Some(session) = session {
                 match session.controller.seek(seek) {
                     Ok(serial) => {
@@ -527,6 +656,7 @@ fn handle_command(
             *seek_timing = None;
             *open_requested = true;
             *open_start_frame = None;
+            scrub_cache.deferred_seek = None;
             info.reset_for_replay();
         }
         PlayerCommand::SetPreprocessor { key, preprocessor } => {
@@ -544,7 +674,7 @@ fn handle_command(
 }
 
 fn spawn_decoder(
-    sender: SyncSender<Frame>,
+    sender: SyncSender<SurfaceFrame>,
     frame_ready_tx: FrameReadySender<()>,
     mut command_rx: UnboundedReceiver<PlayerCommand>,
     info: VideoPlayerInfoHandle,
@@ -560,6 +690,14 @@ fn spawn_decoder(
             return;
         }
 
+        // On Windows DXVA is preferred for playback: its frames reach the renderer without a readback.
+        #[cfg(target_os = "windows")]
+        let backend = available
+            .iter()
+            .copied()
+            .find(|backend| *backend == Backend::Dxva)
+            .unwrap_or(available[0]);
+        #[cfg(not(target_os = "windows"))]
         let backend = available[0];
         let mut input_path: Option<PathBuf> = None;
         let mut session: Option<DecoderSession> = None;
@@ -574,6 +712,7 @@ fn spawn_decoder(
         let mut seek_timing: Option<SeekTiming> = None;
         let mut preprocessors: Vec<PreprocessorEntry> = Vec::new();
         let mut last_frame: Option<CachedFrame> = None;
+        let mut scrub_cache = ScrubCache::new();
 
         let mut started = false;
         let mut start_instant = Instant::now();
@@ -595,11 +734,16 @@ fn spawn_decoder(
                         open_requested = false;
                         continue;
                     }
-                    let new_session =
-                        match open_session(backend, input_path, open_start_frame.take(), &info) {
-                            Some(session) => session,
-                            None => return,
-                        };
+                    let new_session = match open_session(
+                        backend,
+                        input_path,
+                        open_start_frame.take(),
+                        playback_format(backend, &preprocessors),
+                        &info,
+                    ) {
+                        Some(session) => session,
+                        None => return,
+                    };
 
                     if let Some(seek) = pending_seek.take() {
                         match new_session.controller.seek(seek) {
@@ -644,18 +788,19 @@ fn spawn_decoder(
                         &mut open_start_frame,
                         &mut preprocessors,
                         &mut refresh_cached,
+                        &mut scrub_cache,
+                        &mut last_frame,
                         &info,
                     ) {
                         break;
                     }
                     if refresh_cached {
-                        if let Some(cache) = last_frame.as_ref() {
-                            if let Some(gpui_frame) = frame_from_cache(cache, &preprocessors) {
-                                if sender.send(gpui_frame).is_ok() {
-                                    let _ = frame_ready_tx.unbounded_send(());
-                                }
-                            }
-                        }
+                        refresh_last_frame(
+                            last_frame.as_ref(),
+                            &preprocessors,
+                            &sender,
+                            &frame_ready_tx,
+                        );
                     }
                 }
                 continue;
@@ -671,6 +816,25 @@ fn spawn_decoder(
                 start_instant += pause_duration;
                 next_deadline += pause_duration;
             }
+            if !paused_like {
+                // A seek deferred for a session that has since gone is dropped with it.
+                if let Some((seek, target)) = scrub_cache.deferred_seek.take()
+                    && let Some(session_ref) = session.as_ref()
+                {
+                    match session_ref.controller.seek(seek) {
+                        Ok(serial) => {
+                            seek_timing = Some(SeekTiming { serial });
+                            pending_seek_frame = target;
+                        }
+                        Err(_) => {
+                            pending_seek = Some(seek);
+                            open_requested = true;
+                            session = None;
+                            continue;
+                        }
+                    }
+                }
+            }
 
             let allow_seek_frames = seek_timing.is_some();
             let allow_first_frame = prime_first_frame && !has_frame;
@@ -696,17 +860,25 @@ fn spawn_decoder(
                         &mut open_start_frame,
                         &mut preprocessors,
                         &mut refresh_cached,
+                        &mut scrub_cache,
+                        &mut last_frame,
                         &info,
                     ) {
                         break;
                     }
                     if refresh_cached {
-                        if let Some(cache) = last_frame.as_ref() {
-                            if let Some(gpui_frame) = frame_from_cache(cache, &preprocessors) {
-                                if sender.send(gpui_frame).is_ok() {
-                                    let _ = frame_ready_tx.unbounded_send(());
-                                }
-                            }
+                        refresh_last_frame(
+                            last_frame.as_ref(),
+                            &preprocessors,
+                            &sender,
+                            &frame_ready_tx,
+                        );
+                        if session_format_stale(session.as_ref(), backend, &preprocessors) {
+                            open_requested = true;
+                            open_start_frame = info.snapshot().last_frame_index;
+                            scrub_cache.reset();
+                            prime_first_frame = true;
+                            has_frame = false;
                         }
                     }
                     if open_requested {
@@ -742,18 +914,25 @@ fn spawn_decoder(
                         &mut open_start_frame,
                         &mut preprocessors,
                         &mut refresh_cached,
+                        &mut scrub_cache,
+                        &mut last_frame,
                         &info,
                     ) {
                         break;
                     }
                     if refresh_cached {
-                        if let Some(cache) = last_frame.as_ref() {
-                            if let Some(gpui_frame) = frame_from_cache(cache, &preprocessors)
-                            {
-                                if sender.send(gpui_frame).is_ok() {
-                                    let _ = frame_ready_tx.unbounded_send(());
-                                }
-                            }
+                        refresh_last_frame(
+                            last_frame.as_ref(),
+                            &preprocessors,
+                            &sender,
+                            &frame_ready_tx,
+                        );
+                        if session_format_stale(session.as_ref(), backend, &preprocessors) {
+                            open_requested = true;
+                            open_start_frame = info.snapshot().last_frame_index;
+                            scrub_cache.reset();
+                            prime_first_frame = paused;
+                            has_frame = false;
                         }
                     }
                     restart_requested = open_requested;
@@ -840,9 +1019,13 @@ fn spawn_decoder(
                             }
 
                             if let Some(cache) = cache_from_video_frame(&frame) {
-                                last_frame = Some(cache.clone());
-                                if let Some(gpui_frame) = frame_from_cache(&cache, &preprocessors)
-                                {
+                                let rendered = frame_from_cache(&cache, &preprocessors);
+                                if let Some(index) = frame.index() {
+                                    let bytes = cache.bytes();
+                                    scrub_cache.frames.insert(index, cache.clone(), bytes);
+                                }
+                                last_frame = Some(cache);
+                                if let Some(gpui_frame) = rendered {
                                     if sender.send(gpui_frame).is_err() {
                                         break;
                                     }
@@ -888,7 +1071,27 @@ fn spawn_decoder(
 }
 
 fn cache_from_video_frame(frame: &VideoFrame) -> Option<CachedFrame> {
-    if frame.native().is_some() {
+    if let Some(native) = frame.native() {
+        #[cfg(target_os = "windows")]
+        {
+            use subtitle_fast_decoder::backends::dxva::DxvaTexture;
+
+            if let Some(texture) = DxvaTexture::from_native(native) {
+                // The cloned buffer holds the decoder's reference for as long as gpui draws it.
+                let owner: Arc<dyn Send + Sync> = Arc::new(native.clone());
+                let shared = unsafe {
+                    gpui::SharedTexture::new(
+                        texture.shared_handle,
+                        texture.id,
+                        texture.width,
+                        texture.height,
+                        owner,
+                    )
+                };
+                return Some(CachedFrame::Texture(shared));
+            }
+        }
+        let _ = native;
         eprintln!("native frame output is unsupported in this component; use NV12 output");
         return None;
     }
@@ -896,17 +1099,46 @@ fn cache_from_video_frame(frame: &VideoFrame) -> Option<CachedFrame> {
     let y_plane = Arc::from(frame.y_plane().to_vec().into_boxed_slice());
     let uv_plane = Arc::from(frame.uv_plane().to_vec().into_boxed_slice());
 
-    Some(CachedFrame {
+    Some(CachedFrame::Planes(CachedPlanes {
         width: frame.width(),
         height: frame.height(),
         y_stride: frame.y_stride(),
         uv_stride: frame.uv_stride(),
         y_plane,
         uv_plane,
-    })
+    }))
+}
+
+fn refresh_last_frame(
+    last_frame: Option<&CachedFrame>,
+    preprocessors: &[PreprocessorEntry],
+    sender: &SyncSender<SurfaceFrame>,
+    frame_ready_tx: &FrameReadySender<()>,
+) {
+    let Some(gpui_frame) = last_frame.and_then(|cache| frame_from_cache(cache, preprocessors))
+    else {
+        return;
+    };
+    if sender.send(gpui_frame).is_ok() {
+        let _ = frame_ready_tx.unbounded_send(());
+    }
+}
+
+fn frame_from_cache(
+    cache: &CachedFrame,
+    preprocessors: &[PreprocessorEntry],
+) -> Option<SurfaceFrame> {
+    match cache {
+        CachedFrame::Planes(planes) => planes_from_cache(planes, preprocessors).map(Into::into),
+        // Textures cannot be preprocessed; the session is reopened with NV12 output instead.
+        #[cfg(target_os = "windows")]
+        CachedFrame::Texture(texture) => preprocessors
+            .is_empty()
+            .then(|| SurfaceFrame::D3D11Texture(texture.clone())),
+    }
 }
 
-fn frame_from_cache(cache: &CachedFrame, preprocessors: &[PreprocessorEntry]) -> Option<Frame> {
+fn planes_from_cache(cache: &CachedPlanes, preprocessors: &[PreprocessorEntry]) -> Option<Frame> {
     if preprocessors.is_empty() {
         Frame::from_nv12(
             cache.width,
@@ -1,11 +1,15 @@
 use std::env;
-use std::num::NonZeroUsize;
+use std::num::{NonZeroU32, NonZeroUsize};
+use std::path::Path;
 
 use clap::CommandFactory;
-use subtitle_fast::backend::{self, ExecutionPlan};
+use subtitle_fast::backend::{self, BatchPlan, ExecutionPlan};
 use subtitle_fast::cli::{CliArgs, CliSources, parse_cli};
-use subtitle_fast::settings::{ConfigError, resolve_settings};
+use subtitle_fast::settings::{
+    ConfigError, EffectiveSettings, default_index_cache, resolve_settings,
+};
 use subtitle_fast::stage::PipelineConfig;
+use subtitle_fast::stage::ocr::FullResolutionSource;
 use subtitle_fast_types::DecoderError;
 
 #[tokio::main(flavor = "multi_thread")]
@@ -41,13 +45,16 @@ fn run_gui() -> Result<(), DecoderError> {
 }
 
 async fn run_cli() -> Result<(), DecoderError> {
-    match prepare_execution_plan().await? {
-        Some(plan) => backend::run(plan).await,
+    match prepare_batch_plan().await? {
+        Some(batch) => backend::run_batch(batch).await,
         None => Ok(()),
     }
 }
 
-async fn prepare_execution_plan() -> Result<Option<ExecutionPlan>, DecoderError> {
+/// Default number of inputs a batch decodes at once.
+const DEFAULT_BATCH_JOBS: usize = 2;
+
+async fn prepare_batch_plan() -> Result<Option<BatchPlan>, DecoderError> {
     let (cli_args, cli_sources): (CliArgs, CliSources) = parse_cli();
 
     if cli_args.list_backends {
@@ -55,48 +62,138 @@ async fn prepare_execution_plan() -> Result<Option<ExecutionPlan>, DecoderError>
         return Ok(None);
     }
 
-    let input = match cli_args.input.clone() {
-        Some(path) => path,
-        None => {
-            usage();
-            return Ok(None);
-        }
-    };
+    if cli_args.inputs.is_empty() {
+        usage();
+        return Ok(None);
+    }
 
-    if !input.exists() {
+    if let Some(missing) = cli_args.inputs.iter().find(|input| !input.exists()) {
         return Err(DecoderError::configuration(format!(
             "input file '{}' does not exist",
-            input.display()
+            missing.display()
         )));
     }
 
     let resolved = resolve_settings(&cli_args, &cli_sources).map_err(map_config_error)?;
     let settings = resolved.settings;
 
-    let pipeline = PipelineConfig::from_settings(&settings, &input)?;
+    #[cfg(target_os = "windows")]
+    subtitle_fast_decoder::backends::dxva::set_sessions_per_adapter(
+        settings
+            .decoder
+            .sessions_per_adapter
+            .and_then(|sessions| NonZeroUsize::new(sessions as usize)),
+    );
+
+    // Every input shares one OCR engine; a batch sends each input's subtitles next to it, or into
+    // the output path as a directory.
+    let shared = PipelineConfig::from_settings(&settings, &cli_args.inputs[0])?;
+    let output_dir = settings.output.path.as_deref();
+    let mut plans: Vec<ExecutionPlan> = Vec::with_capacity(cli_args.inputs.len());
+    for input in &cli_args.inputs {
+        let pipeline = if cli_args.inputs.len() == 1 {
+            shared.clone()
+        } else {
+            shared.for_batch_input(input, output_dir)
+        };
+        if let Some(other) = plans
+            .iter()
+            .find(|plan| plan.pipeline.output.path == pipeline.output.path)
+        {
+            return Err(DecoderError::configuration(format!(
+                "inputs '{}' and '{}' would both write {}",
+                other
+                    .config
+                    .input
+                    .as_deref()
+                    .unwrap_or(input.as_path())
+                    .display(),
+                input.display(),
+                pipeline.output.path.display()
+            )));
+        }
+        plans.push(execution_plan(&settings, input, pipeline)?);
+    }
+
+    let jobs = cli_args
+        .jobs
+        .and_then(|jobs| NonZeroUsize::new(jobs as usize))
+        .unwrap_or(NonZeroUsize::new(DEFAULT_BATCH_JOBS).unwrap());
+    Ok(Some(BatchPlan { plans, jobs }))
+}
 
+fn execution_plan(
+    settings: &EffectiveSettings,
+    input: &Path,
+    mut pipeline: PipelineConfig,
+) -> Result<ExecutionPlan, DecoderError> {
     let env_backend_present = std::env::var("SUBFAST_BACKEND").is_ok();
     let mut config = subtitle_fast_decoder::Configuration::from_env().unwrap_or_default();
     let backend_override = match settings.decoder.backend.as_ref() {
         Some(name) => Some(backend::parse_backend(name)?),
         None => None,
     };
-    let backend_locked = backend_override.is_some() || env_backend_present;
+    let mut backend_locked = backend_override.is_some() || env_backend_present;
     if let Some(backend_value) = backend_override {
         config.backend = backend_value;
     }
-    config.input = Some(input);
+    config.input = Some(input.to_path_buf());
+    if config.index_cache.is_none() {
+        config.index_cache = default_index_cache();
+    }
+    // Detection, comparison and OCR read only the Y plane.
+    config.output_format = subtitle_fast_decoder::OutputFormat::Luma;
     if let Some(capacity) = settings.decoder.channel_capacity
         && let Some(non_zero) = NonZeroUsize::new(capacity)
     {
         config.channel_capacity = Some(non_zero);
     }
+    if settings.decoder.sampled_readback {
+        config.samples_per_second = NonZeroU32::new(settings.detection.samples_per_second);
+    }
+    config.retained_frames =
+        NonZeroUsize::new(subtitle_fast::stage::sampler::DEFAULT_POOL_CAPACITY);
+    if settings.decoder.gpu_crop {
+        config.crop = settings.detection.roi;
+    }
+    if settings.decoder.gpu_gate {
+        config.luma_gate = Some(subtitle_fast_decoder::LumaGate {
+            target: settings.detection.target,
+            delta: settings.detection.delta,
+        });
+    }
+    if let Some(threshold) = settings.decoder.change_threshold {
+        config.change_detection = Some(subtitle_fast_decoder::ChangeDetection { threshold });
+    }
+    if settings.decoder.prefetch_mib.is_some() || settings.decoder.prefetch_map {
+        let window = settings
+            .decoder
+            .prefetch_mib
+            .unwrap_or(subtitle_fast_decoder::Prefetch::DEFAULT_WINDOW_MIB);
+        config.prefetch = NonZeroU32::new(window).and_then(|window| {
+            subtitle_fast_decoder::Prefetch::from_mib(window, settings.decoder.prefetch_map)
+        });
+    }
+    // Block leaves a SUBFAST_BACKPRESSURE policy in force.
+    if settings.decoder.backpressure != subtitle_fast_decoder::Backpressure::Block {
+        config.backpressure = settings.decoder.backpressure;
+    }
+    if let Some(height) = settings.decoder.detection_height.and_then(NonZeroU32::new) {
+        config.scale_height = Some(height);
+        pipeline.ocr.full_resolution = Some(FullResolutionSource::new(&config));
+    }
+    // After the full-resolution source is taken: its re-reads decode the input itself.
+    if let Some(cache) = backend::luma_cache_config(settings)
+        && backend::attach_luma_cache(&mut config, cache)
+    {
+        backend_locked = true;
+    }
 
-    Ok(Some(ExecutionPlan {
+    Ok(ExecutionPlan {
         config,
         backend_locked,
         pipeline,
-    }))
+    })
 }
 
 fn usage() {
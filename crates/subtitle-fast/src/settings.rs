@@ -1,12 +1,14 @@
 use std::env;
 use std::fmt;
 use std::fs;
+use std::num::NonZeroU32;
 use std::path::{Path, PathBuf};
 use std::str::FromStr;
 
 use directories::ProjectDirs;
 use serde::Deserialize;
 use subtitle_fast_comparator::ComparatorKind;
+use subtitle_fast_decoder::Backpressure;
 use subtitle_fast_types::RoiConfig;
 use subtitle_fast_validator::subtitle_detection::{DEFAULT_DELTA, DEFAULT_TARGET};
 
@@ -25,6 +27,17 @@ struct FileConfig {
 struct DecoderFileConfig {
     backend: Option<String>,
     channel_capacity: Option<usize>,
+    sampled_readback: Option<bool>,
+    gpu_crop: Option<bool>,
+    gpu_gate: Option<bool>,
+    detection_height: Option<u32>,
+    change_threshold: Option<u8>,
+    sessions_per_adapter: Option<u32>,
+    prefetch_mib: Option<u32>,
+    prefetch_map: Option<bool>,
+    luma_cache: Option<bool>,
+    luma_cache_compress: Option<bool>,
+    backpressure: Option<String>,
 }
 
 #[derive(Debug, Default, Deserialize, Clone)]
@@ -77,6 +90,22 @@ pub struct DetectionSettings {
 pub struct DecoderSettings {
     pub backend: Option<String>,
     pub channel_capacity: Option<usize>,
+    pub sampled_readback: bool,
+    pub gpu_crop: bool,
+    pub gpu_gate: bool,
+    /// Source height the decoder scales to for detection; `None` keeps native resolution.
+    pub detection_height: Option<u32>,
+    /// Luma levels a frame may drift from the last one read back and still be delivered as its repeat.
+    pub change_threshold: Option<u8>,
+    /// Hardware decode sessions allowed per GPU at once; `None` leaves them unbounded.
+    pub sessions_per_adapter: Option<u32>,
+    /// Read-ahead window of the decoder's byte stream; `None` without `prefetch_map` reads the file directly.
+    pub prefetch_mib: Option<u32>,
+    pub prefetch_map: bool,
+    /// Record the sampled ROI luma of a full decode and replay it on later runs it covers.
+    pub luma_cache: bool,
+    pub luma_cache_compress: bool,
+    pub backpressure: Backpressure,
 }
 
 #[derive(Debug, Clone, Default)]
@@ -270,9 +299,62 @@ fn merge(
     let decoder_backend = normalize_string(cli.backend.clone())
         .or_else(|| normalize_string(decoder_cfg.backend.clone()));
 
+    let decoder_sampled_readback =
+        cli.decoder_sampled_readback || decoder_cfg.sampled_readback.unwrap_or(false);
+    let decoder_gpu_crop = cli.decoder_gpu_crop || decoder_cfg.gpu_crop.unwrap_or(false);
+    let decoder_gpu_gate = cli.decoder_gpu_gate || decoder_cfg.gpu_gate.unwrap_or(false);
+    let decoder_detection_height = cli
+        .decoder_detection_height
+        .or(decoder_cfg.detection_height)
+        .filter(|height| *height > 0);
+    let decoder_change_threshold = cli
+        .decoder_change_threshold
+        .or(decoder_cfg.change_threshold);
+    let decoder_sessions_per_adapter = cli
+        .decoder_sessions_per_adapter
+        .or(decoder_cfg.sessions_per_adapter)
+        .filter(|sessions| *sessions > 0);
+    let decoder_prefetch_map =
+        cli.decoder_prefetch_map || decoder_cfg.prefetch_map.unwrap_or(false);
+    let decoder_prefetch_mib = cli.decoder_prefetch_mib.or(decoder_cfg.prefetch_mib);
+    let decoder_luma_cache = cli.decoder_luma_cache || decoder_cfg.luma_cache.unwrap_or(false);
+    let decoder_luma_cache_compress =
+        cli.decoder_luma_cache_compress || decoder_cfg.luma_cache_compress.unwrap_or(false);
+    let decoder_backpressure = resolve_decoder_backpressure(
+        cli.decoder_backpressure.clone(),
+        decoder_cfg.backpressure.clone(),
+        detection_samples_per_second,
+        config_path.as_ref(),
+    )?;
+    // The bridges take the window as a 32-bit byte count.
+    if let Some(mib) = decoder_prefetch_mib
+        && !(1..4096).contains(&mib)
+    {
+        return Err(ConfigError::InvalidValue {
+            path: cli
+                .decoder_prefetch_mib
+                .is_none()
+                .then(|| config_path.clone())
+                .flatten(),
+            field: "decoder_prefetch_mib",
+            value: mib.to_string(),
+        });
+    }
+
     let decoder_settings = DecoderSettings {
         backend: decoder_backend,
         channel_capacity: decoder_channel_capacity,
+        sampled_readback: decoder_sampled_readback,
+        gpu_crop: decoder_gpu_crop,
+        gpu_gate: decoder_gpu_gate,
+        detection_height: decoder_detection_height,
+        change_threshold: decoder_change_threshold,
+        sessions_per_adapter: decoder_sessions_per_adapter,
+        prefetch_mib: decoder_prefetch_mib,
+        prefetch_map: decoder_prefetch_map,
+        luma_cache: decoder_luma_cache,
+        luma_cache_compress: decoder_luma_cache_compress,
+        backpressure: decoder_backpressure,
     };
 
     let output_settings = OutputSettings {
@@ -294,6 +376,18 @@ fn merge(
     Ok(ResolvedSettings { settings })
 }
 
+/// Where DXVA/MFT keep per-file frame indexes unless `SUBFAST_INDEX_CACHE` says otherwise.
+pub fn default_index_cache() -> Option<PathBuf> {
+    ProjectDirs::from("rs", "subtitle-fast", "subtitle-fast")
+        .map(|dirs| dirs.cache_dir().join("index"))
+}
+
+/// Where recorded ROI luma caches are kept.
+pub fn default_luma_cache() -> Option<PathBuf> {
+    ProjectDirs::from("rs", "subtitle-fast", "subtitle-fast")
+        .map(|dirs| dirs.cache_dir().join("luma"))
+}
+
 fn default_config_path() -> Option<PathBuf> {
     ProjectDirs::from("rs", "subtitle-fast", "subtitle-fast")
         .map(|dirs| dirs.config_dir().join("config.toml"))
@@ -424,6 +518,30 @@ fn round_roi(value: f32) -> f32 {
     (value * SCALE).round() / SCALE
 }
 
+/// `unsampled` on its own drops the frames the detection sampler would skip at its own rate.
+fn resolve_decoder_backpressure(
+    cli_value: Option<String>,
+    file_value: Option<String>,
+    samples_per_second: u32,
+    config_path: Option<&PathBuf>,
+) -> Result<Backpressure, ConfigError> {
+    let from_cli = cli_value.is_some();
+    let Some(value) = normalize_string(cli_value).or_else(|| normalize_string(file_value)) else {
+        return Ok(Backpressure::Block);
+    };
+    let parsed = if value.eq_ignore_ascii_case("unsampled") {
+        NonZeroU32::new(samples_per_second)
+            .map(|samples_per_second| Backpressure::Unsampled { samples_per_second })
+    } else {
+        value.parse().ok()
+    };
+    parsed.ok_or_else(|| ConfigError::InvalidValue {
+        path: (!from_cli).then(|| config_path.cloned()).flatten(),
+        field: "decoder_backpressure",
+        value,
+    })
+}
+
 fn resolve_comparator_kind(
     cli_value: Option<String>,
     file_value: Option<String>,
@@ -565,4 +683,23 @@ mod tests {
         let roi = resolve_detection_roi(None, Some(file_roi), true, None).unwrap();
         assert_eq!(roi, full_frame_roi());
     }
+
+    #[test]
+    fn unsampled_backpressure_follows_the_detection_rate() {
+        let policy = resolve_decoder_backpressure(None, Some("unsampled".into()), 7, None).unwrap();
+        assert_eq!(
+            policy,
+            Backpressure::Unsampled {
+                samples_per_second: NonZeroU32::new(7).unwrap()
+            }
+        );
+        let policy =
+            resolve_decoder_backpressure(Some("drop".into()), Some("bogus".into()), 7, None);
+        assert_eq!(policy.unwrap(), Backpressure::DropWhenFull);
+        assert_eq!(
+            resolve_decoder_backpressure(None, None, 7, None).unwrap(),
+            Backpressure::Block
+        );
+        assert!(resolve_decoder_backpressure(Some("newest".into()), None, 7, None).is_err());
+    }
 }
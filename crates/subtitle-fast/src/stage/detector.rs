@@ -6,7 +6,7 @@ use tokio::sync::mpsc;
 use super::StreamBundle;
 use super::sampler::{SampledFrame, SamplerResult};
 use crate::settings::DetectionSettings;
-use subtitle_fast_types::{DecoderError, SubtitleDetectionResult};
+use subtitle_fast_types::{DecoderError, RoiConfig, SubtitleDetectionResult, VideoFrame};
 use subtitle_fast_validator::subtitle_detection::SubtitleDetectionError;
 use subtitle_fast_validator::{FrameValidator, FrameValidatorConfig, SubtitleDetectionOptions};
 
@@ -27,6 +27,7 @@ pub enum DetectorError {
 
 pub struct Detector {
     validator: FrameValidator,
+    roi: Option<RoiConfig>,
 }
 
 impl Detector {
@@ -40,7 +41,10 @@ impl Detector {
             detection: detection_options,
         };
         let validator = FrameValidator::new(config)?;
-        Ok(Self { validator })
+        Ok(Self {
+            validator,
+            roi: settings.roi,
+        })
     }
 
     pub fn attach(self, input: StreamBundle<SamplerResult>) -> StreamBundle<DetectionSampleResult> {
@@ -51,9 +55,10 @@ impl Detector {
 
         let (tx, rx) = mpsc::channel::<DetectionSampleResult>(DETECTOR_CHANNEL_CAPACITY);
         let validator = self.validator;
+        let roi = self.roi;
 
         tokio::spawn(async move {
-            let worker = DetectorWorker::new(validator);
+            let mut worker = DetectorWorker::new(validator, roi);
             let mut upstream = stream;
 
             while let Some(sample_result) = upstream.next().await {
@@ -88,21 +93,59 @@ impl Detector {
 
 struct DetectorWorker {
     validator: FrameValidator,
+    roi: Option<RoiConfig>,
+    /// Last frame with pixels and its result, for frames the decoder marks as repeating it.
+    last: Option<(VideoFrame, SubtitleDetectionResult)>,
 }
 
 impl DetectorWorker {
-    fn new(validator: FrameValidator) -> Self {
-        Self { validator }
+    fn new(validator: FrameValidator, roi: Option<RoiConfig>) -> Self {
+        Self {
+            validator,
+            roi,
+            last: None,
+        }
+    }
+
+    /// GPU-cropped frames only cover part of the source, so the configured ROI is remapped onto them.
+    fn roi_for(&self, frame: &VideoFrame) -> Option<RoiConfig> {
+        frame.crop()?;
+        let roi = self.roi.unwrap_or(RoiConfig {
+            x: 0.0,
+            y: 0.0,
+            width: 1.0,
+            height: 1.0,
+        });
+        Some(frame.roi_in_frame(&roi))
     }
 
-    async fn handle_sample(&self, sample: SampledFrame) -> Result<DetectionSample, DetectorError> {
+    async fn handle_sample(
+        &mut self,
+        sample: SampledFrame,
+    ) -> Result<DetectionSample, DetectorError> {
         let frame = sample.frame().clone();
         let started = Instant::now();
-        let detection = self
-            .validator
-            .process_frame(frame)
-            .await
-            .map_err(DetectorError::Detection)?;
+        // Holding the last frame keeps its planes alive, so sharing them proves it is the one repeated.
+        let repeated = self
+            .last
+            .as_ref()
+            .filter(|(last, _)| frame.repeats_previous() && frame.shares_pixels(last))
+            .map(|(_, detection)| detection.clone());
+        let detection = match repeated {
+            Some(detection) => detection,
+            None => {
+                let roi = self.roi_for(&frame);
+                let detection = self
+                    .validator
+                    .process_frame_with_roi(frame.clone(), roi)
+                    .await
+                    .map_err(DetectorError::Detection)?;
+                if frame.has_pixels() {
+                    self.last = Some((frame, detection.clone()));
+                }
+                detection
+            }
+        };
         let elapsed = started.elapsed();
 
         Ok(DetectionSample {
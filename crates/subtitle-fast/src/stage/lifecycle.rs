@@ -152,6 +152,17 @@ struct ActiveRegion {
     last_time: Duration,
     last_frame: u64,
     frame: Arc<VideoFrame>,
+    /// Features of `frame` once it matched; a decoder repeat of it matches again without extraction.
+    frame_features: Option<FeatureBlob>,
+}
+
+impl ActiveRegion {
+    fn repeated_features(&self, frame: &VideoFrame, roi: &RoiConfig) -> Option<FeatureBlob> {
+        if !frame.repeats_previous() || !frame.shares_pixels(&self.frame) || self.roi != *roi {
+            return None;
+        }
+        self.frame_features.clone()
+    }
 }
 
 struct RegionLifecycleWorker {
@@ -178,13 +189,21 @@ impl RegionLifecycleWorker {
         self.last_history = Some(frame_ctx.history.clone());
 
         let mut roi_features: Vec<Option<FeatureBlob>> = Vec::with_capacity(event.regions.len());
+        let mut repeated: Vec<bool> = Vec::with_capacity(event.regions.len());
         for region in &event.regions {
-            let features = timed_extract(
-                timings,
-                self.comparator.as_ref(),
-                &frame_ctx.frame,
-                &region.roi,
-            );
+            let reused = self
+                .active
+                .get(&region.id)
+                .and_then(|active| active.repeated_features(&frame_ctx.frame, &region.roi));
+            repeated.push(reused.is_some());
+            let features = reused.or_else(|| {
+                timed_extract(
+                    timings,
+                    self.comparator.as_ref(),
+                    &frame_ctx.frame,
+                    &region.roi,
+                )
+            });
             roi_features.push(features);
         }
 
@@ -196,14 +215,15 @@ impl RegionLifecycleWorker {
                 continue;
             };
             if let Some(active) = self.active.get(&region.id) {
-                let matched = match_active(
-                    self.comparator.as_ref(),
-                    active,
-                    &frame_ctx,
-                    &region.roi,
-                    &features,
-                    timings,
-                );
+                let matched = repeated[idx]
+                    || match_active(
+                        self.comparator.as_ref(),
+                        active,
+                        &frame_ctx,
+                        &region.roi,
+                        &features,
+                        timings,
+                    );
                 if matched {
                     if let Some(active) = self.active.get_mut(&region.id) {
                         active.roi = region.roi;
@@ -211,6 +231,7 @@ impl RegionLifecycleWorker {
                         active.last_time = frame_ctx.time;
                         active.last_frame = frame_ctx.frame_index;
                         active.template_features = features.clone();
+                        active.frame_features = Some(features.clone());
                         active.anchor_features = Some(features);
                     }
                     seen.insert(region.id);
@@ -270,6 +291,7 @@ impl RegionLifecycleWorker {
             last_time: frame.time,
             last_frame: frame.frame_index,
             frame: frame.frame,
+            frame_features: None,
         }
     }
 
@@ -20,12 +20,14 @@ use crate::settings::{DetectionSettings, EffectiveSettings};
 use determiner::{RegionDeterminer, RegionDeterminerError};
 use lifecycle::{RegionLifecycleError, RegionLifecycleTracker};
 use merge::{Merge, MergeResult};
-use ocr::{OcrStageError, SubtitleOcr};
+use ocr::{FullResolutionSource, OcrStageError, SubtitleOcr};
 use sampler::FrameSampler;
 use sorter::FrameSorter;
-use subtitle_fast_decoder::DynDecoderProvider;
+use subtitle_fast_decoder::{DecoderStats, DecoderStatsSnapshot, DynDecoderProvider};
 #[cfg(all(feature = "ocr-vision", target_os = "macos"))]
 use subtitle_fast_ocr::VisionOcrEngine;
+#[cfg(all(feature = "ocr-windows", target_os = "windows"))]
+use subtitle_fast_ocr::WindowsOcrEngine;
 use subtitle_fast_ocr::{NoopOcrEngine, OcrEngine};
 use subtitle_fast_types::DecoderError;
 use subtitle_fast_validator::subtitle_detection::SubtitleDetectionError;
@@ -59,6 +61,8 @@ pub struct PipelineConfig {
 #[derive(Clone)]
 pub struct OcrPipelineConfig {
     pub engine: Arc<dyn OcrEngine>,
+    /// Set when the decoder scales frames for detection; OCR then re-reads regions at source size.
+    pub full_resolution: Option<FullResolutionSource>,
 }
 
 #[derive(Clone)]
@@ -76,10 +80,26 @@ impl PipelineConfig {
             .unwrap_or_else(|| default_output_path(input));
         Ok(Self {
             detection: settings.detection.clone(),
-            ocr: OcrPipelineConfig { engine },
+            ocr: OcrPipelineConfig {
+                engine,
+                full_resolution: None,
+            },
             output: OutputPipelineConfig { path: output_path },
         })
     }
+
+    /// The same settings, OCR engine included, for one input of a batch. Its subtitles go next to
+    /// it, or into `output_dir` under its file name.
+    pub fn for_batch_input(&self, input: &Path, output_dir: Option<&Path>) -> Self {
+        let path = default_output_path(input);
+        let path = match (output_dir, path.file_name()) {
+            (Some(dir), Some(name)) => dir.join(name),
+            _ => path,
+        };
+        let mut config = self.clone();
+        config.output.path = path;
+        config
+    }
 }
 
 #[derive(Clone, Debug, Default, PartialEq)]
@@ -120,6 +140,7 @@ pub struct PipelineOutputs {
 #[derive(Clone)]
 pub struct PipelineHandle {
     pause_tx: tokio::sync::watch::Sender<bool>,
+    decoder_stats: Arc<DecoderStats>,
 }
 
 impl PipelineHandle {
@@ -130,6 +151,11 @@ impl PipelineHandle {
     pub fn set_paused(&self, paused: bool) {
         let _ = self.pause_tx.send(paused);
     }
+
+    /// Per-stage decoder timings; empty for backends that do not instrument their decode loop.
+    pub fn decoder_stats(&self) -> DecoderStatsSnapshot {
+        self.decoder_stats.snapshot()
+    }
 }
 
 pub fn build_pipeline(
@@ -137,7 +163,8 @@ pub fn build_pipeline(
     pipeline: &PipelineConfig,
 ) -> Result<PipelineOutputs, DecoderError> {
     let initial_total_frames = provider.metadata().total_frames;
-    let (_, initial_stream) = provider.open()?;
+    let (controller, initial_stream) = provider.open()?;
+    let decoder_stats = controller.stats_handle();
 
     let (pause_tx, pause_rx) = tokio::sync::watch::channel(false);
 
@@ -154,14 +181,19 @@ pub fn build_pipeline(
     let detected = detector_stage.attach(sampled);
     let determined = RegionDeterminer::new().attach(detected);
     let tracked = RegionLifecycleTracker::new(&pipeline.detection).attach(determined);
-    let ocred = SubtitleOcr::new(Arc::clone(&pipeline.ocr.engine)).attach(tracked);
+    let ocred = SubtitleOcr::new(Arc::clone(&pipeline.ocr.engine))
+        .with_full_resolution(pipeline.ocr.full_resolution.clone())
+        .attach(tracked);
     let merged: StreamBundle<MergeResult> = Merge::with_default_window().attach(ocred);
     let averaged: StreamBundle<AveragerResult> = Averager::new().attach(merged);
 
     Ok(PipelineOutputs {
         stream: averaged.stream,
         total_frames: averaged.total_frames,
-        handle: PipelineHandle { pause_tx },
+        handle: PipelineHandle {
+            pause_tx,
+            decoder_stats,
+        },
     })
 }
 
@@ -266,6 +298,15 @@ fn build_ocr_engine(_settings: &EffectiveSettings) -> Arc<dyn OcrEngine> {
             }
         }
     }
+    #[cfg(all(feature = "ocr-windows", target_os = "windows"))]
+    {
+        match WindowsOcrEngine::new() {
+            Ok(engine) => return Arc::new(engine),
+            Err(err) => {
+                eprintln!("windows OCR engine failed to initialize: {err}");
+            }
+        }
+    }
     Arc::new(NoopOcrEngine)
 }
 
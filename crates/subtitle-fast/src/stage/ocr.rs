@@ -1,3 +1,4 @@
+use std::num::NonZeroUsize;
 use std::sync::Arc;
 use std::time::{Duration, Instant};
 
@@ -9,8 +10,9 @@ use super::detector::DetectionSample;
 use super::lifecycle::{
     CompletedRegion, LifecycleEvent, LifecycleResult, RegionLifecycleError, RegionTimings,
 };
+use subtitle_fast_decoder::{Backpressure, Configuration, ScanMode};
 use subtitle_fast_ocr::{LumaPlane, OcrEngine, OcrError, OcrRequest};
-use subtitle_fast_types::{OcrRegion, OcrResponse, RoiConfig, VideoFrame};
+use subtitle_fast_types::{DecoderError, OcrRegion, OcrResponse, RoiConfig, VideoFrame};
 
 const OCR_CHANNEL_CAPACITY: usize = 4;
 
@@ -19,11 +21,20 @@ pub type OcrStageResult = Result<OcrEvent, OcrStageError>;
 
 pub struct SubtitleOcr {
     engine: Arc<dyn OcrEngine>,
+    full_resolution: Option<FullResolutionSource>,
 }
 
 impl SubtitleOcr {
     pub fn new(engine: Arc<dyn OcrEngine>) -> Self {
-        Self { engine }
+        Self {
+            engine,
+            full_resolution: None,
+        }
+    }
+
+    pub fn with_full_resolution(mut self, source: Option<FullResolutionSource>) -> Self {
+        self.full_resolution = source;
+        self
     }
 
     pub fn attach(self, input: StreamBundle<LifecycleResult>) -> StreamBundle<OcrStageResult> {
@@ -33,6 +44,7 @@ impl SubtitleOcr {
         } = input;
 
         let engine = self.engine;
+        let full_resolution = self.full_resolution;
         let (tx, rx) = mpsc::channel::<OcrStageResult>(OCR_CHANNEL_CAPACITY);
 
         tokio::spawn(async move {
@@ -41,13 +53,13 @@ impl SubtitleOcr {
                 return;
             }
 
-            let worker = OcrWorker::new(Arc::clone(&engine));
+            let worker = OcrWorker::new(Arc::clone(&engine), full_resolution);
             let mut upstream = stream;
 
             while let Some(event) = upstream.next().await {
                 match event {
                     Ok(segment_event) => {
-                        let result = worker.handle_event(segment_event);
+                        let result = worker.handle_event(segment_event).await;
                         let is_err = result.is_err();
                         if tx.send(result).await.is_err() {
                             return;
@@ -99,16 +111,98 @@ pub enum OcrStageError {
     Engine(OcrError),
 }
 
+/// Decodes OCR regions again at source resolution when the decoder scaled frames down for detection.
+#[derive(Clone)]
+pub struct FullResolutionSource {
+    config: Configuration,
+}
+
+impl FullResolutionSource {
+    /// `config` is the detection decode; re-reads keep its input and backend but none of its filters.
+    pub fn new(config: &Configuration) -> Self {
+        let mut config = config.clone();
+        config.channel_capacity = NonZeroUsize::new(1);
+        config.start_frame = None;
+        config.samples_per_second = None;
+        config.crop = None;
+        config.retained_frames = None;
+        config.scan = ScanMode::Full;
+        config.decode_workers = None;
+        config.luma_gate = None;
+        config.scale_height = None;
+        config.change_detection = None;
+        config.luma_cache = None;
+        config.backpressure = Backpressure::Block;
+        Self { config }
+    }
+
+    /// Decodes `frame` again unscaled, cropped to `roi` (normalized to `frame`), and returns it with the ROI
+    /// mapped into it. `None` when `frame` was not scaled or the re-read produced nothing.
+    async fn fetch(
+        &self,
+        frame: &VideoFrame,
+        roi: &RoiConfig,
+    ) -> Result<Option<(VideoFrame, RoiConfig)>, DecoderError> {
+        let Some(index) = frame.index().filter(|_| frame.is_scaled()) else {
+            return Ok(None);
+        };
+        let source_roi = frame.roi_in_source(roi);
+        let mut config = self.config.clone();
+        config.start_frame = Some(index);
+        config.crop = Some(source_roi);
+        let (_, mut stream) = config.create_provider()?.open()?;
+        while let Some(item) = stream.next().await {
+            let full = item?;
+            if full.index().is_some_and(|found| found < index) {
+                continue;
+            }
+            let roi = full.roi_in_frame(&source_roi);
+            return Ok(Some((full, roi)));
+        }
+        Ok(None)
+    }
+}
+
 struct OcrWorker {
     engine: Arc<dyn OcrEngine>,
+    full_resolution: Option<FullResolutionSource>,
 }
 
 impl OcrWorker {
-    fn new(engine: Arc<dyn OcrEngine>) -> Self {
-        Self { engine }
+    fn new(engine: Arc<dyn OcrEngine>, full_resolution: Option<FullResolutionSource>) -> Self {
+        Self {
+            engine,
+            full_resolution,
+        }
+    }
+
+    /// The frame and region handed to the engine: a full-resolution re-read when one is configured and the
+    /// frame was scaled, otherwise the detection frame itself.
+    async fn ocr_source(
+        &self,
+        lifecycle: &CompletedRegion,
+        region: OcrRegion,
+    ) -> (Option<VideoFrame>, OcrRegion) {
+        let Some(source) = &self.full_resolution else {
+            return (None, region);
+        };
+        match source.fetch(&lifecycle.frame, &lifecycle.roi).await {
+            Ok(Some((frame, roi))) => {
+                let region = roi_to_region(&roi, &frame);
+                (Some(frame), region)
+            }
+            Ok(None) => (None, region),
+            Err(err) => {
+                eprintln!(
+                    "full-resolution re-read of frame {} failed: {err}; using the detection frame",
+                    lifecycle.start_frame
+                );
+                (None, region)
+            }
+        }
     }
 
-    fn handle_event(&self, event: LifecycleEvent) -> Result<OcrEvent, OcrStageError> {
+    async fn handle_event(&self, event: LifecycleEvent) -> Result<OcrEvent, OcrStageError> {
         let started = Instant::now();
         let mut timings = OcrTimings::default();
         let mut subtitles = Vec::with_capacity(event.completed.len());
@@ -120,8 +214,10 @@ impl OcrWorker {
                 continue;
             };
 
-            let plane = LumaPlane::from_frame(&lifecycle.frame);
-            let regions = [region];
+            let (full_frame, ocr_region) = self.ocr_source(&lifecycle, region).await;
+            let plane =
+                LumaPlane::from_frame(full_frame.as_ref().unwrap_or(lifecycle.frame.as_ref()));
+            let regions = [ocr_region];
             let request = OcrRequest::new(plane, &regions);
             let ocr_started = Instant::now();
             let response = match self.engine.recognize(&request) {
@@ -6,10 +6,12 @@ use futures_util::{StreamExt, stream::unfold};
 use tokio::sync::mpsc;
 
 use super::StreamBundle;
+use subtitle_fast_decoder::SampleSchedule;
 use subtitle_fast_types::{DecoderError, DecoderResult, VideoFrame};
 
 const SAMPLER_CHANNEL_CAPACITY: usize = 1;
-const DEFAULT_POOL_CAPACITY: usize = 24;
+/// History frames kept before the frame rate is known; decoders size their buffer pools from it.
+pub const DEFAULT_POOL_CAPACITY: usize = 24;
 const MAX_POOL_CAPACITY: usize = 240;
 const EPSILON: f64 = 1e-6;
 
@@ -292,72 +294,6 @@ impl SamplerPool {
     }
 }
 
-struct SampleSchedule {
-    samples_per_second: u32,
-    current_second: Option<u64>,
-    targets: Vec<f64>,
-    next_target_idx: usize,
-}
-
-impl SampleSchedule {
-    fn new(samples_per_second: u32) -> Self {
-        let samples = samples_per_second;
-        let mut targets = Vec::with_capacity(samples as usize);
-        for i in 0..samples {
-            let target = if i == 0 {
-                0.0
-            } else {
-                i as f64 / samples as f64
-            };
-            targets.push(target);
-        }
-
-        Self {
-            samples_per_second: samples,
-            current_second: None,
-            targets,
-            next_target_idx: 0,
-        }
-    }
-
-    fn should_sample(&mut self, timestamp: Option<Duration>, processed_index: u64) -> bool {
-        let (second_index, elapsed) = self.resolve_second(timestamp, processed_index);
-
-        if self.current_second != Some(second_index) {
-            self.current_second = Some(second_index);
-            self.next_target_idx = 0;
-        }
-
-        let mut should_sample = false;
-        while self.next_target_idx < self.targets.len()
-            && elapsed + EPSILON >= self.targets[self.next_target_idx]
-        {
-            should_sample = true;
-            self.next_target_idx += 1;
-        }
-
-        should_sample
-    }
-
-    fn resolve_second(&self, timestamp: Option<Duration>, processed_index: u64) -> (u64, f64) {
-        if let Some(ts) = timestamp {
-            let second_index = ts.as_secs();
-            let fractional = ts
-                .checked_sub(Duration::from_secs(second_index))
-                .unwrap_or_else(|| Duration::from_secs(0))
-                .as_secs_f64();
-            return (second_index, fractional);
-        }
-
-        let samples = self.samples_per_second as u64;
-        let processed = processed_index.saturating_sub(1);
-        let second_index = processed / samples;
-        let offset = processed.saturating_sub(second_index * samples);
-        let elapsed = offset as f64 / self.samples_per_second as f64;
-        (second_index, elapsed)
-    }
-}
-
 struct FpsEstimator {
     last: Option<FpsObservation>,
     estimate: Option<f64>,